@@ -22,4 +22,7 @@ LOCAL_SRC_FILES := $(subst ${LOCAL_PATH}/,, \
 
 LOCAL_CFLAGS := -DWITH_SDL2_STATIC
 
+# The filters have NEON paths
+LOCAL_ARM_NEON := true
+
 include $(BUILD_STATIC_LIBRARY)
@@ -0,0 +1,457 @@
+/*
+    This is free and unencumbered software released into the public domain.
+
+    Anyone is free to copy, modify, publish, use, compile, sell, or
+    distribute this software, either in source code form or as a compiled
+    binary, for any purpose, commercial or non-commercial, and by any
+    means.
+
+    In jurisdictions that recognize copyright laws, the author or authors
+    of this software dedicate any and all copyright interest in the
+    software to the public domain. We make this dedication for the benefit
+    of the public at large and to the detriment of our heirs and
+    successors. We intend this dedication to be an overt act of
+    relinquishment in perpetuity of all present and future rights to this
+    software under copyright law.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+    MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+    IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+    OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+    ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+    OTHER DEALINGS IN THE SOFTWARE.
+
+    For more information, please refer to <http://unlicense.org>
+*/
+
+// Renders audio scenarios on SoLoud's null driver as fast as possible
+// Usage: bench-audio [--seconds <n>] [--wav <prefix>] [--compare <prefix> [--tolerance <dB>]]
+//                    [<scenario>|@<file>]...
+// A scenario is a comma separated list of key=value pairs:
+//   name=<label>, voices=<n>, filters=<echo+flanger+biquad+lofi+dcremoval+bassboost>,
+//   bus=<0|1>, 3d=<0|1>, format=<float|int16|adpcm>
+// Files list one scenario per line, lines starting with # are ignored
+// --compare checks the output against WAV files from an earlier --wav run,
+// and fails the scenarios whose signal to error ratio is under the tolerance (90dB by default)
+
+#include "audio/audio.hpp"
+#include "audio/sample.hpp"
+#include "system/scheduler.hpp"
+
+#include <soloud/soloud_bassboostfilter.h>
+#include <soloud/soloud_biquadresonantfilter.h>
+#include <soloud/soloud_bus.h>
+#include <soloud/soloud_dcremovalfilter.h>
+#include <soloud/soloud_echofilter.h>
+#include <soloud/soloud_flangerfilter.h>
+#include <soloud/soloud_lofifilter.h>
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+//----------------------------------------------------------
+// Locals
+//----------------------------------------------------------
+namespace
+{
+    using Clock = std::chrono::high_resolution_clock;
+
+    const unsigned Samplerate = 44100u;
+    const unsigned BlockFrames = 512u;
+
+    struct Scenario
+    {
+        std::string name;
+        unsigned voices {16u};
+        std::vector<std::string> filters;
+        bool bus {false};
+        bool positional {false};
+        SampleBank::Format format {SampleBank::Float32};
+    };
+
+    const char* defaultScenarios[] = {
+        "name=plain-1,voices=1",
+        "name=plain-16,voices=16",
+        "name=plain-64,voices=64",
+        "name=int16-64,voices=64,format=int16",
+        "name=adpcm-64,voices=64,format=adpcm",
+        "name=echo-16,voices=16,filters=echo",
+        "name=flanger-16,voices=16,filters=flanger",
+        "name=biquad-16,voices=16,filters=biquad",
+        "name=lofi-16,voices=16,filters=lofi",
+        "name=dcremoval-16,voices=16,filters=dcremoval",
+        "name=bassboost-16,voices=16,filters=bassboost",
+        "name=chain-16,voices=16,filters=biquad+echo+flanger+lofi",
+        "name=bus-16,voices=16,bus=1,filters=echo",
+        "name=3d-64,voices=64,3d=1"
+    };
+
+    bool parseScenario(const std::string& line, Scenario& scenario)
+    {
+        std::istringstream stream(line);
+        std::string pair;
+
+        while (std::getline(stream, pair, ',')) {
+            auto separator = pair.find('=');
+            if (separator == std::string::npos) return false;
+
+            auto key = pair.substr(0u, separator);
+            auto value = pair.substr(separator + 1u);
+
+            if (key == "name") {
+                scenario.name = value;
+            }
+            else if (key == "voices") {
+                scenario.voices = static_cast<unsigned>(std::max(std::atoi(value.data()), 1));
+            }
+            else if (key == "filters") {
+                std::istringstream filters(value);
+                std::string filter;
+                while (std::getline(filters, filter, '+')) scenario.filters.push_back(filter);
+            }
+            else if (key == "bus") {
+                scenario.bus = value == "1";
+            }
+            else if (key == "3d") {
+                scenario.positional = value == "1";
+            }
+            else if (key == "format") {
+                if (value == "int16") scenario.format = SampleBank::Int16;
+                else if (value == "adpcm") scenario.format = SampleBank::Adpcm;
+                else if (value == "float") scenario.format = SampleBank::Float32;
+                else return false;
+            }
+            else {
+                return false;
+            }
+        }
+
+        if (scenario.name.empty()) scenario.name = line;
+        return true;
+    }
+
+    SoLoud::Filter* createFilter(const std::string& name)
+    {
+        if (name == "echo") {
+            auto* filter = new SoLoud::EchoFilter();
+            filter->setParams(0.25f, 0.6f, 0.2f);
+            return filter;
+        }
+        if (name == "flanger") {
+            auto* filter = new SoLoud::FlangerFilter();
+            filter->setParams(0.005f, 8.f);
+            return filter;
+        }
+        if (name == "biquad") {
+            auto* filter = new SoLoud::BiquadResonantFilter();
+            filter->setParams(SoLoud::BiquadResonantFilter::LOWPASS, Samplerate, 2000.f, 2.f);
+            return filter;
+        }
+        if (name == "lofi") {
+            auto* filter = new SoLoud::LofiFilter();
+            filter->setParams(8000.f, 6.f);
+            return filter;
+        }
+        if (name == "dcremoval") {
+            auto* filter = new SoLoud::DCRemovalFilter();
+            filter->setParams(0.05f);
+            return filter;
+        }
+        if (name == "bassboost") {
+            auto* filter = new SoLoud::BassboostFilter();
+            filter->setParams(4.f);
+            return filter;
+        }
+
+        return nullptr;
+    }
+
+    // A deterministic two second stereo clip, as a 16-bit WAV file in memory
+    std::vector<uint8_t> makeClip()
+    {
+        const unsigned frames = Samplerate * 2u;
+        std::vector<int16_t> samples(frames * 2u);
+
+        uint32_t noise = 12345u;
+        for (unsigned i = 0u; i < frames; ++i) {
+            noise = noise * 1664525u + 1013904223u;
+            float t = i / static_cast<float>(Samplerate);
+            float tone = 0.4f * std::sin(2.f * 3.14159265f * 220.f * t) +
+                0.2f * std::sin(2.f * 3.14159265f * 1375.f * t);
+            float hiss = ((noise >> 16u) / 65535.f - 0.5f) * 0.1f;
+
+            samples[i * 2u] = static_cast<int16_t>((tone + hiss) * 32767.f);
+            samples[i * 2u + 1u] = static_cast<int16_t>((tone - hiss) * 32767.f);
+        }
+
+        uint32_t dataSize = static_cast<uint32_t>(samples.size() * sizeof(int16_t));
+        std::vector<uint8_t> wav(44u + dataSize);
+        auto put32 = [&wav](size_t offset, uint32_t value) {
+            for (unsigned i = 0u; i < 4u; ++i) wav[offset + i] = (value >> (i * 8u)) & 0xFFu;
+        };
+        auto put16 = [&wav](size_t offset, uint16_t value) {
+            wav[offset] = value & 0xFFu;
+            wav[offset + 1u] = value >> 8u;
+        };
+
+        std::memcpy(wav.data(), "RIFF", 4u);
+        put32(4u, 36u + dataSize);
+        std::memcpy(wav.data() + 8u, "WAVEfmt ", 8u);
+        put32(16u, 16u);
+        put16(20u, 1u);
+        put16(22u, 2u);
+        put32(24u, Samplerate);
+        put32(28u, Samplerate * 4u);
+        put16(32u, 4u);
+        put16(34u, 16u);
+        std::memcpy(wav.data() + 36u, "data", 4u);
+        put32(40u, dataSize);
+        std::memcpy(wav.data() + 44u, samples.data(), dataSize);
+
+        return wav;
+    }
+
+    bool writeWav(const std::string& filename, const std::vector<float>& samples)
+    {
+        std::ofstream file(filename, std::ios::binary);
+        if (!file) return false;
+
+        uint32_t dataSize = static_cast<uint32_t>(samples.size() * sizeof(float));
+        uint32_t header32[] = {36u + dataSize, 16u};
+        uint16_t format[] = {3u, 2u};
+        uint32_t rates[] = {Samplerate, Samplerate * 8u};
+        uint16_t layout[] = {8u, 32u};
+
+        file.write("RIFF", 4).write(reinterpret_cast<const char*>(&header32[0]), 4);
+        file.write("WAVEfmt ", 8).write(reinterpret_cast<const char*>(&header32[1]), 4);
+        file.write(reinterpret_cast<const char*>(format), sizeof(format));
+        file.write(reinterpret_cast<const char*>(rates), sizeof(rates));
+        file.write(reinterpret_cast<const char*>(layout), sizeof(layout));
+        file.write("data", 4).write(reinterpret_cast<const char*>(&dataSize), 4);
+        file.write(reinterpret_cast<const char*>(samples.data()), dataSize);
+
+        return static_cast<bool>(file);
+    }
+
+    bool readWav(const std::string& filename, std::vector<float>& samples)
+    {
+        std::ifstream file(filename, std::ios::binary);
+        if (!file) return false;
+
+        uint32_t dataSize = 0u;
+        file.seekg(40);
+        file.read(reinterpret_cast<char*>(&dataSize), 4);
+        samples.resize(dataSize / sizeof(float));
+        file.read(reinterpret_cast<char*>(samples.data()), samples.size() * sizeof(float));
+
+        return static_cast<bool>(file);
+    }
+
+    // Signal to error ratio in dB, infinite when both are identical
+    double compare(const std::vector<float>& reference, const std::vector<float>& samples,
+        float& maxError)
+    {
+        double signal = 0.0;
+        double error = 0.0;
+        maxError = 0.f;
+
+        size_t count = std::min(reference.size(), samples.size());
+        for (size_t i = 0u; i < count; ++i) {
+            float diff = std::fabs(reference[i] - samples[i]);
+            maxError = std::max(maxError, diff);
+            signal += static_cast<double>(reference[i]) * reference[i];
+            error += static_cast<double>(diff) * diff;
+        }
+        if (reference.size() != samples.size()) return -INFINITY;
+
+        return error > 0.0 ? 10.0 * std::log10(signal / error) : INFINITY;
+    }
+
+    // Identical hashes mean the optimization didn't change the output
+    uint64_t hashBlock(uint64_t hash, const float* block, unsigned count)
+    {
+        auto* bytes = reinterpret_cast<const uint8_t*>(block);
+        for (size_t i = 0u; i < count * sizeof(float); ++i) {
+            hash ^= bytes[i];
+            hash *= 1099511628211ull;
+        }
+        return hash;
+    }
+
+    bool run(const Scenario& scenario, const std::vector<uint8_t>& clip, double seconds,
+        const std::string& wavPrefix, const std::string& comparePrefix, double tolerance)
+    {
+        auto& soloud = Audio::instance();
+
+        Audio::Sample sample;
+        sample.load(clip.data(), clip.size(), scenario.format);
+        sample.setLooping(true);
+        if (scenario.positional) sample.set3dMinMaxDistance(1.f, 50.f);
+
+        std::vector<std::unique_ptr<SoLoud::Filter>> filters;
+        for (const auto& name : scenario.filters) {
+            filters.emplace_back(createFilter(name));
+            if (!filters.back()) {
+                std::fprintf(stderr, "%s: unknown filter %s\n", scenario.name.data(), name.data());
+                return false;
+            }
+        }
+
+        // Filters go on the bus when there's one, on every voice otherwise
+        SoLoud::Bus bus;
+        SoLoud::AudioSource& filtered = scenario.bus ? static_cast<SoLoud::AudioSource&>(bus) :
+            static_cast<SoLoud::AudioSource&>(sample);
+        for (size_t i = 0u; i < filters.size(); ++i) {
+            filtered.setFilter(static_cast<unsigned>(i), filters[i].get());
+        }
+        if (scenario.bus) soloud.play(bus);
+
+        float volume = 1.f / scenario.voices;
+        for (unsigned i = 0u; i < scenario.voices; ++i) {
+            SoLoud::handle handle;
+            if (scenario.positional) {
+                float angle = i * 2.f * 3.14159265f / scenario.voices;
+                float distance = 2.f + (i % 8u) * 4.f;
+                float x = std::cos(angle) * distance;
+                float z = std::sin(angle) * distance;
+                handle = scenario.bus ? bus.play3d(sample, x, 0.f, z, 0.f, 0.f, 0.f, volume) :
+                    soloud.play3d(sample, x, 0.f, z, 0.f, 0.f, 0.f, volume);
+            }
+            else {
+                float pan = (i % 9u) / 4.f - 1.f;
+                handle = scenario.bus ? bus.play(sample, volume, pan) :
+                    soloud.play(sample, volume, pan);
+            }
+
+            // Resampling is part of the cost
+            soloud.setRelativePlaySpeed(handle, 0.75f + (i % 16u) / 32.f);
+        }
+
+        unsigned blocks = static_cast<unsigned>(std::ceil(seconds * Samplerate / BlockFrames));
+        std::vector<float> block(BlockFrames * 2u);
+        std::vector<float> output;
+        bool keepOutput = !wavPrefix.empty() || !comparePrefix.empty();
+        if (keepOutput) output.reserve(blocks * block.size());
+
+        uint64_t hash = 14695981039346656037ull;
+        auto start = Clock::now();
+        for (unsigned i = 0u; i < blocks; ++i) {
+            if (scenario.positional) soloud.update3dAudio();
+
+            soloud.mix(block.data(), BlockFrames);
+            hash = hashBlock(hash, block.data(), static_cast<unsigned>(block.size()));
+            if (keepOutput) output.insert(output.end(), block.begin(), block.end());
+        }
+        double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+
+        soloud.stopAll();
+
+        double frames = static_cast<double>(blocks) * BlockFrames;
+        std::printf("%-16s %5u voices %10.2f ns/frame/voice %8.1fx realtime  hash %016llx\n",
+            scenario.name.data(), scenario.voices, elapsed * 1e9 / frames / scenario.voices,
+            frames / Samplerate / elapsed, static_cast<unsigned long long>(hash));
+
+        if (!wavPrefix.empty() && !writeWav(wavPrefix + scenario.name + ".wav", output)) {
+            std::fprintf(stderr, "could not write %s%s.wav\n", wavPrefix.data(),
+                scenario.name.data());
+            return false;
+        }
+
+        if (!comparePrefix.empty()) {
+            std::vector<float> reference;
+            if (!readWav(comparePrefix + scenario.name + ".wav", reference)) {
+                std::fprintf(stderr, "could not read %s%s.wav\n", comparePrefix.data(),
+                    scenario.name.data());
+                return false;
+            }
+
+            float maxError;
+            double ratio = compare(reference, output, maxError);
+            std::printf("%-16s vs reference: max error %g, %.1f dB%s\n", scenario.name.data(),
+                maxError, ratio, ratio < tolerance ? "  FAILED" : "");
+            if (ratio < tolerance) return false;
+        }
+
+        return true;
+    }
+}
+
+//----------------------------------------------------------
+int main(int argc, char* argv[])
+{
+    double seconds = 10.0;
+    std::string wavPrefix;
+    std::string comparePrefix;
+    double tolerance = 90.0;
+    std::vector<std::string> lines;
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--seconds") == 0 && i + 1 < argc) {
+            seconds = std::max(std::atof(argv[++i]), 0.1);
+        }
+        else if (std::strcmp(argv[i], "--wav") == 0 && i + 1 < argc) {
+            wavPrefix = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--compare") == 0 && i + 1 < argc) {
+            comparePrefix = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--tolerance") == 0 && i + 1 < argc) {
+            tolerance = std::atof(argv[++i]);
+        }
+        else if (argv[i][0] == '@') {
+            std::ifstream file(argv[i] + 1);
+            if (!file) {
+                std::fprintf(stderr, "could not read %s\n", argv[i] + 1);
+                return 1;
+            }
+
+            std::string line;
+            while (std::getline(file, line)) {
+                if (!line.empty() && line[0] != '#') lines.push_back(line);
+            }
+        }
+        else {
+            lines.push_back(argv[i]);
+        }
+    }
+
+    if (lines.empty()) lines.assign(std::begin(defaultScenarios), std::end(defaultScenarios));
+
+    std::vector<Scenario> scenarios(lines.size());
+    for (size_t i = 0u; i < lines.size(); ++i) {
+        if (!parseScenario(lines[i], scenarios[i])) {
+            std::fprintf(stderr, "invalid scenario: %s\n", lines[i].data());
+            return 1;
+        }
+    }
+
+    auto& soloud = Audio::instance();
+    if (soloud.init(SoLoud::Soloud::CLIP_ROUNDOFF, SoLoud::Soloud::NULLDRIVER, Samplerate,
+        BlockFrames, 2u) != SoLoud::SO_NO_ERROR) {
+        std::fprintf(stderr, "could not initialize the null audio driver\n");
+        return 1;
+    }
+    soloud.setMaxActiveVoiceCount(255u);
+
+    auto clip = makeClip();
+
+    bool succeeded = true;
+    for (const auto& scenario : scenarios) {
+        succeeded = run(scenario, clip, seconds, wavPrefix, comparePrefix, tolerance) &&
+            succeeded;
+    }
+
+    soloud.deinit();
+    Scheduler::shutdown();
+
+    return succeeded ? 0 : 1;
+}
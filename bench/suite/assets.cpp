@@ -0,0 +1,133 @@
+/*
+    This is free and unencumbered software released into the public domain.
+
+    Anyone is free to copy, modify, publish, use, compile, sell, or
+    distribute this software, either in source code form or as a compiled
+    binary, for any purpose, commercial or non-commercial, and by any
+    means.
+
+    In jurisdictions that recognize copyright laws, the author or authors
+    of this software dedicate any and all copyright interest in the
+    software to the public domain. We make this dedication for the benefit
+    of the public at large and to the detriment of our heirs and
+    successors. We intend this dedication to be an overt act of
+    relinquishment in perpetuity of all present and future rights to this
+    software under copyright law.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+    MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+    IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+    OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+    ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+    OTHER DEALINGS IN THE SOFTWARE.
+
+    For more information, please refer to <http://unlicense.org>
+*/
+
+#include "bench.hpp"
+#include "audio/samplebank.hpp"
+#include "graphics/image.hpp"
+#include "graphics/vectorfont.hpp"
+
+//----------------------------------------------------------
+// Locals
+//----------------------------------------------------------
+namespace
+{
+    using Files = std::vector<std::string>;
+
+    const std::vector<std::string> ImageExtensions = {".png", ".jpg", ".bmp", ".tga"};
+    const std::vector<std::string> FontExtensions = {".ttf", ".otf"};
+    const std::vector<std::string> SoundExtensions = {".wav", ".ogg"};
+
+    Files readAll(const std::vector<std::string>& filenames, double& bytes)
+    {
+        Files files;
+        for (const auto& filename : filenames) {
+            std::string contents;
+            if (!Bench::readFile(filename, contents)) continue;
+
+            bytes += contents.size();
+            files.push_back(std::move(contents));
+        }
+
+        return files;
+    }
+
+    bool decodeImages(const Files& files)
+    {
+        bool ok = true;
+        for (const auto& file : files) {
+            Image image;
+            ok = image.open(file.data(), file.size()) && ok;
+        }
+
+        return ok;
+    }
+
+    bool decodeFonts(const Files& files)
+    {
+        bool ok = true;
+        for (const auto& file : files) {
+            VectorFont font;
+            ok = font.open(file.data(), file.size()) && ok;
+        }
+
+        return ok;
+    }
+
+    bool decodeSounds(const Files& files)
+    {
+        bool ok = true;
+        for (const auto& file : files) {
+            // Nothing else holds the buffer, so the bank decodes it again every time
+            ok = SampleBank::load(file.data(), file.size(), SampleBank::Float32) && ok;
+        }
+
+        return ok;
+    }
+}
+
+namespace Bench
+{
+    void runAssets(Runner& runner)
+    {
+        if (!runner.enabled("assets")) return;
+
+        auto imageNames = listFiles("/assets", ImageExtensions);
+        auto fontNames = listFiles("/assets", FontExtensions);
+        auto soundNames = listFiles("/assets", SoundExtensions);
+
+        double imageBytes = 0.0, fontBytes = 0.0, soundBytes = 0.0;
+        auto images = readAll(imageNames, imageBytes);
+        auto fonts = readAll(fontNames, fontBytes);
+        auto sounds = readAll(soundNames, soundBytes);
+
+        // Check once that everything decodes, a broken asset would make the figures meaningless
+        if (!decodeImages(images) || !decodeFonts(fonts) || !decodeSounds(sounds)) {
+            runner.fail("assets", "decode", "some assets failed to decode");
+            return;
+        }
+
+        runner.measure("assets", "decode/images", [&] {
+            decodeImages(images);
+        }, imageBytes, "bytes");
+
+        runner.measure("assets", "decode/fonts", [&] {
+            decodeFonts(fonts);
+        }, fontBytes, "bytes");
+
+        runner.measure("assets", "decode/sounds", [&] {
+            decodeSounds(sounds);
+        }, soundBytes, "bytes");
+
+        // Everything again, reading the files through the virtual filesystem as well
+        runner.measure("assets", "load-all", [&] {
+            double bytes = 0.0;
+            decodeImages(readAll(imageNames, bytes));
+            decodeFonts(readAll(fontNames, bytes));
+            decodeSounds(readAll(soundNames, bytes));
+        }, imageBytes + fontBytes + soundBytes, "bytes");
+    }
+}
@@ -0,0 +1,92 @@
+/*
+    This is free and unencumbered software released into the public domain.
+
+    Anyone is free to copy, modify, publish, use, compile, sell, or
+    distribute this software, either in source code form or as a compiled
+    binary, for any purpose, commercial or non-commercial, and by any
+    means.
+
+    In jurisdictions that recognize copyright laws, the author or authors
+    of this software dedicate any and all copyright interest in the
+    software to the public domain. We make this dedication for the benefit
+    of the public at large and to the detriment of our heirs and
+    successors. We intend this dedication to be an overt act of
+    relinquishment in perpetuity of all present and future rights to this
+    software under copyright law.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+    MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+    IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+    OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+    ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+    OTHER DEALINGS IN THE SOFTWARE.
+
+    For more information, please refer to <http://unlicense.org>
+*/
+
+#pragma once
+#include "config.hpp"
+
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+// Shared harness of the benchmark suite, each subsystem registers its cases through a Runner
+namespace Bench
+{
+    struct Result
+    {
+        std::string suite;
+        std::string name;
+        uint64_t iterations;
+        std::map<std::string, double> metrics;
+        std::string error;
+    };
+
+    class Runner
+    {
+    public:
+        Runner(double minTime, const std::string& filter);
+
+        // Whether a suite may have enabled cases, to skip its setup otherwise
+        bool enabled(const std::string& suite) const;
+        bool enabled(const std::string& suite, const std::string& name) const;
+
+        // Runs function repeatedly for at least minTime seconds and keeps per-iteration timings
+        // units is the amount of work an iteration does, reported per second under unit
+        void measure(const std::string& suite, const std::string& name,
+            const std::function<void()>& function, double units = 0.0, const char* unit = nullptr);
+
+        // For scenarios that time themselves
+        void add(const Result& result);
+        void fail(const std::string& suite, const std::string& name, const std::string& error);
+
+        const std::vector<Result>& results() const;
+        bool writeJson(const std::string& filename) const;
+
+    private:
+        double mMinTime;
+        std::string mFilter;
+        std::vector<Result> mResults;
+    };
+
+    // Benchmarks that need a render device share a hidden window, created on first use
+    bool ensureContext();
+
+    // Reads a whole file through the virtual filesystem
+    bool readFile(const std::string& filename, std::string& contents);
+
+    // Files under a virtual directory, recursively, whose name ends with one of the extensions
+    std::vector<std::string> listFiles(const std::string& dir,
+        const std::vector<std::string>& extensions);
+
+    void runUnicode(Runner& runner);
+    void runImage(Runner& runner);
+    void runText(Runner& runner);
+    void runRenderer(Runner& runner);
+    void runLua(Runner& runner);
+    void runAssets(Runner& runner);
+    void runGame(Runner& runner, int frames);
+}
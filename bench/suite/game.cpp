@@ -0,0 +1,141 @@
+/*
+    This is free and unencumbered software released into the public domain.
+
+    Anyone is free to copy, modify, publish, use, compile, sell, or
+    distribute this software, either in source code form or as a compiled
+    binary, for any purpose, commercial or non-commercial, and by any
+    means.
+
+    In jurisdictions that recognize copyright laws, the author or authors
+    of this software dedicate any and all copyright interest in the
+    software to the public domain. We make this dedication for the benefit
+    of the public at large and to the detriment of our heirs and
+    successors. We intend this dedication to be an overt act of
+    relinquishment in perpetuity of all present and future rights to this
+    software under copyright law.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+    MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+    IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+    OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+    ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+    OTHER DEALINGS IN THE SOFTWARE.
+
+    For more information, please refer to <http://unlicense.org>
+*/
+
+#include "bench.hpp"
+#include "system/clock.hpp"
+#include "system/framepacer.hpp"
+#include "system/luavm.hpp"
+#include "system/scheduler.hpp"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+//----------------------------------------------------------
+// Locals
+//----------------------------------------------------------
+namespace
+{
+    const char* Screen = "screen.test.3d";
+    const int StartupRuns = 3;
+
+    // Runs main.lua like the game does, on the hidden window
+    bool runGame(int frames, double& elapsed, std::string& error)
+    {
+        std::string frameArg = std::to_string(frames);
+        const char* args[] = {
+            "bench", "--nolimit", "--hidden", "--screen", Screen, "--frames", frameArg.data()
+        };
+
+        LuaVM lua;
+        double start = Clock::now();
+        bool succeeded = lua.initialize(sizeof(args) / sizeof(args[0]), const_cast<char**>(args)) &&
+            lua.runCode("boot.lua", "return require 'main'");
+        elapsed = Clock::now() - start;
+
+        if (!succeeded) error = lua.getErrorMessage();
+        return succeeded;
+    }
+}
+
+namespace Bench
+{
+    void runGame(Runner& runner, int frames)
+    {
+        if (!runner.enabled("game")) return;
+
+        // Only pooled states are shared between runs, the scheduler can't be restarted
+        struct Cleanup
+        {
+            ~Cleanup()
+            {
+                Scheduler::shutdown();
+                LuaVM::clearPool();
+            }
+        } cleanup;
+
+        // Boots the game and loads the scene of the 3D test screen, then renders a single frame
+        // The first run compiles scripts and decodes assets that the other runs find in caches
+        if (runner.enabled("game", "startup")) {
+            double times[StartupRuns];
+            std::string error;
+            for (int i = 0; i < StartupRuns; ++i) {
+                if (!::runGame(1, times[i], error)) {
+                    runner.fail("game", "startup", error);
+                    return;
+                }
+            }
+
+            Result result {"game", "startup", StartupRuns, {}, {}};
+            result.metrics["first_ms"] = times[0] * 1000.0;
+            std::sort(times, times + StartupRuns);
+            result.metrics["median_ms"] = times[StartupRuns / 2] * 1000.0;
+            runner.add(result);
+        }
+
+        // Every frame is recorded, the last ones are those counted past the loading screen
+        // Only they add up to the total, booting and loading are left to the startup figures
+        if (runner.enabled("game", "frames")) {
+            std::vector<float> samples;
+            samples.reserve(frames * 2);
+
+            double elapsed;
+            std::string error;
+            FramePacer::instance().record(&samples);
+            bool succeeded = ::runGame(frames, elapsed, error);
+            FramePacer::instance().record(nullptr);
+
+            if (!succeeded) {
+                runner.fail("game", "frames", error);
+                return;
+            }
+
+            auto first = samples.end() - std::min(samples.size(), static_cast<size_t>(frames));
+            std::vector<float> times(first, samples.end());
+
+            double total = 0.0;
+            for (float time : times) total += time;
+            double mean = times.empty() ? 0.0 : total / times.size();
+
+            double p99 = 0.0, max = 0.0;
+            if (!times.empty()) {
+                auto nth = times.begin() + (times.size() - 1u) * 99u / 100u;
+                std::nth_element(times.begin(), nth, times.end());
+                p99 = *nth;
+                max = *std::max_element(nth, times.end());
+            }
+
+            Result result {"game", "frames", static_cast<uint64_t>(times.size()), {}, {}};
+            result.metrics["total_ms"] = total * 1000.0;
+            result.metrics["frame_mean_ms"] = mean * 1000.0;
+            result.metrics["frame_p99_ms"] = p99 * 1000.0;
+            result.metrics["frame_max_ms"] = max * 1000.0;
+            result.metrics["fps"] = mean > 0.0 ? 1.0 / mean : 0.0;
+            runner.add(result);
+        }
+    }
+}
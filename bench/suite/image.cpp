@@ -0,0 +1,74 @@
+/*
+    This is free and unencumbered software released into the public domain.
+
+    Anyone is free to copy, modify, publish, use, compile, sell, or
+    distribute this software, either in source code form or as a compiled
+    binary, for any purpose, commercial or non-commercial, and by any
+    means.
+
+    In jurisdictions that recognize copyright laws, the author or authors
+    of this software dedicate any and all copyright interest in the
+    software to the public domain. We make this dedication for the benefit
+    of the public at large and to the detriment of our heirs and
+    successors. We intend this dedication to be an overt act of
+    relinquishment in perpetuity of all present and future rights to this
+    software under copyright law.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+    MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+    IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+    OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+    ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+    OTHER DEALINGS IN THE SOFTWARE.
+
+    For more information, please refer to <http://unlicense.org>
+*/
+
+#include "bench.hpp"
+#include "graphics/image.hpp"
+
+namespace Bench
+{
+    void runImage(Runner& runner)
+    {
+        const unsigned Size = 512u;
+
+        // Varying alpha so that blending can't take shortcuts
+        std::vector<uint8_t> pixels(Size * Size * 4u);
+        for (unsigned i = 0u; i < Size * Size; ++i) {
+            pixels[i * 4u + 0u] = static_cast<uint8_t>(i);
+            pixels[i * 4u + 1u] = static_cast<uint8_t>(i >> 3u);
+            pixels[i * 4u + 2u] = static_cast<uint8_t>(i >> 6u);
+            pixels[i * 4u + 3u] = static_cast<uint8_t>(i * 7u);
+        }
+
+        Image source;
+        source.create(Size, Size, pixels.data());
+
+        Image target;
+        target.create(Size * 2u, Size * 2u, 32u, 64u, 128u, 255u);
+
+        double count = static_cast<double>(Size * Size);
+
+        runner.measure("image", "copy/opaque", [&] {
+            target.copy(source, 0, 0, 17, 33, Size, Size, false);
+        }, count, "pixels");
+
+        runner.measure("image", "copy/alpha", [&] {
+            target.copy(source, 0, 0, 17, 33, Size, Size, true);
+        }, count, "pixels");
+
+        runner.measure("image", "copy/raw-alpha", [&] {
+            target.copy(pixels.data(), 0, 0, Size, 250, 250, Size, Size, true);
+        }, count, "pixels");
+
+        runner.measure("image", "createMaskFromColor", [&] {
+            source.createMaskFromColor(0u, 0u, 0u, 0u, 0u);
+        }, count, "pixels");
+
+        runner.measure("image", "flipVertically", [&] {
+            target.flipVertically();
+        }, count * 4.0, "pixels");
+    }
+}
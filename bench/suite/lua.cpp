@@ -0,0 +1,117 @@
+/*
+    This is free and unencumbered software released into the public domain.
+
+    Anyone is free to copy, modify, publish, use, compile, sell, or
+    distribute this software, either in source code form or as a compiled
+    binary, for any purpose, commercial or non-commercial, and by any
+    means.
+
+    In jurisdictions that recognize copyright laws, the author or authors
+    of this software dedicate any and all copyright interest in the
+    software to the public domain. We make this dedication for the benefit
+    of the public at large and to the detriment of our heirs and
+    successors. We intend this dedication to be an overt act of
+    relinquishment in perpetuity of all present and future rights to this
+    software under copyright law.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+    MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+    IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+    OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+    ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+    OTHER DEALINGS IN THE SOFTWARE.
+
+    For more information, please refer to <http://unlicense.org>
+*/
+
+#include "bench.hpp"
+#include "system/luacache.hpp"
+#include "system/luavm.hpp"
+
+#include <luajit/lua.hpp>
+
+//----------------------------------------------------------
+// Locals
+//----------------------------------------------------------
+namespace
+{
+    int writeChunk(lua_State*, const void* data, size_t size, void* userdata)
+    {
+        static_cast<std::string*>(userdata)->append(static_cast<const char*>(data), size);
+        return 0;
+    }
+}
+
+namespace Bench
+{
+    void runLua(Runner& runner)
+    {
+        if (!runner.enabled("lua")) return;
+
+        auto files = listFiles("/assets/scripts", {".lua"});
+        std::vector<std::string> sources(files.size());
+        double totalSize = 0.0;
+        for (size_t i = 0u; i < files.size(); ++i) {
+            if (!readFile(files[i], sources[i])) {
+                runner.fail("lua", "scripts", "could not read " + files[i]);
+                return;
+            }
+            totalSize += sources[i].size();
+        }
+
+        // What a require costs before any compilation: reading, hashing and the cache lookup
+        runner.measure("lua", "fetch-all", [&] {
+            size_t size, bytecodeSize;
+            const char* bytecode;
+            uint64_t hash;
+            for (const auto& file : files) {
+                LuaCache::fetch(file, size, bytecode, bytecodeSize, hash);
+            }
+        }, totalSize / 1048576.0, "MiB");
+
+        lua_State* state = luaL_newstate();
+        if (!state) {
+            runner.fail("lua", "state", "could not create a Lua state");
+            return;
+        }
+
+        std::vector<std::string> bytecodes(files.size());
+        for (size_t i = 0u; i < files.size(); ++i) {
+            if (luaL_loadbuffer(state, sources[i].data(), sources[i].size(), files[i].data())) {
+                runner.fail("lua", "compile-all", lua_tostring(state, -1));
+                lua_close(state);
+                return;
+            }
+            lua_dump(state, writeChunk, &bytecodes[i]);
+            lua_pop(state, 1);
+        }
+
+        // Cold startup compiles every script, warm startup loads their cached bytecode instead
+        runner.measure("lua", "compile-all", [&] {
+            for (size_t i = 0u; i < files.size(); ++i) {
+                luaL_loadbuffer(state, sources[i].data(), sources[i].size(), files[i].data());
+                lua_pop(state, 1);
+            }
+        }, totalSize / 1048576.0, "MiB");
+
+        runner.measure("lua", "load-bytecode-all", [&] {
+            for (size_t i = 0u; i < files.size(); ++i) {
+                luaL_loadbuffer(state, bytecodes[i].data(), bytecodes[i].size(), files[i].data());
+                lua_pop(state, 1);
+            }
+        }, static_cast<double>(files.size()), "scripts");
+
+        lua_close(state);
+
+        runner.measure("lua", "vm-create", [] {
+            LuaVM vm;
+            vm.initialize();
+        });
+
+        // Pooled states are reset and handed out again instead of being created
+        runner.measure("lua", "vm-acquire", [] {
+            LuaVM::releaseState(LuaVM::acquireState());
+        });
+    }
+}
@@ -0,0 +1,351 @@
+/*
+    This is free and unencumbered software released into the public domain.
+
+    Anyone is free to copy, modify, publish, use, compile, sell, or
+    distribute this software, either in source code form or as a compiled
+    binary, for any purpose, commercial or non-commercial, and by any
+    means.
+
+    In jurisdictions that recognize copyright laws, the author or authors
+    of this software dedicate any and all copyright interest in the
+    software to the public domain. We make this dedication for the benefit
+    of the public at large and to the detriment of our heirs and
+    successors. We intend this dedication to be an overt act of
+    relinquishment in perpetuity of all present and future rights to this
+    software under copyright law.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+    MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+    IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+    OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+    ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+    OTHER DEALINGS IN THE SOFTWARE.
+
+    For more information, please refer to <http://unlicense.org>
+*/
+
+// Engine benchmark suite, micro benchmarks per subsystem followed by whole-game scenarios
+// Usage: bench [--seconds <n>] [--filter <text>] [--frames <n>] [--json <file>]
+// --seconds is the minimum time spent on each micro benchmark (0.5 by default)
+// --filter only runs the cases whose "suite/name" contains the given text
+// --frames is the length of the 3D test screen run (1000 by default)
+// Results are written as JSON to --json (bench.json by default), to compare between commits
+
+#include "bench.hpp"
+#include "graphics/renderdevice.hpp"
+#include "system/clock.hpp"
+#include "system/filesystem.hpp"
+#include "system/log.hpp"
+#include "system/thread.hpp"
+
+#include <SDL2/SDL.h>
+#include <physfs/physfs.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+extern "C" SDL_Window* nxWindowCreate(const char* title, int width, int height, int fullscreen,
+    int display, bool vsync, bool resizable, bool borderless, int minWidth, int minHeight,
+    bool highDpi, int refreshRate, int posX, int posY, int depthBits, int stencilBits, bool hidden);
+
+//----------------------------------------------------------
+// Locals
+//----------------------------------------------------------
+namespace
+{
+    std::string escape(const std::string& str)
+    {
+        std::string escaped;
+        for (char c : str) {
+            if (c == '"' || c == '\\') {
+                escaped += '\\';
+                escaped += c;
+            }
+            else if (static_cast<unsigned char>(c) < 0x20u) {
+                escaped += ' ';
+            }
+            else {
+                escaped += c;
+            }
+        }
+
+        return escaped;
+    }
+
+    bool endsWith(const std::string& str, const std::string& suffix)
+    {
+        return str.size() >= suffix.size() &&
+            str.compare(str.size() - suffix.size(), suffix.size(), suffix) == 0;
+    }
+
+    void listFilesIn(const std::string& dir, const std::vector<std::string>& extensions,
+        std::vector<std::string>& files)
+    {
+        char** list = PHYSFS_enumerateFiles(dir.data());
+        if (!list) return;
+
+        for (char** it = list; *it; ++it) {
+            std::string path = dir + "/" + *it;
+
+            PHYSFS_Stat stat;
+            if (!PHYSFS_stat(path.data(), &stat)) continue;
+
+            if (stat.filetype == PHYSFS_FILETYPE_DIRECTORY) {
+                listFilesIn(path, extensions, files);
+                continue;
+            }
+
+            for (const auto& extension : extensions) {
+                if (endsWith(path, extension)) {
+                    files.push_back(path);
+                    break;
+                }
+            }
+        }
+
+        PHYSFS_freeList(list);
+    }
+
+    bool mountFilesystem(Filesystem& fs, const char* arg0)
+    {
+        if (!fs.initialize(arg0)) return false;
+
+        // Same layout as the game, so that scripts and assets resolve the same way
+        auto prefsDir = Filesystem::getPrefsDir();
+        if (prefsDir.empty()) return false;
+
+        Log::setLogFile(prefsDir + "/bench-log.txt");
+
+        auto baseDir = Filesystem::getBaseDir();
+        return Filesystem::setWriteDir(prefsDir) && Filesystem::mountDir(prefsDir, "/userdata") &&
+            Filesystem::mountDir("/", "/sysroot", false) && !baseDir.empty() &&
+            Filesystem::mountDir(baseDir, "/", false) &&
+            (Filesystem::mountAssetsDir("/assets", false) ||
+                Filesystem::mountArchive("assets.zip", "/assets", false));
+    }
+}
+
+namespace Bench
+{
+    Runner::Runner(double minTime, const std::string& filter) :
+        mMinTime(minTime),
+        mFilter(filter)
+    {
+        // Nothing else to do
+    }
+
+    bool Runner::enabled(const std::string& suite) const
+    {
+        // Filters without a suite part can match a case in any suite
+        auto separator = mFilter.find('/');
+        if (separator == std::string::npos) return true;
+
+        return suite.find(mFilter.substr(0u, separator)) != std::string::npos;
+    }
+
+    bool Runner::enabled(const std::string& suite, const std::string& name) const
+    {
+        return mFilter.empty() || (suite + "/" + name).find(mFilter) != std::string::npos;
+    }
+
+    void Runner::measure(const std::string& suite, const std::string& name,
+        const std::function<void()>& function, double units, const char* unit)
+    {
+        if (!enabled(suite, name)) return;
+
+        // The first run warms caches up, and tells how many runs to batch between clock reads
+        double start = Clock::now();
+        function();
+        double first = Clock::now() - start;
+        auto batch = static_cast<uint64_t>(std::max(0.001 / std::max(first, 1e-9), 1.0));
+
+        std::vector<double> samples;
+        uint64_t iterations = 0u;
+        double total = 0.0;
+        while (total < mMinTime || samples.size() < 3u) {
+            start = Clock::now();
+            for (uint64_t i = 0u; i < batch; ++i) {
+                function();
+            }
+            double elapsed = Clock::now() - start;
+
+            samples.push_back(elapsed / batch);
+            iterations += batch;
+            total += elapsed;
+        }
+
+        double mean = total / iterations;
+        std::sort(samples.begin(), samples.end());
+        double median = samples[samples.size() / 2u];
+
+        Result result {suite, name, iterations, {}, {}};
+        result.metrics["mean_ns"] = mean * 1e9;
+        result.metrics["median_ns"] = median * 1e9;
+        result.metrics["min_ns"] = samples.front() * 1e9;
+        if (units > 0.0 && unit) result.metrics[std::string(unit) + "_per_s"] = units / median;
+
+        add(result);
+    }
+
+    void Runner::add(const Result& result)
+    {
+        std::printf("%-10s %-32s", result.suite.data(), result.name.data());
+        if (!result.error.empty()) {
+            std::printf(" FAILED: %s\n", result.error.data());
+        }
+        else {
+            for (const auto& it : result.metrics) {
+                std::printf(" %s=%.6g", it.first.data(), it.second);
+            }
+            std::printf("\n");
+        }
+        std::fflush(stdout);
+
+        mResults.push_back(result);
+    }
+
+    void Runner::fail(const std::string& suite, const std::string& name, const std::string& error)
+    {
+        if (enabled(suite, name)) add(Result {suite, name, 0u, {}, error});
+    }
+
+    const std::vector<Result>& Runner::results() const
+    {
+        return mResults;
+    }
+
+    bool Runner::writeJson(const std::string& filename) const
+    {
+        FILE* file = std::fopen(filename.data(), "w");
+        if (!file) return false;
+
+        std::fprintf(file, "{\n  \"results\": [");
+        for (size_t i = 0u; i < mResults.size(); ++i) {
+            const auto& result = mResults[i];
+            std::fprintf(file, "%s\n    {\"suite\": \"%s\", \"name\": \"%s\", \"iterations\": %llu",
+                i ? "," : "", escape(result.suite).data(), escape(result.name).data(),
+                static_cast<unsigned long long>(result.iterations));
+
+            if (!result.error.empty()) {
+                std::fprintf(file, ", \"error\": \"%s\"", escape(result.error).data());
+            }
+
+            std::fprintf(file, ", \"metrics\": {");
+            bool first = true;
+            for (const auto& it : result.metrics) {
+                std::fprintf(file, "%s\"%s\": %.9g", first ? "" : ", ", escape(it.first).data(),
+                    it.second);
+                first = false;
+            }
+            std::fprintf(file, "}}");
+        }
+        std::fprintf(file, "\n  ]\n}\n");
+
+        return std::fclose(file) == 0;
+    }
+
+    bool ensureContext()
+    {
+        static bool tried = false;
+        static bool ready = false;
+        if (tried) return ready;
+
+        tried = true;
+        ready = nxWindowCreate("bench", 1280, 720, 0, 1, false, false, false, 0, 0, false, 0, -1, -1,
+            24, 8, true) && RenderDevice::instance().initialize();
+
+        return ready;
+    }
+
+    bool readFile(const std::string& filename, std::string& contents)
+    {
+        auto* file = PHYSFS_openRead(filename.data());
+        if (!file) return false;
+
+        auto length = PHYSFS_fileLength(file);
+        bool ok = length >= 0;
+        if (ok) {
+            contents.resize(static_cast<size_t>(length));
+            ok = PHYSFS_readBytes(file, &contents[0], contents.size()) == length;
+        }
+
+        PHYSFS_close(file);
+        return ok;
+    }
+
+    std::vector<std::string> listFiles(const std::string& dir,
+        const std::vector<std::string>& extensions)
+    {
+        std::vector<std::string> files;
+        listFilesIn(dir, extensions, files);
+        std::sort(files.begin(), files.end());
+
+        return files;
+    }
+}
+
+//----------------------------------------------------------
+int main(int argc, char* argv[])
+{
+    double seconds = 0.5;
+    std::string filter;
+    std::string output = "bench.json";
+    int frames = 1000;
+
+    for (int i = 1; i < argc; ++i) {
+        bool hasValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "--seconds") == 0 && hasValue) {
+            seconds = std::max(std::atof(argv[++i]), 0.01);
+        }
+        else if (std::strcmp(argv[i], "--filter") == 0 && hasValue) {
+            filter = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--frames") == 0 && hasValue) {
+            frames = std::max(std::atoi(argv[++i]), 1);
+        }
+        else if (std::strcmp(argv[i], "--json") == 0 && hasValue) {
+            output = argv[++i];
+        }
+        else {
+            std::fprintf(stderr, "usage: %s [--seconds <n>] [--filter <text>] [--frames <n>] "
+                "[--json <file>]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    SDL_Init(SDL_INIT_VIDEO | SDL_INIT_TIMER);
+
+    Filesystem fs;
+    if (!mountFilesystem(fs, argv[0])) {
+        std::fprintf(stderr, "could not mount the filesystem: %s\n",
+            Filesystem::getErrorMessage().data());
+        SDL_Quit();
+        return 1;
+    }
+
+    Thread::setMain();
+
+    Bench::Runner runner(seconds, filter);
+    Bench::runUnicode(runner);
+    Bench::runImage(runner);
+    Bench::runAssets(runner);
+    Bench::runText(runner);
+    Bench::runRenderer(runner);
+    Bench::runLua(runner);
+    Bench::runGame(runner, frames);
+
+    bool failed = false;
+    for (const auto& result : runner.results()) {
+        failed = failed || !result.error.empty();
+    }
+
+    if (!runner.writeJson(output)) {
+        std::fprintf(stderr, "could not write %s\n", output.data());
+        failed = true;
+    }
+
+    SDL_Quit();
+    return failed ? 1 : 0;
+}
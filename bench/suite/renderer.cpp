@@ -0,0 +1,83 @@
+/*
+    This is free and unencumbered software released into the public domain.
+
+    Anyone is free to copy, modify, publish, use, compile, sell, or
+    distribute this software, either in source code form or as a compiled
+    binary, for any purpose, commercial or non-commercial, and by any
+    means.
+
+    In jurisdictions that recognize copyright laws, the author or authors
+    of this software dedicate any and all copyright interest in the
+    software to the public domain. We make this dedication for the benefit
+    of the public at large and to the detriment of our heirs and
+    successors. We intend this dedication to be an overt act of
+    relinquishment in perpetuity of all present and future rights to this
+    software under copyright law.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+    MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+    IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+    OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+    ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+    OTHER DEALINGS IN THE SOFTWARE.
+
+    For more information, please refer to <http://unlicense.org>
+*/
+
+#include "bench.hpp"
+#include "graphics/renderdevice.hpp"
+
+#include <memory>
+
+namespace Bench
+{
+    void runRenderer(Runner& runner)
+    {
+        if (!runner.enabled("renderer")) return;
+
+        if (!ensureContext()) {
+            runner.fail("renderer", "context", "could not create a render device");
+            return;
+        }
+
+        auto& device = RenderDevice::instance();
+        device.resetStates();
+
+        // These measure the CPU side of state changes, the driver queues the actual work
+        runner.measure("renderer", "commitStates/clean", [&] {
+            device.commitStates();
+        });
+
+        bool flip = false;
+        runner.measure("renderer", "commitStates/renderStates", [&] {
+            flip = !flip;
+            device.setBlendMode(flip, RenderDevice::SrcAlpha, RenderDevice::InvSrcAlpha);
+            device.setDepthTest(!flip);
+            device.setCullMode(flip ? RenderDevice::Back : RenderDevice::None);
+            device.commitStates();
+        });
+
+        runner.measure("renderer", "commitStates/viewport", [&] {
+            flip = !flip;
+            device.setViewport(0, 0, flip ? 1280 : 640, flip ? 720 : 360);
+            device.setScissorRect(flip ? 10 : 0, 0, 320, 240);
+            device.commitStates();
+        });
+
+        std::unique_ptr<Texture> textures[2];
+        for (auto& texture : textures) {
+            texture.reset(device.newTexture());
+            texture->create(Texture::_2D, Texture::RGBA8, 64u, 64u, false, false, false);
+        }
+
+        runner.measure("renderer", "commitStates/textures", [&] {
+            flip = !flip;
+            device.bind(textures[flip ? 1 : 0].get(), 0u);
+            device.commitStates();
+        });
+
+        device.bind(static_cast<const Texture*>(nullptr), 0u);
+        device.resetStates();
+    }
+}
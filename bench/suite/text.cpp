@@ -0,0 +1,131 @@
+/*
+    This is free and unencumbered software released into the public domain.
+
+    Anyone is free to copy, modify, publish, use, compile, sell, or
+    distribute this software, either in source code form or as a compiled
+    binary, for any purpose, commercial or non-commercial, and by any
+    means.
+
+    In jurisdictions that recognize copyright laws, the author or authors
+    of this software dedicate any and all copyright interest in the
+    software to the public domain. We make this dedication for the benefit
+    of the public at large and to the detriment of our heirs and
+    successors. We intend this dedication to be an overt act of
+    relinquishment in perpetuity of all present and future rights to this
+    software under copyright law.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+    MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+    IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+    OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+    ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+    OTHER DEALINGS IN THE SOFTWARE.
+
+    For more information, please refer to <http://unlicense.org>
+*/
+
+#include "bench.hpp"
+#include "graphics/text.hpp"
+#include "graphics/vectorfont.hpp"
+
+//----------------------------------------------------------
+// Locals
+//----------------------------------------------------------
+namespace
+{
+    const char* FontFile = "/assets/fonts/01-Asap-Regular.otf";
+    const uint32_t CharSize = 24u;
+
+    std::u32string sampleString(size_t length)
+    {
+        const std::u32string words[] = {
+            U"monsters ", U"of ", U"second ", U"night ", U"walk ", U"the ", U"lonely ", U"streets, ",
+            U"Quickly! ", U"12345 ", U"(jumping) ", U"over\n"
+        };
+
+        std::u32string str;
+        for (size_t i = 0u; str.size() < length; ++i) {
+            str += words[(i * 7u) % (sizeof(words) / sizeof(words[0]))];
+        }
+        str.resize(length);
+
+        return str;
+    }
+
+    // Lays text out and uploads its vertices, like drawing it would
+    size_t drain(const Text& text)
+    {
+        float x, y, w, h;
+        text.bounds(x, y, w, h);
+
+        size_t buffers = 0u;
+        uint32_t index, quadCount;
+        while (text.nextBuffer(&index, &quadCount)) ++buffers;
+
+        return buffers;
+    }
+}
+
+namespace Bench
+{
+    void runText(Runner& runner)
+    {
+        if (!runner.enabled("text")) return;
+
+        if (!ensureContext()) {
+            runner.fail("text", "context", "could not create a render device");
+            return;
+        }
+
+        std::string fontData;
+        VectorFont font;
+        if (!readFile(FontFile, fontData) || !font.open(fontData.data(), fontData.size())) {
+            runner.fail("text", "font", std::string("could not open ") + FontFile);
+            return;
+        }
+
+        // Every glyph is rendered and packed in the atlas again on a fresh font
+        const std::u32string charset = sampleString(256u) + U"ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+        runner.measure("text", "loadGlyph", [&] {
+            VectorFont fresh;
+            fresh.open(fontData.data(), fontData.size());
+            for (auto c : charset) fresh.glyph(c, CharSize, false);
+        }, static_cast<double>(charset.size()), "glyphs");
+
+        volatile size_t sink = 0u;
+
+        const auto paragraph = sampleString(1000u);
+        const auto other = sampleString(1001u);
+        Text text;
+        text.setFont(font);
+        text.setCharacterSize(CharSize);
+        text.setMaxWidth(600.f);
+
+        bool flip = false;
+        runner.measure("text", "ensureGeometryUpdate/full", [&] {
+            text.setString((flip = !flip) ? paragraph : other);
+            sink = sink + drain(text);
+        }, static_cast<double>(paragraph.size()), "glyphs");
+
+        // Typing at the end only has to lay out the new character
+        text.setString(paragraph);
+        drain(text);
+        runner.measure("text", "ensureGeometryUpdate/append", [&] {
+            auto str = text.string();
+            str.back() = (flip = !flip) ? U'a' : U'b';
+            text.setString(str);
+            sink = sink + drain(text);
+        }, 1.0, "edits");
+
+        const auto large = sampleString(10000u);
+        Text layout;
+        layout.setFont(font);
+        layout.setCharacterSize(CharSize);
+        layout.setMaxWidth(1280.f);
+        runner.measure("text", "layout-10k", [&] {
+            layout.setString((flip = !flip) ? large : large + U"!");
+            sink = sink + drain(layout);
+        }, static_cast<double>(large.size()), "glyphs");
+    }
+}
@@ -0,0 +1,96 @@
+/*
+    This is free and unencumbered software released into the public domain.
+
+    Anyone is free to copy, modify, publish, use, compile, sell, or
+    distribute this software, either in source code form or as a compiled
+    binary, for any purpose, commercial or non-commercial, and by any
+    means.
+
+    In jurisdictions that recognize copyright laws, the author or authors
+    of this software dedicate any and all copyright interest in the
+    software to the public domain. We make this dedication for the benefit
+    of the public at large and to the detriment of our heirs and
+    successors. We intend this dedication to be an overt act of
+    relinquishment in perpetuity of all present and future rights to this
+    software under copyright law.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+    MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+    IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+    OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+    ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+    OTHER DEALINGS IN THE SOFTWARE.
+
+    For more information, please refer to <http://unlicense.org>
+*/
+
+#include "bench.hpp"
+#include "system/unicode.hpp"
+
+#include <algorithm>
+
+//----------------------------------------------------------
+// Locals
+//----------------------------------------------------------
+namespace
+{
+    // Mostly multi-byte text, the scripts alone would only exercise the ASCII paths
+    const char* MixedText =
+        u8"Monsters of Second Night — ночь, ليل, 夜, 밤, νύχτα, 🌙. "
+        u8"Ceci n'est pas une pipe, これはパイプではありません. ";
+
+    void runCases(Bench::Runner& runner, const char* label, const std::string& input)
+    {
+        const char* begin = input.data();
+        const char* end = begin + input.size();
+
+        std::vector<char32_t> utf32(Unicode::utf32Length(begin, end));
+        std::vector<char> utf8(input.size());
+        std::u32string decoded = Unicode::utf8To32(input);
+        double bytes = static_cast<double>(input.size());
+
+        volatile size_t sink = 0u;
+
+        runner.measure("unicode", std::string("isValidUtf8/") + label, [&] {
+            sink = sink + Unicode::isValidUtf8(begin, end);
+        }, bytes, "bytes");
+
+        runner.measure("unicode", std::string("utf32Length/") + label, [&] {
+            sink = sink + Unicode::utf32Length(begin, end);
+        }, bytes, "bytes");
+
+        runner.measure("unicode", std::string("utf8To32/") + label, [&] {
+            sink = sink + (Unicode::utf8To32(begin, end, utf32.data()) - utf32.data());
+        }, bytes, "bytes");
+
+        runner.measure("unicode", std::string("utf32To8/") + label, [&] {
+            auto first = decoded.data();
+            sink = sink + (Unicode::utf32To8(first, first + decoded.size(), utf8.data()) - utf8.data());
+        }, bytes, "bytes");
+    }
+}
+
+namespace Bench
+{
+    void runUnicode(Runner& runner)
+    {
+        std::string scripts;
+        for (const auto& filename : listFiles("/assets/scripts", {".lua"})) {
+            std::string contents;
+            if (readFile(filename, contents)) scripts += contents;
+        }
+
+        std::string mixed;
+        while (mixed.size() < std::max<size_t>(scripts.size(), 65536u)) mixed += MixedText;
+
+        if (scripts.empty()) {
+            runner.fail("unicode", "scripts", "no scripts under /assets/scripts");
+        }
+        else {
+            runCases(runner, "scripts", scripts);
+        }
+
+        runCases(runner, "mixed", mixed);
+    }
+}
@@ -71,6 +71,24 @@ ffi.cdef [[
     void nxAudioVoiceSetFilterParameter(uint32_t, uint32_t, uint32_t, float);
     float nxAudioVoiceFilterParamter(uint32_t, uint32_t, uint32_t);
     void nxAudioVoiceFadeFilterParameter(uint32_t, uint32_t, uint32_t, float, double);
+
+    typedef struct NxVoiceUpdate {
+        uint32_t handle;
+        uint32_t mask;
+        float volume;
+        float pan;
+        float playSpeed;
+        bool paused;
+        float position[3];
+        float velocity[3];
+        float minDistance;
+        float maxDistance;
+        uint32_t attenuationModel;
+        float attenuationRolloff;
+        float dopplerFactor;
+    } NxVoiceUpdate;
+
+    void nxAudioVoiceBatchUpdate(const NxVoiceUpdate*, size_t);
 ]]
 
 local toFilterAttribute = {
@@ -83,6 +101,56 @@ local toFilterAttribute = {
     resonance  = 3
 }
 
+local UpdateVolume, UpdatePan, UpdatePlaySpeed, UpdatePaused = 0x1, 0x2, 0x4, 0x8
+local UpdatePosition, UpdateVelocity, UpdateMinMaxDistance = 0x10, 0x20, 0x40
+local UpdateAttenuation, UpdateDopplerFactor = 0x80, 0x100
+
+-- Pending updates, one record per handle, sent to the mixer in one go
+local batchDepth    = 0
+local batchCount    = 0
+local batchCapacity = 64
+local batchUpdates  = ffi.new('NxVoiceUpdate[?]', batchCapacity)
+local batchIndices  = {}
+
+local function batchedUpdate(handle, field)
+    local index = batchIndices[handle]
+    if not index then
+        if batchCount == batchCapacity then
+            local updates = ffi.new('NxVoiceUpdate[?]', batchCapacity * 2)
+            ffi.copy(updates, batchUpdates, ffi.sizeof('NxVoiceUpdate') * batchCount)
+            batchUpdates, batchCapacity = updates, batchCapacity * 2
+        end
+
+        index = batchCount
+        batchCount = batchCount + 1
+        batchIndices[handle] = index
+
+        batchUpdates[index].handle = handle
+        batchUpdates[index].mask = 0
+    end
+
+    local update = batchUpdates[index]
+    update.mask = bit.bor(update.mask, field)
+    return update
+end
+
+-- Until the matching endBatch, volume, pan, play speed, pause and 3d setters are queued
+-- and then applied all at once, taking the mixer lock a single time
+function AudioVoice.static.beginBatch()
+    batchDepth = batchDepth + 1
+end
+
+function AudioVoice.static.endBatch()
+    if batchDepth == 0 then return end
+
+    batchDepth = batchDepth - 1
+    if batchDepth > 0 or batchCount == 0 then return end
+
+    C.nxAudioVoiceBatchUpdate(batchUpdates, batchCount)
+    batchCount = 0
+    batchIndices = {}
+end
+
 function AudioVoice:initialize(handle)
     self._cdata = handle
 end
@@ -102,7 +170,11 @@ function AudioVoice:seek(pos)
 end
 
 function AudioVoice:pause(paused)
-    C.nxAudioVoiceSetPaused(self:_handle(), paused)
+    if batchDepth > 0 then
+        batchedUpdate(self:_handle(), UpdatePaused).paused = paused
+    else
+        C.nxAudioVoiceSetPaused(self:_handle(), paused)
+    end
 
     return self
 end
@@ -132,7 +204,11 @@ function AudioVoice:setInaudibleBehavior(tick, kill)
 end
 
 function AudioVoice:setPlaySpeed(factor)
-    C.nxAudioVoiceSetRelativePlaySpeed(self:_handle(), factor)
+    if batchDepth > 0 then
+        batchedUpdate(self:_handle(), UpdatePlaySpeed).playSpeed = factor
+    else
+        C.nxAudioVoiceSetRelativePlaySpeed(self:_handle(), factor)
+    end
 
     return self
 end
@@ -144,7 +220,11 @@ function AudioVoice:setSamplerate(samplerate)
 end
 
 function AudioVoice:setPan(pan)
-    C.nxAudioVoiceSetPan(self:_handle(), pan)
+    if batchDepth > 0 then
+        batchedUpdate(self:_handle(), UpdatePan).pan = pan
+    else
+        C.nxAudioVoiceSetPan(self:_handle(), pan)
+    end
 
     return self
 end
@@ -156,7 +236,11 @@ function AudioVoice:setAbsolutePan(l, r, lb, rb, c, s)
 end
 
 function AudioVoice:setVolume(vol)
-    C.nxAudioVoiceSetVolume(self:_handle(), vol)
+    if batchDepth > 0 then
+        batchedUpdate(self:_handle(), UpdateVolume).volume = vol
+    else
+        C.nxAudioVoiceSetVolume(self:_handle(), vol)
+    end
 
     return self
 end
@@ -168,39 +252,68 @@ function AudioVoice:setDelaySamples(samples)
 end
 
 function AudioVoice:set3dParameters(x, y, z, velX, velY, velZ)
-    C.nxAudioVoiceSet3dSourceParameters(self:_handle(), x, y, z, velX or 0, velY or 0, velZ or 0)
+    if batchDepth > 0 then
+        self:set3dPosition(x, y, z)
+        self:set3dVelocity(velX or 0, velY or 0, velZ or 0)
+    else
+        C.nxAudioVoiceSet3dSourceParameters(self:_handle(), x, y, z, velX or 0, velY or 0, velZ or 0)
+    end
 
     return self
 end
 
 function AudioVoice:set3dPosition(x, y, z)
-    C.nxAudioVoiceSet3dSourcePosition(self:_handle(), x, y, z)
+    if batchDepth > 0 then
+        local update = batchedUpdate(self:_handle(), UpdatePosition)
+        update.position[0], update.position[1], update.position[2] = x, y, z
+    else
+        C.nxAudioVoiceSet3dSourcePosition(self:_handle(), x, y, z)
+    end
 
     return self
 end
 
 function AudioVoice:set3dVelocity(x, y, z)
-    C.nxAudioVoiceSet3dSourceVelocity(self:_handle(), x, y, z)
+    if batchDepth > 0 then
+        local update = batchedUpdate(self:_handle(), UpdateVelocity)
+        update.velocity[0], update.velocity[1], update.velocity[2] = x, y, z
+    else
+        C.nxAudioVoiceSet3dSourceVelocity(self:_handle(), x, y, z)
+    end
 
     return self
 end
 
 function AudioVoice:set3dMinMaxDistance(min, max)
-    C.nxAudioVoiceSet3dSourceMinMaxDistance(self:_handle(), min, max)
+    if batchDepth > 0 then
+        local update = batchedUpdate(self:_handle(), UpdateMinMaxDistance)
+        update.minDistance, update.maxDistance = min, max
+    else
+        C.nxAudioVoiceSet3dSourceMinMaxDistance(self:_handle(), min, max)
+    end
 
     return self
 end
 
 function AudioVoice:set3dAttenuation(model, rolloffFactor)
-    C.nxAudioVoiceSet3dSourceAttenuation(
-        self:_handle(), require('audio.source')._toAttenuationModel[model] or 0, rolloffFactor
-    )
+    model = require('audio.source')._toAttenuationModel[model] or 0
+
+    if batchDepth > 0 then
+        local update = batchedUpdate(self:_handle(), UpdateAttenuation)
+        update.attenuationModel, update.attenuationRolloff = model, rolloffFactor
+    else
+        C.nxAudioVoiceSet3dSourceAttenuation(self:_handle(), model, rolloffFactor)
+    end
 
     return self
 end
 
 function AudioVoice:set3dDopplerFactor(factor)
-    C.nxAudioVoiceSet3dSourceDopplerFactor(self:_handle(), factor)
+    if batchDepth > 0 then
+        batchedUpdate(self:_handle(), UpdateDopplerFactor).dopplerFactor = factor
+    else
+        C.nxAudioVoiceSet3dSourceDopplerFactor(self:_handle(), factor)
+    end
 
     return self
 end
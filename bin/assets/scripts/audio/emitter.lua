@@ -0,0 +1,114 @@
+--[[
+    This is free and unencumbered software released into the public domain.
+
+    Anyone is free to copy, modify, publish, use, compile, sell, or
+    distribute this software, either in source code form or as a compiled
+    binary, for any purpose, commercial or non-commercial, and by any
+    means.
+
+    In jurisdictions that recognize copyright laws, the author or authors
+    of this software dedicate any and all copyright interest in the
+    software to the public domain. We make this dedication for the benefit
+    of the public at large and to the detriment of our heirs and
+    successors. We intend this dedication to be an overt act of
+    relinquishment in perpetuity of all present and future rights to this
+    software under copyright law.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+    MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+    IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+    OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+    ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+    OTHER DEALINGS IN THE SOFTWARE.
+
+    For more information, please refer to <http://unlicense.org>
+--]]
+
+local class = require 'class'
+
+local AudioEmitter = class 'audio.emitter'
+
+local ffi = require 'ffi'
+local C = ffi.C
+
+ffi.cdef [[
+    typedef struct NxAudioSource NxAudioSource;
+
+    uint32_t nxAudioEmitterCreate(NxAudioSource*, double, float, float);
+    void nxAudioEmitterRelease(uint32_t);
+    void nxAudioEmitterSetPosition(uint32_t, float, float, float);
+    void nxAudioEmitterSetVelocity(uint32_t, float, float, float);
+    void nxAudioEmitterSetVolume(uint32_t, float);
+    void nxAudioEmitterSetPriority(uint32_t, float);
+    bool nxAudioEmitterIsPlaying(uint32_t);
+    bool nxAudioEmitterIsReal(uint32_t);
+    double nxAudioEmitterPosition(uint32_t);
+]]
+
+local function releaseHandle(handle)
+    C.nxAudioEmitterRelease(handle[0])
+end
+
+-- A 3D sound that only gets a real voice while it's among the most audible ones
+-- Keeps a reference to the source, which must not be released while the emitter lives
+function AudioEmitter:initialize(source, x, y, z, volume, priority)
+    self._source = source
+    self._id     = C.nxAudioEmitterCreate(source._cdata, source:length(), volume or 1, priority or 1)
+    self._handle = ffi.gc(ffi.new('uint32_t[1]', self._id), releaseHandle)
+
+    C.nxAudioEmitterSetPosition(self._id, x or 0, y or 0, z or 0)
+end
+
+function AudioEmitter:release()
+    if not self._handle then return end
+
+    releaseHandle(ffi.gc(self._handle, nil))
+    self._handle = nil
+    self._source = nil
+end
+
+function AudioEmitter:source()
+    return self._source
+end
+
+function AudioEmitter:setPosition(x, y, z)
+    if self._handle then C.nxAudioEmitterSetPosition(self._id, x, y, z) end
+
+    return self
+end
+
+function AudioEmitter:setVelocity(x, y, z)
+    if self._handle then C.nxAudioEmitterSetVelocity(self._id, x, y, z) end
+
+    return self
+end
+
+function AudioEmitter:setVolume(volume)
+    if self._handle then C.nxAudioEmitterSetVolume(self._id, volume) end
+
+    return self
+end
+
+-- Scales how audible the emitter is considered when picking the real voices
+function AudioEmitter:setPriority(priority)
+    if self._handle then C.nxAudioEmitterSetPriority(self._id, priority) end
+
+    return self
+end
+
+function AudioEmitter:isPlaying()
+    return self._handle ~= nil and C.nxAudioEmitterIsPlaying(self._id)
+end
+
+-- Whether the emitter is currently being mixed
+function AudioEmitter:isReal()
+    return self._handle ~= nil and C.nxAudioEmitterIsReal(self._id)
+end
+
+-- Play position in seconds, tracked even while the emitter is virtual
+function AudioEmitter:position()
+    return self._handle and C.nxAudioEmitterPosition(self._id) or 0
+end
+
+return AudioEmitter
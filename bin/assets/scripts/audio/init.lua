@@ -58,8 +58,14 @@ ffi.cdef [[
     void nxAudioSet3dListenerUp(float, float, float);
     void nxAudioSet3dListenerVelocity(float, float, float);
     void nxAudioSetGlobalFilter(NxAudioFilter*, uint32_t);
+    void nxAudioUpdateEmitters(double);
+    void nxAudioSetMaxRealVoices(uint32_t);
+    uint32_t nxAudioMaxRealVoices();
+    void nxAudioEmitterStats(uint32_t*);
 ]]
 
+local statsPtr = ffi.new('uint32_t[4]')
+
 function Audio.init()
     return C.nxAudioInit()
 end
@@ -111,6 +117,30 @@ function Audio.update3d()
     return Audio
 end
 
+-- Picks the emitters that get a real voice and applies their 3D parameters, once per frame
+function Audio.update(dt)
+    C.nxAudioUpdateEmitters(dt)
+
+    return Audio
+end
+
+-- How many emitters can be mixed at once, the others are tracked virtually
+function Audio.setMaxRealVoices(count)
+    C.nxAudioSetMaxRealVoices(count)
+
+    return Audio
+end
+
+function Audio.maxRealVoices()
+    return C.nxAudioMaxRealVoices()
+end
+
+-- Playing emitters, real ones among them, and the promotions and demotions of the last update
+function Audio.emitterStats()
+    C.nxAudioEmitterStats(statsPtr)
+    return statsPtr[0], statsPtr[1], statsPtr[2], statsPtr[3]
+end
+
 function Audio.setSoundSpeed(speed)
     C.nxAudioSet3dSoundSpeed(speed)
 
@@ -25,8 +25,9 @@
     For more information, please refer to <http://unlicense.org>
 --]]
 
-local class      = require 'class'
-local AudioVoice = require 'audio._voice'
+local class        = require 'class'
+local AudioVoice   = require 'audio._voice'
+local AudioEmitter = require 'audio.emitter'
 
 local AudioSource = class 'audio.source'
 
@@ -68,12 +69,17 @@ ffi.cdef [[
     const float* nxAudioBusCurrentWaveData(NxAudioSource*);
 
     NxAudioSource* nxAudioSourceCreate();
-    void nxAudioSourceLoadFile(NxAudioSource*, const char*);
-    void nxAudioSourceLoadMemory(NxAudioSource*, uint8_t*, uint32_t);
+    void nxAudioSourceLoadFile(NxAudioSource*, const char*, uint32_t);
+    void nxAudioSourceLoadMemory(NxAudioSource*, uint8_t*, uint32_t, uint32_t);
     double nxAudioSourceStaticLength(NxAudioSource*);
+    uint32_t nxAudioSourceStaticMemorySize(NxAudioSource*);
+    size_t nxAudioSampleBankMemory();
+    size_t nxAudioSampleBankCount();
     void nxAudioSourceOpenFile(NxAudioSource*, const char*);
     void nxAudioSourceOpenMemory(NxAudioSource*, uint8_t*, uint32_t);
     double nxAudioSourceStreamLength(NxAudioSource*);
+    void nxAudioSourceStreamHealth(const NxAudioSource*, uint32_t*, float*);
+    uint32_t nxAudioStreamUnderruns();
 ]]
 
 local toAttenuationModel = {
@@ -84,6 +90,25 @@ local toAttenuationModel = {
 }
 AudioSource.static._toAttenuationModel = toAttenuationModel
 
+local toSampleFormat = {
+    float = 0,
+    int16 = 1,
+    adpcm = 2
+}
+
+local underrunsPtr  = ffi.new('uint32_t[1]')
+local fillLevelPtr = ffi.new('float[1]')
+
+-- Times any stream's mixer had to wait on its read-ahead buffer
+function AudioSource.static.streamUnderruns()
+    return C.nxAudioStreamUnderruns()
+end
+
+-- Decoded samples shared by all the static sources, in bytes, and the number of buffers
+function AudioSource.static.sampleBankUsage()
+    return tonumber(C.nxAudioSampleBankMemory()), tonumber(C.nxAudioSampleBankCount())
+end
+
 function AudioSource.static.factory(task, filename, type)
     if type == 'music' then
         task:setReusable(false)
@@ -92,7 +117,7 @@ function AudioSource.static.factory(task, filename, type)
             end)
     else
         task:addTask(true, function(source, filename)
-                source:load(filename)
+                source:load(filename, require('config').audioSampleFormat)
             end)
     end
 end
@@ -118,11 +143,13 @@ function AudioSource:open(a, b)
     return self
 end
 
-function AudioSource:load(a, b)
-    if b then
-        C.nxAudioSourceLoadMemory(self._cdata, a, b)
+-- Either load(filename, format) or load(buffer, size, format), format defaults to 'float'
+-- Decoding happens in the background, identical content is only decoded once
+function AudioSource:load(a, b, c)
+    if type(b) == 'number' then
+        C.nxAudioSourceLoadMemory(self._cdata, a, b, toSampleFormat[c] or 0)
     else
-        C.nxAudioSourceLoadFile(self._cdata, a)
+        C.nxAudioSourceLoadFile(self._cdata, a, toSampleFormat[b] or 0)
     end
 
     self._type = 'static'
@@ -139,6 +166,24 @@ function AudioSource:length()
     end
 end
 
+-- Returns the RAM and VRAM used by the source, in bytes, and what it holds in the sample bank
+-- Bank buffers are shared between sources, the bank counts them once as a whole
+function AudioSource:memoryUsage()
+    if self._type == 'static' then
+        return 0, 0, C.nxAudioSourceStaticMemorySize(self._cdata)
+    else
+        return 0, 0, 0
+    end
+end
+
+-- Underruns of this stream and how full its read-ahead buffer is, from 0 to 1
+function AudioSource:streamHealth()
+    if self._type ~= 'stream' then return 0, 1 end
+
+    C.nxAudioSourceStreamHealth(self._cdata, underrunsPtr, fillLevelPtr)
+    return underrunsPtr[0], fillLevelPtr[0]
+end
+
 function AudioSource:type()
     return self._type
 end
@@ -173,6 +218,11 @@ function AudioSource:play3dClocked(interval, x, y, z, velX, velY, velZ, volume)
     return AudioVoice:new(handle)
 end
 
+-- Plays through the voice manager, which virtualizes the emitter when it's not audible enough
+function AudioSource:emit(x, y, z, volume, priority)
+    return AudioEmitter:new(self, x, y, z, volume, priority)
+end
+
 function AudioSource:playThrough(bus, volume, pan, paused)
     local handle = C.nxAudioSourcePlayThrough(
         self._cdata, bus._cdata, volume or -1, pan or 0, not not paused
@@ -36,5 +36,15 @@ return {
     textureFormat = 'rgba8',
 
     -- True to allow multi-threading on the GPU
-    noGpuMultithreading = true
+    noGpuMultithreading = true,
+
+    -- Memory the cache can use before evicting unused items, in bytes
+    cacheMemoryBudget = 64 * 1024 * 1024,
+    cacheVideoMemoryBudget = 128 * 1024 * 1024,
+
+    -- Lua VMs kept ready for cache tasks and threads
+    luaVMPoolSize = 8,
+
+    -- Storage for the decoded samples of cached sounds: 'float', 'int16' or 'adpcm'
+    audioSampleFormat = 'int16'
 }
\ No newline at end of file
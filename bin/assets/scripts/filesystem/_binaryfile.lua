@@ -34,25 +34,47 @@ local ffi = require 'ffi'
 local C = ffi.C
 
 ffi.cdef[[
-    typedef struct PHYSFS_File PHYSFS_File;
-
-    const char* nxFsGetError();
-
-    void nxFsClose(PHYSFS_File*);
-    bool nxFsSize(PHYSFS_File*, size_t*);
-    bool nxFsTell(PHYSFS_File*, size_t*);
-    bool nxFsSeek(PHYSFS_File*, size_t);
+    typedef struct NxStream NxStream;
+
+    NxStream* nxStreamOpen(const char*, bool, size_t, const char**);
+    void nxStreamRelease(NxStream*);
+    const char* nxStreamGetError(const NxStream*);
+    void nxStreamSetBigEndian(NxStream*, bool);
+    bool nxStreamIsBigEndian(const NxStream*);
+    bool nxStreamSize(NxStream*, size_t*);
+    bool nxStreamTell(NxStream*, size_t*);
+    bool nxStreamSeek(NxStream*, size_t);
 ]]
 
+local sizePtr  = ffi.new('size_t[1]')
+local errorPtr = ffi.new('const char*[1]')
+
 function BinaryFile.static.defaultCallback(message)
     Log.error('File I/O error: ' .. message)
 end
 
-function BinaryFile:initialize(filename)
+function BinaryFile:initialize(filename, bufferSize)
     self._errorCallback = BinaryFile.defaultCallback
+    self._bigEndian = false
 
     -- Attempt to open the file if given a string
-    if type(filename) == 'string' then self:open(filename) end
+    if type(filename) == 'string' then self:open(filename, bufferSize) end
+end
+
+function BinaryFile:_open(filename, write, bufferSize)
+    -- Close if already open
+    if self:isOpen() then self:release() end
+
+    local handle = C.nxStreamOpen(filename, write, bufferSize or 0, errorPtr)
+    if handle == nil then
+        self._errorCallback(ffi.string(errorPtr[0]))
+        return self
+    end
+
+    self._cdata = ffi.gc(handle, C.nxStreamRelease)
+    C.nxStreamSetBigEndian(self._cdata, self._bigEndian)
+
+    return self
 end
 
 function BinaryFile:onError(callback)
@@ -62,7 +84,7 @@ function BinaryFile:onError(callback)
 end
 
 function BinaryFile:_throwError(retVal1, retVal2)
-    self._errorCallback(ffi.string(C.nxFsGetError()))
+    self._errorCallback(ffi.string(C.nxStreamGetError(self._cdata)))
     self:release()
 
     return retVal1, retVal2
@@ -75,34 +97,44 @@ end
 function BinaryFile:release()
     if self._cdata == nil then return end
 
-    C.nxFsClose(ffi.gc(self._cdata, nil))
+    C.nxStreamRelease(ffi.gc(self._cdata, nil))
     self._cdata = nil
 end
 
+-- Multi-byte values are little-endian unless told otherwise
+function BinaryFile:setBigEndian(bigEndian)
+    self._bigEndian = not not bigEndian
+    if self._cdata ~= nil then C.nxStreamSetBigEndian(self._cdata, self._bigEndian) end
+
+    return self
+end
+
+function BinaryFile:isBigEndian()
+    return self._bigEndian
+end
+
 function BinaryFile:size()
     if self._cdata == nil then return 0 end
 
-    local size = ffi.new('size_t[1]')
-    if not C.nxFsSize(self._cdata, size) then return self:_throwError(0) end
+    if not C.nxStreamSize(self._cdata, sizePtr) then return self:_throwError(0) end
 
-    return tonumber(size[0])
+    return tonumber(sizePtr[0])
 end
 
 function BinaryFile:tell()
     if self._cdata == nil then return 0 end
 
-    local position = ffi.new('size_t[1]')
-    if not C.nxFsTell(self._cdata, position) then return self:_throwError(0) end
+    if not C.nxStreamTell(self._cdata, sizePtr) then return self:_throwError(0) end
 
-    return tonumber(position[0])
+    return tonumber(sizePtr[0])
 end
 
 function BinaryFile:seek(position)
     if self._cdata == nil then return self end
 
-    if not C.nxFsSeek(self._cdata, position) then self._throwError() end
+    if not C.nxStreamSeek(self._cdata, position) then self:_throwError() end
 
     return self
 end
 
-return BinaryFile
\ No newline at end of file
+return BinaryFile
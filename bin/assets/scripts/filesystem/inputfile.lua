@@ -33,174 +33,146 @@ local ffi = require 'ffi'
 local C = ffi.C
 
 ffi.cdef[[
-    typedef struct PHYSFS_File PHYSFS_File;
-
-    PHYSFS_File* nxFsOpenRead(const char*);
-    void nxFsClose(PHYSFS_File*);
-
-    bool nxFsRead(PHYSFS_File*, PHYSFS_File*, size_t, size_t*);
-    bool nxFsReadS8(PHYSFS_File*, int8_t*);
-    bool nxFsReadS16(PHYSFS_File*, int16_t*);
-    bool nxFsReadS32(PHYSFS_File*, int32_t*);
-    bool nxFsReadS64(PHYSFS_File*, int64_t*);
-    bool nxFsReadU8(PHYSFS_File*, uint8_t*);
-    bool nxFsReadU16(PHYSFS_File*, uint16_t*);
-    bool nxFsReadU32(PHYSFS_File*, uint32_t*);
-    bool nxFsReadU64(PHYSFS_File*, uint64_t*);
-    bool nxFsReadFloat(PHYSFS_File*, double*);
-    bool nxFsReadDouble(PHYSFS_File*, double*);
-    const char* nxFsReadString(PHYSFS_File*);
+    typedef struct NxStream NxStream;
+
+    bool nxStreamRead(NxStream*, void*, size_t, size_t*);
+    bool nxStreamReadArray(NxStream*, void*, size_t, size_t);
+    const char* nxStreamReadCString(NxStream*, size_t*);
+    const char* nxStreamReadLengthPrefixed(NxStream*, size_t, size_t*);
 ]]
 
-function InputFile:initialize(filename)
-    BinaryFile.initialize(self, filename)
+local scratch = ffi.new([[union {
+    int8_t s8; int16_t s16; int32_t s32; int64_t s64;
+    uint8_t u8; uint16_t u16; uint32_t u32; uint64_t u64;
+    float f; double d;
+}]])
+local lengthPtr = ffi.new('size_t[1]')
+
+local arrayTypes = {}
+local function arrayType(ctype)
+    local arrType = arrayTypes[ctype]
+    if not arrType then
+        arrType = ffi.typeof('$[?]', ffi.typeof(ctype))
+        arrayTypes[ctype] = arrType
+    end
+
+    return arrType
 end
 
-function InputFile:open(filename)
-    -- Close if already open
-    if self:isOpen() then self:close() end
-
-    local handle = C.nxFsOpenRead(filename)
-    if handle == nil then return self:_throwError(self) end
+function InputFile:initialize(filename, bufferSize)
+    BinaryFile.initialize(self, filename, bufferSize)
+end
 
-    self._cdata = ffi.gc(handle, C.nxFsClose)
-    return self
+function InputFile:open(filename, bufferSize)
+    return self:_open(filename, false, bufferSize)
 end
 
+-- Returns the buffer and the number of bytes read, which is short of size at the end of the file
 function InputFile:read(size)
     if self._cdata == nil then return '', 0 end
 
     -- If size is invalid, read all
     if type(size) ~= 'number' then size = self:size() end
 
-    local readBytesPtr = ffi.new('size_t[1]')
-    local buffer       = ffi.new('uint8_t[?]', size)
+    local buffer = ffi.new('uint8_t[?]', size)
+    if not C.nxStreamRead(self._cdata, buffer, size, lengthPtr) then
+        return self:_throwError('', 0)
+    end
 
-    local ok = C.nxFsRead(self._cdata, buffer, size, readBytesPtr)
-    if not ok then return self:_throwError('', 0) end
-
-    return buffer, tonumber(readBytesPtr[0])
+    return buffer, tonumber(lengthPtr[0])
 end
 
-function InputFile:readS8()
+function InputFile:_readScalar(field, size)
     if self._cdata == nil then return 0 end
 
-    local valPtr = ffi.new('int8_t[1]')
+    if not C.nxStreamReadArray(self._cdata, scratch, 1, size) then return self:_throwError(0) end
 
-    local ok = C.nxFsReadS8(self._cdata, valPtr)
-    if not ok then return self:_throwError(0) end
+    return scratch[field]
+end
 
-    return tonumber(valPtr[0])
+function InputFile:readS8()
+    return tonumber(self:_readScalar('s8', 1))
 end
 
 function InputFile:readS16()
-    if self._cdata == nil then return 0 end
-
-    local valPtr = ffi.new('int16_t[1]')
-
-    local ok = C.nxFsReadS16(self._cdata, valPtr)
-    if not ok then return self:_throwError(0) end
-
-    return tonumber(valPtr[0])
+    return tonumber(self:_readScalar('s16', 2))
 end
 
 function InputFile:readS32()
-    if self._cdata == nil then return 0 end
-
-    local valPtr = ffi.new('int32_t[1]')
-
-    local ok = C.nxFsReadS32(self._cdata, valPtr)
-    if not ok then return self:_throwError(0) end
-
-    return tonumber(valPtr[0])
+    return tonumber(self:_readScalar('s32', 4))
 end
 
 function InputFile:readS64()
-    if self._cdata == nil then return 0 end
-
-    local valPtr = ffi.new('int64_t[1]')
-
-    local ok = C.nxFsReadS64(self._cdata, valPtr)
-    if not ok then return self:_throwError(0) end
-
-    return valPtr[0]
+    return self:_readScalar('s64', 8)
 end
 
 function InputFile:readU8()
-    if self._cdata == nil then return 0 end
-
-    local valPtr = ffi.new('uint8_t[1]')
-
-    local ok = C.nxFsReadU8(self._cdata, valPtr)
-    if not ok then return self:_throwError(0) end
-
-    return tonumber(valPtr[0])
+    return tonumber(self:_readScalar('u8', 1))
 end
 
 function InputFile:readU16()
-    if self._cdata == nil then return 0 end
-
-    local valPtr = ffi.new('uint16_t[1]')
-
-    local ok = C.nxFsReadU16(self._cdata, valPtr)
-    if not ok then return self:_throwError(0) end
-
-    return tonumber(valPtr[0])
+    return tonumber(self:_readScalar('u16', 2))
 end
 
 function InputFile:readU32()
-    if self._cdata == nil then return 0 end
-
-    local valPtr = ffi.new('uint32_t[1]')
+    return tonumber(self:_readScalar('u32', 4))
+end
 
-    local ok = C.nxFsReadU32(self._cdata, valPtr)
-    if not ok then return self:_throwError(0) end
+function InputFile:readU64()
+    return self:_readScalar('u64', 8)
+end
 
-    return tonumber(valPtr[0])
+function InputFile:readFloat()
+    -- Round to float precision to prevent the loss of precision that's due to float<->double
+    return tonumber(('%g'):format(self:_readScalar('f', 4)))
 end
 
-function InputFile:readU64()
-    if self._cdata == nil then return 0 end
+function InputFile:readDouble()
+    return tonumber(self:_readScalar('d', 8))
+end
 
-    local valPtr = ffi.new('uint64_t[1]')
+-- Reads count scalars of the given type in one go, into dst if given
+function InputFile:readArray(ctype, count, dst)
+    dst = dst or arrayType(ctype)(count)
+    if self._cdata == nil then return dst end
 
-    local ok = C.nxFsReadU32(self._cdata, valPtr)
-    if not ok then return self:_throwError(0) end
+    if not C.nxStreamReadArray(self._cdata, dst, count, ffi.sizeof(ctype)) then
+        return self:_throwError(dst)
+    end
 
-    return valPtr[0]
+    return dst
 end
 
-function InputFile:readFloat()
-    if self._cdata == nil then return 0 end
-
-    -- C function does float-->string-->double to prevent the loss of precision
-    -- that's due to float<->double
-    local valPtr = ffi.new('double[1]')
+-- Structs are read as raw bytes, with no endianness conversion
+function InputFile:readStruct(ctype, dst)
+    dst = dst or ffi.new(ctype)
+    if self._cdata == nil then return dst end
 
-    local ok = C.nxFsReadFloat(self._cdata, valPtr)
-    if not ok then return self:_throwError(0) end
+    if not C.nxStreamReadArray(self._cdata, dst, ffi.sizeof(dst), 1) then
+        return self:_throwError(dst)
+    end
 
-    return tonumber(valPtr[0])
+    return dst
 end
 
-function InputFile:readDouble()
-    if self._cdata == nil then return 0 end
-
-    local valPtr = ffi.new('double[1]')
+function InputFile:readCString()
+    if self._cdata == nil then return '' end
 
-    local ok = C.nxFsReadDouble(self._cdata, valPtr)
-    if not ok then return self:_throwError(0) end
+    local str = C.nxStreamReadCString(self._cdata, lengthPtr)
+    if str == nil then return self:_throwError('') end
 
-    return tonumber(valPtr[0])
+    return ffi.string(str, lengthPtr[0])
 end
 
-function InputFile:readString()
+InputFile.readString = InputFile.readCString
+
+function InputFile:readLengthPrefixed(prefixSize)
     if self._cdata == nil then return '' end
 
-    local str = C.nxFsReadString(self._cdata)
-    if str == nil then self:_throwError('') end
+    local str = C.nxStreamReadLengthPrefixed(self._cdata, prefixSize or 4, lengthPtr)
+    if str == nil then return self:_throwError('') end
 
-    return ffi.string(str)
+    return ffi.string(str, lengthPtr[0])
 end
 
-return InputFile
\ No newline at end of file
+return InputFile
@@ -33,141 +33,133 @@ local ffi = require 'ffi'
 local C = ffi.C
 
 ffi.cdef[[
-    typedef struct PHYSFS_File PHYSFS_File;
-
-    PHYSFS_File* nxFsOpenWrite(const char*);
-    bool nxFsFlush(PHYSFS_File*);
-    void nxFsClose(PHYSFS_File*);
-
-    bool nxFsWrite(PHYSFS_File*, const void*, size_t, size_t*);
-    bool nxFsWriteS8(PHYSFS_File*, int8_t);
-    bool nxFsWriteS16(PHYSFS_File*, int16_t);
-    bool nxFsWriteS32(PHYSFS_File*, int32_t);
-    bool nxFsWriteS64(PHYSFS_File*, int64_t);
-    bool nxFsWriteU8(PHYSFS_File*, uint8_t);
-    bool nxFsWriteU16(PHYSFS_File*, uint16_t);
-    bool nxFsWriteU32(PHYSFS_File*, uint32_t);
-    bool nxFsWriteS64(PHYSFS_File*, uint64_t);
-    bool nxFsWriteFloat(PHYSFS_File*, double);
-    bool nxFsWriteDouble(PHYSFS_File*, double);
-    bool nxFsWriteString(PHYSFS_File*, const char*);
+    typedef struct NxStream NxStream;
+
+    bool nxStreamFlush(NxStream*);
+    bool nxStreamWrite(NxStream*, const void*, size_t);
+    bool nxStreamWriteArray(NxStream*, const void*, size_t, size_t);
+    bool nxStreamWriteLengthPrefixed(NxStream*, const char*, size_t, size_t);
 ]]
 
-function OutputFile:initialize(filename)
-    BinaryFile.initialize(self, filename)
+local scratch = ffi.new([[union {
+    int8_t s8; int16_t s16; int32_t s32; int64_t s64;
+    uint8_t u8; uint16_t u16; uint32_t u32; uint64_t u64;
+    float f; double d;
+}]])
+
+function OutputFile:initialize(filename, bufferSize)
+    BinaryFile.initialize(self, filename, bufferSize)
 end
 
-function OutputFile:open(filename)
-    -- If already open, close it
-    if self:isOpen() then self:close() end
+function OutputFile:open(filename, bufferSize)
+    return self:_open(filename, true, bufferSize)
+end
 
-    local handle = C.nxFsOpenWrite(filename)
-    if handle == nil then return self:_throwError(self) end
+function OutputFile:flush()
+    if self._cdata ~= nil and not C.nxStreamFlush(self._cdata) then
+        self:_throwError()
+    end
 
-    self._cdata = ffi.gc(handle, C.nxFsClose)
     return self
 end
 
 function OutputFile:write(buffer, size)
-    if self._cdata ~= nil then
-        -- If no size supplied, assume size of buffer string
-        if not size then size = #buffer end
-
-        local bytesWrittenPtr = ffi.new('size_t[1]')
-
-        local ok = C.nxFsWrite(self._cdata, buffer, size, bytesWrittenPtr)
-        if not ok then self:_throwError() end
+    -- If no size supplied, assume size of buffer string
+    if self._cdata ~= nil and not C.nxStreamWrite(self._cdata, buffer, size or #buffer) then
+        self:_throwError()
     end
 
     return self
 end
 
-function OutputFile:writeS8(val)
-    if self._cdata ~= nil and not C.nxFsWriteS8(self._cdata, val) then
-        self:_throwError()
-    end
+function OutputFile:_writeScalar(field, size, val)
+    if self._cdata == nil then return self end
+
+    scratch[field] = val
+    if not C.nxStreamWriteArray(self._cdata, scratch, 1, size) then self:_throwError() end
 
     return self
 end
 
-function OutputFile:writeS16(val)
-    if self._cdata ~= nil and not C.nxFsWriteS16(self._cdata, val) then
-        self:_throwError()
-    end
+function OutputFile:writeS8(val)
+    return self:_writeScalar('s8', 1, val)
+end
 
-    return self
+function OutputFile:writeS16(val)
+    return self:_writeScalar('s16', 2, val)
 end
 
 function OutputFile:writeS32(val)
-    if self._cdata ~= nil and not C.nxFsWriteS32(self._cdata, val) then
-        self:_throwError()
-    end
-
-    return self
+    return self:_writeScalar('s32', 4, val)
 end
 
 function OutputFile:writeS64(val)
-    if self._cdata ~= nil and not C.nxFsWriteS64(self._cdata, val) then
-        self:_throwError()
-    end
-
-    return self
+    return self:_writeScalar('s64', 8, val)
 end
 
 function OutputFile:writeU8(val)
-    if self._cdata ~= nil and not C.nxFsWriteU8(self._cdata, val) then
-        self:_throwError()
-    end
-
-    return self
+    return self:_writeScalar('u8', 1, val)
 end
 
 function OutputFile:writeU16(val)
-    if self._cdata ~= nil and not C.nxFsWriteU16(self._cdata, val) then
-        self:_throwError()
-    end
-
-    return self
+    return self:_writeScalar('u16', 2, val)
 end
 
 function OutputFile:writeU32(val)
-    if self._cdata ~= nil and not C.nxFsWriteU32(self._cdata, val) then
-        self:_throwError()
-    end
-
-    return self
+    return self:_writeScalar('u32', 4, val)
 end
 
 function OutputFile:writeU64(val)
-    if self._cdata ~= nil and not C.nxFsWriteU64(self._cdata, val) then
+    return self:_writeScalar('u64', 8, val)
+end
+
+function OutputFile:writeFloat(val)
+    -- Round to float precision to prevent the loss of precision that's due to float<->double
+    return self:_writeScalar('f', 4, tonumber(('%g'):format(val)))
+end
+
+function OutputFile:writeDouble(val)
+    return self:_writeScalar('d', 8, val)
+end
+
+-- Writes count scalars of the given type in one go
+function OutputFile:writeArray(ctype, data, count)
+    if self._cdata == nil then return self end
+
+    if not C.nxStreamWriteArray(self._cdata, data, count, ffi.sizeof(ctype)) then
         self:_throwError()
     end
 
     return self
 end
 
-function OutputFile:writeFloat(val)
-    if self._cdata ~= nil and not C.nxFsWriteFloat(self._cdata, val) then
+-- Structs are written as raw bytes, with no endianness conversion
+function OutputFile:writeStruct(data)
+    if self._cdata ~= nil and not C.nxStreamWrite(self._cdata, data, ffi.sizeof(data)) then
         self:_throwError()
     end
 
     return self
 end
 
-function OutputFile:writeDouble(val)
-    if self._cdata ~= nil and not C.nxFsWriteDouble(self._cdata, val) then
+function OutputFile:writeCString(str)
+    -- Lua strings are always null-terminated
+    if self._cdata ~= nil and not C.nxStreamWrite(self._cdata, str, #str + 1) then
         self:_throwError()
     end
 
     return self
 end
 
-function OutputFile:writeString(str)
-    if self._cdata ~= nil and not C.nxFsWriteString(self._cdata, str) then
+OutputFile.writeString = OutputFile.writeCString
+
+function OutputFile:writeLengthPrefixed(str, prefixSize)
+    if self._cdata ~= nil
+        and not C.nxStreamWriteLengthPrefixed(self._cdata, str, #str, prefixSize or 4) then
         self:_throwError()
     end
 
     return self
 end
 
-return OutputFile
\ No newline at end of file
+return OutputFile
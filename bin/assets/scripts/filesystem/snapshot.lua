@@ -0,0 +1,362 @@
+--[[
+    This is free and unencumbered software released into the public domain.
+
+    Anyone is free to copy, modify, publish, use, compile, sell, or
+    distribute this software, either in source code form or as a compiled
+    binary, for any purpose, commercial or non-commercial, and by any
+    means.
+
+    In jurisdictions that recognize copyright laws, the author or authors
+    of this software dedicate any and all copyright interest in the
+    software to the public domain. We make this dedication for the benefit
+    of the public at large and to the detriment of our heirs and
+    successors. We intend this dedication to be an overt act of
+    relinquishment in perpetuity of all present and future rights to this
+    software under copyright law.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+    MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+    IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+    OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+    ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+    OTHER DEALINGS IN THE SOFTWARE.
+
+    For more information, please refer to <http://unlicense.org>
+--]]
+
+local class = require 'class'
+
+local Snapshot = class 'filesystem.snapshot'
+
+local ffi = require 'ffi'
+local C = ffi.C
+
+ffi.cdef [[
+    typedef struct NxSnapshot NxSnapshot;
+
+    NxSnapshot* nxSnapshotCreate();
+    void nxSnapshotRelease(NxSnapshot*);
+    uint8_t* nxSnapshotReserve(NxSnapshot*, size_t);
+    bool nxSnapshotSave(NxSnapshot*, const char*, size_t, bool);
+    bool nxSnapshotIsBusy(const NxSnapshot*);
+    bool nxSnapshotWait(NxSnapshot*);
+    const uint8_t* nxSnapshotLoad(NxSnapshot*, const char*, size_t*);
+    bool nxSnapshotHasBase(const NxSnapshot*);
+]]
+
+-- Value tags
+local End, Nil, False, True, Integer, Number, String, Table, Reference, CData, Object = 0, 1, 2, 3,
+    4, 5, 6, 7, 8, 9, 10
+
+local scratch = ffi.new('union { double d; int32_t i; uint32_t u; uint8_t b[8]; }')
+local sizePtr = ffi.new('size_t[1]')
+
+-- Serialization state
+local handle, buffer, capacity, position, tables, tableCount
+
+-- Values encoded in memory, rather than to be saved, go to this buffer
+local memoryBuffer, memoryCapacity = nil, 0
+
+local function reserve(size)
+    local required = position + size
+    if required > capacity then
+        capacity = math.max(required, capacity * 2)
+        if handle then
+            buffer = C.nxSnapshotReserve(handle, capacity)
+        else
+            memoryBuffer, memoryCapacity = ffi.new('uint8_t[?]', capacity), capacity
+            if position > 0 then ffi.copy(memoryBuffer, buffer, position) end
+            buffer = memoryBuffer
+        end
+    end
+end
+
+local function writeByte(value)
+    reserve(1)
+    buffer[position] = value
+    position = position + 1
+end
+
+local function writeBytes(data, size)
+    reserve(size)
+    ffi.copy(buffer + position, data, size)
+    position = position + size
+end
+
+local function writeU32(value)
+    scratch.u = value
+    writeBytes(scratch.b, 4)
+end
+
+local function writeString(str)
+    writeU32(#str)
+    writeBytes(str, #str)
+end
+
+local writeValue
+
+local function writeTable(value, isObject)
+    local count = #value
+    writeU32(count)
+    for i = 1, count do
+        writeValue(value[i])
+    end
+
+    for k, v in pairs(value) do
+        if (type(k) ~= 'number' or k < 1 or k > count or k % 1 ~= 0)
+            and not (isObject and k == 'class') then
+            writeValue(k)
+            writeValue(v)
+        end
+    end
+    writeByte(End)
+end
+
+writeValue = function(value)
+    local valueType = type(value)
+
+    if valueType == 'nil' then
+        writeByte(Nil)
+    elseif valueType == 'boolean' then
+        writeByte(value and True or False)
+    elseif valueType == 'number' then
+        if value % 1 == 0 and value >= -2147483648 and value <= 2147483647 then
+            writeByte(Integer)
+            scratch.i = value
+            writeBytes(scratch.b, 4)
+        else
+            writeByte(Number)
+            scratch.d = value
+            writeBytes(scratch.b, 8)
+        end
+    elseif valueType == 'string' then
+        writeByte(String)
+        writeString(value)
+    elseif valueType == 'table' then
+        -- Tables referenced more than once are only written the first time
+        local index = tables[value]
+        if index then
+            writeByte(Reference)
+            writeU32(index)
+            return
+        end
+
+        tableCount = tableCount + 1
+        tables[value] = tableCount
+
+        -- Class instances are recreated from their class when read back
+        local isObject = type(value.class) == 'table' and value.class.name ~= nil
+        if isObject then
+            writeByte(Object)
+            writeString(value.class.name)
+        else
+            writeByte(Table)
+        end
+        writeTable(value, isObject)
+    elseif valueType == 'cdata' then
+        local typeName = tostring(ffi.typeof(value)):match('^ctype<(.*)>$')
+        if typeName:match('[*&]$') then
+            error('Snapshot: cannot serialize pointers (' .. typeName .. ')')
+        end
+
+        -- Scalars (such as 64-bit integers) need to be boxed to be copied
+        local size = ffi.sizeof(value)
+        if tonumber(value) then
+            value = ffi.new(ffi.typeof('$[1]', ffi.typeof(value)), value)
+        end
+
+        writeByte(CData)
+        writeString(typeName)
+        writeU32(size)
+        writeBytes(value, size)
+    else
+        error('Snapshot: cannot serialize values of type ' .. valueType)
+    end
+end
+
+-- Deserialization state
+local data, dataSize
+
+local function check(size)
+    if position + size > dataSize then
+        error('Snapshot: unexpected end of data')
+    end
+end
+
+local function readByte()
+    check(1)
+    position = position + 1
+    return data[position - 1]
+end
+
+local function readU32()
+    check(4)
+    ffi.copy(scratch.b, data + position, 4)
+    position = position + 4
+    return scratch.u
+end
+
+local function readString()
+    local size = readU32()
+    check(size)
+    position = position + size
+    return ffi.string(data + position - size, size)
+end
+
+local readValue
+
+local function readTable(value)
+    tableCount = tableCount + 1
+    tables[tableCount] = value
+
+    for i = 1, readU32() do
+        value[i] = readValue()
+    end
+
+    while true do
+        check(1)
+        if data[position] == End then
+            position = position + 1
+            return value
+        end
+
+        local k = readValue()
+        value[k] = readValue()
+    end
+end
+
+readValue = function()
+    local tag = readByte()
+
+    if tag == Nil then
+        return nil
+    elseif tag == False then
+        return false
+    elseif tag == True then
+        return true
+    elseif tag == Integer then
+        check(4)
+        ffi.copy(scratch.b, data + position, 4)
+        position = position + 4
+        return scratch.i
+    elseif tag == Number then
+        check(8)
+        ffi.copy(scratch.b, data + position, 8)
+        position = position + 8
+        return scratch.d
+    elseif tag == String then
+        return readString()
+    elseif tag == Table then
+        return readTable({})
+    elseif tag == Object then
+        return readTable(require(readString()):allocate())
+    elseif tag == Reference then
+        return tables[readU32()]
+    elseif tag == CData then
+        local typeName = readString()
+        local size = readU32()
+        check(size)
+
+        local ctype = ffi.typeof(typeName)
+        local value
+        if typeName:find('[?]', 1, true) then
+            value = ffi.new(ctype, size / ffi.sizeof(ctype, 1))
+        else
+            value = ffi.new(ctype)
+        end
+
+        -- Scalars are copied through a box
+        local scalar = tonumber(value) ~= nil
+        local target = scalar and ffi.new(ffi.typeof('$[1]', ctype)) or value
+        ffi.copy(target, data + position, size)
+        position = position + size
+
+        return scalar and target[0] or value
+    else
+        error('Snapshot: invalid value tag ' .. tag)
+    end
+end
+
+-- Encodes the value in memory, the data is valid until the next call
+function Snapshot.static.encode(value)
+    buffer, capacity, position, tables, tableCount = memoryBuffer, memoryCapacity, 0, {}, 0
+
+    local ok, err = pcall(writeValue, value)
+    tables = nil
+    if not ok then error(err, 2) end
+
+    return buffer, position
+end
+
+function Snapshot.static.decode(pointer, size)
+    data, dataSize, position, tables, tableCount = ffi.cast('const uint8_t*', pointer), size, 0, {}, 0
+
+    local ok, value = pcall(readValue)
+    data, tables = nil, nil
+    if not ok then error(value, 2) end
+
+    return value
+end
+
+function Snapshot:initialize()
+    self._cdata = ffi.gc(C.nxSnapshotCreate(), C.nxSnapshotRelease)
+    self._capacity = 4096
+end
+
+function Snapshot:release()
+    if self._cdata == nil then return end
+
+    C.nxSnapshotRelease(ffi.gc(self._cdata, nil))
+    self._cdata = nil
+end
+
+-- Serializes the value and writes it in the background.
+-- Delta snapshots are smaller but need the last full snapshot to be loaded first.
+function Snapshot:save(filename, value, delta)
+    if self._cdata == nil then return false end
+
+    handle, capacity, position, tables, tableCount = self._cdata, self._capacity, 0, {}, 0
+    buffer = C.nxSnapshotReserve(handle, capacity)
+
+    local ok, err = pcall(writeValue, value)
+    handle, buffer, tables = nil, nil, nil
+    if not ok then error(err, 2) end
+
+    -- Start with enough room for the next snapshot
+    self._capacity = math.max(self._capacity, position)
+
+    return C.nxSnapshotSave(self._cdata, filename, position, not not delta)
+end
+
+function Snapshot:load(filename)
+    if self._cdata == nil then return nil end
+
+    data = C.nxSnapshotLoad(self._cdata, filename, sizePtr)
+    if data == nil then return nil end
+
+    dataSize, position, tables, tableCount = tonumber(sizePtr[0]), 0, {}, 0
+
+    local ok, value = pcall(readValue)
+    data, tables = nil, nil
+    if not ok then error(value, 2) end
+
+    return value
+end
+
+function Snapshot:isBusy()
+    return self._cdata ~= nil and C.nxSnapshotIsBusy(self._cdata)
+end
+
+-- Waits for the last snapshot to be written, returns whether it succeeded
+function Snapshot:wait()
+    if self._cdata == nil then return false end
+
+    return C.nxSnapshotWait(self._cdata)
+end
+
+function Snapshot:hasBase()
+    return self._cdata ~= nil and C.nxSnapshotHasBase(self._cdata)
+end
+
+return Snapshot
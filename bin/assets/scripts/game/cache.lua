@@ -25,27 +25,45 @@
     For more information, please refer to <http://unlicense.org>
 --]]
 
-local ffi    = require 'ffi'
-local Log    = require 'util.log'
-local Config = require 'config'
-local Thread = require 'system.thread'
-local LuaVM  = require 'system.luavm'
-local class  = require 'class'
+local Log       = require 'util.log'
+local System    = require 'system'
+local Config    = require 'config'
+local Thread    = require 'system.thread'
+local LuaVM     = require 'system.luavm'
+local TaskGraph = require 'system.taskgraph'
+local Atomic    = require 'system.atomic'
+local class     = require 'class'
 
 local Cache = {}
 local items = {} -- cached items
 
+-- Unreferenced items are kept around, least recently used first, until memory runs short
+-- Those that were the quickest to load for the memory they hold go first (GreedyDual-Size),
+-- every eviction raises the floor that newly idle items start from, so old ones go eventually
+local idleItems = {}
+idleItems.prev, idleItems.next = idleItems, idleItems
+local evictionFloor = 0
+
+local memoryBudget = Config.cacheMemoryBudget
+local videoMemoryBudget = Config.cacheVideoMemoryBudget
+local usedMemory = 0
+local hits, misses, evictions = 0, 0, 0
+
 local registeredTypes = {}
 local totalTasks, finishedTasks, failedTasks = 0, 0, 0
 local loadingTasks, temporaryDeps = {}, {}
+local tasksById, taskCount = {}, 0
+
+-- Tasks are polled as soon as their dependencies are done or their current stage is over
+local graph = TaskGraph:new()
 
 local Task = class '_cacheclass'
 
 function Task:initialize(id, name, objClass, screen)
     self.id = id
+    self.node = graph:add()
     self.obj = objClass:new()
-    self.stagePtr = ffi.new('uint32_t[1]', 1)
-    self.lastStage = 0
+    self.stage = Atomic:new(1)
     self.screen = screen
     self.depsAdded = false
     self.name = name
@@ -55,6 +73,7 @@ function Task:initialize(id, name, objClass, screen)
     self.tasks = {}
     self.params = {}
     self.vm = LuaVM:new()
+    self.startTime = System.time()
 end
 
 function Task:addTask(threaded, func, deps)
@@ -108,7 +127,7 @@ function Task:addDependency(id, temporary)
     return self
 end
 
-local function loadFunc(stagePtr, vm, gpu, proc, obj, name, params)
+local function loadFunc(stage, vm, gpu, proc, obj, name, params, graph, node)
     if gpu then require('window').ensureContext() end
 
     local retVals = {pcall(proc, obj, name, unpack(params))}
@@ -117,17 +136,20 @@ local function loadFunc(stagePtr, vm, gpu, proc, obj, name, params)
         if retVals[2] then
             require('util.log').error('Unable to load file \'' .. name .. '\' :' .. retVals[2])
         end
-        stagePtr[0] = 0
+        stage:store(0, 'release')
     else
         for i = 2, table.maxn(retVals) do
             vm:push(retVals[i])
         end
 
-        stagePtr[0] = stagePtr[0] + 1
+        stage:add(1, 'release')
     end
 
     -- Synchronize loaded data accross all contexts
     if gpu then require('graphics').sync() end
+
+    -- Let the main thread know the stage is over
+    graph:signal(node)
 end
 
 local function isLoadable(str)
@@ -136,10 +158,9 @@ end
 
 local function addLoadingTask(screen, id)
     -- Check if task already exists
-    for i, task in pairs(loadingTasks) do
-        if task.id == id then
-            return task.obj, task.reusable
-        end
+    local task = tasksById[id]
+    if task then
+        return task.obj, task.reusable
     end
 
     -- Does not exists, add it the task list
@@ -152,11 +173,15 @@ local function addLoadingTask(screen, id)
 
     -- Setup a new task
     local name = id:sub(#type+2)
-    local task = Task:new(id, name, objClass, screen)
+    task = Task:new(id, name, objClass, screen)
     objClass.factory(task, name, type)
 
-    -- Add to task list
-    loadingTasks[table.maxn(loadingTasks)+1] = task
+    -- Add to task list, it has no dependencies yet so it's polled right away
+    loadingTasks[task.node] = task
+    tasksById[id] = task
+    taskCount = taskCount + 1
+    graph:signal(task.node)
+
     return task.obj, task.reusable
 end
 
@@ -168,11 +193,23 @@ function Cache.registerType(objType, objClass)
     return Cache
 end
 
-function Cache.prepare()
-    totalTasks, finishedTasks, failedTasks = 0, 0, 0
-    for i in pairs(loadingTasks) do
-        totalTasks = totalTasks + 1
+-- Workers get VMs that already loaded the classes of the registered types
+function Cache.prewarm(count)
+    local modules, seen = {'util.log', 'system.atomic', 'system.taskgraph'}, {}
+    for _, objClass in pairs(registeredTypes) do
+        local name = objClass.name
+        if name and not seen[name] then
+            seen[name] = true
+            modules[#modules+1] = name
+        end
     end
+
+    LuaVM.prewarm(count, modules)
+    return Cache
+end
+
+function Cache.prepare()
+    totalTasks, finishedTasks, failedTasks = taskCount, 0, 0
 end
 
 function Cache.progress()
@@ -181,10 +218,78 @@ function Cache.progress()
 end
 
 function Cache.hasTasks()
-    for i in pairs(loadingTasks) do
-        return true
+    return taskCount > 0
+end
+
+-- Shared memory shows up once decoding is done, which can be after the task finished
+local function sharedMemory(item)
+    if not item.obj.memoryUsage then return 0 end
+
+    local _, _, shared = item.obj:memoryUsage()
+    return shared or 0
+end
+
+local function linkIdle(item)
+    local size = item.memory + item.videoMemory + sharedMemory(item)
+    item.priority = evictionFloor + item.loadTime / math.max(size, 1)
+
+    item.prev, item.next = idleItems.prev, idleItems
+    idleItems.prev.next = item
+    idleItems.prev = item
+end
+
+local function unlinkIdle(item)
+    item.prev.next, item.next.prev = item.next, item.prev
+    item.prev, item.next = nil, nil
+end
+
+local function destroyItem(item)
+    Log.info('Removing from global cache: ' .. item.id)
+
+    items[item.id] = nil
+    usedMemory = usedMemory - item.memory
+
+    -- If object can be released, do that
+    if item.obj.release then item.obj:release() end
+end
+
+-- Shared buffers are counted by their pool, once however many items use them
+local function usedSharedMemory()
+    return (require('audio.source').sampleBankUsage())
+end
+
+local function usedVideoMemory()
+    return require('graphics.texture').usedMemory()
+        + require('graphics.vertexbuffer').usedMemory()
+        + require('graphics.indexbuffer').usedMemory()
+end
+
+-- Releases idle items until memory usage is within budget.
+-- Only items that use the kind of memory that is over budget are evicted.
+local function evict(budget, videoBudget)
+    while true do
+        local overBudget = usedMemory + usedSharedMemory() > budget
+        local overVideoBudget = usedVideoMemory() > videoBudget
+        if not overBudget and not overVideoBudget then break end
+
+        -- Cheapest item to load again, the least recently used one on ties
+        local victim
+        local item = idleItems.next
+        while item ~= idleItems do
+            local freesMemory = item.memory > 0 or sharedMemory(item) > 0
+            if ((overBudget and freesMemory) or (overVideoBudget and item.videoMemory > 0)) and
+                (not victim or item.priority < victim.priority) then
+                victim = item
+            end
+            item = item.next
+        end
+        if not victim then break end
+
+        evictionFloor = victim.priority
+        unlinkIdle(victim)
+        destroyItem(victim)
+        evictions = evictions + 1
     end
-    return false
 end
 
 local function checkTemporary(dep, screen, temporary)
@@ -200,123 +305,147 @@ local function checkTemporary(dep, screen, temporary)
     end
 end
 
-function Cache.iteration()
-    -- Reverse cycle through each loading task.
-    -- Latest tasks are prioritized as they're more likely to be dependencies of earlier tasks.
-    for i = table.maxn(loadingTasks), 1, -1 do
-        local task = loadingTasks[i]
-        if task then
-            -- Cache func
-            local cache = task.screen and task.screen.cache or Cache.get
+local function addDependency(task, dep, temporary)
+    local cache = task.screen and task.screen.cache or Cache.get
+    local obj = cache(task.screen, dep)
 
-            -- Add dependencies
-            if not task.depsAdded then 
-                task.depsAdded = true
+    checkTemporary(dep, task.screen, temporary)
 
-                for dep, temporary in pairs(task.deps) do
-                    cache(task.screen, dep)
+    -- Wait for the dependency if it's still loading
+    local depTask = tasksById[dep]
+    if depTask then
+        graph:depend(task.node, depTask.node)
+    elseif not obj or obj.__wk_status == 'failed' then
+        task.stage:store(0)
+    end
+end
 
-                    checkTemporary(dep, task.screen, temporary)
-                end
+local function finishTask(task, failed)
+    if failed then
+        task.obj.__wk_status = 'failed'
+        graph:fail(task.node)
+        failedTasks = failedTasks + 1
+    else
+        task.obj.__wk_status = 'ready'
+        graph:complete(task.node)
+        Log.info('Loaded: ' .. task.id)
+
+        -- Keep track of the memory used by cached items, and of how long they take to load
+        local item = items[task.id]
+        if item and item.obj == task.obj then
+            item.loadTime = System.time() - task.startTime
+
+            if task.obj.memoryUsage then
+                item.memory, item.videoMemory = task.obj:memoryUsage()
+                usedMemory = usedMemory + item.memory
+                evict(memoryBudget, videoMemoryBudget)
             end
+        end
+    end
 
-            -- Add dependencies that are added during a subTask
-            for dep, temporary in pairs(task.newDeps) do
-                cache(task.screen, dep)
-                if not task.deps[dep] then
-                    task.deps[dep] = temporary
-                    task.newDeps[dep] = nil
+    graph:remove(task.node)
+    loadingTasks[task.node] = nil
+    tasksById[task.id] = nil
+    taskCount = taskCount - 1
+end
 
-                    checkTemporary(dep, task.screen, temporary)
-                end
-            end
+local function advance(task)
+    -- Cache func
+    local cache = task.screen and task.screen.cache or Cache.get
 
-            -- Check how many dependencies have successfully loaded
-            local ready = true
-            for dependency in pairs(task.deps) do
-                local item = cache(task.screen, dependency, true)
-
-                if not item or item.__wk_status == 'failed' then
-                    task.stagePtr[0] = 0
-                    break
-                elseif item.__wk_status ~= 'ready' then
-                    ready = false
-                    break
-                end
-            end
+    -- Add dependencies
+    if not task.depsAdded then
+        task.depsAdded = true
 
-            if task.stagePtr[0] == 0 then
-                -- Failed
-                task.obj.__wk_status = 'failed'
-                loadingTasks[i] = nil
-                failedTasks = failedTasks + 1
-                
-            elseif task.stagePtr[0] ~= task.lastStage and ready then
-                -- If the stage number has changed between last time and now
-                local stage = task.stagePtr[0]
-                task.lastStage = stage
-
-                if stage > #task.tasks then
-                    -- Task is done, remove it from ongoing tasks
-                    task.obj.__wk_status = 'ready'
-                    loadingTasks[i] = nil
-                    Log.info('Loaded: ' .. task.id)
-                else
-                    local subTask = task.tasks[stage]
-                    local params = {}
-                    local depsChanged = false
-
-                    local entries = (stage == 1) and task.params or subTask.entries
-                    if entries then
-                        for i, entry in ipairs(entries) do
-                            if isLoadable(entry) then
-                                params[#params+1] = cache(task.screen, entry, true)
-                            elseif not depsChanged then
-                                params[#params+1] = entry
-                            end
-                        end
-                    else
-                        -- Pop IDs from the vm and repopulate it with instances
-                        subTask.entries = {task.vm:pop(task.vm:top(), true)}
-                        for i, entry in ipairs(subTask.entries) do
-                            if isLoadable(entry) then
-                                depsChanged = true
-                                local temporary = false
-                                if entry:match('^#.') then
-                                    temporary = true
-                                    entry = entry:sub(2)
-                                end
-                                if task.deps[entry] ~= false then
-                                    task.newDeps[entry] = temporary
-                                end
-                            elseif not depsChanged then
-                                params[#params+1] = entry
-                            end
-                        end
-                    end
-
-                    if not depsChanged then
-                        local gpu = subTask.threaded == 'gpu' and not Config.noGpuMultithreading
-                        if subTask.threaded == true or gpu then
-                            Thread:new(
-                                loadFunc, task.stagePtr, task.vm, gpu,
-                                subTask.func, task.obj, task.name, params
-                            ):detach()
-                        else
-                            loadFunc(
-                                task.stagePtr, task.vm, false,
-                                subTask.func, task.obj, task.name, params
-                            )
-                        end
-                    else
-                        task.lastStage = 0
-                    end
+        for dep, temporary in pairs(task.deps) do
+            addDependency(task, dep, temporary)
+        end
+    end
+
+    -- Add dependencies that are added during a subTask
+    for dep, temporary in pairs(task.newDeps) do
+        task.newDeps[dep] = nil
+
+        if task.deps[dep] == nil then
+            task.deps[dep] = temporary
+            addDependency(task, dep, temporary)
+        end
+    end
+
+    local stage = task.stage:load('acquire')
+    if stage == 0 or graph:status(task.node) == 'failed' then
+        return finishTask(task, true)
+    end
+
+    -- The task is polled again once its dependencies are done
+    if graph:await(task.node) then return end
+
+    if stage > #task.tasks then
+        return finishTask(task, false)
+    end
+
+    local subTask = task.tasks[stage]
+    local params = {}
+    local depsChanged = false
+
+    local entries = (stage == 1) and task.params or subTask.entries
+    if entries then
+        for i, entry in ipairs(entries) do
+            if isLoadable(entry) then
+                params[#params+1] = cache(task.screen, entry, true)
+            elseif not depsChanged then
+                params[#params+1] = entry
+            end
+        end
+    else
+        -- Pop IDs from the vm and repopulate it with instances
+        subTask.entries = {task.vm:pop(task.vm:top(), true)}
+        for i, entry in ipairs(subTask.entries) do
+            if isLoadable(entry) then
+                depsChanged = true
+                local temporary = false
+                if entry:match('^#.') then
+                    temporary = true
+                    entry = entry:sub(2)
                 end
+                if task.deps[entry] ~= false then
+                    task.newDeps[entry] = temporary
+                end
+            elseif not depsChanged then
+                params[#params+1] = entry
             end
         end
     end
 
-    local taskCount = table.maxn(loadingTasks)
+    -- Run the stage again once the new dependencies are loaded
+    if depsChanged then
+        return advance(task)
+    end
+
+    local gpu = subTask.threaded == 'gpu' and not Config.noGpuMultithreading
+    if subTask.threaded == true or gpu then
+        Thread:new(
+            loadFunc, task.stage, task.vm, gpu,
+            subTask.func, task.obj, task.name, params, graph, task.node
+        ):detach()
+    else
+        loadFunc(
+            task.stage, task.vm, false,
+            subTask.func, task.obj, task.name, params, graph, task.node
+        )
+    end
+end
+
+function Cache.iteration()
+    -- Only visit tasks that can make progress.
+    -- Polling continues until the queue is empty, so chains of dependencies resolve in one call.
+    for node in graph:poll() do
+        local task = loadingTasks[node]
+        if task then
+            advance(task)
+        end
+    end
+
     if taskCount == 0 then
         -- Remove temporary depndencies
         for screen, deps in pairs(temporaryDeps) do
@@ -343,6 +472,11 @@ end
 function Cache.wait()
     while Cache.hasTasks() do
         Cache.iteration()
+
+        -- Sleep until a worker is done instead of spinning
+        if Cache.hasTasks() then
+            graph:wait()
+        end
     end
 
     return Cache
@@ -357,23 +491,31 @@ function Cache.get(screen, id, peek)
 
     -- If item does not exist, try to load it using loadFunc
     if not item then
-        items[id] = item
+        if not peek then misses = misses + 1 end
+
         local obj, reusable = addLoadingTask(screen, id)
         if reusable then
             Log.info('Adding to global cache: ' .. id)
             item = {
+                id = id,
                 count = 0,
-                obj = obj
+                obj = obj,
+                memory = 0,
+                videoMemory = 0,
+                loadTime = 0
             }
 
             items[id] = item
         else
             return obj, false
         end
+    elseif not peek then
+        hits = hits + 1
     end
 
     -- If requested, increment the load count of the item
     if not peek then
+        if item.prev then unlinkIdle(item) end
         item.count = item.count + 1
     end
 
@@ -388,15 +530,55 @@ function Cache.release(id)
     -- Decrement load count
     item.count = item.count - 1
 
-    -- If load count reaches zero, remove item from list
-    if item.count <= 0 then
-        Log.info('Removing from global cache: ' .. id)
+    -- If load count reaches zero, keep loaded items around in case they're needed again
+    if item.count <= 0 and not item.prev then
+        if item.obj.__wk_status == 'ready' then
+            linkIdle(item)
+            evict(memoryBudget, videoMemoryBudget)
+        else
+            destroyItem(item)
+        end
+    end
+end
 
-        items[id] = nil
+-- Releases idle items until memory usage is within the given budget, or all of them by default
+function Cache.trim(budget, videoBudget)
+    if budget or videoBudget then
+        evict(budget or memoryBudget, videoBudget or videoMemoryBudget)
+    else
+        while idleItems.next ~= idleItems do
+            local item = idleItems.next
+            unlinkIdle(item)
+            destroyItem(item)
+            evictions = evictions + 1
+        end
+    end
+
+    return Cache
+end
+
+function Cache.setBudget(budget, videoBudget)
+    memoryBudget = budget or memoryBudget
+    videoMemoryBudget = videoBudget or videoMemoryBudget
+    evict(memoryBudget, videoMemoryBudget)
 
-        -- If object can be released, do that
-        if item.obj.release then item.obj:release() end
+    return Cache
+end
+
+function Cache.budget()
+    return memoryBudget, videoMemoryBudget
+end
+
+-- Returns hits, misses, evictions, the RAM used by cached items and how many are idle
+function Cache.stats()
+    local idleCount = 0
+    local item = idleItems.next
+    while item ~= idleItems do
+        idleCount = idleCount + 1
+        item = item.next
     end
+
+    return hits, misses, evictions, usedMemory + usedSharedMemory(), idleCount
 end
 
 return Cache
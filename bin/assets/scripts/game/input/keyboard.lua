@@ -26,7 +26,7 @@
 --]]
 
 local Input = require 'game.input'
-local Keyboard = require 'window.keyboard'
+local InputState = require 'window.input'
 local Window = require 'window'
 
 local KeyboardInput = Input:subclass 'game.keyboard.input'
@@ -39,12 +39,12 @@ function KeyboardInput:initialize(keyMap)
 end
 
 function KeyboardInput:setMap(keyMap)
+    -- Only the key bindings are replaced, gamepads drive the same actions
+    InputState.clearBindings('key')
+
     self.keyMap = keyMap
     for key, button in pairs(keyMap) do
-        if button == 'shift' then
-            self.shiftKey = key
-            break
-        end
+        InputState.bind(button, 'key', key)
     end
 
     return self
@@ -59,13 +59,13 @@ end
 function KeyboardInput:handleMoving(button, cb)
     local moved = true
     if button == 'moveup' then
-        self.moveY = Keyboard.down(self.shiftKey) and -1 or -0.5
+        self.moveY = InputState.down('shift') and -1 or -0.5
     elseif button == 'movedown' then
-        self.moveY = Keyboard.down(self.shiftKey) and 1 or 0.5
+        self.moveY = InputState.down('shift') and 1 or 0.5
     elseif button == 'moveleft' then
-        self.moveX = Keyboard.down(self.shiftKey) and -1 or -0.5
+        self.moveX = InputState.down('shift') and -1 or -0.5
     elseif button == 'moveright' then
-        self.moveX = Keyboard.down(self.shiftKey) and 1 or 0.5
+        self.moveX = InputState.down('shift') and 1 or 0.5
     else
         moved = false
     end
@@ -107,10 +107,7 @@ function KeyboardInput:process(cb, e, a, b, c, d)
 end
 
 function KeyboardInput:down(button)
-    for key, btn in ipairs(self.keyMap) do
-        if btn == button and Keyboard.down(key) then return true end
-    end
-    return false
+    return InputState.down(button)
 end
 
 function KeyboardInput:position(stick)
@@ -25,21 +25,91 @@
     For more information, please refer to <http://unlicense.org>
 --]]
 
-local class = require 'class'
+local class      = require 'class'
 local FileSystem = require 'filesystem'
+local Snapshot   = require 'filesystem.snapshot'
 
 local State = class 'state'
 
-function State.static.factory(task, filename)
-    -- TODO
+-- Full saves go to <name>.sav, autosaves are stored as deltas against it in <name>.delta
+local snapshots = {}
+
+local function snapshot(name)
+    local current = snapshots[name]
+    if not current then
+        current = Snapshot:new()
+        snapshots[name] = current
+    end
+
+    return current
+end
+
+function State.static.factory(task, name)
+    -- Game states are plain Lua tables, they have to be loaded in the main VM
+    task:addTask(function(state, name)
+        if not state:load(name) then
+            error('Unable to load game state \'' .. name .. '\'')
+        end
+    end)
 end
 
 function State.static.list()
-    return FileSystem.enumerateFiles('userdata/states/')
+    local names, found = {}, {}
+
+    for i, file in ipairs(FileSystem.enumerateFiles('userdata/states/')) do
+        local name = file:match('^(.+)%.sav$')
+        if name and not found[name] then
+            found[name] = true
+            names[#names+1] = name
+        end
+    end
+
+    return names
 end
 
 function State.static.load(name)
-    -- TODO: load given gamestate
+    local state = State:new()
+    return state:load(name) and state or nil
+end
+
+function State:initialize()
+    self.data = {}
+end
+
+function State:load(name)
+    local states = snapshot(name)
+    states:wait()
+
+    local data = states:load('userdata/states/' .. name .. '.sav')
+    if data == nil then return false end
+
+    -- Autosaves made after the last full save are only valid against it
+    local deltaFile = 'userdata/states/' .. name .. '.delta'
+    if FileSystem.isFile(deltaFile) then
+        data = states:load(deltaFile) or data
+    end
+
+    self.name, self.data = name, data
+    return true
+end
+
+-- Writes a full save, the serialized data is compressed and written in the background
+function State:save(name)
+    name = name or self.name
+    self.name = name
+
+    return snapshot(name):save('states/' .. name .. '.sav', self.data)
+end
+
+-- Only writes what changed since the last full save, falls back to a full save if there's none
+function State:autosave(name)
+    name = name or self.name
+
+    local states = snapshot(name)
+    if not states:hasBase() then return self:save(name) end
+
+    self.name = name
+    return states:save('states/' .. name .. '.delta', self.data, true)
 end
 
 return State
@@ -55,6 +55,9 @@ ffi.cdef [[
     void nxImageFlipVertically(NxImage*);
 ]]
 
+local sizePtr = ffi.new('unsigned int[2]')
+local colorPtr = ffi.new('uint8_t[4]')
+
 local function isCArray(a)
     return type(a) == 'cdata' or type(a) == 'userdata'
 end
@@ -125,11 +128,16 @@ end
 function Image:size()
     if self._cdata == nil then return 0, 0 end
 
-    local sizePtr = ffi.new('unsigned int[2]')
     C.nxImageGetSize(self._cdata, sizePtr)
     return tonumber(sizePtr[0]), tonumber(sizePtr[1])
 end
 
+-- Returns the RAM and VRAM used by the image, in bytes
+function Image:memoryUsage()
+    local width, height = self:size()
+    return width * height * 4, 0
+end
+
 function Image:setColorMask(r, g, b, a, alpha)
     if self._cdata ~= nil then
         C.nxImageColorMask(self._cdata, r or 0, g or 0, b or 0, a or 255, alpha or 0)
@@ -163,7 +171,6 @@ end
 function Image:pixel(x, y)
     if self._cdata == nil then return 0, 0, 0, 0 end
 
-    local colorPtr = ffi.new('uint8_t[4]')
     C.nxImageGetPixel(self._cdata, x, y, colorPtr)
 
     return tonumber(colorPtr[0]),
@@ -49,6 +49,8 @@ ffi.cdef [[
     void nxRenderBufferBind(const NxRenderBuffer*);
 ]]
 
+local sizePtr = ffi.new('uint16_t[2]')
+
 function RenderBuffer.static.bind(buffer)
     C.nxRenderBufferBind(buffer and buffer._cdata)
 
@@ -105,7 +107,6 @@ function RenderBuffer:texture(bufIndex)
 end
 
 function RenderBuffer:size()
-    local sizePtr = ffi.new('uint16_t[2]')
     C.nxRenderBufferSize(self._cdata, sizePtr)
 
     return tonumber(sizePtr[0]), tonumber(sizePtr[1])
@@ -28,7 +28,7 @@
 local Entity2D     = require 'graphics.entity2d'
 local VertexBuffer = require 'graphics.vertexbuffer'
 local Text         = require 'graphics.text'
-local Arabic       = require 'util.arabic'
+local Unicode      = require 'util.unicode'
 
 local RtlText = Text:subclass('graphics.rtltext')
 -- RtlText:include(Entity2D)
@@ -38,6 +38,7 @@ local C = ffi.C
 
 ffi.cdef [[
     NxText* nxRtlTextNew();
+    void nxTextSetArabicString(NxText*, const char*);
 ]]
 
 function RtlText:initialize(str, font, charSize)
@@ -50,11 +51,25 @@ function RtlText:initialize(str, font, charSize)
         :setSize(charSize or 30)
         
     self._style = 0
+    self._alignment = 'right'
     self._vertices = VertexBuffer:allocate()
 end
 
 function RtlText:setString(str, isArabic)
-    return Text.setString(self, isArabic and Arabic(str) or str)
+    if not isArabic then
+        -- Don't let the shaped string pass for the original one
+        if self._isArabic then self._string, self._isArabic = nil, false end
+        return Text.setString(self, str)
+    end
+
+    -- Shaped natively, string() keeps returning the unshaped text
+    if type(str) ~= 'string' then str = Unicode.utf32To8(str) end
+    if self._isArabic and self._string == str then return self end
+
+    self._string, self._u32string, self._isArabic = str, nil, true
+    C.nxTextSetArabicString(self._cdata, str)
+
+    return self
 end
 
 return RtlText
\ No newline at end of file
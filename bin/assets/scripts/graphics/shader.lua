@@ -51,6 +51,8 @@ ffi.cdef [[
     const char* nxShaderDefaultFSCode();
 ]]
 
+local uniformBuffer = ffi.new('float[4]')
+
 function Shader.static.factory(task)
     task:addTask(true, function(shader, filename)
             local shaders = loadfile(filename)
@@ -151,18 +153,11 @@ function Shader:setUniform(name, a, b, c, d)
             if class.Object.isInstanceOf(a, Matrix) then
                 uniformType = 4
                 uniformData = a:data()
-            elseif not b then
-                uniformType = 0
-                uniformData = ffi.new('float[1]', {a})
-            elseif not c then
-                uniformType = 1
-                uniformData = ffi.new('float[2]', {a, b})
-            elseif not d then
-                uniformType = 2
-                uniformData = ffi.new('float[3]', {a, b, c})
             else
-                uniformType = 3
-                uniformData = ffi.new('float[4]', {a, b, c, d})
+                uniformType = not b and 0 or not c and 1 or not d and 2 or 3
+                uniformData = uniformBuffer
+                uniformData[0], uniformData[1], uniformData[2], uniformData[3] =
+                    a, b or 0, c or 0, d or 0
             end
 
             C.nxShaderSetUniform(self._cdata, uniform, uniformType, uniformData)
@@ -29,6 +29,7 @@ local Graphics     = require 'graphics'
 local VertexBuffer = require 'graphics.vertexbuffer'
 local Texture2D    = require 'graphics.texture2d'
 local Entity2D     = require 'graphics.entity2d'
+local Arena        = require 'system.arena'
 
 local Sprite = Entity2D:subclass 'graphics.sprite'
 
@@ -144,17 +145,17 @@ function Sprite:_render(camera)
             subB = temp
         end
 
-        local buffer = ffi.new('float[16]', {
-            0, 0, subL, subT,
-            0, h, subL, subB,
-            w, 0, subR, subT,
-            w, h, subR, subB
-        })
+        -- Uploaded right away, the vertices don't need to outlive this call
+        local buffer, i = Arena.scratch('float', 16)
+        buffer[i],      buffer[i + 1],  buffer[i + 2],  buffer[i + 3]  = 0, 0, subL, subT
+        buffer[i + 4],  buffer[i + 5],  buffer[i + 6],  buffer[i + 7]  = 0, h, subL, subB
+        buffer[i + 8],  buffer[i + 9],  buffer[i + 10], buffer[i + 11] = w, 0, subR, subT
+        buffer[i + 12], buffer[i + 13], buffer[i + 14], buffer[i + 15] = w, h, subR, subB
 
         if not self._vertexBuffer then
-            self._vertexBuffer = VertexBuffer:new(buffer, ffi.sizeof(buffer), 16)
+            self._vertexBuffer = VertexBuffer:new(buffer + i, 16 * ffi.sizeof('float'), 16)
         else
-            self._vertexBuffer:update(buffer)
+            self._vertexBuffer:update(buffer + i)
         end
 
         self._bufferUpdated = true
@@ -28,8 +28,10 @@
 local Unicode      = require 'util.unicode'
 local Graphics     = require 'graphics'
 local VertexBuffer = require 'graphics.vertexbuffer'
+local IndexBuffer  = require 'graphics.indexbuffer'
 local Texture      = require 'graphics.texture'
 local Entity2D     = require 'graphics.entity2d'
+local Arena        = require 'system.arena'
 
 local Text = Entity2D:subclass 'graphics.text'
 
@@ -46,12 +48,24 @@ ffi.cdef [[
     void nxTextSetFont(NxText*, const void*);
     void nxTextSetCharacterSize(NxText*, uint32_t);
     void nxTextSetStyle(NxText*, uint8_t);
+    void nxTextSetMaxWidth(NxText*, float);
+    void nxTextSetAlignment(NxText*, uint8_t);
     void nxTextCharacterPosition(const NxText*, uint32_t, float*);
+    uint32_t nxTextCharacterAt(const NxText*, float, float);
+    uint32_t nxTextLineCount(const NxText*);
+    void nxTextLineMetrics(const NxText*, uint32_t, uint32_t*, float*);
     void nxTextBounds(const NxText*, float*);
     NxVertexBuffer* nxTextNextBuffer(const NxText*, uint32_t*);
+    NxIndexBuffer* nxTextQuadIndexBuffer();
 ]]
 
-local indexPtr = ffi.new('uint32_t[1]')
+-- Quads that can be drawn with the shared 16-bit index buffer in one call
+local maxQuadsPerDraw = 16384
+local quadSize = 64
+
+local infoPtr = ffi.new('uint32_t[2]')
+local rangePtr = ffi.new('uint32_t[2]')
+local metricsPtr = ffi.new('float[5]')
 local vertexHelper = VertexBuffer:allocate()
 
 local toStyle = {
@@ -62,6 +76,12 @@ local toStyle = {
     strikethrough = 8
 }
 
+local toAlignment = {
+    left   = 0,
+    center = 1,
+    right  = 2
+}
+
 function Text.static._defaultShader()
     return Graphics.defaultShader(1)
 end
@@ -106,8 +126,9 @@ function Text:setString(str, arg, ...)
         self._u32string = str
         self._string = nil
 
-        local strPtr = ffi.new('uint32_t[?]', #str, str)
-        C.nxTextSetU32String(self._cdata, strPtr)
+        local strPtr, first = Arena.scratch('uint32_t', #str)
+        for i = 1, #str do strPtr[first + i - 1] = str[i] end
+        C.nxTextSetU32String(self._cdata, strPtr + first)
     end
 
     return self
@@ -146,6 +167,20 @@ function Text:setStyle(style1, style2, ...)
     return self
 end
 
+function Text:setMaxWidth(maxWidth)
+    self._maxWidth = maxWidth
+    C.nxTextSetMaxWidth(self._cdata, maxWidth or 0)
+
+    return self
+end
+
+function Text:setAlignment(alignment)
+    self._alignment = alignment
+    C.nxTextSetAlignment(self._cdata, toAlignment[alignment] or 0)
+
+    return self
+end
+
 function Text:string(u32)
     if not self._string and not self._u32string then return '' end
 
@@ -174,22 +209,45 @@ function Text:style()
     return unpack(self._style)
 end
 
+function Text:maxWidth()
+    return self._maxWidth
+end
+
+function Text:alignment()
+    return self._alignment or 'left'
+end
+
 function Text:characterPosition(index)
-    local posPtr = ffi.new('float[2]')
-    C.nxTextCharacterPosition(self._cdata, index, posPtr)
+    C.nxTextCharacterPosition(self._cdata, index, metricsPtr)
+
+    return metricsPtr[0], metricsPtr[1]
+end
+
+function Text:characterAt(x, y)
+    return C.nxTextCharacterAt(self._cdata, x, y)
+end
 
-    return posPtr[0], posPtr[1]
+function Text:lineCount()
+    return C.nxTextLineCount(self._cdata)
+end
+
+function Text:lineMetrics(line)
+    C.nxTextLineMetrics(self._cdata, line - 1, rangePtr, metricsPtr)
+
+    -- x, y, width, height, baseline, first character and character count
+    return metricsPtr[0], metricsPtr[1], metricsPtr[2], metricsPtr[3], metricsPtr[4],
+        rangePtr[0], rangePtr[1]
 end
 
 function Text:bounds(transformed, absolute)
-    local ptr = ffi.new('float[4]')
-    C.nxTextBounds(self._cdata, ptr)
+    C.nxTextBounds(self._cdata, metricsPtr)
+    local x, y, w, h = metricsPtr[0], metricsPtr[1], metricsPtr[2], metricsPtr[3]
 
     if not transformed then
-        return ptr[0], ptr[1], ptr[2], ptr[3]
+        return x, y, w, h
     else
-        local x1, y1 = self:matrix(absolute):apply(ptr[0], ptr[1], 0)
-        local x2, y2 = self:matrix(absolute):apply(ptr[0]+ptr[2], ptr[1]+ptr[3], 0)
+        local x1, y1 = self:matrix(absolute):apply(x, y, 0)
+        local x2, y2 = self:matrix(absolute):apply(x+w, y+h, 0)
 
         x1, y1, x2, y2 = math.min(x1, x2), math.min(y1, y2), math.max(x1, x2), math.max(y1, y2)
         return x1, y1, x2-x1, y2-y1
@@ -206,21 +264,30 @@ function Text:_render(camera)
         shader:setUniform('uColor', self:color(true, true))
         shader:setSampler('uTexture0', 0)
 
+        C.nxIndexBufferBind(C.nxTextQuadIndexBuffer())
+
         repeat
-            vertexHelper._cdata = C.nxTextNextBuffer(self._cdata, indexPtr)
+            vertexHelper._cdata = C.nxTextNextBuffer(self._cdata, infoPtr)
             if vertexHelper._cdata == nil then break end
 
-            vertexHelper:bind()
-            C.nxRendererSetVertexLayout(Text._vertexLayout())
-            
-            local texture = self._font:texture(self._charSize, indexPtr[0])
+            local texture = self._font:texture(self._charSize, infoPtr[0])
             texture:bind()
 
             shader:setUniform('uTexSize', texture:size())
 
-            C.nxRendererDraw(4, 0, vertexHelper:count())
+            -- Buffers have spare capacity, only draw the quads that are in use
+            local quadCount = infoPtr[1]
+            for first = 0, quadCount - 1, maxQuadsPerDraw do
+                vertexHelper:bind(0, first * quadSize)
+                C.nxRendererSetVertexLayout(Text._vertexLayout())
+
+                local count = math.min(quadCount - first, maxQuadsPerDraw)
+                C.nxRendererDrawIndexed(4, 0, count * 6)
+            end
         until false
 
+        IndexBuffer.bind(nil)
+
     end
 end
 
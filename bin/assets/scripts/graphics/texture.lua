@@ -50,6 +50,7 @@ ffi.cdef [[
     bool nxTextureData(const NxTexture*, void*, uint8_t, uint8_t);
     void nxTextureSize(const NxTexture*, uint16_t*);
     uint32_t nxTextureBufferSize(const NxTexture*);
+    uint32_t nxTextureMemorySize(const NxTexture*);
     void nxTextureSetFilter(NxTexture*, uint32_t);
     void nxTextureSetAnisotropyLevel(NxTexture*, uint32_t);
     void nxTextureSetRepeating(NxTexture*, uint32_t);
@@ -65,6 +66,8 @@ ffi.cdef [[
     void nxTextureBind(const NxTexture*, uint8_t);
 ]]
 
+local sizePtr = ffi.new('uint16_t[2]')
+
 local toTextureType = {
     ['2d'] = 0,
     ['cube'] = 1
@@ -239,10 +242,16 @@ function Texture:data(slice, level)
     end
 end
 
+-- Returns the RAM and VRAM used by the texture, in bytes
+function Texture:memoryUsage()
+    if self.__wk_status == 'failed' or self._cdata == nil then return 0, 0 end
+
+    return 0, C.nxTextureMemorySize(self._cdata)
+end
+
 function Texture:size()
     if self.__wk_status == 'failed' then return 0, 0 end
     
-    local sizePtr = ffi.new('uint16_t[2]')
     C.nxTextureSize(self._cdata, sizePtr)
     return sizePtr[0], sizePtr[1]
 end
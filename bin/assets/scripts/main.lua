@@ -27,7 +27,8 @@
 
 local Log = require 'util.log'
 
-local noFpsLimit
+local noFpsLimit, recordName, replayName, replayStep
+local startScreen, frameCount, hiddenWindow = 'screen.title', nil, false
 
 -- Handle application arguments
 for i, v in ipairs(arg) do
@@ -36,17 +37,32 @@ for i, v in ipairs(arg) do
         return 0
     elseif v == '--nolimit' then
         noFpsLimit = true
+    elseif v == '--record' then
+        recordName = arg[i + 1]
+    elseif v == '--replay' then
+        replayName = arg[i + 1]
+    elseif v == '--timestep' then
+        replayStep = tonumber(arg[i + 1])
+    elseif v == '--screen' then
+        startScreen = arg[i + 1]
+    elseif v == '--frames' then
+        frameCount = tonumber(arg[i + 1])
+    elseif v == '--hidden' then
+        hiddenWindow = true
     end
 end
 
 local System   = require 'system'
 local LuaVM    = require 'system.luavm'
 local Events   = require 'window.events'
+local Input    = require 'window.input'
+local Async    = require 'system.async'
 local Graphics = require 'graphics'
 local Window   = require 'window'
 local Audio    = require 'audio'
 local Screen   = require 'screen'
 local Config   = require 'config'
+local Cache    = require 'game.cache'
 
 -- Load settings (in VM sandbox)
 local vm = LuaVM:new()
@@ -57,7 +73,7 @@ local argsCount = vm:pcall(function()
 local settings, err = vm:pop(argsCount, true)
 
 -- Create window
-Window.create("m2n", 1280, 720, {vsync = true})
+Window.create("m2n", 1280, 720, {vsync = not noFpsLimit, hidden = hiddenWindow})
 
 -- Initialize renderer
 Graphics.init()
@@ -72,13 +88,21 @@ if not Audio.init() then
 end
 
 -- Handling FPS
-local totalTime, fixedFrameTime = 0, 1/30
+local fixedFrameTime = 1/30
+Window.setFixedTimestep(fixedFrameTime)
 if not noFpsLimit then
     Window.setFramerateLimit(System.platform('android', 'ios') and 1/30 or 1/60)
 end
 
+-- Input recording and replay, for reproducible runs
+if replayName then
+    Events.replay(replayName, replayStep)
+elseif recordName then
+    Events.record(recordName)
+end
+
 -- Register some types
-require('game.cache')
+Cache
     .registerType('image', 'graphics.image')
     .registerType('vectorfont', 'graphics.vectorfont')
     .registerType('fontstack', 'graphics.fontstack')
@@ -91,6 +115,7 @@ require('game.cache')
     .registerType('model', 'graphics.modeldesc')
     .registerType('scene', 'graphics.scenedesc')
     .registerType('state', 'game.state')
+    .prewarm(Config.luaVMPoolSize)
 
 -- Register default input
 require('game.input').register('game.input.keyboard', {
@@ -107,12 +132,34 @@ require('game.input').register('game.input.keyboard', {
     e = 'accept',
     tab = 'back',
     q = 'auxilary',
-    shift = 'shift',
+    ['left shift'] = 'shift',
+    ['right shift'] = 'shift',
     ['return'] = 'accept'
 })
 
+-- Gamepads drive the same actions, resolved natively along with the keys
+Input.bind('up', 'button', 'up')
+Input.bind('down', 'button', 'down')
+Input.bind('left', 'button', 'left')
+Input.bind('right', 'button', 'right')
+Input.bind('up', 'axis', 'lefty', -1)
+Input.bind('down', 'axis', 'lefty', 1)
+Input.bind('left', 'axis', 'leftx', -1)
+Input.bind('right', 'axis', 'leftx', 1)
+Input.bind('accept', 'button', 'a')
+Input.bind('back', 'button', 'b')
+Input.bind('auxilary', 'button', 'x')
+Input.bind('pause', 'button', 'start')
+
 -- Startup screen
-Screen.goTo('screen.title', true)
+Screen.goTo(startScreen, true)
+
+-- Startup is warm when scripts come from the bytecode cache of a previous run
+local cacheStats = LuaVM.cacheStats()
+Log.info(('Startup took %.1fms: %d scripts compiled, %d loaded from cache, '
+    .. '%.2fms per new Lua VM, %.1fus per acquired Lua VM'):format(System.time() * 1000,
+        cacheStats.compiles, cacheStats.diskHits + cacheStats.memoryHits,
+        cacheStats.vmCreationTime * 1000, cacheStats.vmAcquireTime * 1000000))
 
 -- Main loop
 while Window.isOpen() do
@@ -124,6 +171,9 @@ while Window.isOpen() do
             Window.close()
             break
         else
+            -- Let go of everything that isn't in use
+            if e == 'lowmemory' then Cache.trim() end
+
             screen:__onEvent(e, a, b, c, d)
             if screen ~= Screen.currentScreen() then goto continue end
         end
@@ -132,15 +182,22 @@ while Window.isOpen() do
     -- Check that the window is still open
     if not Window.isOpen() then break end
 
+    -- One input snapshot per frame, taken once all of its events went through
+    Input.update()
+
+    -- Resume the tasks whose futures completed since the last frame
+    Async.update()
+
     screen:__update(Window.frameTime())
     if screen ~= Screen.currentScreen() then goto continue end
 
-    totalTime = totalTime + Window.frameTime()
-    for i = 1, totalTime / fixedFrameTime do
+    for i = 1, Window.fixedSteps() do
         screen:__fixedUpdate(fixedFrameTime)
         if screen ~= Screen.currentScreen() then goto continue end
     end
-    totalTime = totalTime % fixedFrameTime
+
+    -- Give the most audible emitters their voices, using this frame's positions
+    Audio.update(Window.frameTime())
 
     Graphics.begin()
     screen:__render()
@@ -148,10 +205,18 @@ while Window.isOpen() do
 
     Window.display()
 
+    -- With --frames, quit after rendering that many frames past loading screens
+    -- The window stays open, the benchmark suite runs the game again in it
+    if frameCount and screen.class.name ~= 'screen._load' then
+        frameCount = frameCount - 1
+        if frameCount <= 0 then break end
+    end
+
     ::continue::
     if screen ~= Screen.currentScreen() then
         Window.resetFrameTime()
     end
 end
 
+Events.stopLog()
 Audio.release()
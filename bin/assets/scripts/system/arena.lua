@@ -0,0 +1,75 @@
+--[[
+    This is free and unencumbered software released into the public domain.
+
+    Anyone is free to copy, modify, publish, use, compile, sell, or
+    distribute this software, either in source code form or as a compiled
+    binary, for any purpose, commercial or non-commercial, and by any
+    means.
+
+    In jurisdictions that recognize copyright laws, the author or authors
+    of this software dedicate any and all copyright interest in the
+    software to the public domain. We make this dedication for the benefit
+    of the public at large and to the detriment of our heirs and
+    successors. We intend this dedication to be an overt act of
+    relinquishment in perpetuity of all present and future rights to this
+    software under copyright law.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+    MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+    IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+    OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+    ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+    OTHER DEALINGS IN THE SOFTWARE.
+
+    For more information, please refer to <http://unlicense.org>
+--]]
+
+local Arena = {}
+
+local ffi = require 'ffi'
+local C = ffi.C
+
+ffi.cdef [[
+    uint8_t* nxArenaBase();
+    uint32_t nxArenaAllocate(size_t, size_t);
+]]
+
+-- The arenas hand out offsets into a single block, a pointer to it is made once per element
+-- type and allocations are indices from it, so that nothing gets boxed on every call
+local base = C.nxArenaBase()
+local invalid = 0xFFFFFFFF
+
+-- Pointer to the block, array type and size, by element type
+local types = {}
+
+local function typeInfo(ctype)
+    local info = types[ctype]
+    if not info then
+        local element = ffi.typeof(ctype)
+        info = {
+            ffi.cast(ffi.typeof('$*', element), base),
+            ffi.typeof('$[?]', element),
+            ffi.sizeof(element)
+        }
+        types[ctype] = info
+    end
+
+    return info
+end
+
+-- Memory for n elements of ctype that the garbage collector never sees, it isn't zeroed
+-- Returns a pointer and the index of the first element, ptr + index is what C functions take
+-- On the main thread it stays valid until the end of the next frame,
+-- on other threads it's only fit for temporaries used right away
+function Arena.scratch(ctype, n)
+    n = n or 1
+    local info = typeInfo(ctype)
+
+    local offset = C.nxArenaAllocate(info[3] * n, info[3])
+    if offset == invalid then return ffi.new(info[2], n), 0 end
+
+    return info[1], offset / info[3]
+end
+
+return Arena
@@ -0,0 +1,133 @@
+--[[
+    This is free and unencumbered software released into the public domain.
+
+    Anyone is free to copy, modify, publish, use, compile, sell, or
+    distribute this software, either in source code form or as a compiled
+    binary, for any purpose, commercial or non-commercial, and by any
+    means.
+
+    In jurisdictions that recognize copyright laws, the author or authors
+    of this software dedicate any and all copyright interest in the
+    software to the public domain. We make this dedication for the benefit
+    of the public at large and to the detriment of our heirs and
+    successors. We intend this dedication to be an overt act of
+    relinquishment in perpetuity of all present and future rights to this
+    software under copyright law.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+    MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+    IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+    OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+    ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+    OTHER DEALINGS IN THE SOFTWARE.
+
+    For more information, please refer to <http://unlicense.org>
+--]]
+
+local Log    = require 'util.log'
+local Future = require 'system.future'
+local Thread = require 'system.thread'
+
+local ffi = require 'ffi'
+
+local Async = {}
+
+-- Coroutines started with Async.spawn, and the ones waiting on each future id
+local tasks   = setmetatable({}, {__mode = 'k'})
+local waiting = {}
+
+local idsBuffer = ffi.new('uint32_t[64]')
+
+local function resume(co, ...)
+    local ok, err = coroutine.resume(co, ...)
+    if not ok then
+        Log.error('Async task failed: ' .. debug.traceback(co, tostring(err)))
+    end
+end
+
+local function finishTask(id, gpu, ok, ...)
+    -- Make the uploaded data visible to the other contexts before resuming anyone
+    if gpu then require('graphics').sync() end
+
+    if ok then
+        require('system.future').complete(id, ...)
+    else
+        require('system.future').fail(id, ...)
+    end
+end
+
+local function runTask(id, gpu, func, ...)
+    if gpu then require('window').ensureContext() end
+
+    finishTask(id, gpu, pcall(func, ...))
+end
+
+-- Runs func as a coroutine that can await futures
+function Async.spawn(func, ...)
+    local co = coroutine.create(func)
+    tasks[co] = true
+    resume(co, ...)
+
+    return co
+end
+
+-- Suspends the current task until the future is done, blocks when not called from a task
+function Async.await(future)
+    if not future:isDone() then
+        local co = coroutine.running()
+        if co and tasks[co] then
+            local id = future:id()
+            waiting[id] = waiting[id] or {}
+            table.insert(waiting[id], {co, future})
+            coroutine.yield()
+        else
+            future:wait()
+        end
+    end
+
+    return future:result()
+end
+
+-- func runs on a separate thread, with no upvalues, its return values are copied back
+function Async.run(func, ...)
+    local future = Future:new()
+    Thread:new(runTask, future:id(), false, func, ...):detach()
+
+    return future
+end
+
+-- Same as Async.run, but with a graphics context, the future is done once the GPU is
+function Async.upload(func, ...)
+    local future = Future:new()
+    Thread:new(runTask, future:id(), true, func, ...):detach()
+
+    return future
+end
+
+function Async.readFile(filename)
+    return Future.readFile(filename)
+end
+
+function Async.decodeImage(filename)
+    return Future.decodeImage(filename)
+end
+
+-- Resumes the tasks whose futures are done, called once per frame
+function Async.update()
+    local ready = {}
+    repeat
+        local count = Future.poll(idsBuffer, 64)
+        for i = 0, count - 1 do
+            local list = waiting[idsBuffer[i]]
+            if list then
+                waiting[idsBuffer[i]] = nil
+                for _, entry in ipairs(list) do table.insert(ready, entry[1]) end
+            end
+        end
+    until count < 64
+
+    for _, co in ipairs(ready) do resume(co) end
+end
+
+return Async
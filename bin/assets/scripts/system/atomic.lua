@@ -0,0 +1,106 @@
+--[[
+    This is free and unencumbered software released into the public domain.
+
+    Anyone is free to copy, modify, publish, use, compile, sell, or
+    distribute this software, either in source code form or as a compiled
+    binary, for any purpose, commercial or non-commercial, and by any
+    means.
+
+    In jurisdictions that recognize copyright laws, the author or authors
+    of this software dedicate any and all copyright interest in the
+    software to the public domain. We make this dedication for the benefit
+    of the public at large and to the detriment of our heirs and
+    successors. We intend this dedication to be an overt act of
+    relinquishment in perpetuity of all present and future rights to this
+    software under copyright law.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+    MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+    IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+    OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+    ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+    OTHER DEALINGS IN THE SOFTWARE.
+
+    For more information, please refer to <http://unlicense.org>
+--]]
+
+local class = require 'class'
+
+local Atomic = class 'system.atomic'
+
+local ffi = require 'ffi'
+local C = ffi.C
+
+ffi.cdef [[
+    typedef struct NxAtomic NxAtomic;
+
+    NxAtomic* nxAtomicCreate(int64_t);
+    void nxAtomicRelease(NxAtomic*);
+    int64_t nxAtomicLoad(const NxAtomic*, int);
+    void nxAtomicStore(NxAtomic*, int64_t, int);
+    int64_t nxAtomicExchange(NxAtomic*, int64_t, int);
+    int64_t nxAtomicAdd(NxAtomic*, int64_t, int);
+    bool nxAtomicCompareExchange(NxAtomic*, int64_t*, int64_t, int);
+]]
+
+-- Memory orders, sequentially consistent unless specified
+local orders = {
+    relaxed = 0,
+    acquire = 1,
+    release = 2,
+    acq_rel = 3,
+    seq_cst = 4
+}
+
+local expectedPtr = ffi.new('int64_t[1]')
+
+function Atomic:initialize(value)
+    self._cdata = ffi.gc(C.nxAtomicCreate(value or 0), C.nxAtomicRelease)
+end
+
+function Atomic:release()
+    if self._cdata == nil then return end
+
+    C.nxAtomicRelease(ffi.gc(self._cdata, nil))
+    self._cdata = nil
+end
+
+function Atomic:load(order)
+    if self._cdata == nil then return 0 end
+
+    return tonumber(C.nxAtomicLoad(self._cdata, orders[order or 'seq_cst']))
+end
+
+function Atomic:store(value, order)
+    if self._cdata ~= nil then C.nxAtomicStore(self._cdata, value, orders[order or 'seq_cst']) end
+
+    return self
+end
+
+-- Returns the previous value
+function Atomic:exchange(value, order)
+    if self._cdata == nil then return 0 end
+
+    return tonumber(C.nxAtomicExchange(self._cdata, value, orders[order or 'seq_cst']))
+end
+
+-- Returns the previous value
+function Atomic:add(value, order)
+    if self._cdata == nil then return 0 end
+
+    return tonumber(C.nxAtomicAdd(self._cdata, value or 1, orders[order or 'seq_cst']))
+end
+
+-- Returns whether the value was replaced, along with the value it had
+function Atomic:compareExchange(expected, desired, order)
+    if self._cdata == nil then return false, 0 end
+
+    expectedPtr[0] = expected
+    local ok = C.nxAtomicCompareExchange(self._cdata, expectedPtr, desired,
+        orders[order or 'seq_cst'])
+
+    return ok, tonumber(expectedPtr[0])
+end
+
+return Atomic
@@ -0,0 +1,117 @@
+--[[
+    This is free and unencumbered software released into the public domain.
+
+    Anyone is free to copy, modify, publish, use, compile, sell, or
+    distribute this software, either in source code form or as a compiled
+    binary, for any purpose, commercial or non-commercial, and by any
+    means.
+
+    In jurisdictions that recognize copyright laws, the author or authors
+    of this software dedicate any and all copyright interest in the
+    software to the public domain. We make this dedication for the benefit
+    of the public at large and to the detriment of our heirs and
+    successors. We intend this dedication to be an overt act of
+    relinquishment in perpetuity of all present and future rights to this
+    software under copyright law.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+    MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+    IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+    OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+    ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+    OTHER DEALINGS IN THE SOFTWARE.
+
+    For more information, please refer to <http://unlicense.org>
+--]]
+
+local class    = require 'class'
+local Snapshot = require 'filesystem.snapshot'
+
+local Channel = class 'system.channel'
+
+local ffi = require 'ffi'
+local C = ffi.C
+
+ffi.cdef [[
+    typedef struct NxChannel NxChannel;
+
+    NxChannel* nxChannelCreate(size_t);
+    void nxChannelRelease(NxChannel*);
+    bool nxChannelSend(NxChannel*, const void*, size_t, double);
+    const uint8_t* nxChannelReceive(NxChannel*, size_t*, double);
+    size_t nxChannelSize(const NxChannel*);
+    size_t nxChannelCapacity(const NxChannel*);
+]]
+
+local sizePtr = ffi.new('size_t[1]')
+
+-- Channels can be passed to other threads, only the creating thread's instance owns it
+function Channel:initialize(capacity)
+    self._cdata = ffi.gc(C.nxChannelCreate(capacity or 64), C.nxChannelRelease)
+end
+
+function Channel:release()
+    if self._cdata == nil then return end
+
+    C.nxChannelRelease(ffi.gc(self._cdata, nil))
+    self._cdata = nil
+end
+
+-- Values are copied, the same way snapshots are serialized
+-- A nil timeout waits for room forever, returns false if it expired
+function Channel:send(value, timeout)
+    if self._cdata == nil then return false end
+
+    local data, size = Snapshot.encode(value)
+    return C.nxChannelSend(self._cdata, data, size, timeout or -1)
+end
+
+function Channel:trySend(value)
+    return self:send(value, 0)
+end
+
+-- Returns the value and true, or nil and false if the timeout expired
+function Channel:receive(timeout)
+    if self._cdata == nil then return nil, false end
+
+    local data = C.nxChannelReceive(self._cdata, sizePtr, timeout or -1)
+    if data == nil then return nil, false end
+
+    return Snapshot.decode(data, tonumber(sizePtr[0])), true
+end
+
+function Channel:tryReceive()
+    return self:receive(0)
+end
+
+-- Raw bytes, without going through serialization
+function Channel:sendData(data, size, timeout)
+    if self._cdata == nil then return false end
+
+    return C.nxChannelSend(self._cdata, data, size or ffi.sizeof(data), timeout or -1)
+end
+
+-- Copies the received bytes into dst if given, returns the data and its size
+function Channel:receiveData(timeout, dst)
+    if self._cdata == nil then return nil, 0 end
+
+    local data = C.nxChannelReceive(self._cdata, sizePtr, timeout or -1)
+    if data == nil then return nil, 0 end
+
+    local size = tonumber(sizePtr[0])
+    dst = dst or ffi.new('uint8_t[?]', size)
+    ffi.copy(dst, data, size)
+
+    return dst, size
+end
+
+function Channel:size()
+    return self._cdata ~= nil and tonumber(C.nxChannelSize(self._cdata)) or 0
+end
+
+function Channel:capacity()
+    return self._cdata ~= nil and tonumber(C.nxChannelCapacity(self._cdata)) or 0
+end
+
+return Channel
@@ -0,0 +1,137 @@
+--[[
+    This is free and unencumbered software released into the public domain.
+
+    Anyone is free to copy, modify, publish, use, compile, sell, or
+    distribute this software, either in source code form or as a compiled
+    binary, for any purpose, commercial or non-commercial, and by any
+    means.
+
+    In jurisdictions that recognize copyright laws, the author or authors
+    of this software dedicate any and all copyright interest in the
+    software to the public domain. We make this dedication for the benefit
+    of the public at large and to the detriment of our heirs and
+    successors. We intend this dedication to be an overt act of
+    relinquishment in perpetuity of all present and future rights to this
+    software under copyright law.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+    MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+    IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+    OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+    ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+    OTHER DEALINGS IN THE SOFTWARE.
+
+    For more information, please refer to <http://unlicense.org>
+--]]
+
+local class    = require 'class'
+local Snapshot = require 'filesystem.snapshot'
+
+local Future = class 'system.future'
+
+local ffi = require 'ffi'
+local C = ffi.C
+
+ffi.cdef [[
+    typedef struct NxImage NxImage;
+
+    uint32_t nxSchedulerCreate();
+    void nxSchedulerComplete(uint32_t, const void*, size_t);
+    void nxSchedulerFail(uint32_t, const char*);
+    size_t nxSchedulerPoll(uint32_t*, size_t);
+    uint32_t nxSchedulerWait(uint32_t, double);
+    uint32_t nxSchedulerStatus(uint32_t);
+    const uint8_t* nxSchedulerData(uint32_t, size_t*);
+    const char* nxSchedulerError(uint32_t);
+    NxImage* nxSchedulerTakeImage(uint32_t);
+    void nxSchedulerRelease(uint32_t);
+    uint32_t nxSchedulerReadFile(const char*);
+    uint32_t nxSchedulerDecodeImage(const char*);
+    void nxImageRelease(NxImage*);
+]]
+
+local statuses = {[0] = 'pending', 'done', 'failed', 'invalid'}
+
+local sizePtr = ffi.new('size_t[1]')
+
+local function releaseHandle(handle)
+    C.nxSchedulerRelease(handle[0])
+end
+
+-- Other threads only get the id, to complete the future with Future.complete()
+function Future.static.complete(id, ...)
+    local data, size = Snapshot.encode({n = select('#', ...), ...})
+    C.nxSchedulerComplete(id, data, size)
+end
+
+function Future.static.fail(id, err)
+    C.nxSchedulerFail(id, tostring(err))
+end
+
+-- Fills a buffer with the ids of the futures that finished since the last call
+function Future.static.poll(ids, maxCount)
+    return tonumber(C.nxSchedulerPoll(ids, maxCount))
+end
+
+function Future.static.readFile(filename)
+    return Future:new(C.nxSchedulerReadFile(filename), 'file')
+end
+
+function Future.static.decodeImage(filename)
+    return Future:new(C.nxSchedulerDecodeImage(filename), 'image')
+end
+
+-- kind is either 'value', 'file' or 'image', and tells how to convert the result
+function Future:initialize(id, kind)
+    self._id      = id or C.nxSchedulerCreate()
+    self._kind    = kind or 'value'
+    self._handle  = ffi.gc(ffi.new('uint32_t[1]', self._id), releaseHandle)
+end
+
+function Future:id()
+    return self._id
+end
+
+function Future:status()
+    return statuses[C.nxSchedulerStatus(self._id)]
+end
+
+function Future:isDone()
+    return C.nxSchedulerStatus(self._id) ~= 0
+end
+
+-- Blocks the calling thread, a nil timeout waits forever
+function Future:wait(timeout)
+    return statuses[C.nxSchedulerWait(self._id, timeout or -1)]
+end
+
+-- Returns the result values, or nil and the error message if it failed
+function Future:result()
+    if self._values then return unpack(self._values, 1, self._values.n) end
+
+    local status = self:status()
+    if status == 'pending' then
+        return nil, 'Future is still pending'
+    elseif status ~= 'done' then
+        return nil, status == 'failed' and ffi.string(C.nxSchedulerError(self._id)) or 'Invalid future'
+    end
+
+    if self._kind == 'image' then
+        local image = require('graphics.image'):allocate()
+        image._cdata  = ffi.gc(C.nxSchedulerTakeImage(self._id), C.nxImageRelease)
+        image.__valid = true
+        self._values  = {n = 1, image}
+    else
+        local data = C.nxSchedulerData(self._id, sizePtr)
+        if self._kind == 'file' then
+            self._values = {n = 1, ffi.string(data, sizePtr[0])}
+        else
+            self._values = Snapshot.decode(data, sizePtr[0])
+        end
+    end
+
+    return unpack(self._values, 1, self._values.n)
+end
+
+return Future
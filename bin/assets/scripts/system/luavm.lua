@@ -36,11 +36,21 @@ local C = ffi.C
 ffi.cdef [[
     typedef struct lua_State lua_State;
 
-    bool nxLuaLoadNxLibs(lua_State*);
+    typedef struct {
+        uint32_t memoryHits;
+        uint32_t diskHits;
+        uint32_t compiles;
+        uint32_t vmCount;
+        uint32_t vmAcquires;
+        double vmCreationTime;
+        double vmAcquireTime;
+    } NxLuaCacheStats;
+
+    lua_State* nxLuaVMAcquire();
+    void nxLuaVMRelease(lua_State*);
+    void nxLuaVMPrewarm(size_t, const char**, size_t);
     void* nxLuaToCdata(lua_State*, int);
-
-    lua_State* luaL_newstate();
-    void lua_close(lua_State*);
+    void nxLuaCacheStats(NxLuaCacheStats*);
 
     int lua_gettop(lua_State*);
     void lua_settop(lua_State*, int);
@@ -267,17 +277,40 @@ retrievers = {
     ['function'] = funcRetriever
 }
 
+-- Bytecode cache hits and compiles so far, along with the cost of creating VMs
+function LuaVM.static.cacheStats()
+    local stats = ffi.new('NxLuaCacheStats')
+    C.nxLuaCacheStats(stats)
+
+    return {
+        memoryHits = stats.memoryHits,
+        diskHits = stats.diskHits,
+        compiles = stats.compiles,
+        vmCount = stats.vmCount,
+        vmCreationTime = stats.vmCount > 0 and stats.vmCreationTime / stats.vmCount or 0,
+        vmAcquireTime = stats.vmAcquires > 0 and stats.vmAcquireTime / stats.vmAcquires or 0
+    }
+end
+
+-- Creates up to count VMs in the background, each one requiring the given modules
+-- New VMs are taken from this pool, and go back to it once released
+function LuaVM.static.prewarm(count, modules)
+    modules = modules or {}
+
+    local names = ffi.new('const char*[?]', #modules)
+    for i, name in ipairs(modules) do
+        names[i-1] = name
+    end
+
+    C.nxLuaVMPrewarm(count, names, #modules)
+end
+
 function LuaVM:initialize()
-    local handle = C.luaL_newstate()
+    local handle = C.nxLuaVMAcquire()
     if handle == nil then
         Log.warning('Cannot create new Lua VM')
     else
-        if C.nxLuaLoadNxLibs(handle) then
-            self._cdata = ffi.gc(handle, C.lua_close)
-        else
-            Log.warning('Unable to load NxLibs into new Lua VM')
-            C.lua_close(handle)
-        end
+        self._cdata = ffi.gc(handle, C.nxLuaVMRelease)
 
         -- Empty the stack
         self:setTop(0)
@@ -287,7 +320,7 @@ end
 function LuaVM:release()
     if self._cdata == nil then return end
 
-    C.lua_close(ffi.gc(self._cdata, nil))
+    C.nxLuaVMRelease(ffi.gc(self._cdata, nil))
     self._cdata = nil
 end
 
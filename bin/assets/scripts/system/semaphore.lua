@@ -0,0 +1,75 @@
+--[[
+    This is free and unencumbered software released into the public domain.
+
+    Anyone is free to copy, modify, publish, use, compile, sell, or
+    distribute this software, either in source code form or as a compiled
+    binary, for any purpose, commercial or non-commercial, and by any
+    means.
+
+    In jurisdictions that recognize copyright laws, the author or authors
+    of this software dedicate any and all copyright interest in the
+    software to the public domain. We make this dedication for the benefit
+    of the public at large and to the detriment of our heirs and
+    successors. We intend this dedication to be an overt act of
+    relinquishment in perpetuity of all present and future rights to this
+    software under copyright law.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+    MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+    IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+    OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+    ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+    OTHER DEALINGS IN THE SOFTWARE.
+
+    For more information, please refer to <http://unlicense.org>
+--]]
+
+local class = require 'class'
+
+local Semaphore = class 'system.semaphore'
+
+local ffi = require 'ffi'
+local C = ffi.C
+
+ffi.cdef [[
+    typedef struct NxSemaphore NxSemaphore;
+
+    NxSemaphore* nxSemaphoreCreate(int);
+    void nxSemaphoreRelease(NxSemaphore*);
+    void nxSemaphoreSignal(NxSemaphore*, int);
+    bool nxSemaphoreWait(NxSemaphore*, double);
+    int nxSemaphoreCount(const NxSemaphore*);
+]]
+
+function Semaphore:initialize(count)
+    self._cdata = ffi.gc(C.nxSemaphoreCreate(count or 0), C.nxSemaphoreRelease)
+end
+
+function Semaphore:release()
+    if self._cdata == nil then return end
+
+    C.nxSemaphoreRelease(ffi.gc(self._cdata, nil))
+    self._cdata = nil
+end
+
+function Semaphore:signal(count)
+    if self._cdata ~= nil then C.nxSemaphoreSignal(self._cdata, count or 1) end
+
+    return self
+end
+
+-- A nil timeout waits forever, returns false if it expired
+function Semaphore:wait(timeout)
+    return self._cdata ~= nil and C.nxSemaphoreWait(self._cdata, timeout or -1)
+end
+
+function Semaphore:tryWait()
+    return self:wait(0)
+end
+
+function Semaphore:count()
+    return self._cdata ~= nil and C.nxSemaphoreCount(self._cdata) or 0
+end
+
+return Semaphore
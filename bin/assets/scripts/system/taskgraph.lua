@@ -0,0 +1,126 @@
+--[[
+    This is free and unencumbered software released into the public domain.
+
+    Anyone is free to copy, modify, publish, use, compile, sell, or
+    distribute this software, either in source code form or as a compiled
+    binary, for any purpose, commercial or non-commercial, and by any
+    means.
+
+    In jurisdictions that recognize copyright laws, the author or authors
+    of this software dedicate any and all copyright interest in the
+    software to the public domain. We make this dedication for the benefit
+    of the public at large and to the detriment of our heirs and
+    successors. We intend this dedication to be an overt act of
+    relinquishment in perpetuity of all present and future rights to this
+    software under copyright law.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+    MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+    IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+    OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+    ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+    OTHER DEALINGS IN THE SOFTWARE.
+
+    For more information, please refer to <http://unlicense.org>
+--]]
+
+local class = require 'class'
+
+local TaskGraph = class 'system.taskgraph'
+
+local ffi = require 'ffi'
+local C = ffi.C
+
+ffi.cdef [[
+    typedef struct NxTaskGraph NxTaskGraph;
+
+    NxTaskGraph* nxTaskGraphCreate();
+    void nxTaskGraphRelease(NxTaskGraph*);
+    uint32_t nxTaskGraphAdd(NxTaskGraph*);
+    void nxTaskGraphRemove(NxTaskGraph*, uint32_t);
+    void nxTaskGraphDepend(NxTaskGraph*, uint32_t, uint32_t);
+    bool nxTaskGraphAwait(NxTaskGraph*, uint32_t);
+    void nxTaskGraphSignal(NxTaskGraph*, uint32_t);
+    void nxTaskGraphComplete(NxTaskGraph*, uint32_t);
+    void nxTaskGraphFail(NxTaskGraph*, uint32_t);
+    uint32_t nxTaskGraphStatus(const NxTaskGraph*, uint32_t);
+    uint32_t nxTaskGraphPoll(NxTaskGraph*, uint32_t*, uint32_t);
+    bool nxTaskGraphWait(NxTaskGraph*, uint32_t);
+]]
+
+local statuses = {[0] = 'pending', 'done', 'failed', 'invalid'}
+
+local pollSize = 64
+local pollBuffer = ffi.new('uint32_t[?]', pollSize)
+
+function TaskGraph:initialize()
+    self._cdata = ffi.gc(C.nxTaskGraphCreate(), C.nxTaskGraphRelease)
+end
+
+function TaskGraph:release()
+    if self._cdata == nil then return end
+    C.nxTaskGraphRelease(ffi.gc(self._cdata, nil))
+    self._cdata = nil
+end
+
+function TaskGraph:add()
+    return C.nxTaskGraphAdd(self._cdata)
+end
+
+function TaskGraph:remove(node)
+    C.nxTaskGraphRemove(self._cdata, node)
+    return self
+end
+
+function TaskGraph:depend(node, dependency)
+    C.nxTaskGraphDepend(self._cdata, node, dependency)
+    return self
+end
+
+-- Returns true if the node is still waiting for dependencies, it will be polled once they're done
+function TaskGraph:await(node)
+    return C.nxTaskGraphAwait(self._cdata, node)
+end
+
+-- Thread-safe, polls the node once its dependencies are done
+function TaskGraph:signal(node)
+    C.nxTaskGraphSignal(self._cdata, node)
+    return self
+end
+
+function TaskGraph:complete(node)
+    C.nxTaskGraphComplete(self._cdata, node)
+    return self
+end
+
+function TaskGraph:fail(node)
+    C.nxTaskGraphFail(self._cdata, node)
+    return self
+end
+
+function TaskGraph:status(node)
+    return statuses[C.nxTaskGraphStatus(self._cdata, node)]
+end
+
+-- Iterates over the nodes that became runnable or failed since the last call
+function TaskGraph:poll()
+    local count, index = 0, 0
+
+    return function()
+        if index == count then
+            count, index = C.nxTaskGraphPoll(self._cdata, pollBuffer, pollSize), 0
+            if count == 0 then return end
+        end
+
+        index = index + 1
+        return pollBuffer[index - 1]
+    end
+end
+
+-- Blocks until a node can be polled, or the timeout (in seconds) is reached
+function TaskGraph:wait(timeout)
+    return C.nxTaskGraphWait(self._cdata, (timeout or 1) * 1000)
+end
+
+return TaskGraph
@@ -37,6 +37,8 @@ ffi.cdef [[
     void nxLogInfo(const char* message);
     void nxLogError(const char* message);
     void nxLogFatal(const char* message);
+    bool nxLogFlush(double maxWait);
+    uint64_t nxLogDroppedMessages();
 ]]
 
 function Log.verbose(message, arg, ...)
@@ -63,4 +65,13 @@ function Log.fatal(message, arg, ...)
     C.nxLogFatal(arg and tostring(message):format(arg, ...) or message)
 end
 
+-- Waits at most maxWait seconds for queued messages to be written to the log file
+function Log.flush(maxWait)
+    return C.nxLogFlush(maxWait or 0.2)
+end
+
+function Log.droppedMessages()
+    return tonumber(C.nxLogDroppedMessages())
+end
+
 return Log
\ No newline at end of file
@@ -25,6 +25,8 @@
     For more information, please refer to <http://unlicense.org>
 --]]
 
+local Arena = require 'system.arena'
+
 local Unicode = {}
 
 local ffi = require 'ffi'
@@ -35,8 +37,9 @@ ffi.cdef [[
     const char* nxUnicodeUtf32To8(const uint32_t*, uint32_t*);
 ]]
 
+local sizePtr = ffi.new('uint32_t[1]')
+
 function Unicode.utf8To32(str)
-    local sizePtr = ffi.new('uint32_t[1]')
     local strPtr = C.nxUnicodeUtf8To32(str, sizePtr)
 
     local utf32 = {}
@@ -51,11 +54,11 @@ function Unicode.utf32To8(str)
     -- Make sure the string ends with a 0
     if str[#str] ~= 0 then str[#str + 1] = 0 end
 
-    -- Convert it to table
-    str = ffi.new('uint32_t[?]', #str, str)
+    -- Copy it to C memory
+    local u32Ptr, first = Arena.scratch('uint32_t', #str)
+    for i = 1, #str do u32Ptr[first + i - 1] = str[i] end
 
-    local sizePtr = ffi.new('uint32_t[1]')
-    local strPtr = C.nxUnicodeUtf32To8(str, sizePtr)
+    local strPtr = C.nxUnicodeUtf32To8(u32Ptr + first, sizePtr)
     return ffi.string(strPtr, sizePtr[0])
 end
 
@@ -73,20 +73,30 @@ ffi.cdef [[
     } NxEventType;
 
     typedef struct {
+        NxEventType type;
         double a, b, c, d;
         const char* t;
     } NxEvent;
 
     NxEventType nxEventWait(NxEvent*);
     NxEventType nxEventPoll(NxEvent*);
+    size_t nxEventPollBatch(NxEvent*, size_t, bool);
+    bool nxEventStartRecording(const char*);
+    bool nxEventStartReplay(const char*, double);
+    void nxEventStopLog();
+    int nxEventLogMode();
 ]]
 
-local function nextEvent(func)
-    local evType, evPtr = nil, ffi.new('NxEvent[1]')
-    repeat
-        evType = func(evPtr)
-    until evType ~= C.NX_Other
-    e = evPtr[0]
+-- Events are drained from the system in batches, and handed out one by one
+local BatchSize = 256
+local batch = ffi.new('NxEvent[?]', BatchSize)
+local batchIndex, batchCount = 0, 0
+local coalesceMotion = false
+
+local waitPtr = ffi.new('NxEvent[1]')
+
+local function translate(e)
+    local evType = e.type
 
     if evType == C.NX_NoEvent then
         return nil
@@ -100,6 +110,8 @@ local function nextEvent(func)
     elseif evType == C.NX_Focus then
         Window.__focus((e.a == 1.0))
         return 'focus', e.a == 1
+    elseif evType == C.NX_LowMemory then
+        return 'lowmemory'
     elseif evType == C.NX_MouseFocus then
         Window.__mouseFocus((e.a == 1.0))
         return 'mousefocus', (e.a == 1.0)
@@ -158,16 +170,68 @@ local function nextEvent(func)
     end
 end
 
+local function nextBatched()
+    if batchIndex >= batchCount then
+        batchIndex, batchCount = 0, tonumber(C.nxEventPollBatch(batch, BatchSize, coalesceMotion))
+        if batchCount == 0 then return nil end
+    end
+
+    local e = batch[batchIndex]
+    batchIndex = batchIndex + 1
+    return translate(e)
+end
+
 function Events.wait()
     return function(t, i)
-        return nextEvent(C.nxEventWait)
+        -- Hand out what's left of the last batch first
+        if batchIndex < batchCount then return nextBatched() end
+
+        repeat
+            C.nxEventWait(waitPtr)
+        until waitPtr[0].type ~= C.NX_Other
+
+        return translate(waitPtr[0])
     end
 end
 
 function Events.poll()
     return function(t, i)
-        return nextEvent(C.nxEventPoll)
+        return nextBatched()
     end
 end
 
+-- Merge consecutive motion events of the same source (mouse, axis, finger) into one
+function Events.setMotionCoalescing(enabled)
+    coalesceMotion = not not enabled
+
+    return Events
+end
+
+-- Records every event and frame time to /userdata/replays/<name>.nxr until stopLog()
+function Events.record(name)
+    return C.nxEventStartRecording(name)
+end
+
+-- Feeds a recording back in place of live events, the frame times come from it too
+-- unless a fixed step is given. The replay ends with a quit event
+function Events.replay(name, step)
+    batchIndex, batchCount = 0, 0
+    return C.nxEventStartReplay(name, step or 0)
+end
+
+-- Ends the recording, or writes the replay's frame timings to /userdata/replays/<name>.csv
+function Events.stopLog()
+    C.nxEventStopLog()
+
+    return Events
+end
+
+function Events.isRecording()
+    return C.nxEventLogMode() == 1
+end
+
+function Events.isReplaying()
+    return C.nxEventLogMode() == 2
+end
+
 return Events
\ No newline at end of file
@@ -25,8 +25,7 @@
     For more information, please refer to <http://unlicense.org>
 --]]
 
-local System = require 'system'
-local Image  = require 'graphics.image'
+local Image = require 'graphics.image'
 
 local Window = {}
 
@@ -38,9 +37,18 @@ ffi.cdef [[
 
     NxWindow* nxWindowGet();
     bool nxWindowCreate(const char*, int, int, int, int, bool, bool, bool, int, int, bool, int, int,
-        int, int, int);
+        int, int, int, bool);
     void nxWindowClose();
     void nxWindowDisplay();
+    void nxWindowRestartClock();
+    void nxWindowResetFrameTime();
+    void nxWindowSetFramerateLimit(double);
+    double nxWindowFrameTime();
+    double nxWindowCurrentFPS();
+    void nxWindowSetFixedTimestep(double, uint32_t);
+    uint32_t nxWindowFixedSteps();
+    double nxWindowFixedAlpha();
+    void nxWindowFrameStats(double*);
     void nxWindowGetFlags(int*);
     void nxWindowEnsureContext();
     bool nxWindowGetDesktopSize(int, int*);
@@ -64,6 +72,10 @@ ffi.cdef [[
     void nxWindowSetIcon(unsigned int, unsigned int, const uint8_t*);
 ]]
 
+-- Output buffers, read right after the calls that fill them
+local pairPtr = ffi.new('int[2]')
+local statsPtr = ffi.new('double[3]')
+
 local MsgBoxType = {
     ['error']   = 16,
     ['warning'] = 32,
@@ -93,15 +105,12 @@ local windowWidth, windowHeight
 local drawableWidth, drawableHeight
 local hasFocus, hasMouseFocus
 
-local lastTime
-local totalElapsedTime, frameCount, currentFPS, elapsedTime = 0, 0, 0, 0
 local originalFramerateLimit, framerateLimit = 0, 0
 
 local function drawableSize()
-    local sizePtr = ffi.new('int[2]')
-    C.nxWindowGetDrawableSize(sizePtr)
+    C.nxWindowGetDrawableSize(pairPtr)
 
-    return tonumber(sizePtr[0]), tonumber(sizePtr[1])
+    return tonumber(pairPtr[0]), tonumber(pairPtr[1])
 end
 
 local function checkFlags(flags)
@@ -121,6 +130,7 @@ local function checkFlags(flags)
     if flags.y == nil              then flags.y = 'undefined' end
     if flags.depthbits == nil      then flags.depthbits = 24 end
     if flags.stencilbits == nil    then flags.stencilbits = 8 end
+    if flags.hidden == nil         then flags.hidden = false end
 
     -- Windowed mode and fullscreen don't mix up well
     if not flags.fullscreen then flags.vsync = false end
@@ -151,7 +161,8 @@ function Window.create(title, width, height, flags)
         posX,
         posY,
         flags.depthbits,
-        flags.stencilbits
+        flags.stencilbits,
+        flags.hidden
     )
 
     if window == nil then
@@ -162,8 +173,9 @@ function Window.create(title, width, height, flags)
     drawableWidth, drawableHeight = drawableSize()
     hasFocus, hasMouseFocus       = true, true
 
-    framerateLimit   = flags.vsync and 0 or originalFramerateLimit
-    lastTime         = System.time()
+    framerateLimit = flags.vsync and 0 or originalFramerateLimit
+    C.nxWindowSetFramerateLimit(framerateLimit)
+    C.nxWindowRestartClock()
 
     -- Initial mouse focus is impossible with SDL < 2.0.4 (need to get global position)
     -- local Mouse = require 'window.mouse'
@@ -181,32 +193,18 @@ function Window.isOpen()
 end
 
 function Window.resetFrameTime()
-    elapsedTime = 0
+    C.nxWindowResetFrameTime()
 end
 
+-- Swaps buffers, then waits out the left time of the frame
 function Window.display()
     C.nxWindowDisplay()
-
-    -- Calculating FPS every whole second
-    totalElapsedTime = totalElapsedTime + elapsedTime
-    frameCount       = frameCount + 1
-    if totalElapsedTime > 1 then
-        currentFPS = frameCount / totalElapsedTime
-        totalElapsedTime = totalElapsedTime % 1
-        frameCount = 0
-    end
-
-    -- Waiting out left time of the frame
-    System.sleep(framerateLimit == 0 and 0 or lastTime - System.time() + framerateLimit)
-
-    local currTime = System.time()
-    elapsedTime = currTime - lastTime
-    lastTime = currTime
 end
 
 function Window.setFramerateLimit(limit)
     framerateLimit = limit or 0
     originalFramerateLimit = framerateLimit
+    C.nxWindowSetFramerateLimit(framerateLimit)
 
     return Window
 end
@@ -216,11 +214,35 @@ function Window.framerateLimit()
 end
 
 function Window.currentFPS()
-    return math.floor(currentFPS + .5)
+    return math.floor(C.nxWindowCurrentFPS() + .5)
 end
 
 function Window.frameTime()
-    return elapsedTime
+    return C.nxWindowFrameTime()
+end
+
+-- maxSteps caps the number of fixed updates per frame, 0 for no limit
+function Window.setFixedTimestep(step, maxSteps)
+    C.nxWindowSetFixedTimestep(step or 0, maxSteps or 5)
+
+    return Window
+end
+
+-- Returns how many fixed updates are due this frame, should be called once per frame
+function Window.fixedSteps()
+    return C.nxWindowFixedSteps()
+end
+
+-- How far we are between the last fixed update and the next one, in the [0, 1) range
+function Window.fixedAlpha()
+    return C.nxWindowFixedAlpha()
+end
+
+-- Returns the mean, 99th percentile and max frame times over the last 256 frames
+function Window.frameStats()
+    C.nxWindowFrameStats(statsPtr)
+
+    return statsPtr[0], statsPtr[1], statsPtr[2]
 end
 
 function Window.flags()
@@ -260,9 +282,8 @@ function Window.size(drawableSize)
 end
 
 function Window.position()
-    local posPtr = ffi.new('int[2]')
-    C.nxWindowGetPosition(posPtr)
-    return tonumber(posPtr[0]), tonumber(posPtr[1])
+    C.nxWindowGetPosition(pairPtr)
+    return tonumber(pairPtr[0]), tonumber(pairPtr[1])
 end
 
 function Window.title()
@@ -0,0 +1,221 @@
+--[[
+    This is free and unencumbered software released into the public domain.
+
+    Anyone is free to copy, modify, publish, use, compile, sell, or
+    distribute this software, either in source code form or as a compiled
+    binary, for any purpose, commercial or non-commercial, and by any
+    means.
+
+    In jurisdictions that recognize copyright laws, the author or authors
+    of this software dedicate any and all copyright interest in the
+    software to the public domain. We make this dedication for the benefit
+    of the public at large and to the detriment of our heirs and
+    successors. We intend this dedication to be an overt act of
+    relinquishment in perpetuity of all present and future rights to this
+    software under copyright law.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+    MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+    IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+    OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+    ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+    OTHER DEALINGS IN THE SOFTWARE.
+
+    For more information, please refer to <http://unlicense.org>
+--]]
+
+local Log      = require 'util.log'
+local Keyboard = require 'window.keyboard'
+local Mouse    = require 'window.mouse'
+local Gamepad  = require 'window.gamepad'
+
+-- Native input snapshot, refreshed once per frame
+-- Actions are bound by name and resolved natively in one pass over all the bindings
+local Input = {}
+
+local ffi = require 'ffi'
+local bit = require 'bit'
+local C = ffi.C
+
+ffi.cdef [[
+    typedef struct {
+        int32_t id;
+        uint32_t buttons;
+        float axes[6];
+    } NxInputGamepad;
+
+    typedef struct {
+        uint32_t keys[16];
+        float mouseX, mouseY;
+        float mouseDX, mouseDY;
+        float wheelX, wheelY;
+        uint32_t mouseButtons;
+
+        uint32_t gamepadCount;
+        NxInputGamepad gamepads[4];
+
+        uint32_t actionsDown;
+        uint32_t actionsPressed;
+        uint32_t actionsReleased;
+        float actionValues[32];
+    } NxInputState;
+
+    const NxInputState* nxInputUpdate();
+    const NxInputState* nxInputState();
+    void nxInputBind(uint32_t, uint32_t, uint32_t, float, float);
+    void nxInputClearBindings();
+    void nxInputClearBindingsOfType(uint32_t);
+    void nxInputSetDeadzones(float, float);
+]]
+
+local MaxActions = 32
+
+local bindingTypes = {
+    key = 0,
+    mouse = 1,
+    button = 2,
+    axis = 3
+}
+
+local scancodes = {}
+for i, v in pairs(Keyboard._sc) do
+    scancodes[v] = i
+end
+
+local actions, actionCount = {}, 0
+local state = C.nxInputState()
+
+local function actionIndex(action)
+    local index = actions[action]
+    if not index then
+        if actionCount >= MaxActions then return nil end
+
+        index, actionCount = actionCount, actionCount + 1
+        actions[action] = index
+    end
+
+    return index
+end
+
+local function actionBit(action, bits)
+    local index = actions[action]
+    return index ~= nil and bit.band(bits, bit.lshift(1, index)) ~= 0
+end
+
+local function findGamepad(id)
+    for i = 0, state.gamepadCount - 1 do
+        if state.gamepads[i].id == id then return state.gamepads[i] end
+    end
+end
+
+-- Takes a new snapshot, call once per frame after the events were handled
+function Input.update()
+    state = C.nxInputUpdate()
+end
+
+-- Binds a key (scancode name), mouse button, gamepad button or gamepad axis to an action
+-- Axes need a direction (1 or -1) and trigger the action past the threshold (0.5 by default)
+function Input.bind(action, type, name, direction, threshold)
+    local code
+    if type == 'key' then
+        code = scancodes[name]
+    elseif type == 'mouse' then
+        code = Mouse._btn[name]
+    elseif type == 'button' then
+        code = Gamepad._buttons[name]
+    elseif type == 'axis' then
+        code = Gamepad._axes[name]
+    end
+
+    local index = actionIndex(action)
+    if not code or code == 0 or not index then
+        Log.warning(('Could not bind %s to %s "%s"'):format(action, type, tostring(name)))
+        return false
+    end
+
+    C.nxInputBind(index, bindingTypes[type], code, direction or 1, threshold or 0.5)
+    return true
+end
+
+-- Clears every binding, or only those of a type, action names stay then
+function Input.clearBindings(type)
+    if type then
+        if bindingTypes[type] then C.nxInputClearBindingsOfType(bindingTypes[type]) end
+        return
+    end
+
+    C.nxInputClearBindings()
+    actions, actionCount = {}, 0
+end
+
+function Input.setDeadzones(stick, trigger)
+    C.nxInputSetDeadzones(stick, trigger)
+end
+
+function Input.down(action)
+    return actionBit(action, state.actionsDown)
+end
+
+function Input.pressed(action)
+    return actionBit(action, state.actionsPressed)
+end
+
+function Input.released(action)
+    return actionBit(action, state.actionsReleased)
+end
+
+function Input.value(action)
+    local index = actions[action]
+    return index and tonumber(state.actionValues[index]) or 0
+end
+
+function Input.keyDown(key)
+    local scancode = scancodes[key]
+    if not scancode then return false end
+
+    return bit.band(state.keys[bit.rshift(scancode, 5)], bit.lshift(1, bit.band(scancode, 31))) ~= 0
+end
+
+function Input.mouseButtonDown(button)
+    local index = Mouse._btn[button]
+    return index ~= nil and bit.band(state.mouseButtons, bit.lshift(1, index - 1)) ~= 0
+end
+
+function Input.mousePosition()
+    return tonumber(state.mouseX), tonumber(state.mouseY)
+end
+
+function Input.mouseDelta()
+    return tonumber(state.mouseDX), tonumber(state.mouseDY)
+end
+
+function Input.wheel()
+    return tonumber(state.wheelX), tonumber(state.wheelY)
+end
+
+-- Gamepads are identified by the ids their events carry
+function Input.gamepads()
+    local ids = {}
+    for i = 0, state.gamepadCount - 1 do
+        ids[#ids + 1] = tonumber(state.gamepads[i].id)
+    end
+
+    return ids
+end
+
+function Input.gamepadButtonDown(id, button)
+    local gamepad, index = findGamepad(id), Gamepad._buttons[button]
+    if not gamepad or not index or index == 0 then return false end
+
+    return bit.band(gamepad.buttons, bit.lshift(1, index - 1)) ~= 0
+end
+
+function Input.gamepadAxis(id, axis)
+    local gamepad, index = findGamepad(id), Gamepad._axes[axis]
+    if not gamepad or not index or index == 0 then return 0 end
+
+    return tonumber(gamepad.axes[index - 1])
+end
+
+return Input
@@ -43,6 +43,8 @@ ffi.cdef [[
     bool nxMouseIsGrabbed();
 ]]
 
+local posPtr = ffi.new('int[2]')
+
 local fromCursor = {
     [-1] = 'default',
     [0] = 'arrow',
@@ -114,7 +116,6 @@ function Mouse.setPosition(x, y)
 end
 
 function Mouse.position()
-    local posPtr = ffi.new('int[2]')
     C.nxMouseGetPosition(posPtr, false)
 
     return tonumber(posPtr[0]), tonumber(posPtr[1])
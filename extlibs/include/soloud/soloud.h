@@ -40,6 +40,9 @@ freely, subject to the following restrictions:
 #if defined(__x86_64__) || defined( _M_X64 ) || defined( __i386 ) || defined( _M_IX86 )
 #define SOLOUD_SSE_INTRINSICS
 #endif
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define SOLOUD_NEON_INTRINSICS
+#endif
 #endif
 
 #define SOLOUD_VERSION 110
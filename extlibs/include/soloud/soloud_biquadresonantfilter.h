@@ -47,7 +47,7 @@ namespace SoLoud
 		};
 
 		int mActive;
-		BQRStateData mState[2];
+		BQRStateData mState[MAX_CHANNELS];
 		float mA0, mA1, mA2, mB1, mB2;
 		int mDirty;
 		int mFilterType;
@@ -55,7 +55,7 @@ namespace SoLoud
 		BiquadResonantFilter *mParent;
 		void calcBQRParams();
 	public:
-		virtual void filterChannel(float *aBuffer, unsigned int aSamples, float aSamplerate, time aTime, unsigned int aChannel, unsigned int aChannels);
+		virtual void filter(float *aBuffer, unsigned int aSamples, unsigned int aChannels, float aSamplerate, time aTime);
 		virtual ~BiquadResonantFilterInstance();
 		BiquadResonantFilterInstance(BiquadResonantFilter *aParent);
 	};
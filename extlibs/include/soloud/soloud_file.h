@@ -44,6 +44,8 @@ namespace SoLoud
 		virtual unsigned int length() = 0;
 		virtual void seek(int aOffset) = 0;
 		virtual unsigned int pos() = 0;
+		// Whether the next aBytes can be read without blocking, files read ahead elsewhere may lag behind
+		virtual int ready(unsigned int aBytes) { (void)aBytes; return 1; }
 		virtual FILE * getFilePtr() { return 0; }
 		virtual unsigned char * getMemPtr() { return 0; }
 	};
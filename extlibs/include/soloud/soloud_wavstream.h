@@ -45,6 +45,7 @@ namespace SoLoud
 		unsigned int mOggFrameSize;
 		unsigned int mOggFrameOffset;
 		float **mOggOutputs;
+		unsigned int bytesNeeded(unsigned int aSamples);
 	public:
 		WavStreamInstance(WavStream *aParent);
 		virtual void getAudio(float *aBuffer, unsigned int aSamples);
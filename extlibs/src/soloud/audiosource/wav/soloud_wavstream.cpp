@@ -183,6 +183,16 @@ namespace SoLoud
 		if (mFile == NULL)
 			return;
 
+		// Streams read ahead in the background can run dry, play silence until they catch up
+		// rather than waiting on the disk while the mixer holds the engine's lock
+		if (!mFile->ready(bytesNeeded(aSamples)))
+		{
+			unsigned int i;
+			for (i = 0; i < channels; i++)
+				memset(aBuffer + i * aSamples, 0, sizeof(float) * aSamples);
+			return;
+		}
+
 		if (mOgg)
 		{
 			unsigned int offset = 0;			
@@ -203,6 +213,19 @@ namespace SoLoud
 				mOffset += b;
 				offset += b;
 				mOggFrameOffset += b;
+				if (b == 0 && mOffset < mParent->mSampleCount)
+				{
+					// The decoder ran out of data early, pad with silence instead of spinning
+					// unless the file really ended before the expected sample count
+					if (!mFile->eof())
+					{
+						unsigned int i;
+						for (i = 0; i < channels; i++)
+							memset(aBuffer + offset + i * aSamples, 0, sizeof(float) * (aSamples - offset));
+						break;
+					}
+					mOffset = mParent->mSampleCount;
+				}
 				if (mOffset >= mParent->mSampleCount)
 				{
 					if (mFlags & AudioSourceInstance::LOOPING)
@@ -256,6 +279,21 @@ namespace SoLoud
 		}
 	}
 
+	unsigned int WavStreamInstance::bytesNeeded(unsigned int aSamples)
+	{
+		if (!mOgg)
+			return aSamples * mParent->mChannels * (mParent->mBits / 8);
+
+		// What is left of the decoded frame may be enough, otherwise allow for a page
+		// on top of the file's average rate, packets are not all the same size
+		if ((mOggFrameOffset < mOggFrameSize && mOggFrameSize - mOggFrameOffset >= aSamples) ||
+			mParent->mSampleCount == 0)
+			return 0;
+
+		double bytesPerSample = mFile->length() / (double)mParent->mSampleCount;
+		return (unsigned int)(bytesPerSample * aSamples * 2) + 16384;
+	}
+
 	result WavStreamInstance::rewind()
 	{
 		if (mOgg)
@@ -31,6 +31,7 @@ Phil Burk, Game Programming Gems 3, p. 606
 #include <string.h>
 #include "soloud.h"
 #include "soloud_biquadresonantfilter.h"
+#include "soloud_filter_simd.h"
 
 namespace SoLoud
 {
@@ -79,7 +80,7 @@ namespace SoLoud
 	BiquadResonantFilterInstance::BiquadResonantFilterInstance(BiquadResonantFilter *aParent)
 	{
 		int i;
-		for (i = 0; i < 2; i++)
+		for (i = 0; i < MAX_CHANNELS; i++)
 		{
 			mState[i].mX1 = 0;
 			mState[i].mY1 = 0;
@@ -100,51 +101,147 @@ namespace SoLoud
 		calcBQRParams();
 	}
 
-	void BiquadResonantFilterInstance::filterChannel(float *aBuffer, unsigned int aSamples, float aSamplerate, double aTime, unsigned int aChannel, unsigned int aChannels)
+	// Filter state of four channels, one per lane
+	struct BQRLanes
+	{
+		float4 mX1, mX2, mY1, mY2;
+		float4 mA0, mA1, mA2, mB1, mB2;
+		float4 mDelta[5];
+		float4 mWet;
+		bool mRamp;
+	};
+
+	static inline float4 bqrStep(BQRLanes &l, float4 x)
+	{
+		if (l.mRamp)
+		{
+			l.mA0 = f4Add(l.mA0, l.mDelta[0]);
+			l.mA1 = f4Add(l.mA1, l.mDelta[1]);
+			l.mA2 = f4Add(l.mA2, l.mDelta[2]);
+			l.mB1 = f4Add(l.mB1, l.mDelta[3]);
+			l.mB2 = f4Add(l.mB2, l.mDelta[4]);
+		}
+
+		float4 y = f4Add(f4Add(f4Mul(l.mA0, x), f4Mul(l.mA1, l.mX1)), f4Mul(l.mA2, l.mX2));
+		y = f4Sub(f4Sub(y, f4Mul(l.mB1, l.mY1)), f4Mul(l.mB2, l.mY2));
+
+		l.mX2 = l.mX1;
+		l.mX1 = x;
+		l.mY2 = l.mY1;
+		l.mY1 = y;
+
+		return f4Add(x, f4Mul(f4Sub(y, x), l.mWet));
+	}
+
+	void BiquadResonantFilterInstance::filter(float *aBuffer, unsigned int aSamples, unsigned int aChannels, float /*aSamplerate*/, double aTime)
 	{
 		if (!mActive)
 			return;
 
-		if (aChannel == 0)
+		updateParams(aTime);
+
+		// New coefficients are glided to over the buffer rather than jumped to,
+		// so fading the frequency doesn't need a recalculation per sample
+		float from[5] = { mA0, mA1, mA2, mB1, mB2 };
+		if (mParamChanged & ((1 << FREQUENCY) | (1 << RESONANCE) | (1 << SAMPLERATE)))
+		{
+			calcBQRParams();
+		}
+		mParamChanged = 0;
+		float to[5] = { mA0, mA1, mA2, mB1, mB2 };
+
+		BQRLanes l;
+		l.mA0 = f4Set(from[0]);
+		l.mA1 = f4Set(from[1]);
+		l.mA2 = f4Set(from[2]);
+		l.mB1 = f4Set(from[3]);
+		l.mB2 = f4Set(from[4]);
+		l.mWet = f4Set(mParam[WET]);
+		l.mRamp = false;
+
+		unsigned int i, k;
+		for (k = 0; k < 5; k++)
+		{
+			l.mDelta[k] = f4Set((to[k] - from[k]) / aSamples);
+			l.mRamp = l.mRamp || from[k] != to[k];
+		}
+
+		// Channels are processed four at a time, samples get transposed into channel lanes
+		unsigned int group;
+		for (group = 0; group < aChannels; group += 4)
 		{
-			updateParams(aTime);
+			unsigned int lanes = aChannels - group < 4 ? aChannels - group : 4;
+			float *ch[4];
+			float t[4][4];
+			for (k = 0; k < 4; k++)
+			{
+				// Missing lanes repeat the last channel, their results are dropped
+				unsigned int c = group + (k < lanes ? k : lanes - 1);
+				ch[k] = aBuffer + c * aSamples;
+				t[0][k] = mState[c].mX1;
+				t[1][k] = mState[c].mX2;
+				t[2][k] = mState[c].mY1;
+				t[3][k] = mState[c].mY2;
+			}
+			l.mX1 = f4Load(t[0]);
+			l.mX2 = f4Load(t[1]);
+			l.mY1 = f4Load(t[2]);
+			l.mY2 = f4Load(t[3]);
 
-			if (mParamChanged & ((1 << FREQUENCY) | (1 << RESONANCE) | (1 << SAMPLERATE)))
+			if (l.mRamp)
 			{
-				calcBQRParams();
+				l.mA0 = f4Set(from[0]);
+				l.mA1 = f4Set(from[1]);
+				l.mA2 = f4Set(from[2]);
+				l.mB1 = f4Set(from[3]);
+				l.mB2 = f4Set(from[4]);
 			}
-			mParamChanged = 0;
-		}
 
-		float x;
-		unsigned int i;
-		int c = 0;
+			for (i = 0; i + 4 <= aSamples; i += 4)
+			{
+				float4 s0 = f4Load(ch[0] + i);
+				float4 s1 = f4Load(ch[1] + i);
+				float4 s2 = f4Load(ch[2] + i);
+				float4 s3 = f4Load(ch[3] + i);
+				f4Transpose(s0, s1, s2, s3);
+
+				s0 = bqrStep(l, s0);
+				s1 = bqrStep(l, s1);
+				s2 = bqrStep(l, s2);
+				s3 = bqrStep(l, s3);
+
+				f4Transpose(s0, s1, s2, s3);
+				f4Store(ch[0] + i, s0);
+				if (lanes > 1) f4Store(ch[1] + i, s1);
+				if (lanes > 2) f4Store(ch[2] + i, s2);
+				if (lanes > 3) f4Store(ch[3] + i, s3);
+			}
 
-		BQRStateData &s = mState[aChannel];
+			for (; i < aSamples; i++)
+			{
+				float4 s = bqrStep(l, f4Make(ch[0][i], ch[1][i], ch[2][i], ch[3][i]));
+				for (k = 0; k < lanes; k++)
+				{
+					ch[k][i] = f4Get(s, k);
+				}
+			}
 
-		for (i = 0; i < aSamples; i +=2, c++)
-		{
-			// Generate outputs by filtering inputs.
-			x = aBuffer[c];
-			s.mY2 = (mA0 * x) + (mA1 * s.mX1) + (mA2 * s.mX2) - (mB1 * s.mY1) - (mB2 * s.mY2);
-			aBuffer[c] += (s.mY2 - aBuffer[c]) * mParam[WET];
-
-			c++;
-
-			// Permute filter operations to reduce data movement.
-			// Just substitute variables instead of doing mX1=x, etc.
-			s.mX2 = aBuffer[c];
-			s.mY1 = (mA0 * s.mX2) + (mA1 * x) + (mA2 * s.mX1) - (mB1 * s.mY2) - (mB2 * s.mY1);
-			aBuffer[c] += (s.mY1 - aBuffer[c]) * mParam[WET];
-
-			// Only move a little data.
-			s.mX1 = s.mX2;
-			s.mX2 = x;
+			f4Store(t[0], l.mX1);
+			f4Store(t[1], l.mX2);
+			f4Store(t[2], l.mY1);
+			f4Store(t[3], l.mY2);
+			for (k = 0; k < lanes; k++)
+			{
+				BQRStateData &s = mState[group + k];
+				s.mX1 = t[0][k];
+				s.mX2 = t[1][k];
+
+				// Apply a small impulse to filter to prevent arithmetic underflow,
+				// which can cause the FPU to interrupt the CPU.
+				s.mY1 = t[2][k] + (float) 1.0E-26;
+				s.mY2 = t[3][k];
+			}
 		}
-
-		// Apply a small impulse to filter to prevent arithmetic underflow,
-		// which can cause the FPU to interrupt the CPU.
-		s.mY1 += (float) 1.0E-26;		
 	}
 
 
@@ -24,6 +24,7 @@ freely, subject to the following restrictions:
 
 #include "soloud.h"
 #include "soloud_dcremovalfilter.h"
+#include "soloud_filter_simd.h"
 
 namespace SoLoud
 {
@@ -58,27 +59,86 @@ namespace SoLoud
 			}
 		}
 
-		unsigned int i, j;
-		int prevofs = (mOffset + mBufferLength - 1) % mBufferLength;
-		for (i = 0; i < aSamples; i++)
+		// Each channel's running total is a dependency chain, so channels go in lanes
+		float wet = mParam[0];
+		float4 wet4 = f4Set(wet);
+		float4 length4 = f4Set((float)mBufferLength);
+		unsigned int length = mBufferLength;
+		unsigned int i, k, group;
+		for (group = 0; group < aChannels; group += 4)
 		{
-			for (j = 0; j < aChannels; j++)
+			unsigned int lanes = aChannels - group < 4 ? aChannels - group : 4;
+			float *buffer[4];
+			float *samples[4];
+			float t[4];
+			for (k = 0; k < 4; k++)
 			{
-				int chofs = j * mBufferLength;
-				int bchofs = j * aSamples;
-								
-				float n = aBuffer[i + bchofs];
-				mTotals[j] -= mBuffer[mOffset + chofs];
-				mTotals[j] += n;
-				mBuffer[mOffset + chofs] = n;
-			    
-			    n -= mTotals[j] / mBufferLength;
-			    
-				aBuffer[i + bchofs] += (n - aBuffer[i + bchofs]) * mParam[0];
+				// Missing lanes repeat the last channel, their results are dropped
+				unsigned int c = group + (k < lanes ? k : lanes - 1);
+				buffer[k] = mBuffer + c * length;
+				samples[k] = aBuffer + c * aSamples;
+				t[k] = mTotals[c];
+			}
+			float4 totals = f4Load(t);
+
+			unsigned int ofs = mOffset;
+			i = 0;
+			while (i < aSamples)
+			{
+				unsigned int end = i + (aSamples - i < length - ofs ? aSamples - i : length - ofs);
+				for (; i + 4 <= end; i += 4, ofs += 4)
+				{
+					float4 x[4], r[4];
+					for (k = 0; k < 4; k++)
+					{
+						x[k] = f4Load(samples[k] + i);
+						r[k] = f4Load(buffer[k] + ofs);
+					}
+					f4Transpose(x[0], x[1], x[2], x[3]);
+					f4Transpose(r[0], r[1], r[2], r[3]);
+
+					for (k = 0; k < 4; k++)
+					{
+						totals = f4Add(f4Sub(totals, r[k]), x[k]);
+						r[k] = x[k];
+						float4 n = f4Sub(x[k], f4Div(totals, length4));
+						x[k] = f4Add(x[k], f4Mul(f4Sub(n, x[k]), wet4));
+					}
+
+					f4Transpose(x[0], x[1], x[2], x[3]);
+					f4Transpose(r[0], r[1], r[2], r[3]);
+					for (k = 0; k < lanes; k++)
+					{
+						f4Store(samples[k] + i, x[k]);
+						f4Store(buffer[k] + ofs, r[k]);
+					}
+				}
+				for (; i < end; i++, ofs++)
+				{
+					float4 x = f4Make(samples[0][i], samples[1][i], samples[2][i], samples[3][i]);
+					float4 r = f4Make(buffer[0][ofs], buffer[1][ofs], buffer[2][ofs], buffer[3][ofs]);
+					totals = f4Add(f4Sub(totals, r), x);
+					float4 n = f4Sub(x, f4Div(totals, length4));
+					float4 y = f4Add(x, f4Mul(f4Sub(n, x), wet4));
+					for (k = 0; k < lanes; k++)
+					{
+						buffer[k][ofs] = samples[k][i];
+						samples[k][i] = f4Get(y, k);
+					}
+				}
+				if (ofs == length)
+				{
+					ofs = 0;
+				}
+			}
+
+			f4Store(t, totals);
+			for (k = 0; k < lanes; k++)
+			{
+				mTotals[group + k] = t[k];
 			}
-			prevofs = mOffset;
-			mOffset = (mOffset + 1) % mBufferLength;
 		}
+		mOffset = (mOffset + aSamples) % length;
 	}
 
 	DCRemovalFilterInstance::~DCRemovalFilterInstance()
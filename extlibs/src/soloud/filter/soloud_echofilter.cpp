@@ -24,6 +24,7 @@ freely, subject to the following restrictions:
 
 #include "soloud.h"
 #include "soloud_echofilter.h"
+#include "soloud_filter_simd.h"
 
 namespace SoLoud
 {
@@ -53,25 +54,122 @@ namespace SoLoud
 		}
 
 		float decay = mParent->mDecay;
-		unsigned int i, j;
-		int prevofs = (mOffset + mBufferLength - 1) % mBufferLength;
-		for (i = 0; i < aSamples; i++)
+		float filter = mParent->mFilter;
+		float wet = mParam[0];
+		float4 decay4 = f4Set(decay);
+		float4 wet4 = f4Set(wet);
+		unsigned int length = mBufferLength;
+		unsigned int i, j, k;
+
+		if (filter == 0)
 		{
+			// Without the filter there's no dependency between samples,
+			// every contiguous run of the ring buffer is done four samples at a time
 			for (j = 0; j < aChannels; j++)
 			{
-				int chofs = j * mBufferLength;
-				int bchofs = j * aSamples;
-				
-				mBuffer[mOffset + chofs] = mParent->mFilter * mBuffer[prevofs + chofs] + (1 - mParent->mFilter) * mBuffer[mOffset + chofs];
-				
-				float n = aBuffer[i + bchofs] + mBuffer[mOffset + chofs] * decay;
-				mBuffer[mOffset + chofs] = n;
-
-				aBuffer[i + bchofs] += (n - aBuffer[i + bchofs]) * mParam[0];
+				float *buffer = mBuffer + j * length;
+				float *samples = aBuffer + j * aSamples;
+				unsigned int ofs = mOffset;
+
+				i = 0;
+				while (i < aSamples)
+				{
+					unsigned int end = i + (aSamples - i < length - ofs ? aSamples - i : length - ofs);
+					for (; i + 4 <= end; i += 4, ofs += 4)
+					{
+						float4 x = f4Load(samples + i);
+						float4 n = f4Add(x, f4Mul(f4Load(buffer + ofs), decay4));
+						f4Store(buffer + ofs, n);
+						f4Store(samples + i, f4Add(x, f4Mul(f4Sub(n, x), wet4)));
+					}
+					for (; i < end; i++, ofs++)
+					{
+						float n = samples[i] + buffer[ofs] * decay;
+						buffer[ofs] = n;
+						samples[i] += (n - samples[i]) * wet;
+					}
+					if (ofs == length)
+					{
+						ofs = 0;
+					}
+				}
 			}
-			prevofs = mOffset;
-			mOffset = (mOffset + 1) % mBufferLength;
 		}
+		else
+		{
+			// Each sample feeds the next one, so channels go in lanes instead
+			float4 filter4 = f4Set(filter);
+			float4 keep4 = f4Set(1 - filter);
+			unsigned int group;
+			for (group = 0; group < aChannels; group += 4)
+			{
+				unsigned int lanes = aChannels - group < 4 ? aChannels - group : 4;
+				float *buffer[4];
+				float *samples[4];
+				float t[4];
+				for (k = 0; k < 4; k++)
+				{
+					// Missing lanes repeat the last channel, their results are dropped
+					unsigned int c = group + (k < lanes ? k : lanes - 1);
+					buffer[k] = mBuffer + c * length;
+					samples[k] = aBuffer + c * aSamples;
+					t[k] = buffer[k][(mOffset + length - 1) % length];
+				}
+				float4 prev = f4Load(t);
+
+				unsigned int ofs = mOffset;
+				i = 0;
+				while (i < aSamples)
+				{
+					unsigned int end = i + (aSamples - i < length - ofs ? aSamples - i : length - ofs);
+					for (; i + 4 <= end; i += 4, ofs += 4)
+					{
+						float4 x[4], r[4];
+						for (k = 0; k < 4; k++)
+						{
+							x[k] = f4Load(samples[k] + i);
+							r[k] = f4Load(buffer[k] + ofs);
+						}
+						f4Transpose(x[0], x[1], x[2], x[3]);
+						f4Transpose(r[0], r[1], r[2], r[3]);
+
+						for (k = 0; k < 4; k++)
+						{
+							float4 n = f4Add(x[k], f4Mul(f4Add(f4Mul(filter4, prev), f4Mul(keep4, r[k])), decay4));
+							prev = n;
+							r[k] = n;
+							x[k] = f4Add(x[k], f4Mul(f4Sub(n, x[k]), wet4));
+						}
+
+						f4Transpose(x[0], x[1], x[2], x[3]);
+						f4Transpose(r[0], r[1], r[2], r[3]);
+						for (k = 0; k < lanes; k++)
+						{
+							f4Store(samples[k] + i, x[k]);
+							f4Store(buffer[k] + ofs, r[k]);
+						}
+					}
+					for (; i < end; i++, ofs++)
+					{
+						float4 x = f4Make(samples[0][i], samples[1][i], samples[2][i], samples[3][i]);
+						float4 r = f4Make(buffer[0][ofs], buffer[1][ofs], buffer[2][ofs], buffer[3][ofs]);
+						float4 n = f4Add(x, f4Mul(f4Add(f4Mul(filter4, prev), f4Mul(keep4, r)), decay4));
+						prev = n;
+						x = f4Add(x, f4Mul(f4Sub(n, x), wet4));
+						for (k = 0; k < lanes; k++)
+						{
+							samples[k][i] = f4Get(x, k);
+							buffer[k][ofs] = f4Get(n, k);
+						}
+					}
+					if (ofs == length)
+					{
+						ofs = 0;
+					}
+				}
+			}
+		}
+		mOffset = (mOffset + aSamples) % mBufferLength;
 	}
 
 	EchoFilterInstance::~EchoFilterInstance()
@@ -26,6 +26,7 @@ freely, subject to the following restrictions:
 #include "soloud.h"
 #include "soloud_fftfilter.h"
 #include "soloud_fft.h"
+#include "soloud_filter_simd.h"
 
 
 namespace SoLoud
@@ -71,23 +72,23 @@ namespace SoLoud
 
 		float * b = mTemp;
 
-		int i;
+		unsigned int i, j;
 		unsigned int ofs = 0;
 		unsigned int chofs = 512 * aChannel;
 		unsigned int bofs = mOffset[aChannel];
-		
+		float4 wet = f4Set(mParam[0]);
+		float4 scale = f4Set(1.0f / 128.0f);
+		float4 step = f4Set(4);
+
+		// bofs is always a multiple of 128, so 128 sample spans of the ring never wrap
 		while (ofs < aSamples)
 		{
-			for (i = 0; i < 128; i++)
-			{
-				mInputBuffer[chofs + ((bofs + i + 128) & 511)] = aBuffer[ofs + i];
-				mMixBuffer[chofs + ((bofs + i + 128) & 511)] = 0;
-			}
-			
-			for (i = 0; i < 256; i++)
-			{
-				b[i] = mInputBuffer[chofs + ((bofs + i) & 511)];
-			}
+			float *input = mInputBuffer + chofs + ((bofs + 128) & 511);
+			memcpy(input, aBuffer + ofs, sizeof(float) * 128);
+			memset(mMixBuffer + chofs + ((bofs + 128) & 511), 0, sizeof(float) * 128);
+
+			memcpy(b, mInputBuffer + chofs + (bofs & 511), sizeof(float) * 128);
+			memcpy(b + 128, input, sizeof(float) * 128);
 			FFT::fft256(b);
 
 			// do magic
@@ -95,14 +96,27 @@ namespace SoLoud
 			
 			FFT::ifft256(b);
 
-			for (i = 0; i < 256; i++)
+			// Triangular window, rising over the first half and falling over the second
+			for (j = 0; j < 2; j++)
 			{
-				mMixBuffer[chofs + ((bofs + i) & 511)] += b[i] * (128 - abs(128 - i)) * (1.0f / 128.0f);
-			}			
-			
-			for (i = 0; i < 128; i++)
+				float *mix = mMixBuffer + chofs + ((bofs + j * 128) & 511);
+				float *src = b + j * 128;
+				float4 window = j == 0 ? f4Make(0, 1, 2, 3) : f4Make(128, 127, 126, 125);
+				float4 windowstep = j == 0 ? step : f4Sub(f4Set(0), step);
+				for (i = 0; i < 128; i += 4)
+				{
+					float4 m = f4Mul(f4Mul(f4Load(src + i), window), scale);
+					f4Store(mix + i, f4Add(f4Load(mix + i), m));
+					window = f4Add(window, windowstep);
+				}
+			}
+
+			float *mix = mMixBuffer + chofs + (bofs & 511);
+			float *dst = aBuffer + ofs;
+			for (i = 0; i < 128; i += 4)
 			{
-				aBuffer[ofs + i] += (mMixBuffer[chofs + ((bofs + i) & 511)] - aBuffer[ofs + i]) * mParam[0];
+				float4 x = f4Load(dst + i);
+				f4Store(dst + i, f4Add(x, f4Mul(f4Sub(f4Load(mix + i), x), wet)));
 			}
 			ofs += 128;
 			bofs += 128;
@@ -0,0 +1,128 @@
+/*
+    This is free and unencumbered software released into the public domain.
+
+    Anyone is free to copy, modify, publish, use, compile, sell, or
+    distribute this software, either in source code form or as a compiled
+    binary, for any purpose, commercial or non-commercial, and by any
+    means.
+
+    In jurisdictions that recognize copyright laws, the author or authors
+    of this software dedicate any and all copyright interest in the
+    software to the public domain. We make this dedication for the benefit
+    of the public at large and to the detriment of our heirs and
+    successors. We intend this dedication to be an overt act of
+    relinquishment in perpetuity of all present and future rights to this
+    software under copyright law.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+    MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+    IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+    OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+    ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+    OTHER DEALINGS IN THE SOFTWARE.
+
+    For more information, please refer to <http://unlicense.org>
+*/
+
+#ifndef SOLOUD_FILTER_SIMD_H
+#define SOLOUD_FILTER_SIMD_H
+
+#include "soloud.h"
+
+#if defined(SOLOUD_SSE_INTRINSICS)
+#include <xmmintrin.h>
+#elif defined(SOLOUD_NEON_INTRINSICS)
+#include <arm_neon.h>
+#endif
+
+// Four float lanes shared by the filters, either four samples or four channels at once.
+// Only plain multiplies and adds, so results match the scalar code bit for bit.
+namespace SoLoud
+{
+	struct float4
+	{
+#if defined(SOLOUD_SSE_INTRINSICS)
+		__m128 v;
+#elif defined(SOLOUD_NEON_INTRINSICS)
+		float32x4_t v;
+#else
+		float v[4];
+#endif
+	};
+
+#if defined(SOLOUD_SSE_INTRINSICS)
+	inline float4 f4Load(const float *aSrc) { float4 r; r.v = _mm_loadu_ps(aSrc); return r; }
+	inline void f4Store(float *aDst, float4 a) { _mm_storeu_ps(aDst, a.v); }
+	inline float4 f4Set(float aValue) { float4 r; r.v = _mm_set1_ps(aValue); return r; }
+	inline float4 f4Add(float4 a, float4 b) { float4 r; r.v = _mm_add_ps(a.v, b.v); return r; }
+	inline float4 f4Sub(float4 a, float4 b) { float4 r; r.v = _mm_sub_ps(a.v, b.v); return r; }
+	inline float4 f4Mul(float4 a, float4 b) { float4 r; r.v = _mm_mul_ps(a.v, b.v); return r; }
+	inline float4 f4Div(float4 a, float4 b) { float4 r; r.v = _mm_div_ps(a.v, b.v); return r; }
+
+	inline void f4Transpose(float4 &a, float4 &b, float4 &c, float4 &d)
+	{
+		_MM_TRANSPOSE4_PS(a.v, b.v, c.v, d.v);
+	}
+#elif defined(SOLOUD_NEON_INTRINSICS)
+	inline float4 f4Load(const float *aSrc) { float4 r; r.v = vld1q_f32(aSrc); return r; }
+	inline void f4Store(float *aDst, float4 a) { vst1q_f32(aDst, a.v); }
+	inline float4 f4Set(float aValue) { float4 r; r.v = vdupq_n_f32(aValue); return r; }
+	inline float4 f4Add(float4 a, float4 b) { float4 r; r.v = vaddq_f32(a.v, b.v); return r; }
+	inline float4 f4Sub(float4 a, float4 b) { float4 r; r.v = vsubq_f32(a.v, b.v); return r; }
+	inline float4 f4Mul(float4 a, float4 b) { float4 r; r.v = vmulq_f32(a.v, b.v); return r; }
+#if defined(__aarch64__)
+	inline float4 f4Div(float4 a, float4 b) { float4 r; r.v = vdivq_f32(a.v, b.v); return r; }
+#else
+	// ARMv7 NEON only has reciprocal estimates, which wouldn't match the scalar code
+	inline float4 f4Div(float4 a, float4 b)
+	{
+		float ta[4], tb[4];
+		vst1q_f32(ta, a.v);
+		vst1q_f32(tb, b.v);
+		int i;
+		for (i = 0; i < 4; i++) ta[i] /= tb[i];
+		float4 r; r.v = vld1q_f32(ta); return r;
+	}
+#endif
+
+	inline void f4Transpose(float4 &a, float4 &b, float4 &c, float4 &d)
+	{
+		float32x4x2_t ab = vtrnq_f32(a.v, b.v);
+		float32x4x2_t cd = vtrnq_f32(c.v, d.v);
+		a.v = vcombine_f32(vget_low_f32(ab.val[0]), vget_low_f32(cd.val[0]));
+		b.v = vcombine_f32(vget_low_f32(ab.val[1]), vget_low_f32(cd.val[1]));
+		c.v = vcombine_f32(vget_high_f32(ab.val[0]), vget_high_f32(cd.val[0]));
+		d.v = vcombine_f32(vget_high_f32(ab.val[1]), vget_high_f32(cd.val[1]));
+	}
+#else
+	inline float4 f4Load(const float *aSrc) { float4 r; for (int i = 0; i < 4; i++) r.v[i] = aSrc[i]; return r; }
+	inline void f4Store(float *aDst, float4 a) { for (int i = 0; i < 4; i++) aDst[i] = a.v[i]; }
+	inline float4 f4Set(float aValue) { float4 r; for (int i = 0; i < 4; i++) r.v[i] = aValue; return r; }
+	inline float4 f4Add(float4 a, float4 b) { float4 r; for (int i = 0; i < 4; i++) r.v[i] = a.v[i] + b.v[i]; return r; }
+	inline float4 f4Sub(float4 a, float4 b) { float4 r; for (int i = 0; i < 4; i++) r.v[i] = a.v[i] - b.v[i]; return r; }
+	inline float4 f4Mul(float4 a, float4 b) { float4 r; for (int i = 0; i < 4; i++) r.v[i] = a.v[i] * b.v[i]; return r; }
+	inline float4 f4Div(float4 a, float4 b) { float4 r; for (int i = 0; i < 4; i++) r.v[i] = a.v[i] / b.v[i]; return r; }
+
+	inline void f4Transpose(float4 &a, float4 &b, float4 &c, float4 &d)
+	{
+		float4 *rows[4] = { &a, &b, &c, &d };
+		int i, j;
+		for (i = 0; i < 4; i++)
+		{
+			for (j = i + 1; j < 4; j++)
+			{
+				float t = rows[i]->v[j];
+				rows[i]->v[j] = rows[j]->v[i];
+				rows[j]->v[i] = t;
+			}
+		}
+	}
+#endif
+
+	// Per lane access, for the odd samples that don't fill a whole vector
+	inline float f4Get(float4 a, int aLane) { float t[4]; f4Store(t, a); return t[aLane]; }
+	inline float4 f4Make(float a, float b, float c, float d) { float t[4] = { a, b, c, d }; return f4Load(t); }
+}
+
+#endif
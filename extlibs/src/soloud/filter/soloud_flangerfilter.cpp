@@ -47,8 +47,8 @@ namespace SoLoud
 		if (mBufferLength < mParam[FlangerFilter::DELAY] * aSamplerate)
 		{
 			delete[] mBuffer;
-			mBufferLength = (int)ceil(mParam[FlangerFilter::DELAY] * aSamplerate) * aChannels;
-			mBuffer = new float[mBufferLength];
+			mBufferLength = (int)ceil(mParam[FlangerFilter::DELAY] * aSamplerate);
+			mBuffer = new float[mBufferLength * aChannels];
 			if (mBuffer == NULL)
 			{
 				mBufferLength = 0;
@@ -60,20 +60,49 @@ namespace SoLoud
 		unsigned int i, j;
 		int maxsamples = (int)ceil(mParam[FlangerFilter::DELAY] * aSamplerate);
 		double inc = mParam[FlangerFilter::FREQ] * M_PI * 2 / aSamplerate;
+		float wet = mParam[FlangerFilter::WET];
+
+		// The oscillator is a phasor rotated by inc every sample instead of a cos() call,
+		// it's reseeded from mIndex for every channel so it can't drift.
+		// Near a whole delay its rounding error could pick the other one, cos() decides there.
+		double rotcos = cos(inc);
+		double rotsin = sin(inc);
+
 		for (i = 0; i < aChannels; i++)
 		{
-			int mbofs = i * mBufferLength;
-			int abofs = i * aSamples;
-			for (j = 0; j < aSamples; j++, abofs++)
+			float *buffer = mBuffer + i * mBufferLength;
+			float *samples = aBuffer + i * aSamples;
+			int ofs = mOffset % mBufferLength;
+			double c = cos(mIndex);
+			double s = sin(mIndex);
+			for (j = 0; j < aSamples; j++)
 			{
-				int delay = (int)floor(maxsamples * (1 + cos(mIndex))) / 2;
+				double d = maxsamples * (1 + c);
+				double whole = floor(d);
+				if (d - whole < 1e-6 || whole + 1 - d < 1e-6)
+				{
+					whole = floor(maxsamples * (1 + cos(mIndex)));
+				}
+				int delay = (int)whole / 2;
+				double rc = c * rotcos - s * rotsin;
+				s = s * rotcos + c * rotsin;
+				c = rc;
 				mIndex += inc;
-				mBuffer[mbofs + mOffset % mBufferLength] = aBuffer[abofs];
-				float n = 0.5f * (aBuffer[abofs] + mBuffer[mbofs + (mBufferLength - delay + mOffset) % mBufferLength]);
-				mOffset++;
-				aBuffer[abofs] += (n - aBuffer[abofs]) * mParam[FlangerFilter::WET];
+
+				buffer[ofs] = samples[j];
+				int readofs = ofs - delay;
+				if (readofs < 0)
+				{
+					readofs += mBufferLength;
+				}
+				float n = 0.5f * (samples[j] + buffer[readofs]);
+				samples[j] += (n - samples[j]) * wet;
+
+				if (++ofs == mBufferLength)
+				{
+					ofs = 0;
+				}
 			}
-			mOffset -= aSamples;
 		}
 		mOffset += aSamples;
 		mOffset %= mBufferLength;
@@ -36,32 +36,44 @@ namespace SoLoud
 		initParams(3);
 		mParam[SAMPLERATE] = aParent->mSampleRate;
 		mParam[BITDEPTH] = aParent->mBitdepth;
-		mChannelData[0].mSample = 0;
-		mChannelData[0].mSamplesToSkip = 0;
-		mChannelData[1].mSample = 0;
-		mChannelData[1].mSamplesToSkip = 0;
+		int i;
+		for (i = 0; i < MAX_CHANNELS; i++)
+		{
+			mChannelData[i].mSample = 0;
+			mChannelData[i].mSamplesToSkip = 0;
+		}
 	}
 
 	void LofiFilterInstance::filterChannel(float *aBuffer, unsigned int aSamples, float aSamplerate, double aTime, unsigned int aChannel, unsigned int aChannels)
 	{
 		updateParams(aTime);
 
+		// Constant for the whole buffer, no need for a pow() per held sample
+		float q = pow(2, mParam[BITDEPTH]);
+		float skip = (aSamplerate / mParam[SAMPLERATE]) - 1;
+		float wet = mParam[WET];
+
+		LofiChannelData &data = mChannelData[aChannel];
+		float sample = data.mSample;
+		float samplesToSkip = data.mSamplesToSkip;
+
 		unsigned int i;
 		for (i = 0; i < aSamples; i++)
 		{
-			if (mChannelData[aChannel].mSamplesToSkip <= 0)
+			if (samplesToSkip <= 0)
 			{
-				mChannelData[aChannel].mSamplesToSkip += (aSamplerate / mParam[SAMPLERATE]) - 1;
-				float q = pow(2, mParam[BITDEPTH]);
-				mChannelData[aChannel].mSample = floor(q*aBuffer[i])/q;
+				samplesToSkip += skip;
+				sample = floor(q*aBuffer[i])/q;
 			}
 			else
 			{
-				mChannelData[aChannel].mSamplesToSkip--;
+				samplesToSkip--;
 			}
-			aBuffer[i] += (mChannelData[aChannel].mSample - aBuffer[i]) * mParam[WET];
+			aBuffer[i] += (sample - aBuffer[i]) * wet;
 		}
 
+		data.mSample = sample;
+		data.mSamplesToSkip = samplesToSkip;
 	}
 
 	LofiFilterInstance::~LofiFilterInstance()
@@ -212,3 +212,81 @@ project 'game'
         postbuildcommands { 'postbuild-win vs2013/x86'}
     filter { 'action:vs*', 'system:windows', 'architecture:x64' }
         postbuildcommands { 'postbuild-win vs2013/x64'}
+
+-- Engine benchmark suite, writes its results to a JSON file
+project 'bench'
+    kind       'ConsoleApp'
+    targetname 'bench'
+    targetdir  'bin'
+    language   'C++'
+
+    files {
+        'bench/suite/*.cpp',
+        'src/**/*.cpp',
+        'src/**/*.c'
+    }
+
+    -- The suite has its own entry point
+    removefiles {
+        'src/main.cpp'
+    }
+
+    -- Linux specific
+    filter { 'system:linux' }
+        links        { 'GL', 'luajit-5.1', 'asound' }
+        linkoptions  { "-export-dynamic" }
+
+    -- Windows specific
+    filter 'system:windows'
+        links        { 'SDL2main', 'opengl32', 'lua51', 'winmm' }
+
+    -- GCC specific
+    filter { 'action:gmake' }
+        buildoptions { '-x c++ -std=c++11' }
+        linkoptions  { "-static-libgcc -static-libstdc++" }
+
+    -- All configs, again, because of linking order
+    filter {}
+        links        { 'SDL2', 'physfs', 'freetype', 'soloud' }
+
+-- Offline audio mixing benchmark, on SoLoud's null driver
+project 'bench-audio'
+    kind       'ConsoleApp'
+    targetname 'bench-audio'
+    targetdir  'bin'
+    language   'C++'
+
+    files {
+        'bench/audio.cpp',
+        'src/audio/*.cpp',
+        'src/system/filesystem.cpp',
+        'src/system/log.cpp',
+        'src/system/scheduler.cpp',
+        'src/system/stream.cpp'
+    }
+
+    filter { 'system:linux' }
+        links        { 'asound' }
+    filter { 'system:windows' }
+        links        { 'winmm' }
+
+    filter { 'action:gmake' }
+        buildoptions { '-std=c++11' }
+
+    filter {}
+        links        { 'SDL2', 'physfs', 'soloud' }
+
+-- Task graph regression checks
+project 'test-taskgraph'
+    kind       'ConsoleApp'
+    targetname 'test-taskgraph'
+    targetdir  'bin'
+    language   'C++'
+
+    files {
+        'tests/taskgraph.cpp',
+        'src/system/taskgraph.cpp'
+    }
+
+    filter { 'action:gmake' }
+        buildoptions { '-std=c++11' }
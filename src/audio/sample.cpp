@@ -0,0 +1,207 @@
+/*
+    This is free and unencumbered software released into the public domain.
+
+    Anyone is free to copy, modify, publish, use, compile, sell, or
+    distribute this software, either in source code form or as a compiled
+    binary, for any purpose, commercial or non-commercial, and by any
+    means.
+
+    In jurisdictions that recognize copyright laws, the author or authors
+    of this software dedicate any and all copyright interest in the
+    software to the public domain. We make this dedication for the benefit
+    of the public at large and to the detriment of our heirs and
+    successors. We intend this dedication to be an overt act of
+    relinquishment in perpetuity of all present and future rights to this
+    software under copyright law.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+    MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+    IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+    OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+    ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+    OTHER DEALINGS IN THE SOFTWARE.
+
+    For more information, please refer to <http://unlicense.org>
+*/
+
+#include "sample.hpp"
+#include "../system/scheduler.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+// Locals
+namespace
+{
+    // Settles the buffer with nothing if the job is dropped before it runs,
+    // a broken promise would throw at whoever waits for it
+    struct PendingBuffer
+    {
+        std::promise<SampleBank::BufferPtr> promise;
+        bool settled = false;
+
+        ~PendingBuffer()
+        {
+            if (!settled) promise.set_value(nullptr);
+        }
+
+        void load(const std::function<SampleBank::BufferPtr()>& loader)
+        {
+            promise.set_value(loader());
+            settled = true;
+        }
+    };
+}
+
+namespace Audio
+{
+    SampleInstance::SampleInstance(SampleBank::BufferPtr buffer) :
+        mBuffer(std::move(buffer))
+    {
+        if (mBuffer->format == SampleBank::Adpcm) {
+            mBlocks.resize(mBuffer->channels * SampleBank::AdpcmBlockFrames);
+            mCachedBlocks.resize(mBuffer->channels, ~0u);
+        }
+    }
+
+    void SampleInstance::getAudio(float* buffer, unsigned int samples)
+    {
+        unsigned frameCount = mBuffer->frameCount;
+        unsigned written = 0u;
+
+        while (written < samples) {
+            if (mOffset >= frameCount) {
+                if (!(mFlags & LOOPING) || frameCount == 0u) {
+                    // Pad with silence past the end
+                    for (unsigned i = 0u; i < mChannels; ++i) {
+                        std::memset(buffer + i * samples + written, 0,
+                            (samples - written) * sizeof(float));
+                    }
+                    mOffset += samples - written;
+                    return;
+                }
+
+                mOffset = 0u;
+                ++mLoopCount;
+            }
+
+            // Converted straight into the mix buffer, whatever the storage format
+            unsigned count = std::min(samples - written, frameCount - mOffset);
+            for (unsigned i = 0u; i < mChannels; ++i) {
+                float* blocks = mBlocks.empty() ? nullptr :
+                    &mBlocks[i * SampleBank::AdpcmBlockFrames];
+                unsigned dummy = 0u;
+                mBuffer->read(i, mOffset, count, buffer + i * samples + written, blocks,
+                    mCachedBlocks.empty() ? dummy : mCachedBlocks[i]);
+            }
+
+            written += count;
+            mOffset += count;
+        }
+    }
+
+    bool SampleInstance::hasEnded()
+    {
+        return !(mFlags & LOOPING) && mOffset >= mBuffer->frameCount;
+    }
+
+    void SampleInstance::seek(double seconds, float*, unsigned int)
+    {
+        // Skips ahead without decoding anything
+        double offset = seconds - mStreamTime;
+        if (offset < 0.0) {
+            rewind();
+            offset = seconds;
+        }
+
+        mOffset += static_cast<unsigned>(std::floor(mSamplerate * offset));
+        if ((mFlags & LOOPING) && mBuffer->frameCount > 0u) {
+            mLoopCount += mOffset / mBuffer->frameCount;
+            mOffset %= mBuffer->frameCount;
+        }
+
+        mStreamTime = seconds;
+    }
+
+    SoLoud::result SampleInstance::rewind()
+    {
+        mOffset = 0u;
+        mStreamTime = 0.0;
+        return SoLoud::SO_NO_ERROR;
+    }
+
+    Sample::~Sample()
+    {
+        stop();
+    }
+
+    void Sample::load(const char* filename, SampleBank::Format format)
+    {
+        std::string name = filename;
+        submit([name, format] { return SampleBank::load(name, format); });
+    }
+
+    void Sample::load(const uint8_t* data, size_t size, SampleBank::Format format)
+    {
+        // The caller's buffer may not outlive this call
+        auto copy = std::make_shared<std::vector<uint8_t>>(data, data + size);
+        submit([copy, format] { return SampleBank::load(copy->data(), copy->size(), format); });
+    }
+
+    double Sample::getLength()
+    {
+        const auto& samples = buffer();
+        if (!samples || samples->samplerate <= 0.f) return 0.0;
+
+        return samples->frameCount / static_cast<double>(samples->samplerate);
+    }
+
+    size_t Sample::getMemorySize()
+    {
+        // Not worth blocking for, the sample bank counts it as a whole once decoded
+        if (!mBuffer.valid() ||
+            mBuffer.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+            return 0u;
+        }
+
+        const auto& samples = mBuffer.get();
+        return samples ? samples->data.size() : 0u;
+    }
+
+    SoLoud::AudioSourceInstance* Sample::createInstance()
+    {
+        // SoLoud reads these right after creating the instance
+        const auto& samples = buffer();
+        mChannels = samples ? samples->channels : 1u;
+        mBaseSamplerate = samples ? samples->samplerate : 44100.f;
+
+        return new SampleInstance(samples ? samples : std::make_shared<SampleBank::Buffer>(
+            SampleBank::Float32, 1u, 44100.f, 0u));
+    }
+
+    void Sample::submit(std::function<SampleBank::BufferPtr()> loader)
+    {
+        stop();
+
+        auto pending = std::make_shared<PendingBuffer>();
+        mBuffer = pending->promise.get_future().share();
+
+        uint32_t id = Scheduler::submit([pending, loader](Scheduler::Result&) {
+            pending->load(loader);
+            return true;
+        });
+
+        // The scheduler doesn't take jobs anymore once it's shutting down
+        if (Scheduler::status(id) == Scheduler::Failed) pending->load(loader);
+        Scheduler::release(id);
+    }
+
+    const SampleBank::BufferPtr& Sample::buffer()
+    {
+        static const SampleBank::BufferPtr empty;
+        return mBuffer.valid() ? mBuffer.get() : empty;
+    }
+}
@@ -0,0 +1,81 @@
+/*
+    This is free and unencumbered software released into the public domain.
+
+    Anyone is free to copy, modify, publish, use, compile, sell, or
+    distribute this software, either in source code form or as a compiled
+    binary, for any purpose, commercial or non-commercial, and by any
+    means.
+
+    In jurisdictions that recognize copyright laws, the author or authors
+    of this software dedicate any and all copyright interest in the
+    software to the public domain. We make this dedication for the benefit
+    of the public at large and to the detriment of our heirs and
+    successors. We intend this dedication to be an overt act of
+    relinquishment in perpetuity of all present and future rights to this
+    software under copyright law.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+    MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+    IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+    OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+    ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+    OTHER DEALINGS IN THE SOFTWARE.
+
+    For more information, please refer to <http://unlicense.org>
+*/
+
+#pragma once
+#include "../config.hpp"
+#include "samplebank.hpp"
+
+#include <soloud/soloud.h>
+
+#include <functional>
+#include <future>
+#include <vector>
+
+namespace Audio
+{
+    class SampleInstance : public SoLoud::AudioSourceInstance
+    {
+    public:
+        SampleInstance(SampleBank::BufferPtr buffer);
+
+        virtual void getAudio(float* buffer, unsigned int samples);
+        virtual bool hasEnded();
+        virtual void seek(double seconds, float* scratch, unsigned int scratchSize);
+        virtual SoLoud::result rewind();
+
+    private:
+        SampleBank::BufferPtr mBuffer;
+        unsigned mOffset {0u};
+
+        // Per channel ADPCM blocks, decoded as playback goes through them
+        std::vector<float> mBlocks;
+        std::vector<unsigned> mCachedBlocks;
+    };
+
+    // Static audio source playing decoded samples from the sample bank
+    // Loading happens on a worker, the source only waits for it when it's first needed
+    class Sample : public SoLoud::AudioSource
+    {
+    public:
+        Sample() = default;
+        virtual ~Sample();
+
+        void load(const char* filename, SampleBank::Format format);
+        void load(const uint8_t* data, size_t size, SampleBank::Format format);
+
+        double getLength();
+        size_t getMemorySize();
+
+        virtual SoLoud::AudioSourceInstance* createInstance();
+
+    private:
+        void submit(std::function<SampleBank::BufferPtr()> loader);
+        const SampleBank::BufferPtr& buffer();
+
+        std::shared_future<SampleBank::BufferPtr> mBuffer;
+    };
+}
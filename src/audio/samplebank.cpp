@@ -0,0 +1,320 @@
+/*
+    This is free and unencumbered software released into the public domain.
+
+    Anyone is free to copy, modify, publish, use, compile, sell, or
+    distribute this software, either in source code form or as a compiled
+    binary, for any purpose, commercial or non-commercial, and by any
+    means.
+
+    In jurisdictions that recognize copyright laws, the author or authors
+    of this software dedicate any and all copyright interest in the
+    software to the public domain. We make this dedication for the benefit
+    of the public at large and to the detriment of our heirs and
+    successors. We intend this dedication to be an overt act of
+    relinquishment in perpetuity of all present and future rights to this
+    software under copyright law.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+    MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+    IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+    OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+    ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+    OTHER DEALINGS IN THE SOFTWARE.
+
+    For more information, please refer to <http://unlicense.org>
+*/
+
+#include "samplebank.hpp"
+#include "../system/stream.hpp"
+
+#include <soloud/soloud_wav.h>
+
+#include <algorithm>
+#include <cinttypes>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <unordered_map>
+
+// Locals
+namespace
+{
+    const int adpcmIndexTable[16] = {
+        -1, -1, -1, -1, 2, 4, 6, 8,
+        -1, -1, -1, -1, 2, 4, 6, 8
+    };
+
+    const int adpcmStepTable[89] = {
+        7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31, 34, 37, 41, 45, 50, 55, 60,
+        66, 73, 80, 88, 97, 107, 118, 130, 143, 157, 173, 190, 209, 230, 253, 279, 307, 337, 371,
+        408, 449, 494, 544, 598, 658, 724, 796, 876, 963, 1060, 1166, 1282, 1411, 1552, 1707,
+        1878, 2066, 2272, 2499, 2749, 3024, 3327, 3660, 4026, 4428, 4871, 5358, 5894, 6484, 7132,
+        7845, 8630, 9493, 10442, 11487, 12635, 13899, 15289, 16818, 18500, 20350, 22385, 24623,
+        27086, 29794, 32767
+    };
+
+    std::mutex mutex;
+    std::unordered_map<std::string, std::weak_ptr<const SampleBank::Buffer>> buffers;
+
+    uint64_t hashData(const uint8_t* data, size_t size)
+    {
+        uint64_t hash = 14695981039346656037ull;
+        for (size_t i = 0u; i < size; ++i) {
+            hash ^= data[i];
+            hash *= 1099511628211ull;
+        }
+
+        return hash;
+    }
+
+    int16_t toInt16(float sample)
+    {
+        long value = std::lround(sample * 32768.f);
+        return static_cast<int16_t>(std::min(std::max(value, -32768l), 32767l));
+    }
+
+    // Advances the ADPCM state by one nibble, the encoder and the decoder both go through here
+    int decodeNibble(uint8_t nibble, int& predictor, int& index)
+    {
+        int step  = adpcmStepTable[index];
+        int delta = step >> 3;
+        if (nibble & 4u) delta += step;
+        if (nibble & 2u) delta += step >> 1;
+        if (nibble & 1u) delta += step >> 2;
+
+        predictor += (nibble & 8u) ? -delta : delta;
+        predictor = std::min(std::max(predictor, -32768), 32767);
+        index = std::min(std::max(index + adpcmIndexTable[nibble], 0), 88);
+
+        return predictor;
+    }
+
+    uint8_t encodeNibble(int sample, int& predictor, int& index)
+    {
+        int step = adpcmStepTable[index];
+        int diff = sample - predictor;
+
+        uint8_t nibble = 0u;
+        if (diff < 0) {
+            nibble = 8u;
+            diff = -diff;
+        }
+        if (diff >= step) {
+            nibble |= 4u;
+            diff -= step;
+        }
+        if (diff >= step >> 1) {
+            nibble |= 2u;
+            diff -= step >> 1;
+        }
+        if (diff >= step >> 2) nibble |= 1u;
+
+        decodeNibble(nibble, predictor, index);
+        return nibble;
+    }
+
+    void encodeAdpcmBlock(const float* samples, unsigned count, uint8_t* block)
+    {
+        // Each block starts from the first sample and the best step index for the second one
+        int predictor = toInt16(samples[0]);
+        int index = 0;
+        if (count > 1u) {
+            int diff = std::abs(toInt16(samples[1]) - predictor);
+            while (index < 88 && adpcmStepTable[index] < diff) ++index;
+        }
+
+        block[0] = static_cast<uint8_t>(predictor & 0xFF);
+        block[1] = static_cast<uint8_t>((predictor >> 8) & 0xFF);
+        block[2] = static_cast<uint8_t>(index);
+        block[3] = 0u;
+
+        std::memset(block + 4u, 0, SampleBank::AdpcmBlockFrames / 2u);
+        for (unsigned i = 0u; i < count; ++i) {
+            uint8_t nibble = encodeNibble(toInt16(samples[i]), predictor, index);
+            block[4u + i / 2u] |= (i & 1u) ? nibble << 4u : nibble;
+        }
+    }
+
+    void decodeAdpcmBlock(const uint8_t* block, float* dst)
+    {
+        int predictor = static_cast<int16_t>(block[0] | (block[1] << 8));
+        int index = std::min<int>(block[2], 88);
+
+        for (unsigned i = 0u; i < SampleBank::AdpcmBlockFrames; ++i) {
+            uint8_t byte = block[4u + i / 2u];
+            dst[i] = decodeNibble((i & 1u) ? byte >> 4u : byte & 0x0Fu, predictor, index) / 32768.f;
+        }
+    }
+
+    SampleBank::BufferPtr convert(const SoLoud::Wav& wav, SampleBank::Format format)
+    {
+        auto* buffer = new SampleBank::Buffer(format, wav.mChannels, wav.mBaseSamplerate,
+            wav.mSampleCount);
+
+        size_t samples = static_cast<size_t>(wav.mSampleCount) * wav.mChannels;
+        switch (format) {
+            case SampleBank::Int16: {
+                buffer->data.resize(samples * sizeof(int16_t));
+                auto* dst = reinterpret_cast<int16_t*>(buffer->data.data());
+                for (size_t i = 0u; i < samples; ++i) dst[i] = toInt16(wav.mData[i]);
+                break;
+            }
+            case SampleBank::Adpcm: {
+                unsigned blockCount = (wav.mSampleCount + SampleBank::AdpcmBlockFrames - 1u) /
+                    SampleBank::AdpcmBlockFrames;
+                buffer->data.resize(static_cast<size_t>(blockCount) * wav.mChannels *
+                    SampleBank::AdpcmBlockSize);
+
+                auto* block = buffer->data.data();
+                for (unsigned channel = 0u; channel < wav.mChannels; ++channel) {
+                    const float* src = wav.mData + static_cast<size_t>(channel) * wav.mSampleCount;
+                    for (unsigned i = 0u; i < blockCount; ++i) {
+                        unsigned first = i * SampleBank::AdpcmBlockFrames;
+                        encodeAdpcmBlock(src + first, std::min(SampleBank::AdpcmBlockFrames,
+                            wav.mSampleCount - first), block);
+                        block += SampleBank::AdpcmBlockSize;
+                    }
+                }
+                break;
+            }
+            default: {
+                auto* bytes = reinterpret_cast<const uint8_t*>(wav.mData);
+                buffer->data.assign(bytes, bytes + samples * sizeof(float));
+                break;
+            }
+        }
+
+        return SampleBank::BufferPtr(buffer);
+    }
+
+    SampleBank::BufferPtr decode(const std::string& name, const uint8_t* data, size_t size,
+        SampleBank::Format format)
+    {
+        char key[32];
+        std::snprintf(key, sizeof(key), ":%016" PRIx64 ":%u", hashData(data, size), format);
+        std::string fullKey = name + key;
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto it = buffers.find(fullKey);
+            if (it != buffers.end()) {
+                auto buffer = it->second.lock();
+                if (buffer) return buffer;
+            }
+        }
+
+        SoLoud::Wav wav;
+        if (wav.loadMem(const_cast<uint8_t*>(data), static_cast<unsigned>(size), false, false) !=
+            SoLoud::SO_NO_ERROR || !wav.mData) {
+            return nullptr;
+        }
+
+        auto buffer = convert(wav, format);
+
+        std::lock_guard<std::mutex> lock(mutex);
+
+        // Forget the buffers nobody uses anymore
+        for (auto it = buffers.begin(); it != buffers.end();) {
+            it = it->second.expired() ? buffers.erase(it) : std::next(it);
+        }
+
+        // Another thread may have decoded the same content in the meantime
+        auto& entry = buffers[fullKey];
+        auto existing = entry.lock();
+        if (existing) return existing;
+
+        entry = buffer;
+        return buffer;
+    }
+}
+
+namespace SampleBank
+{
+    Buffer::Buffer(Format format, unsigned channels, float samplerate, unsigned frameCount) :
+        format(format),
+        channels(channels),
+        samplerate(samplerate),
+        frameCount(frameCount)
+    {
+        // Nothing else to do
+    }
+
+    void Buffer::read(unsigned channel, unsigned frame, unsigned count, float* dst,
+        float* blockCache, unsigned& cachedBlock) const
+    {
+        size_t first = static_cast<size_t>(channel) * frameCount + frame;
+
+        switch (format) {
+            case Int16: {
+                auto* src = reinterpret_cast<const int16_t*>(data.data()) + first;
+                for (unsigned i = 0u; i < count; ++i) dst[i] = src[i] / 32768.f;
+                break;
+            }
+            case Adpcm: {
+                unsigned blockCount = (frameCount + AdpcmBlockFrames - 1u) / AdpcmBlockFrames;
+                while (count > 0u) {
+                    unsigned block = frame / AdpcmBlockFrames;
+                    if (cachedBlock != block) {
+                        decodeAdpcmBlock(data.data() + (static_cast<size_t>(channel) * blockCount +
+                            block) * AdpcmBlockSize, blockCache);
+                        cachedBlock = block;
+                    }
+
+                    unsigned offset = frame % AdpcmBlockFrames;
+                    unsigned copied = std::min(count, AdpcmBlockFrames - offset);
+                    std::memcpy(dst, blockCache + offset, copied * sizeof(float));
+
+                    dst += copied;
+                    frame += copied;
+                    count -= copied;
+                }
+                break;
+            }
+            default: {
+                std::memcpy(dst, reinterpret_cast<const float*>(data.data()) + first,
+                    count * sizeof(float));
+                break;
+            }
+        }
+    }
+
+    BufferPtr load(const std::string& filename, Format format)
+    {
+        Stream stream;
+        size_t size;
+        if (!stream.open(filename, Stream::Read) || !stream.size(size)) return nullptr;
+
+        std::vector<uint8_t> data(size);
+        if (!stream.readArray(data.data(), size, 1u)) return nullptr;
+
+        return decode(filename, data.data(), size, format);
+    }
+
+    BufferPtr load(const void* data, size_t size, Format format)
+    {
+        return decode("memory", static_cast<const uint8_t*>(data), size, format);
+    }
+
+    size_t residentMemory()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        size_t total = 0u;
+        for (const auto& entry : buffers) {
+            auto buffer = entry.second.lock();
+            if (buffer) total += buffer->data.size();
+        }
+
+        return total;
+    }
+
+    size_t bufferCount()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        return std::count_if(buffers.begin(), buffers.end(),
+            [](const decltype(buffers)::value_type& entry) { return !entry.second.expired(); });
+    }
+}
@@ -0,0 +1,76 @@
+/*
+    This is free and unencumbered software released into the public domain.
+
+    Anyone is free to copy, modify, publish, use, compile, sell, or
+    distribute this software, either in source code form or as a compiled
+    binary, for any purpose, commercial or non-commercial, and by any
+    means.
+
+    In jurisdictions that recognize copyright laws, the author or authors
+    of this software dedicate any and all copyright interest in the
+    software to the public domain. We make this dedication for the benefit
+    of the public at large and to the detriment of our heirs and
+    successors. We intend this dedication to be an overt act of
+    relinquishment in perpetuity of all present and future rights to this
+    software under copyright law.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+    MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+    IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+    OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+    ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+    OTHER DEALINGS IN THE SOFTWARE.
+
+    For more information, please refer to <http://unlicense.org>
+*/
+
+#pragma once
+#include "../config.hpp"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+// Decoded PCM shared by every static audio source playing the same content
+// Buffers are keyed by path, content hash and format, and live as long as a source uses them
+namespace SampleBank
+{
+    enum Format : uint32_t {
+        Float32,
+        Int16,
+        Adpcm
+    };
+
+    // IMA-ADPCM is stored in independent blocks, so any frame can be decoded without the ones before
+    static const unsigned AdpcmBlockFrames = 1024u;
+    static const unsigned AdpcmBlockSize   = 4u + AdpcmBlockFrames / 2u;
+
+    class Buffer
+    {
+    public:
+        Buffer(Format format, unsigned channels, float samplerate, unsigned frameCount);
+
+        // Converts count frames of a channel to floats, ADPCM blocks are decoded into blockCache
+        // which holds AdpcmBlockFrames floats, cachedBlock tells which block it holds
+        void read(unsigned channel, unsigned frame, unsigned count, float* dst,
+            float* blockCache, unsigned& cachedBlock) const;
+
+        Format format;
+        unsigned channels;
+        float samplerate;
+        unsigned frameCount;
+        std::vector<uint8_t> data;
+    };
+
+    using BufferPtr = std::shared_ptr<const Buffer>;
+
+    // Decodes a file or a buffer, unless the same content is already in the bank
+    // Returns nullptr if the data can't be decoded
+    BufferPtr load(const std::string& filename, Format format);
+    BufferPtr load(const void* data, size_t size, Format format);
+
+    // Memory used by the decoded buffers currently alive, in bytes
+    size_t residentMemory();
+    size_t bufferCount();
+}
@@ -0,0 +1,353 @@
+/*
+    This is free and unencumbered software released into the public domain.
+
+    Anyone is free to copy, modify, publish, use, compile, sell, or
+    distribute this software, either in source code form or as a compiled
+    binary, for any purpose, commercial or non-commercial, and by any
+    means.
+
+    In jurisdictions that recognize copyright laws, the author or authors
+    of this software dedicate any and all copyright interest in the
+    software to the public domain. We make this dedication for the benefit
+    of the public at large and to the detriment of our heirs and
+    successors. We intend this dedication to be an overt act of
+    relinquishment in perpetuity of all present and future rights to this
+    software under copyright law.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+    MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+    IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+    OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+    ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+    OTHER DEALINGS IN THE SOFTWARE.
+
+    For more information, please refer to <http://unlicense.org>
+*/
+
+#include "streamfile.hpp"
+
+#include <physfs/physfs.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <thread>
+
+// Locals
+namespace
+{
+    struct Streamer
+    {
+        std::mutex mutex;
+        std::condition_variable ioCondition;
+        std::condition_variable dataCondition;
+        std::vector<Audio::StreamFile*> streams;
+        bool running {false};
+        std::atomic<uint32_t> underruns {0u};
+    };
+
+    // Never destroyed, the detached I/O thread may still be winding down at exit
+    Streamer& streamer()
+    {
+        static auto* instance = new Streamer();
+        return *instance;
+    }
+}
+
+namespace Audio
+{
+    const unsigned StreamFile::HeadSize;
+    const unsigned StreamFile::RingSize;
+    const unsigned StreamFile::ChunkSize;
+    const unsigned StreamFile::ReadTimeoutMs;
+
+    StreamFile::~StreamFile()
+    {
+        if (!mFile) return;
+
+        {
+            auto& state = streamer();
+            std::unique_lock<std::mutex> lock(state.mutex);
+
+            auto& streams = state.streams;
+            streams.erase(std::remove(streams.begin(), streams.end(), this), streams.end());
+            state.ioCondition.notify_one();
+
+            // The I/O thread might be reading for this stream right now
+            state.dataCondition.wait(lock, [this] { return !mBusy; });
+        }
+
+        PHYSFS_close(mFile);
+    }
+
+    bool StreamFile::open(const char* filename)
+    {
+        if (mFile) return false;
+
+        mFile = PHYSFS_openRead(filename);
+        if (!mFile) return false;
+
+        auto length = PHYSFS_fileLength(mFile);
+        mLength = length > 0 ? static_cast<unsigned>(length) : 0u;
+
+        // The head is read right away, it's what parsing the header goes through anyway
+        mHead.resize(std::min(mLength, HeadSize));
+        auto status = PHYSFS_readBytes(mFile, mHead.data(), mHead.size());
+        mHead.resize(status > 0 ? static_cast<size_t>(status) : 0u);
+
+        mRing.resize(RingSize);
+        mRingStart = static_cast<unsigned>(mHead.size());
+
+        auto& state = streamer();
+        std::lock_guard<std::mutex> lock(state.mutex);
+
+        state.streams.push_back(this);
+        if (!state.running) {
+            state.running = true;
+            std::thread(ioLoop).detach();
+        }
+        state.ioCondition.notify_one();
+
+        return true;
+    }
+
+    void StreamFile::setRealtime(bool realtime)
+    {
+        std::lock_guard<std::mutex> lock(streamer().mutex);
+        mRealtime = realtime;
+    }
+
+    int StreamFile::eof()
+    {
+        return mPosition >= mLength;
+    }
+
+    unsigned int StreamFile::read(unsigned char* dst, unsigned int bytes)
+    {
+        if (!mFile) return 0u;
+
+        bytes = std::min(bytes, mLength - std::min(mPosition, mLength));
+        unsigned total = 0u;
+
+        if (mPosition < mHead.size()) {
+            unsigned count = std::min(bytes, static_cast<unsigned>(mHead.size()) - mPosition);
+            std::memcpy(dst, mHead.data() + mPosition, count);
+
+            mPosition += count;
+            total += count;
+            bytes -= count;
+        }
+
+        if (bytes == 0u) return total;
+
+        auto& state = streamer();
+        std::unique_lock<std::mutex> lock(state.mutex);
+
+        while (bytes > 0u) {
+            reposition();
+
+            if (mRingSize == 0u) {
+                if (mFailed) break;
+
+                // The reader caught up with the I/O thread, decoders take a short read for
+                // the end of the file so it's only returned once the wait timed out
+                if (!waitForData(lock, mRingStart + 1u)) break;
+                continue;
+            }
+
+            unsigned count = std::min(bytes, mRingSize);
+            consume(dst + total, count);
+
+            mPosition += count;
+            total += count;
+            bytes -= count;
+        }
+
+        if (needsData()) state.ioCondition.notify_one();
+
+        return total;
+    }
+
+    int StreamFile::ready(unsigned int bytes)
+    {
+        if (!mFile) return 1;
+
+        // The head is always there, and the ring can't hold more than its size past it
+        unsigned start = std::max(mPosition, static_cast<unsigned>(mHead.size()));
+        unsigned end = std::min(mPosition + std::min(bytes, mLength - std::min(mPosition, mLength)),
+            start + RingSize);
+        if (end <= start) return 1;
+
+        auto& state = streamer();
+        std::unique_lock<std::mutex> lock(state.mutex);
+
+        reposition();
+        return mFailed || mRingStart + mRingSize >= end || waitForData(lock, end);
+    }
+
+    unsigned int StreamFile::length()
+    {
+        return mLength;
+    }
+
+    void StreamFile::seek(int offset)
+    {
+        if (!mFile) return;
+
+        mPosition = std::min(static_cast<unsigned>(std::max(offset, 0)), mLength);
+
+        // Start prefetching from the new position right away
+        auto& state = streamer();
+        std::lock_guard<std::mutex> lock(state.mutex);
+        reposition();
+        if (needsData()) state.ioCondition.notify_one();
+    }
+
+    unsigned int StreamFile::pos()
+    {
+        return mPosition;
+    }
+
+    StreamFile::Health StreamFile::health() const
+    {
+        std::lock_guard<std::mutex> lock(streamer().mutex);
+
+        // Relative to what can still be buffered, the ring can't fill up near the end
+        unsigned fillable = std::min(RingSize, mLength - std::min(mRingStart, mLength));
+        float fillLevel = fillable > 0u ? std::min(1.f, mRingSize / static_cast<float>(fillable)) : 1.f;
+
+        return {mUnderruns, fillLevel};
+    }
+
+    uint32_t StreamFile::totalUnderruns()
+    {
+        return streamer().underruns;
+    }
+
+    void StreamFile::ioLoop()
+    {
+        auto& state = streamer();
+        std::vector<uint8_t> chunk(ChunkSize);
+
+        std::unique_lock<std::mutex> lock(state.mutex);
+        while (true) {
+            if (state.streams.empty()) {
+                state.running = false;
+                return;
+            }
+
+            // Serve the emptiest ring first
+            StreamFile* stream = nullptr;
+            float lowestFill = 2.f;
+            for (auto* candidate : state.streams) {
+                if (!candidate->needsData()) continue;
+
+                float fill = candidate->mRingSize / static_cast<float>(RingSize);
+                if (fill < lowestFill) {
+                    stream = candidate;
+                    lowestFill = fill;
+                }
+            }
+
+            if (!stream) {
+                state.ioCondition.wait(lock);
+                continue;
+            }
+
+            unsigned offset = stream->mRingStart + stream->mRingSize;
+            unsigned count = std::min(std::min(ChunkSize, RingSize - stream->mRingSize),
+                stream->mLength - offset);
+            auto generation = stream->mGeneration;
+            stream->mBusy = true;
+
+            // Only this thread touches the PhysFS file once it's open
+            lock.unlock();
+            bool succeeded = static_cast<unsigned>(PHYSFS_tell(stream->mFile)) == offset ||
+                PHYSFS_seek(stream->mFile, offset) != 0;
+            auto status = succeeded ? PHYSFS_readBytes(stream->mFile, chunk.data(), count) : -1;
+            lock.lock();
+
+            stream->mBusy = false;
+
+            // Drop the data if the reader seeked away in the meantime
+            if (stream->mGeneration == generation) {
+                if (status == static_cast<PHYSFS_sint64>(count)) {
+                    unsigned write = (stream->mRingRead + stream->mRingSize) % RingSize;
+                    unsigned first = std::min(count, RingSize - write);
+                    std::memcpy(stream->mRing.data() + write, chunk.data(), first);
+                    std::memcpy(stream->mRing.data(), chunk.data() + first, count - first);
+                    stream->mRingSize += count;
+                }
+                else {
+                    stream->mFailed = true;
+                }
+            }
+
+            state.dataCondition.notify_all();
+        }
+    }
+
+    bool StreamFile::waitForData(std::unique_lock<std::mutex>& lock, unsigned end)
+    {
+        auto& state = streamer();
+        if (needsData()) state.ioCondition.notify_one();
+
+        auto generation = mGeneration;
+        auto ready = [this, generation, end] {
+            return mRingStart + mRingSize >= end || mFailed || mGeneration != generation;
+        };
+
+        // Parsing happens before the stream plays, it can wait for the disk
+        if (!mRealtime) {
+            state.dataCondition.wait(lock, ready);
+            return true;
+        }
+
+        ++mUnderruns;
+        ++state.underruns;
+        return state.dataCondition.wait_for(lock, std::chrono::milliseconds(ReadTimeoutMs), ready);
+    }
+
+    bool StreamFile::needsData() const
+    {
+        unsigned end = mRingStart + mRingSize;
+        if (mFailed || end >= mLength) return false;
+
+        return RingSize - mRingSize >= std::min(ChunkSize, mLength - end);
+    }
+
+    void StreamFile::reposition()
+    {
+        // Reads from the head still need the ring to be ready right after it
+        unsigned target = std::max(mPosition, static_cast<unsigned>(mHead.size()));
+
+        if (target < mRingStart || target > mRingStart + mRingSize) {
+            mRingStart = target;
+            mRingSize = 0u;
+            mRingRead = 0u;
+            mFailed = false;
+            ++mGeneration;
+        }
+        else {
+            unsigned skipped = target - mRingStart;
+            mRingStart += skipped;
+            mRingSize -= skipped;
+            mRingRead = (mRingRead + skipped) % RingSize;
+        }
+    }
+
+    void StreamFile::consume(unsigned char* dst, unsigned count)
+    {
+        unsigned first = std::min(count, RingSize - mRingRead);
+        std::memcpy(dst, mRing.data() + mRingRead, first);
+        std::memcpy(dst + first, mRing.data(), count - first);
+
+        mRingStart += count;
+        mRingSize -= count;
+        mRingRead = (mRingRead + count) % RingSize;
+    }
+}
@@ -0,0 +1,101 @@
+/*
+    This is free and unencumbered software released into the public domain.
+
+    Anyone is free to copy, modify, publish, use, compile, sell, or
+    distribute this software, either in source code form or as a compiled
+    binary, for any purpose, commercial or non-commercial, and by any
+    means.
+
+    In jurisdictions that recognize copyright laws, the author or authors
+    of this software dedicate any and all copyright interest in the
+    software to the public domain. We make this dedication for the benefit
+    of the public at large and to the detriment of our heirs and
+    successors. We intend this dedication to be an overt act of
+    relinquishment in perpetuity of all present and future rights to this
+    software under copyright law.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+    MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+    IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+    OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+    ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+    OTHER DEALINGS IN THE SOFTWARE.
+
+    For more information, please refer to <http://unlicense.org>
+*/
+
+#pragma once
+#include "../config.hpp"
+
+#include <soloud/soloud_file.h>
+
+#include <mutex>
+#include <vector>
+
+struct PHYSFS_File;
+namespace Audio
+{
+    // SoLoud file read ahead by a background I/O thread, so the mixer never waits on PhysFS
+    // The start of the file is always kept in memory, decoders seek back to it when looping
+    class StreamFile : public SoLoud::File
+    {
+    public:
+        static const unsigned HeadSize  = 64u * 1024u;
+        static const unsigned RingSize  = 256u * 1024u;
+        static const unsigned ChunkSize = 32u * 1024u;
+
+        // Longest the mixer waits for the I/O thread before it gives up on the data for now
+        static const unsigned ReadTimeoutMs = 2u;
+
+        struct Health
+        {
+            uint32_t underruns;
+            float fillLevel;
+        };
+
+        StreamFile() = default;
+        ~StreamFile();
+
+        bool open(const char* filename);
+
+        // Once realtime, reads that catch up with the I/O thread are counted as underruns
+        // and only wait a few milliseconds for it, the mixer holds the engine's lock meanwhile
+        void setRealtime(bool realtime);
+
+        virtual int eof();
+        virtual unsigned int read(unsigned char* dst, unsigned int bytes);
+        virtual int ready(unsigned int bytes);
+        virtual unsigned int length();
+        virtual void seek(int offset);
+        virtual unsigned int pos();
+
+        Health health() const;
+        static uint32_t totalUnderruns();
+
+    private:
+        static void ioLoop();
+
+        bool needsData() const;
+        void reposition();
+        bool waitForData(std::unique_lock<std::mutex>& lock, unsigned end);
+        void consume(unsigned char* dst, unsigned count);
+
+        PHYSFS_File* mFile {nullptr};
+        unsigned mLength {0u};
+        unsigned mPosition {0u};
+        std::vector<uint8_t> mHead;
+
+        // File range [mRingStart, mRingStart + mRingSize) starting at index mRingRead
+        std::vector<uint8_t> mRing;
+        unsigned mRingStart {0u};
+        unsigned mRingSize {0u};
+        unsigned mRingRead {0u};
+
+        uint32_t mGeneration {0u};
+        uint32_t mUnderruns {0u};
+        bool mRealtime {false};
+        bool mBusy {false};
+        bool mFailed {false};
+    };
+}
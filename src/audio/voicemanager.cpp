@@ -0,0 +1,360 @@
+/*
+    This is free and unencumbered software released into the public domain.
+
+    Anyone is free to copy, modify, publish, use, compile, sell, or
+    distribute this software, either in source code form or as a compiled
+    binary, for any purpose, commercial or non-commercial, and by any
+    means.
+
+    In jurisdictions that recognize copyright laws, the author or authors
+    of this software dedicate any and all copyright interest in the
+    software to the public domain. We make this dedication for the benefit
+    of the public at large and to the detriment of our heirs and
+    successors. We intend this dedication to be an overt act of
+    relinquishment in perpetuity of all present and future rights to this
+    software under copyright law.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+    MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+    IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+    OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+    ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+    OTHER DEALINGS IN THE SOFTWARE.
+
+    For more information, please refer to <http://unlicense.org>
+*/
+
+#include "voicemanager.hpp"
+#include "audio.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+// Locals
+namespace
+{
+    struct Emitter
+    {
+        SoLoud::AudioSource* const* source;
+        double length;
+        double time;
+        float volume;
+        float priority;
+        float position[3];
+        float velocity[3];
+        SoLoud::handle voice;
+        float score;
+        uint32_t generation;
+        bool used;
+        bool playing;
+    };
+
+    // Time it takes to fade out a demoted voice, hides clicks
+    constexpr float FadeTime = 0.02f;
+
+    // Real voices get a small edge so that emitters at the cut-off don't swap every frame
+    constexpr float Hysteresis = 1.1f;
+
+    // Below this an emitter isn't worth a voice even if there are free ones
+    constexpr float MinAudibility = 0.001f;
+
+    // Ids are the slot index plus one in the low bits and the slot's generation in the high ones,
+    // so that ids of removed emitters don't reach whatever reuses their slot
+    constexpr uint32_t IndexBits = 20u;
+    constexpr uint32_t IndexMask = (1u << IndexBits) - 1u;
+
+    std::vector<Emitter> emitters;
+    std::vector<uint32_t> freeSlots;
+    std::vector<uint32_t> ranking;
+    uint32_t maxVoices {16u};
+    VoiceManager::Stats lastStats {0u, 0u, 0u, 0u};
+
+    Emitter* get(uint32_t id)
+    {
+        uint32_t index = (id & IndexMask) - 1u;
+        if ((id & IndexMask) == 0u || index >= emitters.size()) return nullptr;
+
+        auto& emitter = emitters[index];
+        if (!emitter.used || emitter.generation != id >> IndexBits) return nullptr;
+        return &emitter;
+    }
+
+    // Frees the slot, ids handed out for it so far stop matching
+    void freeSlot(uint32_t index)
+    {
+        auto& emitter = emitters[index];
+        emitter.used = false;
+        emitter.voice = 0u;
+        emitter.generation = (emitter.generation + 1u) & (~0u >> IndexBits);
+        freeSlots.push_back(index);
+    }
+
+    bool isLooping(const Emitter& emitter)
+    {
+        return (**emitter.source).mFlags & SoLoud::AudioSource::SHOULD_LOOP;
+    }
+
+    float attenuation(const Emitter& emitter, const float* listener)
+    {
+        const auto& source = **emitter.source;
+
+        float dx = emitter.position[0];
+        float dy = emitter.position[1];
+        float dz = emitter.position[2];
+        if (!(source.mFlags & SoLoud::AudioSource::LISTENER_RELATIVE)) {
+            dx -= listener[0];
+            dy -= listener[1];
+            dz -= listener[2];
+        }
+
+        float minDist = source.m3dMinDistance;
+        float maxDist = source.m3dMaxDistance;
+        float rolloff = source.m3dAttenuationRolloff;
+        float dist = std::min(std::max(std::sqrt(dx * dx + dy * dy + dz * dz), minDist), maxDist);
+
+        // Same models as SoLoud's, so ranking follows what would actually be heard
+        switch (source.m3dAttenuationModel) {
+            case SoLoud::AudioSource::INVERSE_DISTANCE:
+                return minDist / (minDist + rolloff * (dist - minDist));
+            case SoLoud::AudioSource::LINEAR_DISTANCE:
+                if (maxDist <= minDist) return 1.f;
+                return 1.f - rolloff * (dist - minDist) / (maxDist - minDist);
+            case SoLoud::AudioSource::EXPONENTIAL_DISTANCE:
+                return std::pow(dist / minDist, -rolloff);
+            default:
+                return 1.f;
+        }
+    }
+
+    void advance(Emitter& emitter, double time)
+    {
+        emitter.time = time;
+        if (emitter.length <= 0.0 || emitter.time < emitter.length) return;
+
+        if (isLooping(emitter)) {
+            emitter.time = std::fmod(emitter.time, emitter.length);
+        }
+        else {
+            emitter.playing = false;
+        }
+    }
+
+    void promote(Emitter& emitter)
+    {
+        auto& soloud = Audio::instance();
+
+        // Start paused so the seek happens before anything gets mixed
+        // The mixer ramps new voices up from silence, no need to fade them in
+        emitter.voice = soloud.play3d(**emitter.source, emitter.position[0], emitter.position[1],
+            emitter.position[2], emitter.velocity[0], emitter.velocity[1], emitter.velocity[2],
+            emitter.volume, true);
+        if (emitter.time > 0.0) soloud.seek(emitter.voice, emitter.time);
+        soloud.setPause(emitter.voice, false);
+    }
+
+    void demote(Emitter& emitter)
+    {
+        auto& soloud = Audio::instance();
+
+        soloud.fadeVolume(emitter.voice, 0.f, FadeTime);
+        soloud.scheduleStop(emitter.voice, FadeTime);
+        emitter.voice = 0u;
+    }
+}
+
+namespace VoiceManager
+{
+    uint32_t add(SoLoud::AudioSource* const* source, double length, float volume,
+        float priority)
+    {
+        uint32_t index;
+        if (freeSlots.empty()) {
+            if (emitters.size() >= IndexMask) return 0u;
+
+            index = emitters.size();
+            emitters.emplace_back();
+        }
+        else {
+            index = freeSlots.back();
+            freeSlots.pop_back();
+        }
+
+        uint32_t generation = emitters[index].generation;
+        emitters[index] = Emitter {
+            source, length, 0.0, volume, priority, {0.f, 0.f, 0.f}, {0.f, 0.f, 0.f}, 0u, 0.f,
+            generation, true, true
+        };
+
+        return (generation << IndexBits) | (index + 1u);
+    }
+
+    void remove(uint32_t id)
+    {
+        auto* emitter = get(id);
+        if (!emitter) return;
+
+        if (emitter->voice) Audio::instance().stop(emitter->voice);
+        freeSlot((id & IndexMask) - 1u);
+    }
+
+    void setPosition(uint32_t id, float x, float y, float z)
+    {
+        auto* emitter = get(id);
+        if (!emitter) return;
+
+        emitter->position[0] = x;
+        emitter->position[1] = y;
+        emitter->position[2] = z;
+    }
+
+    void setVelocity(uint32_t id, float x, float y, float z)
+    {
+        auto* emitter = get(id);
+        if (!emitter) return;
+
+        emitter->velocity[0] = x;
+        emitter->velocity[1] = y;
+        emitter->velocity[2] = z;
+    }
+
+    void setVolume(uint32_t id, float volume)
+    {
+        auto* emitter = get(id);
+        if (!emitter) return;
+
+        emitter->volume = volume;
+        if (emitter->voice) Audio::instance().setVolume(emitter->voice, volume);
+    }
+
+    void setPriority(uint32_t id, float priority)
+    {
+        auto* emitter = get(id);
+        if (emitter) emitter->priority = priority;
+    }
+
+    bool isPlaying(uint32_t id)
+    {
+        auto* emitter = get(id);
+        return emitter && emitter->playing;
+    }
+
+    bool isReal(uint32_t id)
+    {
+        auto* emitter = get(id);
+        return emitter && emitter->voice;
+    }
+
+    double position(uint32_t id)
+    {
+        auto* emitter = get(id);
+        return emitter ? emitter->time : 0.0;
+    }
+
+    void setMaxRealVoices(uint32_t count)
+    {
+        maxVoices = count;
+    }
+
+    uint32_t maxRealVoices()
+    {
+        return maxVoices;
+    }
+
+    void update(double dt)
+    {
+        auto& soloud = Audio::instance();
+        const float* listener = soloud.m3dPosition;
+
+        lastStats = Stats {0u, 0u, 0u, 0u};
+        ranking.clear();
+
+        for (uint32_t i = 0u; i < emitters.size(); ++i) {
+            auto& emitter = emitters[i];
+            if (!emitter.used || !emitter.playing) continue;
+
+            if (emitter.voice) {
+                // A real voice that went away either ended or had its source released
+                if (!soloud.isValidVoiceHandle(emitter.voice)) {
+                    emitter.voice = 0u;
+                    emitter.playing = false;
+                    continue;
+                }
+                advance(emitter, soloud.getStreamTime(emitter.voice));
+            }
+            else {
+                advance(emitter, emitter.time + dt);
+                if (!emitter.playing) continue;
+            }
+
+            ++lastStats.emitters;
+            emitter.score = emitter.priority * emitter.volume * attenuation(emitter, listener);
+            if (emitter.voice) emitter.score *= Hysteresis;
+            if (emitter.score >= MinAudibility) ranking.push_back(i);
+        }
+
+        // Only the top of the ranking needs to be ordered
+        auto count = std::min<size_t>(maxVoices, ranking.size());
+        std::nth_element(ranking.begin(), ranking.begin() + count, ranking.end(),
+            [](uint32_t a, uint32_t b) {
+                return emitters[a].score > emitters[b].score;
+            });
+
+        for (size_t i = count; i < ranking.size(); ++i) {
+            auto& emitter = emitters[ranking[i]];
+            if (emitter.voice) {
+                demote(emitter);
+                ++lastStats.demotions;
+            }
+        }
+
+        // Emitters that fell under the audibility threshold aren't ranked at all
+        for (auto& emitter : emitters) {
+            if (emitter.voice && emitter.score < MinAudibility) {
+                demote(emitter);
+                ++lastStats.demotions;
+            }
+        }
+
+        for (size_t i = 0u; i < count; ++i) {
+            auto& emitter = emitters[ranking[i]];
+            if (!emitter.voice) {
+                promote(emitter);
+                ++lastStats.promotions;
+            }
+            else {
+                soloud.set3dSourceParameters(emitter.voice, emitter.position[0], emitter.position[1],
+                    emitter.position[2], emitter.velocity[0], emitter.velocity[1], emitter.velocity[2]);
+            }
+        }
+
+        lastStats.real = count;
+        soloud.update3dAudio();
+    }
+
+    void clear()
+    {
+        // Slots are kept for their generations, emitters created before stay invalid
+        auto& soloud = Audio::instance();
+        freeSlots.clear();
+        for (uint32_t i = 0u; i < emitters.size(); ++i) {
+            auto& emitter = emitters[i];
+            if (emitter.voice) soloud.stop(emitter.voice);
+
+            if (emitter.used) {
+                freeSlot(i);
+            }
+            else {
+                freeSlots.push_back(i);
+            }
+        }
+
+        ranking.clear();
+    }
+
+    Stats stats()
+    {
+        return lastStats;
+    }
+}
@@ -0,0 +1,70 @@
+/*
+    This is free and unencumbered software released into the public domain.
+
+    Anyone is free to copy, modify, publish, use, compile, sell, or
+    distribute this software, either in source code form or as a compiled
+    binary, for any purpose, commercial or non-commercial, and by any
+    means.
+
+    In jurisdictions that recognize copyright laws, the author or authors
+    of this software dedicate any and all copyright interest in the
+    software to the public domain. We make this dedication for the benefit
+    of the public at large and to the detriment of our heirs and
+    successors. We intend this dedication to be an overt act of
+    relinquishment in perpetuity of all present and future rights to this
+    software under copyright law.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+    MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+    IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+    OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+    ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+    OTHER DEALINGS IN THE SOFTWARE.
+
+    For more information, please refer to <http://unlicense.org>
+*/
+
+#pragma once
+#include "../config.hpp"
+
+#include <soloud/soloud.h>
+
+// Keeps large amounts of 3D emitters alive while only mixing the most audible ones
+// Virtual emitters track their play position and resume where they would be when promoted
+// Not thread-safe, meant to be driven from the main thread once per frame
+namespace VoiceManager
+{
+    struct Stats
+    {
+        uint32_t emitters;
+        uint32_t real;
+        uint32_t promotions;
+        uint32_t demotions;
+    };
+
+    // The source is referenced through its owner's slot, since sources get replaced on reload
+    // Ids of removed emitters are ignored by every function, even once their slot is reused
+    uint32_t add(SoLoud::AudioSource* const* source, double length, float volume, float priority);
+    void remove(uint32_t id);
+
+    void setPosition(uint32_t id, float x, float y, float z);
+    void setVelocity(uint32_t id, float x, float y, float z);
+    void setVolume(uint32_t id, float volume);
+    void setPriority(uint32_t id, float priority);
+
+    bool isPlaying(uint32_t id);
+    bool isReal(uint32_t id);
+    double position(uint32_t id);
+
+    void setMaxRealVoices(uint32_t count);
+    uint32_t maxRealVoices();
+
+    // Ranks emitters against the current listener, swaps voices and applies 3D parameters
+    void update(double dt);
+
+    // Stops every voice, used when the audio engine shuts down
+    void clear();
+
+    Stats stats();
+}
@@ -28,6 +28,7 @@
 #include "../config.hpp"
 #include "../system/log.hpp"
 #include "../audio/audio.hpp"
+#include "../audio/voicemanager.hpp"
 
 #include <SDL2/SDL.h>
 
@@ -39,6 +40,7 @@ NX_EXPORT void nxAudioRelease()
 {
     if (!initialized) return;
 
+    VoiceManager::clear();
     Audio::instance().deinit();
 }
 
@@ -163,3 +165,27 @@ NX_EXPORT void nxAudioSetGlobalFilter(NxAudioFilter* filter, uint32_t id)
 {
     Audio::instance().setGlobalFilter(id, filter);
 }
+
+NX_EXPORT void nxAudioUpdateEmitters(double dt)
+{
+    VoiceManager::update(dt);
+}
+
+NX_EXPORT void nxAudioSetMaxRealVoices(uint32_t count)
+{
+    VoiceManager::setMaxRealVoices(count);
+}
+
+NX_EXPORT uint32_t nxAudioMaxRealVoices()
+{
+    return VoiceManager::maxRealVoices();
+}
+
+NX_EXPORT void nxAudioEmitterStats(uint32_t* stats)
+{
+    auto current = VoiceManager::stats();
+    stats[0] = current.emitters;
+    stats[1] = current.real;
+    stats[2] = current.promotions;
+    stats[3] = current.demotions;
+}
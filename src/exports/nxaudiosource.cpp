@@ -27,6 +27,9 @@
 
 #include "../config.hpp"
 #include "../audio/audio.hpp"
+#include "../audio/sample.hpp"
+#include "../audio/streamfile.hpp"
+#include "../audio/voicemanager.hpp"
 
 #include <soloud/soloud_wav.h>
 #include <soloud/soloud_wavstream.h>
@@ -35,7 +38,7 @@ using NxAudioFilter = SoLoud::Filter;
 struct NxAudioSource
 {
     SoLoud::AudioSource* handle;
-    Audio::File* file; // Used if the audio source needs an active file
+    Audio::StreamFile* file; // Used if the audio source needs an active file
 };
 
 NX_EXPORT NxAudioSource* nxAudioSourceCreate()
@@ -54,52 +57,75 @@ NX_EXPORT void nxAudioSourceRelease(NxAudioSource* source)
     delete source;
 }
 
-NX_EXPORT void nxAudioSourceLoadFile(NxAudioSource* source, const char* filename)
+NX_EXPORT void nxAudioSourceLoadFile(NxAudioSource* source, const char* filename, uint32_t format)
 {
-    delete source->file;
-    source->file = nullptr;
+    auto* sample = new Audio::Sample();
+    sample->load(filename, static_cast<SampleBank::Format>(format));
 
-    Audio::File file;
-    file.open(filename);
+    // Stopping the previous source first, its voices may still be reading the file
+    delete source->handle;
+    source->handle = sample;
 
-    delete static_cast<SoLoud::Wav*>(source->handle);
-    source->handle = new SoLoud::Wav();
-    static_cast<SoLoud::Wav*>(source->handle)->loadFile(&file);
+    delete source->file;
+    source->file = nullptr;
 }
 
-NX_EXPORT void nxAudioSourceLoadMemory(NxAudioSource* source, uint8_t* buffer, uint32_t size)
+NX_EXPORT void nxAudioSourceLoadMemory(NxAudioSource* source, uint8_t* buffer, uint32_t size,
+    uint32_t format)
 {
+    auto* sample = new Audio::Sample();
+    sample->load(buffer, size, static_cast<SampleBank::Format>(format));
+
+    // Stopping the previous source first, its voices may still be reading the file
+    delete source->handle;
+    source->handle = sample;
+
     delete source->file;
     source->file = nullptr;
-
-    delete static_cast<SoLoud::Wav*>(source->handle);
-    source->handle = new SoLoud::Wav();
-    static_cast<SoLoud::Wav*>(source->handle)->loadMem(buffer, size, true, false);
 }
 
 NX_EXPORT double nxAudioSourceStaticLength(NxAudioSource* source)
 {
-    return static_cast<SoLoud::Wav*>(source->handle)->getLength();
+    return static_cast<Audio::Sample*>(source->handle)->getLength();
+}
+
+NX_EXPORT uint32_t nxAudioSourceStaticMemorySize(NxAudioSource* source)
+{
+    return static_cast<uint32_t>(static_cast<Audio::Sample*>(source->handle)->getMemorySize());
+}
+
+NX_EXPORT size_t nxAudioSampleBankMemory()
+{
+    return SampleBank::residentMemory();
+}
+
+NX_EXPORT size_t nxAudioSampleBankCount()
+{
+    return SampleBank::bufferCount();
 }
 
 NX_EXPORT void nxAudioSourceOpenFile(NxAudioSource* source, const char* filename)
 {
+    delete static_cast<SoLoud::WavStream*>(source->handle);
+    source->handle = new SoLoud::WavStream();
+
     delete source->file;
-    source->file = new Audio::File();
+    source->file = new Audio::StreamFile();
     source->file->open(filename);
 
-    delete static_cast<SoLoud::WavStream*>(source->handle);
-    source->handle = new SoLoud::WavStream();
+    // Parsing may wait for the disk, the mixer thread may not
     static_cast<SoLoud::WavStream*>(source->handle)->loadFile(source->file);
+    source->file->setRealtime(true);
 }
 
 NX_EXPORT void nxAudioSourceOpenMemory(NxAudioSource* source, uint8_t* buffer, uint32_t size)
 {
+    delete static_cast<SoLoud::WavStream*>(source->handle);
+    source->handle = new SoLoud::WavStream();
+
     delete source->file;
     source->file = nullptr;
 
-    delete static_cast<SoLoud::WavStream*>(source->handle);
-    source->handle = new SoLoud::WavStream();
     static_cast<SoLoud::WavStream*>(source->handle)->loadMem(buffer, size, true, false);
 }
 
@@ -108,6 +134,19 @@ NX_EXPORT double nxAudioSourceStreamLength(NxAudioSource* source)
     return static_cast<SoLoud::WavStream*>(source->handle)->getLength();
 }
 
+NX_EXPORT void nxAudioSourceStreamHealth(const NxAudioSource* source, uint32_t* underruns,
+    float* fillLevel)
+{
+    auto health = source->file ? source->file->health() : Audio::StreamFile::Health {0u, 1.f};
+    *underruns = health.underruns;
+    *fillLevel = health.fillLevel;
+}
+
+NX_EXPORT uint32_t nxAudioStreamUnderruns()
+{
+    return Audio::StreamFile::totalUnderruns();
+}
+
 NX_EXPORT uint32_t nxAudioPlay(NxAudioSource* source, float volume, float pan, bool paused)
 {
     return Audio::instance().play(*source->handle, volume, pan, paused);
@@ -249,3 +288,49 @@ NX_EXPORT const float* nxAudioBusCurrentWaveData(NxAudioSource* bus)
 {
     return static_cast<SoLoud::Bus*>(bus->handle)->getWave();
 }
+
+NX_EXPORT uint32_t nxAudioEmitterCreate(NxAudioSource* source, double length, float volume,
+    float priority)
+{
+    return VoiceManager::add(&source->handle, length, volume, priority);
+}
+
+NX_EXPORT void nxAudioEmitterRelease(uint32_t id)
+{
+    VoiceManager::remove(id);
+}
+
+NX_EXPORT void nxAudioEmitterSetPosition(uint32_t id, float x, float y, float z)
+{
+    VoiceManager::setPosition(id, x, y, z);
+}
+
+NX_EXPORT void nxAudioEmitterSetVelocity(uint32_t id, float x, float y, float z)
+{
+    VoiceManager::setVelocity(id, x, y, z);
+}
+
+NX_EXPORT void nxAudioEmitterSetVolume(uint32_t id, float volume)
+{
+    VoiceManager::setVolume(id, volume);
+}
+
+NX_EXPORT void nxAudioEmitterSetPriority(uint32_t id, float priority)
+{
+    VoiceManager::setPriority(id, priority);
+}
+
+NX_EXPORT bool nxAudioEmitterIsPlaying(uint32_t id)
+{
+    return VoiceManager::isPlaying(id);
+}
+
+NX_EXPORT bool nxAudioEmitterIsReal(uint32_t id)
+{
+    return VoiceManager::isReal(id);
+}
+
+NX_EXPORT double nxAudioEmitterPosition(uint32_t id)
+{
+    return VoiceManager::position(id);
+}
@@ -28,11 +28,112 @@
 #include "../config.hpp"
 #include "../audio/audio.hpp"
 
+#include <algorithm>
+
 struct NxVoiceGroup
 {
     uint32_t handle;
 };
 
+// Only the fields set in the mask are applied
+struct NxVoiceUpdate
+{
+    uint32_t handle;
+    uint32_t mask;
+    float volume;
+    float pan;
+    float playSpeed;
+    bool paused;
+    float position[3];
+    float velocity[3];
+    float minDistance;
+    float maxDistance;
+    uint32_t attenuationModel;
+    float attenuationRolloff;
+    float dopplerFactor;
+};
+
+// Locals
+namespace
+{
+    enum : uint32_t {
+        UpdateVolume         = 1u << 0u,
+        UpdatePan            = 1u << 1u,
+        UpdatePlaySpeed      = 1u << 2u,
+        UpdatePaused         = 1u << 3u,
+        UpdatePosition       = 1u << 4u,
+        UpdateVelocity       = 1u << 5u,
+        UpdateMinMaxDistance = 1u << 6u,
+        UpdateAttenuation    = 1u << 7u,
+        UpdateDopplerFactor  = 1u << 8u,
+        Update3d             = 0x1F0u
+    };
+
+    // Same as SoLoud's own setters, minus the locking
+    void applyUpdate(SoLoud::Soloud& soloud, unsigned voice, const NxVoiceUpdate& update)
+    {
+        if (update.mask & UpdateVolume) {
+            soloud.mVoice[voice]->mVolumeFader.mActive = 0;
+            soloud.setVoiceVolume(voice, update.volume);
+        }
+        if (update.mask & UpdatePan) {
+            soloud.setVoicePan(voice, update.pan);
+        }
+        if (update.mask & UpdatePlaySpeed) {
+            soloud.mVoice[voice]->mRelativePlaySpeedFader.mActive = 0;
+            soloud.setVoiceRelativePlaySpeed(voice, update.playSpeed);
+        }
+        if (update.mask & UpdatePaused) {
+            soloud.setVoicePause(voice, update.paused);
+        }
+
+        auto& data = soloud.m3dData[voice];
+        if (data.mHandle != soloud.getHandleFromVoice(voice)) return;
+
+        if (update.mask & UpdatePosition) {
+            std::copy(update.position, update.position + 3, data.m3dPosition);
+        }
+        if (update.mask & UpdateVelocity) {
+            std::copy(update.velocity, update.velocity + 3, data.m3dVelocity);
+        }
+        if (update.mask & UpdateMinMaxDistance) {
+            data.m3dMinDistance = update.minDistance;
+            data.m3dMaxDistance = update.maxDistance;
+        }
+        if (update.mask & UpdateAttenuation) {
+            data.m3dAttenuationModel   = update.attenuationModel;
+            data.m3dAttenuationRolloff = update.attenuationRolloff;
+        }
+        if (update.mask & UpdateDopplerFactor) {
+            data.m3dDopplerFactor = update.dopplerFactor;
+        }
+    }
+}
+
+NX_EXPORT void nxAudioVoiceBatchUpdate(const NxVoiceUpdate* updates, size_t count)
+{
+    auto& soloud = Audio::instance();
+    uint32_t mask = 0u;
+
+    // A single lock for the whole batch instead of one per setter
+    soloud.lockAudioMutex();
+    for (size_t i = 0u; i < count; ++i) {
+        SoLoud::handle single[2] = {updates[i].handle, 0u};
+        auto* handles = soloud.voiceGroupHandleToArray(updates[i].handle);
+        if (!handles) handles = single;
+
+        for (; *handles; ++handles) {
+            int voice = soloud.getVoiceFromHandle(*handles);
+            if (voice >= 0) applyUpdate(soloud, voice, updates[i]);
+        }
+
+        mask |= updates[i].mask;
+    }
+    soloud.unlockAudioMutex();
+
+    if (mask & Update3d) soloud.update3dAudio();
+}
+
 NX_EXPORT void nxAudioVoiceSeek(uint32_t handle, double position)
 {
     Audio::instance().seek(handle, position);
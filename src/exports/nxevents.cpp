@@ -26,9 +26,14 @@
 */
 
 #include "../config.hpp"
+#include "../system/eventlog.hpp"
+#include "../system/input.hpp"
 
 #include <SDL2/SDL.h>
+#include <algorithm>
+#include <cstring>
 #include <string>
+#include <vector>
 
 enum NxEventType
 {
@@ -70,19 +75,14 @@ using NxWindow = SDL_Window;
 extern NxWindow* nxWindowGet();
 
 struct NxEvent {
+    NxEventType type;
     double a, b, c, d;
     const char* t;
 };
 
-static NxEventType nextEvent(NxEvent* e, int (*func)(SDL_Event*))
+// Fills e from the given SDL event, text payloads are left pointing to SDL's memory
+static NxEventType translateEvent(const SDL_Event& event, NxEvent* e)
 {
-    static std::string strArg;
-
-    SDL_Event event;
-    int pending = func(&event);
-
-    if (pending == 0) return NX_NoEvent;
-
     switch (event.type) {
     case SDL_QUIT:
         return NX_Quit;
@@ -109,7 +109,7 @@ static NxEventType nextEvent(NxEvent* e, int (*func)(SDL_Event*))
                 e->a = 1.0;
                 return NX_MouseFocus;
             case SDL_WINDOWEVENT_LEAVE:
-                e->b = 0.0;
+                e->a = 0.0;
                 return NX_MouseFocus;
             default:
                 return NX_Other;
@@ -117,14 +117,12 @@ static NxEventType nextEvent(NxEvent* e, int (*func)(SDL_Event*))
     case SDL_APP_LOWMEMORY:
         return NX_LowMemory;
     case SDL_TEXTINPUT:
-        strArg = event.text.text;
-        e->t = strArg.data();
+        e->t = event.text.text;
         return NX_TextInput;
     case SDL_TEXTEDITING:
-        strArg = event.text.text;
         e->a = event.edit.start;
         e->b = event.edit.length;
-        e->t = strArg.data();
+        e->t = event.edit.text;
         return NX_TextEdit;
     case SDL_KEYDOWN:
         e->a = event.key.keysym.scancode;
@@ -232,15 +230,147 @@ static NxEventType nextEvent(NxEvent* e, int (*func)(SDL_Event*))
     case SDL_CLIPBOARDUPDATE:
         return NX_ClipboardUpdated;
     case SDL_DROPFILE:
-        strArg = event.drop.file;
-        SDL_free(event.drop.file);
-        e->t = strArg.data();
+        e->t = event.drop.file;
         return NX_FileDropped;
     default:
         return NX_Other;
     }
 }
 
+// Keeps the native input state in step with the events handed to Lua
+static void trackEvent(const NxEvent* e)
+{
+    switch (e->type) {
+        case NX_KeyDown:
+        case NX_KeyUp:
+            Input::keyEvent(static_cast<uint32_t>(e->a), e->type == NX_KeyDown);
+            break;
+        case NX_MouseMotion:
+            Input::mouseMotion(static_cast<float>(e->a), static_cast<float>(e->b),
+                static_cast<float>(e->c), static_cast<float>(e->d));
+            break;
+        case NX_MouseDown:
+        case NX_MouseUp:
+            Input::mouseButton(static_cast<uint32_t>(e->c), e->type == NX_MouseDown);
+            break;
+        case NX_WheelScroll:
+            Input::wheel(static_cast<float>(e->a), static_cast<float>(e->b));
+            break;
+        case NX_GamepadMotion:
+            Input::gamepadAxis(static_cast<int32_t>(e->a), static_cast<uint32_t>(e->b),
+                static_cast<float>(e->c));
+            break;
+        case NX_GamepadButtonDown:
+        case NX_GamepadButtonUp:
+            Input::gamepadButton(static_cast<int32_t>(e->a), static_cast<uint32_t>(e->b),
+                e->type == NX_GamepadButtonDown);
+            break;
+        case NX_GamepadConnect:
+            if (e->b == 0.0) Input::gamepadRemoved(static_cast<int32_t>(e->a));
+            break;
+        case NX_Focus:
+            if (e->a == 0.0) Input::focusLost();
+            break;
+        default:
+            break;
+    }
+}
+
+static void recordEvent(const NxEvent* e)
+{
+    EventLog::Event event {static_cast<uint32_t>(e->type), {e->a, e->b, e->c, e->d}, e->t};
+    EventLog::record(event);
+}
+
+// Live events are dropped while replaying so that only the log drives the game
+// Closing the window still ends the run
+static bool replayInterrupted()
+{
+    SDL_PumpEvents();
+    bool quit = SDL_HasEvent(SDL_QUIT) == SDL_TRUE;
+    SDL_FlushEvents(SDL_FIRSTEVENT, SDL_LASTEVENT);
+
+    return quit;
+}
+
+static NxEventType replayEvent(NxEvent* e)
+{
+    if (EventLog::finished()) return e->type = NX_Quit;
+
+    EventLog::Event event;
+    if (!EventLog::next(event)) return e->type = NX_NoEvent;
+
+    e->type = static_cast<NxEventType>(event.type);
+    e->a = event.values[0];
+    e->b = event.values[1];
+    e->c = event.values[2];
+    e->d = event.values[3];
+    e->t = event.text;
+    trackEvent(e);
+
+    return e->type;
+}
+
+// Merges e into prev if both are motion events of the same source
+static bool coalesceEvent(NxEvent* prev, const NxEvent* e)
+{
+    if (prev->type != e->type) return false;
+
+    switch (e->type) {
+    case NX_MouseMotion:
+        prev->a = e->a;
+        prev->b = e->b;
+        prev->c += e->c;
+        prev->d += e->d;
+        return true;
+    case NX_JoyAxisMotion:
+    case NX_GamepadMotion:
+        if (prev->a != e->a || prev->b != e->b) return false;
+        prev->c = e->c;
+        return true;
+    case NX_JoyBallMotion:
+        if (prev->a != e->a || prev->b != e->b) return false;
+        prev->c += e->c;
+        prev->d += e->d;
+        return true;
+    case NX_TouchMotion:
+        if (prev->a != e->a) return false;
+        prev->b = e->b;
+        prev->c = e->c;
+        return true;
+    default:
+        return false;
+    }
+}
+
+static NxEventType nextEvent(NxEvent* e, int (*func)(SDL_Event*))
+{
+    static std::string strArg;
+
+    if (EventLog::mode() == EventLog::Replaying) {
+        if (replayInterrupted()) return e->type = NX_Quit;
+        return replayEvent(e);
+    }
+
+    SDL_Event event;
+    int pending = func(&event);
+
+    if (pending == 0) return e->type = NX_NoEvent;
+
+    e->t = nullptr;
+    e->type = translateEvent(event, e);
+    trackEvent(e);
+    if (e->type != NX_Other) recordEvent(e);
+    if (e->t) {
+        strArg = e->t;
+        e->t = strArg.data();
+    }
+
+    if (event.type == SDL_DROPFILE) SDL_free(event.drop.file);
+
+    return e->type;
+}
+
 NX_EXPORT NxEventType nxEventWait(NxEvent* e)
 {
     return nextEvent(e, SDL_WaitEvent);
@@ -250,3 +380,94 @@ NX_EXPORT NxEventType nxEventPoll(NxEvent* e)
 {
     return nextEvent(e, SDL_PollEvent);
 }
+
+// Drains up to max pending events into the given array, skipping those we don't handle
+// Text payloads stay valid until the next call
+NX_EXPORT size_t nxEventPollBatch(NxEvent* events, size_t max, bool coalesce)
+{
+    static std::vector<char> textArena;
+    static std::vector<std::pair<size_t, size_t>> textOffsets;
+    textArena.clear();
+    textOffsets.clear();
+
+    // Replayed texts live in the log, no need to copy them
+    if (EventLog::mode() == EventLog::Replaying) {
+        if (replayInterrupted() && max > 0u) {
+            events[0].type = NX_Quit;
+            return 1u;
+        }
+
+        size_t count = 0u;
+        while (count < max) {
+            NxEvent* e = &events[count];
+            auto type = replayEvent(e);
+            if (type == NX_NoEvent) break;
+            if (type == NX_Quit) return count + 1u;
+            if (coalesce && count > 0u && coalesceEvent(&events[count - 1u], e)) continue;
+
+            ++count;
+        }
+
+        return count;
+    }
+
+    SDL_PumpEvents();
+
+    SDL_Event buffer[64];
+    size_t count = 0u;
+    while (count < max) {
+        int toPeek = static_cast<int>(std::min<size_t>(max - count, 64u));
+        int peeked = SDL_PeepEvents(buffer, toPeek, SDL_GETEVENT, SDL_FIRSTEVENT, SDL_LASTEVENT);
+        if (peeked <= 0) break;
+
+        for (int i = 0; i < peeked; ++i) {
+            const SDL_Event& event = buffer[i];
+            NxEvent* e = &events[count];
+            e->t = nullptr;
+
+            e->type = translateEvent(event, e);
+            if (e->type == NX_Other) continue;
+            trackEvent(e);
+            recordEvent(e);
+            if (coalesce && count > 0u && coalesceEvent(&events[count - 1u], e)) continue;
+
+            if (e->t) {
+                textOffsets.emplace_back(count, textArena.size());
+                textArena.insert(textArena.end(), e->t, e->t + strlen(e->t) + 1u);
+            }
+
+            if (event.type == SDL_DROPFILE) SDL_free(event.drop.file);
+
+            ++count;
+        }
+    }
+
+    // The arena is done growing, point the events to their text
+    for (auto& it : textOffsets) {
+        events[it.first].t = textArena.data() + it.second;
+    }
+
+    return count;
+}
+
+// Records events and frame times to /userdata/replays/<name>.nxr
+NX_EXPORT bool nxEventStartRecording(const char* name)
+{
+    return EventLog::startRecording(name);
+}
+
+// Plays a recording back instead of live events, a positive step fixes the frame time
+NX_EXPORT bool nxEventStartReplay(const char* name, double step)
+{
+    return EventLog::startReplay(name, step);
+}
+
+NX_EXPORT void nxEventStopLog()
+{
+    EventLog::stop();
+}
+
+NX_EXPORT int nxEventLogMode()
+{
+    return EventLog::mode();
+}
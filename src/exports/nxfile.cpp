@@ -197,13 +197,15 @@ NX_EXPORT const char* nxFsReadString(PHYSFS_File* handle)
 {
     thread_local std::string str;
     char c;
+    size_t readBytes;
 
-    do {
-        if (!nxFsRead(handle, &c, 1u, nullptr)) return nullptr;
+    str.clear();
+    while (true) {
+        if (!nxFsRead(handle, &c, 1u, &readBytes) || readBytes == 0u) return nullptr;
+        if (c == '\0') break;
 
         str += c;
     }
-    while (c != '\0');
 
     return str.data();
 }
@@ -30,30 +30,40 @@
 
 NX_EXPORT void nxLogVerbose(const char* message)
 {
-    Log::verbose(message);
+    Log::verbose("%s", message);
 }
 
 NX_EXPORT void nxLogDebug(const char* message)
 {
-    Log::debug(message);
+    Log::debug("%s", message);
 }
 
 NX_EXPORT void nxLogWarning(const char* message)
 {
-    Log::warning(message);
+    Log::warning("%s", message);
 }
 
 NX_EXPORT void nxLogInfo(const char* message)
 {
-    Log::info(message);
+    Log::info("%s", message);
 }
 
 NX_EXPORT void nxLogError(const char* message)
 {
-    Log::error(message);
+    Log::error("%s", message);
 }
 
 NX_EXPORT void nxLogFatal(const char* message)
 {
-    Log::fatal(message);
+    Log::fatal("%s", message);
+}
+
+NX_EXPORT bool nxLogFlush(double maxWait)
+{
+    return Log::flush(maxWait);
+}
+
+NX_EXPORT uint64_t nxLogDroppedMessages()
+{
+    return Log::droppedMessages();
 }
@@ -27,17 +27,68 @@
 
 #include "../config.hpp"
 #include "../system/luavm.hpp"
+#include "../system/luacache.hpp"
 
 #include <luajit/lua.hpp>
 #include <string>
+#include <vector>
+
+using NxLuaCacheStats = LuaCache::Stats;
 
 NX_EXPORT bool nxLuaLoadNxLibs(lua_State* state)
 {
     return LuaVM::loadNxLibs(state);
 }
 
+NX_EXPORT lua_State* nxLuaVMAcquire()
+{
+    return LuaVM::acquireState();
+}
+
+NX_EXPORT void nxLuaVMRelease(lua_State* state)
+{
+    LuaVM::releaseState(state);
+}
+
+NX_EXPORT void nxLuaVMPrewarm(size_t count, const char** modules, size_t moduleCount)
+{
+    LuaVM::prewarm(count, std::vector<std::string>(modules, modules + moduleCount));
+}
+
 NX_EXPORT void* nxLuaToCdata(lua_State* state, int index)
 {
     auto ptr = lua_topointer(state, index);
     return reinterpret_cast<void*>(*reinterpret_cast<const uintptr_t*>(ptr));
 }
+
+NX_EXPORT const char* nxLuaCacheFetch(const char* filename, size_t* size, const char** bytecode,
+    size_t* bytecodeSize, uint64_t* hash)
+{
+    return LuaCache::fetch(filename, *size, *bytecode, *bytecodeSize, *hash);
+}
+
+NX_EXPORT void nxLuaCacheStore(const char* filename, uint64_t hash, const char* bytecode,
+    size_t size)
+{
+    LuaCache::store(filename, hash, bytecode, size);
+}
+
+NX_EXPORT const char* nxLuaCacheResolve(const char* moduleName)
+{
+    return LuaCache::resolve(moduleName);
+}
+
+NX_EXPORT void nxLuaCacheIndex(const char* moduleName, const char* filename)
+{
+    LuaCache::index(moduleName, filename);
+}
+
+NX_EXPORT bool nxLuaCacheStripsDebugInfo()
+{
+    return LuaCache::stripsDebugInfo();
+}
+
+NX_EXPORT void nxLuaCacheStats(NxLuaCacheStats* stats)
+{
+    *stats = LuaCache::stats();
+}
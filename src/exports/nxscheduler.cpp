@@ -0,0 +1,123 @@
+/*
+    This is free and unencumbered software released into the public domain.
+
+    Anyone is free to copy, modify, publish, use, compile, sell, or
+    distribute this software, either in source code form or as a compiled
+    binary, for any purpose, commercial or non-commercial, and by any
+    means.
+
+    In jurisdictions that recognize copyright laws, the author or authors
+    of this software dedicate any and all copyright interest in the
+    software to the public domain. We make this dedication for the benefit
+    of the public at large and to the detriment of our heirs and
+    successors. We intend this dedication to be an overt act of
+    relinquishment in perpetuity of all present and future rights to this
+    software under copyright law.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+    MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+    IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+    OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+    ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+    OTHER DEALINGS IN THE SOFTWARE.
+
+    For more information, please refer to <http://unlicense.org>
+*/
+
+#include "../config.hpp"
+#include "../system/scheduler.hpp"
+#include "../system/stream.hpp"
+#include "../graphics/image.hpp"
+
+using NxImage = Image;
+
+NX_EXPORT uint32_t nxSchedulerCreate()
+{
+    return Scheduler::create();
+}
+
+NX_EXPORT void nxSchedulerComplete(uint32_t id, const void* data, size_t size)
+{
+    Scheduler::complete(id, data, size);
+}
+
+NX_EXPORT void nxSchedulerFail(uint32_t id, const char* error)
+{
+    Scheduler::fail(id, error ? error : "");
+}
+
+NX_EXPORT size_t nxSchedulerPoll(uint32_t* ids, size_t maxCount)
+{
+    return Scheduler::poll(ids, maxCount);
+}
+
+NX_EXPORT uint32_t nxSchedulerWait(uint32_t id, double timeout)
+{
+    return Scheduler::wait(id, timeout);
+}
+
+NX_EXPORT uint32_t nxSchedulerStatus(uint32_t id)
+{
+    return Scheduler::status(id);
+}
+
+NX_EXPORT const uint8_t* nxSchedulerData(uint32_t id, size_t* sizePtr)
+{
+    const auto* data = Scheduler::data(id);
+    *sizePtr = data ? data->size() : 0u;
+    return data ? data->data() : nullptr;
+}
+
+NX_EXPORT const char* nxSchedulerError(uint32_t id)
+{
+    return Scheduler::error(id);
+}
+
+NX_EXPORT NxImage* nxSchedulerTakeImage(uint32_t id)
+{
+    return static_cast<NxImage*>(Scheduler::takeObject(id));
+}
+
+NX_EXPORT void nxSchedulerRelease(uint32_t id)
+{
+    Scheduler::release(id);
+}
+
+NX_EXPORT uint32_t nxSchedulerReadFile(const char* filename)
+{
+    std::string name = filename;
+    return Scheduler::submit([name](Scheduler::Result& result) {
+        Stream stream;
+        size_t size;
+        if (!stream.open(name, Stream::Read) || !stream.size(size)) {
+            result.error = stream.getError();
+            return false;
+        }
+
+        result.data.resize(size);
+        if (!stream.readArray(result.data.data(), size, 1u)) {
+            result.error = stream.getError();
+            return false;
+        }
+
+        return true;
+    });
+}
+
+NX_EXPORT uint32_t nxSchedulerDecodeImage(const char* filename)
+{
+    std::string name = filename;
+    return Scheduler::submit([name](Scheduler::Result& result) {
+        auto* image = new NxImage();
+        if (!image->open(name)) {
+            delete image;
+            result.error = "Unable to decode image: " + name;
+            return false;
+        }
+
+        result.object = image;
+        result.deleter = [](void* object) { delete static_cast<NxImage*>(object); };
+        return true;
+    });
+}
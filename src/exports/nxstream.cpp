@@ -0,0 +1,125 @@
+/*
+    This is free and unencumbered software released into the public domain.
+
+    Anyone is free to copy, modify, publish, use, compile, sell, or
+    distribute this software, either in source code form or as a compiled
+    binary, for any purpose, commercial or non-commercial, and by any
+    means.
+
+    In jurisdictions that recognize copyright laws, the author or authors
+    of this software dedicate any and all copyright interest in the
+    software to the public domain. We make this dedication for the benefit
+    of the public at large and to the detriment of our heirs and
+    successors. We intend this dedication to be an overt act of
+    relinquishment in perpetuity of all present and future rights to this
+    software under copyright law.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+    MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+    IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+    OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+    ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+    OTHER DEALINGS IN THE SOFTWARE.
+
+    For more information, please refer to <http://unlicense.org>
+*/
+
+#include "../config.hpp"
+#include "../system/stream.hpp"
+
+using NxStream = Stream;
+
+NX_EXPORT NxStream* nxStreamOpen(const char* filename, bool write, size_t bufferSize, const char** error)
+{
+    auto* stream = new Stream();
+    if (!stream->open(filename, write ? Stream::Write : Stream::Read,
+        bufferSize ? bufferSize : Stream::DefaultBufferSize)) {
+        thread_local std::string message;
+        message = stream->getError();
+        *error = message.data();
+
+        delete stream;
+        return nullptr;
+    }
+
+    return stream;
+}
+
+NX_EXPORT void nxStreamRelease(NxStream* stream)
+{
+    delete stream;
+}
+
+NX_EXPORT const char* nxStreamGetError(const NxStream* stream)
+{
+    return stream->getError().data();
+}
+
+NX_EXPORT void nxStreamSetBigEndian(NxStream* stream, bool bigEndian)
+{
+    stream->setBigEndian(bigEndian);
+}
+
+NX_EXPORT bool nxStreamIsBigEndian(const NxStream* stream)
+{
+    return stream->isBigEndian();
+}
+
+NX_EXPORT bool nxStreamSize(NxStream* stream, size_t* size)
+{
+    return stream->size(*size);
+}
+
+NX_EXPORT bool nxStreamTell(NxStream* stream, size_t* position)
+{
+    return stream->tell(*position);
+}
+
+NX_EXPORT bool nxStreamSeek(NxStream* stream, size_t position)
+{
+    return stream->seek(position);
+}
+
+NX_EXPORT bool nxStreamFlush(NxStream* stream)
+{
+    return stream->flush();
+}
+
+NX_EXPORT bool nxStreamRead(NxStream* stream, void* data, size_t size, size_t* readBytes)
+{
+    return stream->read(data, size, *readBytes);
+}
+
+NX_EXPORT bool nxStreamWrite(NxStream* stream, const void* data, size_t size)
+{
+    return stream->write(data, size);
+}
+
+NX_EXPORT bool nxStreamReadArray(NxStream* stream, void* data, size_t count, size_t elementSize)
+{
+    return stream->readArray(data, count, elementSize);
+}
+
+NX_EXPORT bool nxStreamWriteArray(NxStream* stream, const void* data, size_t count,
+    size_t elementSize)
+{
+    return stream->writeArray(data, count, elementSize);
+}
+
+NX_EXPORT const char* nxStreamReadCString(NxStream* stream, size_t* length)
+{
+    return stream->readCString(*length);
+}
+
+NX_EXPORT const char* nxStreamReadLengthPrefixed(NxStream* stream, size_t prefixSize,
+    size_t* length)
+{
+    return stream->readLengthPrefixed(prefixSize, *length);
+}
+
+NX_EXPORT bool nxStreamWriteLengthPrefixed(NxStream* stream, const char* str, size_t length,
+    size_t prefixSize)
+{
+    return stream->writeLengthPrefixed(str, length, prefixSize);
+}
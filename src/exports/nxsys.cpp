@@ -26,46 +26,19 @@
 */
 
 #include "../config.hpp"
+#include "../system/clock.hpp"
 
 #include <SDL2/SDL.h>
 #include <string>
-#include <chrono>
-#include <thread>
-#if defined(NX_SYSTEM_WINDOWS) || defined(NX_SYSTEM_WINCE)
-    #include <windows.h>
-    #include <mmsystem.h>
-#endif
 
 NX_EXPORT void nxSysSleep(double s)
 {
-    // Not all system tolerate negative sleep times
-    if (s <= 0) return;
-
-    #if defined(NX_SYSTEM_WINDOWS) || defined(NX_SYSTEM_WINCE)
-        // Taken from SFML ._.
-
-        // Get the supported timer resolutions on this system
-        TIMECAPS tc;
-        timeGetDevCaps(&tc, sizeof(TIMECAPS));
-
-        // Set the timer resolution to the minimum for the Sleep call
-        timeBeginPeriod(tc.wPeriodMin);
-    #endif
-
-    // Wait...
-    const auto time = static_cast<unsigned long>(s * 1000);
-    std::this_thread::sleep_for(std::chrono::milliseconds(time));
-
-    #if defined(NX_SYSTEM_WINDOWS) || defined(NX_SYSTEM_WINCE)
-        // Reset the timer resolution back to the system default
-        timeEndPeriod(tc.wPeriodMin);
-    #endif
+    Clock::sleep(s);
 }
 
 NX_EXPORT double nxSysGetTime()
 {
-    auto t = std::chrono::high_resolution_clock::now().time_since_epoch();
-    return std::chrono::duration_cast<std::chrono::milliseconds>(t).count() / 1000.0;
+    return Clock::now();
 }
 
 NX_EXPORT const char* nxSysGetSDLError()
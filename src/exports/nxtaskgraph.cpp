@@ -0,0 +1,91 @@
+/*
+    This is free and unencumbered software released into the public domain.
+
+    Anyone is free to copy, modify, publish, use, compile, sell, or
+    distribute this software, either in source code form or as a compiled
+    binary, for any purpose, commercial or non-commercial, and by any
+    means.
+
+    In jurisdictions that recognize copyright laws, the author or authors
+    of this software dedicate any and all copyright interest in the
+    software to the public domain. We make this dedication for the benefit
+    of the public at large and to the detriment of our heirs and
+    successors. We intend this dedication to be an overt act of
+    relinquishment in perpetuity of all present and future rights to this
+    software under copyright law.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+    MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+    IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+    OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+    ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+    OTHER DEALINGS IN THE SOFTWARE.
+
+    For more information, please refer to <http://unlicense.org>
+*/
+
+#include "../config.hpp"
+#include "../system/taskgraph.hpp"
+
+using NxTaskGraph = TaskGraph;
+
+NX_EXPORT NxTaskGraph* nxTaskGraphCreate()
+{
+    return new TaskGraph();
+}
+
+NX_EXPORT void nxTaskGraphRelease(NxTaskGraph* graph)
+{
+    delete graph;
+}
+
+NX_EXPORT uint32_t nxTaskGraphAdd(NxTaskGraph* graph)
+{
+    return graph->add();
+}
+
+NX_EXPORT void nxTaskGraphRemove(NxTaskGraph* graph, uint32_t node)
+{
+    graph->remove(node);
+}
+
+NX_EXPORT void nxTaskGraphDepend(NxTaskGraph* graph, uint32_t node, uint32_t dependency)
+{
+    graph->depend(node, dependency);
+}
+
+NX_EXPORT bool nxTaskGraphAwait(NxTaskGraph* graph, uint32_t node)
+{
+    return graph->await(node);
+}
+
+NX_EXPORT void nxTaskGraphSignal(NxTaskGraph* graph, uint32_t node)
+{
+    graph->signal(node);
+}
+
+NX_EXPORT void nxTaskGraphComplete(NxTaskGraph* graph, uint32_t node)
+{
+    graph->complete(node);
+}
+
+NX_EXPORT void nxTaskGraphFail(NxTaskGraph* graph, uint32_t node)
+{
+    graph->fail(node);
+}
+
+NX_EXPORT uint32_t nxTaskGraphStatus(const NxTaskGraph* graph, uint32_t node)
+{
+    return graph->status(node);
+}
+
+NX_EXPORT uint32_t nxTaskGraphPoll(NxTaskGraph* graph, uint32_t* nodes, uint32_t max)
+{
+    return static_cast<uint32_t>(graph->poll(nodes, max));
+}
+
+NX_EXPORT bool nxTaskGraphWait(NxTaskGraph* graph, uint32_t timeout)
+{
+    return graph->wait(timeout);
+}
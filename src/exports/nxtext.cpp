@@ -28,11 +28,15 @@
 #include "../config.hpp"
 #include "../graphics/text.hpp"
 #include "../graphics/rtltext.hpp"
+#include "../graphics/arabic.hpp"
 #include "../graphics/vertexbuffer.hpp"
+#include "../graphics/indexbuffer.hpp"
+#include "../system/unicode.hpp"
 
 using NxText = Text;
 using NxFont = Font;
 using NxVertexBuffer = VertexBuffer;
+using NxIndexBuffer = IndexBuffer;
 
 NX_EXPORT NxText* nxTextNew()
 {
@@ -59,6 +63,11 @@ NX_EXPORT void nxTextSetU32String(NxText* text, const uint32_t* str)
     text->setString(reinterpret_cast<const char32_t*>(str));
 }
 
+NX_EXPORT void nxTextSetArabicString(NxText* text, const char* str)
+{
+    text->setString(Arabic::shape(Unicode::utf8To32(str)));
+}
+
 NX_EXPORT void nxTextSetFont(NxText* text, const NxFont* font)
 {
     text->setFont(*font);
@@ -74,17 +83,56 @@ NX_EXPORT void nxTextSetStyle(NxText* text, uint8_t style)
     text->setStyle(style);
 }
 
+NX_EXPORT void nxTextSetMaxWidth(NxText* text, float maxWidth)
+{
+    text->setMaxWidth(maxWidth);
+}
+
+NX_EXPORT void nxTextSetAlignment(NxText* text, uint8_t alignment)
+{
+    text->setAlignment(static_cast<Text::Alignment>(alignment));
+}
+
 NX_EXPORT void nxTextCharacterPosition(const Text* text, uint32_t index, float* posPtr)
 {
     text->characterPosition(index, posPtr[0], posPtr[1]);
 }
 
+NX_EXPORT uint32_t nxTextCharacterAt(const Text* text, float x, float y)
+{
+    return static_cast<uint32_t>(text->characterAt(x, y));
+}
+
+NX_EXPORT uint32_t nxTextLineCount(const Text* text)
+{
+    return static_cast<uint32_t>(text->lineCount());
+}
+
+NX_EXPORT void nxTextLineMetrics(const Text* text, uint32_t line, uint32_t* rangePtr,
+    float* metricsPtr)
+{
+    auto metrics = text->lineMetrics(line);
+
+    rangePtr[0] = static_cast<uint32_t>(metrics.first);
+    rangePtr[1] = static_cast<uint32_t>(metrics.count);
+    metricsPtr[0] = metrics.x;
+    metricsPtr[1] = metrics.y;
+    metricsPtr[2] = metrics.width;
+    metricsPtr[3] = metrics.height;
+    metricsPtr[4] = metrics.baseline;
+}
+
 NX_EXPORT void nxTextBounds(const Text* text, float* boundsPtr)
 {
     text->bounds(boundsPtr[0], boundsPtr[1], boundsPtr[2], boundsPtr[3]);
 }
 
-NX_EXPORT NxVertexBuffer* nxTextNextBuffer(const Text* text, uint32_t* index)
+NX_EXPORT NxVertexBuffer* nxTextNextBuffer(const Text* text, uint32_t* info)
+{
+    return text->nextBuffer(&info[0], &info[1]);
+}
+
+NX_EXPORT NxIndexBuffer* nxTextQuadIndexBuffer()
 {
-    return text->nextBuffer(index);
+    return Text::quadIndexBuffer();
 }
\ No newline at end of file
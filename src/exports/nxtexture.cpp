@@ -77,6 +77,11 @@ NX_EXPORT uint32_t nxTextureBufferSize(const NxTexture* texture)
     return texture->bufferSize();
 }
 
+NX_EXPORT uint32_t nxTextureMemorySize(const NxTexture* texture)
+{
+    return texture->memorySize();
+}
+
 NX_EXPORT void nxTextureSetFilter(NxTexture* texture, uint32_t filter)
 {
     texture->setFilter(static_cast<Texture::Filter>(filter));
@@ -27,9 +27,13 @@
 
 #include "../config.hpp"
 #include "../system/thread.hpp"
+#include "../system/luavm.hpp"
+#include "../system/channel.hpp"
+#include "../system/semaphore.hpp"
 #include "../system/log.hpp"
 
 #include <luajit/lua.hpp>
+#include <atomic>
 #include <thread>
 
 #if defined(NX_SYSTEM_ANDROID)
@@ -37,6 +41,10 @@
     #include <SDL2/SDL.h>
 #endif
 
+using NxChannel = Channel;
+using NxSemaphore = Semaphore;
+using NxAtomic = std::atomic<int64_t>;
+
 struct NxThreadObj
 {
     std::thread handle;
@@ -45,6 +53,37 @@ struct NxThreadObj
     bool succeeded;
 };
 
+// Orders are given as 0: relaxed, 1: acquire, 2: release, 3: acq_rel, 4: seq_cst
+// Loads drop the release half of an order, stores drop the acquire half
+static std::memory_order loadOrder(int order)
+{
+    switch (order) {
+        case 0: case 2: return std::memory_order_relaxed;
+        case 1: case 3: return std::memory_order_acquire;
+        default: return std::memory_order_seq_cst;
+    }
+}
+
+static std::memory_order storeOrder(int order)
+{
+    switch (order) {
+        case 0: case 1: return std::memory_order_relaxed;
+        case 2: case 3: return std::memory_order_release;
+        default: return std::memory_order_seq_cst;
+    }
+}
+
+static std::memory_order exchangeOrder(int order)
+{
+    switch (order) {
+        case 0: return std::memory_order_relaxed;
+        case 1: return std::memory_order_acquire;
+        case 2: return std::memory_order_release;
+        case 3: return std::memory_order_acq_rel;
+        default: return std::memory_order_seq_cst;
+    }
+}
+
 static void threadCallback(NxThreadObj* thread)
 {
     // Total elements in stack minus the function itself AND the reserved function
@@ -55,7 +94,7 @@ static void threadCallback(NxThreadObj* thread)
     }
 
     if (thread->ownsState) {
-        lua_close(thread->state);
+        LuaVM::releaseState(thread->state);
 
         #if defined(NX_SYSTEM_ANDROID)
         JNIEnv* env = (JNIEnv*)SDL_AndroidGetJNIEnv();
@@ -105,3 +144,95 @@ NX_EXPORT bool nxThreadIsMain()
 {
     return Thread::isMain();
 }
+
+NX_EXPORT NxChannel* nxChannelCreate(size_t capacity)
+{
+    return new Channel(capacity);
+}
+
+NX_EXPORT void nxChannelRelease(NxChannel* channel)
+{
+    delete channel;
+}
+
+NX_EXPORT bool nxChannelSend(NxChannel* channel, const void* data, size_t size, double timeout)
+{
+    return channel->send(data, size, timeout);
+}
+
+NX_EXPORT const uint8_t* nxChannelReceive(NxChannel* channel, size_t* size, double timeout)
+{
+    return channel->receive(*size, timeout);
+}
+
+NX_EXPORT size_t nxChannelSize(const NxChannel* channel)
+{
+    return channel->size();
+}
+
+NX_EXPORT size_t nxChannelCapacity(const NxChannel* channel)
+{
+    return channel->capacity();
+}
+
+NX_EXPORT NxSemaphore* nxSemaphoreCreate(int count)
+{
+    return new Semaphore(count);
+}
+
+NX_EXPORT void nxSemaphoreRelease(NxSemaphore* semaphore)
+{
+    delete semaphore;
+}
+
+NX_EXPORT void nxSemaphoreSignal(NxSemaphore* semaphore, int count)
+{
+    semaphore->release(count);
+}
+
+NX_EXPORT bool nxSemaphoreWait(NxSemaphore* semaphore, double timeout)
+{
+    return semaphore->acquire(timeout);
+}
+
+NX_EXPORT int nxSemaphoreCount(const NxSemaphore* semaphore)
+{
+    return semaphore->count();
+}
+
+NX_EXPORT NxAtomic* nxAtomicCreate(int64_t value)
+{
+    return new NxAtomic(value);
+}
+
+NX_EXPORT void nxAtomicRelease(NxAtomic* atomic)
+{
+    delete atomic;
+}
+
+NX_EXPORT int64_t nxAtomicLoad(const NxAtomic* atomic, int order)
+{
+    return atomic->load(loadOrder(order));
+}
+
+NX_EXPORT void nxAtomicStore(NxAtomic* atomic, int64_t value, int order)
+{
+    atomic->store(value, storeOrder(order));
+}
+
+NX_EXPORT int64_t nxAtomicExchange(NxAtomic* atomic, int64_t value, int order)
+{
+    return atomic->exchange(value, exchangeOrder(order));
+}
+
+NX_EXPORT int64_t nxAtomicAdd(NxAtomic* atomic, int64_t value, int order)
+{
+    return atomic->fetch_add(value, exchangeOrder(order));
+}
+
+NX_EXPORT bool nxAtomicCompareExchange(NxAtomic* atomic, int64_t* expected, int64_t desired,
+    int order)
+{
+    return atomic->compare_exchange_strong(*expected, desired, exchangeOrder(order),
+        loadOrder(order));
+}
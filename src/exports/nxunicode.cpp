@@ -27,11 +27,17 @@
 
 #include "../config.hpp"
 #include "../system/unicode.hpp"
+#include "../graphics/arabic.hpp"
+
+#include <cstring>
 
 NX_EXPORT const uint32_t* nxUnicodeUtf8To32(const char* str, uint32_t* size)
 {
+    // Decode in place to reuse the buffer's capacity
     static std::u32string utf32;
-    utf32 = Unicode::utf8To32(str);
+    const char* end = str + std::strlen(str);
+    utf32.resize(Unicode::utf32Length(str, end));
+    Unicode::utf8To32(str, end, &utf32[0]);
     *size = static_cast<uint32_t>(utf32.size());
     return reinterpret_cast<const uint32_t*>(utf32.data());
 }
@@ -39,7 +45,23 @@ NX_EXPORT const uint32_t* nxUnicodeUtf8To32(const char* str, uint32_t* size)
 NX_EXPORT const char* nxUnicodeUtf32To8(const uint32_t* str, uint32_t* size)
 {
     static std::string utf8;
-    utf8 = Unicode::utf32To8(reinterpret_cast<const char32_t*>(str));
+    auto begin = reinterpret_cast<const char32_t*>(str);
+    auto end = begin + std::char_traits<char32_t>::length(begin);
+    utf8.resize(Unicode::utf8Length(begin, end));
+    Unicode::utf32To8(begin, end, &utf8[0]);
     *size = static_cast<uint32_t>(utf8.size());
     return utf8.data();
 }
+
+NX_EXPORT const uint32_t* nxUnicodeArabicShape(const uint32_t* str, uint32_t* size)
+{
+    static std::u32string shaped;
+    shaped = Arabic::shape(reinterpret_cast<const char32_t*>(str));
+    *size = static_cast<uint32_t>(shaped.size());
+    return reinterpret_cast<const uint32_t*>(shaped.data());
+}
+
+NX_EXPORT uint32_t nxUnicodeArabicLength(const uint32_t* str)
+{
+    return static_cast<uint32_t>(Arabic::length(reinterpret_cast<const char32_t*>(str)));
+}
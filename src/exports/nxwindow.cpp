@@ -29,6 +29,9 @@
 
 #include "../system/thread.hpp"
 #include "../system/log.hpp"
+#include "../system/framepacer.hpp"
+#include "../system/eventlog.hpp"
+#include "../system/arena.hpp"
 #include "../graphics/image.hpp"
 
 #include <SDL2/SDL.h>
@@ -97,7 +100,7 @@ NX_EXPORT void nxWindowClose()
 
 NX_EXPORT NxWindow* nxWindowCreate(const char* title, int width, int height, int fullscreen,
     int display, bool vsync, bool resizable, bool borderless, int minWidth, int minHeight,
-    bool highDpi, int refreshRate, int posX, int posY, int depthBits, int stencilBits)
+    bool highDpi, int refreshRate, int posX, int posY, int depthBits, int stencilBits, bool hidden)
 {
     // Get a valid display number
     display = std::max(0, std::min(display-1, SDL_GetNumVideoDisplays()-1));
@@ -136,6 +139,7 @@ NX_EXPORT NxWindow* nxWindowCreate(const char* title, int width, int height, int
         if (resizable)  flags |= SDL_WINDOW_RESIZABLE;
         if (borderless) flags |= SDL_WINDOW_BORDERLESS;
         if (highDpi)    flags |= SDL_WINDOW_ALLOW_HIGHDPI;
+        if (hidden)     flags |= SDL_WINDOW_HIDDEN;
 
         // Set context attributes
         SDL_GL_SetAttribute(SDL_GL_DOUBLEBUFFER, 1);
@@ -226,6 +230,58 @@ NX_EXPORT void nxWindowEnsureContext()
 NX_EXPORT void nxWindowDisplay()
 {
     SDL_GL_SwapWindow(window);
+
+    // Frame times are part of a recording, and come from it when replaying
+    auto& pacer = FramePacer::instance();
+    pacer.frame();
+    pacer.setFrameTime(EventLog::frame(pacer.frameTime()));
+
+    Arena::nextFrame();
+}
+
+NX_EXPORT void nxWindowRestartClock()
+{
+    FramePacer::instance().restart();
+}
+
+NX_EXPORT void nxWindowResetFrameTime()
+{
+    FramePacer::instance().resetFrameTime();
+}
+
+NX_EXPORT void nxWindowSetFramerateLimit(double limit)
+{
+    FramePacer::instance().setFramerateLimit(limit);
+}
+
+NX_EXPORT double nxWindowFrameTime()
+{
+    return FramePacer::instance().frameTime();
+}
+
+NX_EXPORT double nxWindowCurrentFPS()
+{
+    return FramePacer::instance().currentFPS();
+}
+
+NX_EXPORT void nxWindowSetFixedTimestep(double step, uint32_t maxSteps)
+{
+    FramePacer::instance().setFixedTimestep(step, maxSteps);
+}
+
+NX_EXPORT uint32_t nxWindowFixedSteps()
+{
+    return FramePacer::instance().fixedSteps();
+}
+
+NX_EXPORT double nxWindowFixedAlpha()
+{
+    return FramePacer::instance().fixedAlpha();
+}
+
+NX_EXPORT void nxWindowFrameStats(double* statsPtr)
+{
+    FramePacer::instance().stats(statsPtr[0], statsPtr[1], statsPtr[2]);
 }
 
 NX_EXPORT void nxWindowGetFlags(int* flagsPtr)
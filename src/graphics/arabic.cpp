@@ -0,0 +1,479 @@
+/*
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Based on Python Arabic Reshaper by mpcabd
+    https://github.com/mpcabd/python-arabic-reshaper
+*/
+
+#include "arabic.hpp"
+
+#include <algorithm>
+#include <iterator>
+#include <vector>
+
+//----------------------------------------------------------
+// Locals
+//----------------------------------------------------------
+namespace
+{
+    // Subset of the bidi character types, AL is resolved to R
+    enum BidiType : uint8_t
+    {
+        L, R, AL, EN, ES, ET, AN, CS, NSM, WS, S, ON
+    };
+
+    struct BidiRange
+    {
+        uint32_t first;
+        uint32_t last;
+        BidiType type;
+    };
+
+    // Sorted, non-overlapping ranges, everything else is L
+    constexpr BidiRange bidiRanges[] {
+        {0x0000, 0x0008, ON},  {0x0009, 0x0009, S},   {0x000A, 0x000D, WS},
+        {0x000E, 0x001F, ON},  {0x0020, 0x0020, WS},  {0x0021, 0x0022, ON},
+        {0x0023, 0x0025, ET},  {0x0026, 0x002A, ON},  {0x002B, 0x002B, ES},
+        {0x002C, 0x002C, CS},  {0x002D, 0x002D, ES},  {0x002E, 0x002F, CS},
+        {0x0030, 0x0039, EN},  {0x003A, 0x003A, CS},  {0x003B, 0x0040, ON},
+        {0x005B, 0x0060, ON},  {0x007B, 0x009F, ON},  {0x00A0, 0x00A0, CS},
+        {0x00A1, 0x00A1, ON},  {0x00A2, 0x00A5, ET},  {0x00A6, 0x00A9, ON},
+        {0x00AB, 0x00AF, ON},  {0x00B0, 0x00B1, ET},  {0x00B2, 0x00B3, EN},
+        {0x00B4, 0x00B4, ON},  {0x00B6, 0x00B8, ON},  {0x00B9, 0x00B9, EN},
+        {0x00BB, 0x00BF, ON},  {0x00D7, 0x00D7, ON},  {0x00F7, 0x00F7, ON},
+        {0x0300, 0x036F, NSM}, {0x0590, 0x05FF, R},   {0x0600, 0x0605, AN},
+        {0x0606, 0x0607, ON},  {0x0608, 0x0608, AL},  {0x0609, 0x060A, ET},
+        {0x060B, 0x060B, AL},  {0x060C, 0x060C, CS},  {0x060D, 0x060D, AL},
+        {0x060E, 0x060F, ON},  {0x0610, 0x061A, NSM}, {0x061B, 0x064A, AL},
+        {0x064B, 0x065F, NSM}, {0x0660, 0x0669, AN},  {0x066A, 0x066A, ET},
+        {0x066B, 0x066C, AN},  {0x066D, 0x066F, AL},  {0x0670, 0x0670, NSM},
+        {0x0671, 0x06D5, AL},  {0x06D6, 0x06DC, NSM}, {0x06DD, 0x06DD, AN},
+        {0x06DE, 0x06DE, ON},  {0x06DF, 0x06E4, NSM}, {0x06E5, 0x06E6, AL},
+        {0x06E7, 0x06E8, NSM}, {0x06E9, 0x06E9, ON},  {0x06EA, 0x06ED, NSM},
+        {0x06EE, 0x06EF, AL},  {0x06F0, 0x06F9, EN},  {0x06FA, 0x07BF, AL},
+        {0x07C0, 0x089F, R},   {0x08A0, 0x08FF, AL},  {0x2000, 0x200A, WS},
+        {0x200B, 0x200D, ON},  {0x200F, 0x200F, R},   {0x2010, 0x2027, ON},
+        {0x2028, 0x2029, WS},  {0x202F, 0x202F, CS},  {0x2030, 0x2034, ET},
+        {0x2035, 0x2043, ON},  {0x2044, 0x2044, CS},  {0x2045, 0x205E, ON},
+        {0x205F, 0x205F, WS},  {0x2070, 0x2070, EN},  {0x2074, 0x2079, EN},
+        {0x207A, 0x207B, ES},  {0x207C, 0x207E, ON},  {0x2080, 0x2089, EN},
+        {0x208A, 0x208B, ES},  {0x208C, 0x208E, ON},  {0x20A0, 0x20CF, ET},
+        {0x2190, 0x2BFF, ON},  {0x3000, 0x3000, WS},  {0x3001, 0x3004, ON},
+        {0xFB1D, 0xFB4F, R},   {0xFB50, 0xFDFF, AL},  {0xFE00, 0xFE0F, NSM},
+        {0xFE50, 0xFE6F, ON},  {0xFE70, 0xFEFE, AL},  {0xFEFF, 0xFEFF, ON},
+        {0xFF01, 0xFF02, ON},  {0xFF03, 0xFF05, ET},  {0xFF06, 0xFF0A, ON},
+        {0xFF0B, 0xFF0B, ES},  {0xFF0C, 0xFF0C, CS},  {0xFF0D, 0xFF0D, ES},
+        {0xFF0E, 0xFF0F, CS},  {0xFF10, 0xFF19, EN},  {0xFF1A, 0xFF1A, CS},
+        {0xFF1B, 0xFF20, ON},  {0xFF3B, 0xFF40, ON},  {0xFF5B, 0xFF65, ON},
+        {0x1F000, 0x1FAFF, ON}
+    };
+
+    struct Range
+    {
+        uint32_t first;
+        uint32_t last;
+    };
+
+    // Marks that attach to the previous letter, including the shadda ligatures
+    constexpr Range harakatRanges[] {
+        {0x0610, 0x061A}, {0x064B, 0x065F}, {0x0670, 0x0670}, {0x06D6, 0x06DC},
+        {0x06DF, 0x06E4}, {0x06E7, 0x06E8}, {0x06EA, 0x06ED}, {0xFC5E, 0xFC63},
+        {0xFE70, 0xFE7F}
+    };
+
+    enum JoiningType : uint8_t
+    {
+        NonJoining,
+        RightJoining, // Only joins with the previous letter
+        DualJoining
+    };
+
+    struct LetterForms
+    {
+        uint32_t letter;
+        uint32_t isolated, initial, medial, final;
+        JoiningType type;
+    };
+
+    // Presentation forms, sorted by letter
+    constexpr LetterForms letterForms[] {
+        {0x0622, 0xFE81, 0xFE81, 0xFE82, 0xFE82, RightJoining},
+        {0x0623, 0xFE83, 0xFE83, 0xFE84, 0xFE84, RightJoining},
+        {0x0624, 0xFE85, 0xFE85, 0xFE86, 0xFE86, RightJoining},
+        {0x0625, 0xFE87, 0xFE87, 0xFE88, 0xFE88, RightJoining},
+        {0x0626, 0xFE89, 0xFE8B, 0xFE8C, 0xFE8A, DualJoining},
+        {0x0627, 0x0627, 0x0627, 0xFE8E, 0xFE8E, RightJoining},
+        {0x0628, 0xFE8F, 0xFE91, 0xFE92, 0xFE90, DualJoining},
+        {0x0629, 0xFE93, 0xFE93, 0xFE94, 0xFE94, RightJoining},
+        {0x062A, 0xFE95, 0xFE97, 0xFE98, 0xFE96, DualJoining},
+        {0x062B, 0xFE99, 0xFE9B, 0xFE9C, 0xFE9A, DualJoining},
+        {0x062C, 0xFE9D, 0xFE9F, 0xFEA0, 0xFE9E, DualJoining},
+        {0x062D, 0xFEA1, 0xFEA3, 0xFEA4, 0xFEA2, DualJoining},
+        {0x062E, 0xFEA5, 0xFEA7, 0xFEA8, 0xFEA6, DualJoining},
+        {0x062F, 0xFEA9, 0xFEA9, 0xFEAA, 0xFEAA, RightJoining},
+        {0x0630, 0xFEAB, 0xFEAB, 0xFEAC, 0xFEAC, RightJoining},
+        {0x0631, 0xFEAD, 0xFEAD, 0xFEAE, 0xFEAE, RightJoining},
+        {0x0632, 0xFEAF, 0xFEAF, 0xFEB0, 0xFEB0, RightJoining},
+        {0x0633, 0xFEB1, 0xFEB3, 0xFEB4, 0xFEB2, DualJoining},
+        {0x0634, 0xFEB5, 0xFEB7, 0xFEB8, 0xFEB6, DualJoining},
+        {0x0635, 0xFEB9, 0xFEBB, 0xFEBC, 0xFEBA, DualJoining},
+        {0x0636, 0xFEBD, 0xFEBF, 0xFEC0, 0xFEBE, DualJoining},
+        {0x0637, 0xFEC1, 0xFEC3, 0xFEC4, 0xFEC2, DualJoining},
+        {0x0638, 0xFEC5, 0xFEC7, 0xFEC8, 0xFEC6, DualJoining},
+        {0x0639, 0xFEC9, 0xFECB, 0xFECC, 0xFECA, DualJoining},
+        {0x063A, 0xFECD, 0xFECF, 0xFED0, 0xFECE, DualJoining},
+        {0x0640, 0x0640, 0x0640, 0x0640, 0x0640, DualJoining}, // Tatweel
+        {0x0641, 0xFED1, 0xFED3, 0xFED4, 0xFED2, DualJoining},
+        {0x0642, 0xFED5, 0xFED7, 0xFED8, 0xFED6, DualJoining},
+        {0x0643, 0xFED9, 0xFEDB, 0xFEDC, 0xFEDA, DualJoining},
+        {0x0644, 0xFEDD, 0xFEDF, 0xFEE0, 0xFEDE, DualJoining},
+        {0x0645, 0xFEE1, 0xFEE3, 0xFEE4, 0xFEE2, DualJoining},
+        {0x0646, 0xFEE5, 0xFEE7, 0xFEE8, 0xFEE6, DualJoining},
+        {0x0647, 0xFEE9, 0xFEEB, 0xFEEC, 0xFEEA, DualJoining},
+        {0x0648, 0xFEED, 0xFEED, 0xFEEE, 0xFEEE, RightJoining},
+        {0x0649, 0xFEEF, 0xFEEF, 0xFEF0, 0xFEF0, RightJoining},
+        {0x064A, 0xFEF1, 0xFEF3, 0xFEF4, 0xFEF2, DualJoining},
+        {0x066E, 0xFBE4, 0xFBE8, 0xFBE9, 0xFBE5, DualJoining},
+        {0x0671, 0x0671, 0x0671, 0xFB51, 0xFB51, RightJoining},
+        {0x067E, 0xFB56, 0xFB58, 0xFB59, 0xFB57, DualJoining},
+        {0x0686, 0xFB7A, 0xFB7C, 0xFB7D, 0xFB7B, DualJoining},
+        {0x0698, 0xFB8A, 0xFB8A, 0xFB8B, 0xFB8B, RightJoining},
+        {0x06A9, 0xFB8E, 0xFB90, 0xFB91, 0xFB8F, DualJoining},
+        {0x06AA, 0xFB8E, 0xFB90, 0xFB91, 0xFB8F, DualJoining},
+        {0x06AF, 0xFB92, 0xFB94, 0xFB95, 0xFB93, DualJoining},
+        {0x06C1, 0xFBA6, 0xFBA8, 0xFBA9, 0xFBA7, DualJoining},
+        {0x06CC, 0xFEEF, 0xFEF3, 0xFEF4, 0xFEF0, DualJoining},
+        // Lam-alef ligatures, isolated forms stand for the ligature until it's shaped
+        {0xFEF5, 0xFEF5, 0xFEF5, 0xFEF6, 0xFEF6, RightJoining},
+        {0xFEF7, 0xFEF7, 0xFEF7, 0xFEF8, 0xFEF8, RightJoining},
+        {0xFEF9, 0xFEF9, 0xFEF9, 0xFEFA, 0xFEFA, RightJoining},
+        {0xFEFB, 0xFEFB, 0xFEFB, 0xFEFC, 0xFEFC, RightJoining}
+    };
+
+    struct Ligature
+    {
+        uint32_t second;
+        uint32_t ligature;
+    };
+
+    // Lam followed by an alef
+    constexpr Ligature lamAlefLigatures[] {
+        {0x0622, 0xFEF5}, {0x0623, 0xFEF7}, {0x0625, 0xFEF9}, {0x0627, 0xFEFB}
+    };
+
+    // Shadda combined with another haraka
+    constexpr Ligature shaddaLigatures[] {
+        {0x064C, 0xFC5E}, {0x064D, 0xFC5F}, {0x064E, 0xFC60}, {0x064F, 0xFC61},
+        {0x0650, 0xFC62}, {0x0670, 0xFC63}
+    };
+
+    // Characters that are mirrored in right-to-left runs
+    constexpr Ligature mirroredPairs[] {
+        {0x0028, 0x0029}, {0x0029, 0x0028}, {0x003C, 0x003E}, {0x003E, 0x003C},
+        {0x005B, 0x005D}, {0x005D, 0x005B}, {0x007B, 0x007D}, {0x007D, 0x007B},
+        {0x00AB, 0x00BB}, {0x00BB, 0x00AB}, {0x2039, 0x203A}, {0x203A, 0x2039}
+    };
+
+    constexpr uint32_t Lam    = 0x0644;
+    constexpr uint32_t Shadda = 0x0651;
+
+    template <typename T, size_t N>
+    constexpr bool isSorted(const T (&table)[N], size_t i = 1u)
+    {
+        return i >= N || (table[i - 1u].first <= table[i - 1u].last &&
+            table[i - 1u].last < table[i].first && isSorted(table, i + 1u));
+    }
+
+    template <typename T, size_t N>
+    constexpr bool isSortedBy(const T (&table)[N], uint32_t T::*key, size_t i = 1u)
+    {
+        return i >= N || (table[i - 1u].*key < table[i].*key && isSortedBy(table, key, i + 1u));
+    }
+
+    static_assert(isSorted(bidiRanges), "Bidi ranges must be sorted");
+    static_assert(isSorted(harakatRanges), "Harakat ranges must be sorted");
+    static_assert(isSortedBy(letterForms, &LetterForms::letter), "Letter forms must be sorted");
+    static_assert(isSortedBy(lamAlefLigatures, &Ligature::second), "Ligatures must be sorted");
+    static_assert(isSortedBy(shaddaLigatures, &Ligature::second), "Ligatures must be sorted");
+    static_assert(isSortedBy(mirroredPairs, &Ligature::second), "Mirrors must be sorted");
+
+    // Finds the range containing a code point
+    template <typename T, size_t N>
+    const T* findRange(const T (&table)[N], uint32_t codePoint)
+    {
+        auto it = std::upper_bound(std::begin(table), std::end(table), codePoint,
+            [](uint32_t cp, const T& range) {
+                return cp < range.first;
+            }
+        );
+
+        if (it == std::begin(table) || codePoint > (--it)->last) return nullptr;
+        return it;
+    }
+
+    // Finds an entry by key
+    template <typename T, size_t N>
+    const T* findEntry(const T (&table)[N], uint32_t T::*key, uint32_t codePoint)
+    {
+        auto it = std::lower_bound(std::begin(table), std::end(table), codePoint,
+            [key](const T& entry, uint32_t cp) {
+                return entry.*key < cp;
+            }
+        );
+
+        return it != std::end(table) && (*it).*key == codePoint ? it : nullptr;
+    }
+
+    BidiType bidiType(uint32_t codePoint)
+    {
+        auto range = findRange(bidiRanges, codePoint);
+        return range ? range->type : L;
+    }
+
+    JoiningType joiningType(uint32_t codePoint)
+    {
+        auto forms = findEntry(letterForms, &LetterForms::letter, codePoint);
+        return forms ? forms->type : NonJoining;
+    }
+
+    // Replaces lam-alef and shadda-haraka pairs with their ligatures
+    void applyLigatures(const char32_t* begin, const char32_t* end, std::u32string& output)
+    {
+        for (auto it = begin; it != end; ++it) {
+            uint32_t c = *it;
+
+            if (c == Lam) {
+                // Harakat may sit between the lam and the alef, they're kept after the ligature
+                auto alef = it + 1;
+                while (alef != end && Arabic::isHarakat(*alef)) ++alef;
+
+                auto lamAlef = alef != end
+                    ? findEntry(lamAlefLigatures, &Ligature::second, *alef)
+                    : nullptr;
+
+                if (lamAlef) {
+                    output += static_cast<char32_t>(lamAlef->ligature);
+                    output.append(it + 1, alef);
+                    it = alef;
+                    continue;
+                }
+            }
+            else if (c == Shadda) {
+                auto prev = output.empty()
+                    ? nullptr
+                    : findEntry(shaddaLigatures, &Ligature::second, output.back());
+
+                if (prev) {
+                    output.back() = static_cast<char32_t>(prev->ligature);
+                    continue;
+                }
+
+                auto next = it + 1 != end
+                    ? findEntry(shaddaLigatures, &Ligature::second, *(it + 1))
+                    : nullptr;
+
+                if (next) {
+                    output += static_cast<char32_t>(next->ligature);
+                    ++it;
+                    continue;
+                }
+            }
+
+            output += static_cast<char32_t>(c);
+        }
+    }
+
+    // Picks the contextual form of each letter
+    void applyForms(std::u32string& str, size_t first)
+    {
+        // The last letter that isn't a haraka and its joining type
+        JoiningType prevType = NonJoining;
+        size_t prevIndex = 0u;
+        bool prevJoinsPrev = false;
+
+        auto setForm = [&](size_t index, bool joinsNext) {
+            auto forms = findEntry(letterForms, &LetterForms::letter, str[index]);
+            if (!forms) return;
+
+            if (prevJoinsPrev) {
+                str[index] = static_cast<char32_t>(joinsNext ? forms->medial : forms->final);
+            }
+            else {
+                str[index] = static_cast<char32_t>(joinsNext ? forms->initial : forms->isolated);
+            }
+        };
+
+        for (size_t i = first; i < str.size(); ++i) {
+            uint32_t c = str[i];
+            if (Arabic::isHarakat(c)) continue;
+
+            JoiningType type = joiningType(c);
+            bool joinsPrev = prevType == DualJoining && type != NonJoining;
+
+            // Now that we know what follows it, shape the previous letter
+            if (i > first && prevType != NonJoining) setForm(prevIndex, joinsPrev);
+
+            prevType = type;
+            prevIndex = i;
+            prevJoinsPrev = joinsPrev;
+        }
+
+        if (prevType != NonJoining) setForm(prevIndex, false);
+    }
+
+    // Resolves the embedding levels of a right-to-left line (UAX #9 without explicit
+    // embeddings), characters end up either at level 1 or 2
+    void resolveLevels(const char32_t* str, size_t size, std::vector<uint8_t>& levels)
+    {
+        std::vector<BidiType> types(size);
+        for (size_t i = 0u; i < size; ++i) types[i] = bidiType(str[i]);
+
+        // W1: Non spacing marks take the type of the previous character
+        // W2: European numbers after Arabic letters are Arabic numbers
+        // W3: Arabic letters are right-to-left
+        BidiType prev = R, lastStrong = R;
+        for (auto& type : types) {
+            if (type == NSM) type = prev;
+
+            if (type == EN && lastStrong == AL) type = AN;
+            if (type == L || type == R || type == AL) lastStrong = type;
+            if (type == AL) type = R;
+
+            prev = type;
+        }
+
+        // W4: A single separator between two numbers of the same type joins them
+        for (size_t i = 1u; i + 1u < size; ++i) {
+            if (types[i - 1u] != types[i + 1u]) continue;
+
+            if ((types[i] == ES && types[i - 1u] == EN) ||
+                (types[i] == CS && (types[i - 1u] == EN || types[i - 1u] == AN)))
+            {
+                types[i] = types[i - 1u];
+            }
+        }
+
+        // W5: Terminators next to european numbers become numbers too
+        for (size_t i = 0u; i < size; ++i) {
+            if (types[i] != ET) continue;
+
+            size_t end = i;
+            while (end < size && types[end] == ET) ++end;
+
+            bool number = (i > 0u && types[i - 1u] == EN) || (end < size && types[end] == EN);
+            std::fill(types.begin() + i, types.begin() + end, number ? EN : ON);
+            i = end - 1u;
+        }
+
+        // W6: Remaining separators are neutral
+        // W7: European numbers after left-to-right text are left-to-right
+        lastStrong = R;
+        for (auto& type : types) {
+            if (type == ES || type == CS || type == ET) type = ON;
+
+            if (type == L || type == R) lastStrong = type;
+            else if (type == EN && lastStrong == L) type = L;
+        }
+
+        // N1, N2: Neutrals take the direction of the text around them if it's the same on
+        // both sides, numbers count as right-to-left, otherwise they're right-to-left
+        auto direction = [](BidiType type) {
+            return type == L ? L : R;
+        };
+
+        for (size_t i = 0u; i < size; ++i) {
+            if (types[i] != WS && types[i] != S && types[i] != ON) continue;
+
+            size_t end = i;
+            while (end < size && (types[end] == WS || types[end] == S || types[end] == ON)) ++end;
+
+            BidiType before = i > 0u ? direction(types[i - 1u]) : R;
+            BidiType after = end < size ? direction(types[end]) : R;
+            std::fill(types.begin() + i, types.begin() + end, before == after ? before : R);
+            i = end - 1u;
+        }
+
+        // I2: Everything that isn't right-to-left goes one level higher
+        levels.resize(size);
+        for (size_t i = 0u; i < size; ++i) {
+            levels[i] = types[i] == R ? 1u : 2u;
+        }
+
+        // L1: Trailing whitespace goes back to the line's level
+        for (size_t i = size; i > 0u; --i) {
+            auto type = bidiType(str[i - 1u]);
+            if (type != WS && type != S) break;
+            levels[i - 1u] = 1u;
+        }
+    }
+}
+
+namespace Arabic
+{
+    bool isHarakat(uint32_t codePoint)
+    {
+        return findRange(harakatRanges, codePoint) != nullptr;
+    }
+
+    std::u32string shape(const std::u32string& str)
+    {
+        std::u32string output;
+        output.reserve(str.size());
+
+        std::vector<uint8_t> levels;
+
+        size_t lineStart = 0u;
+        while (lineStart <= str.size()) {
+            size_t lineEnd = std::min(str.find(U'\n', lineStart), str.size());
+
+            // Shape the line
+            size_t first = output.size();
+            applyLigatures(str.data() + lineStart, str.data() + lineEnd, output);
+            applyForms(output, first);
+
+            // The line is laid out from right to left, so only left-to-right runs
+            // are reversed, and mirrored characters are flipped in the others
+            resolveLevels(output.data() + first, output.size() - first, levels);
+            for (size_t i = 0u; i < levels.size(); ++i) {
+                auto begin = output.begin() + static_cast<std::ptrdiff_t>(first + i);
+
+                if (levels[i] == 1u) {
+                    auto mirror = findEntry(mirroredPairs, &Ligature::second, *begin);
+                    if (mirror) *begin = static_cast<char32_t>(mirror->ligature);
+                    continue;
+                }
+
+                size_t end = i;
+                while (end < levels.size() && levels[end] == 2u) ++end;
+
+                std::reverse(begin, output.begin() + static_cast<std::ptrdiff_t>(first + end));
+                i = end - 1u;
+            }
+
+            if (lineEnd == str.size()) break;
+
+            output += U'\n';
+            lineStart = lineEnd + 1u;
+        }
+
+        return output;
+    }
+
+    size_t length(const std::u32string& str)
+    {
+        return static_cast<size_t>(std::count_if(str.begin(), str.end(), [](char32_t c) {
+            return !isHarakat(c);
+        }));
+    }
+}
@@ -0,0 +1,153 @@
+/*
+    This is free and unencumbered software released into the public domain.
+
+    Anyone is free to copy, modify, publish, use, compile, sell, or
+    distribute this software, either in source code form or as a compiled
+    binary, for any purpose, commercial or non-commercial, and by any
+    means.
+
+    In jurisdictions that recognize copyright laws, the author or authors
+    of this software dedicate any and all copyright interest in the
+    software to the public domain. We make this dedication for the benefit
+    of the public at large and to the detriment of our heirs and
+    successors. We intend this dedication to be an overt act of
+    relinquishment in perpetuity of all present and future rights to this
+    software under copyright law.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+    MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+    IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+    OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+    ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+    OTHER DEALINGS IN THE SOFTWARE.
+
+    For more information, please refer to <http://unlicense.org>
+*/
+
+#include "linebreak.hpp"
+
+#include <algorithm>
+#include <iterator>
+
+//----------------------------------------------------------
+// Locals
+//----------------------------------------------------------
+namespace
+{
+    struct Range
+    {
+        uint32_t first;
+        uint32_t last;
+        LineBreaker::Class lineClass;
+    };
+
+    // Sorted, non-overlapping ranges, everything else is AL
+    constexpr Range classRanges[] {
+        {0x0009, 0x0009, LineBreaker::SP}, {0x000A, 0x000D, LineBreaker::BK},
+        {0x0020, 0x0020, LineBreaker::SP}, {0x0021, 0x0021, LineBreaker::CL},
+        {0x0028, 0x0028, LineBreaker::OP}, {0x0029, 0x0029, LineBreaker::CL},
+        {0x002C, 0x002C, LineBreaker::CL}, {0x002D, 0x002D, LineBreaker::HY},
+        {0x002E, 0x002F, LineBreaker::CL}, {0x0030, 0x0039, LineBreaker::NU},
+        {0x003A, 0x003B, LineBreaker::CL}, {0x003F, 0x003F, LineBreaker::CL},
+        {0x005B, 0x005B, LineBreaker::OP}, {0x005D, 0x005D, LineBreaker::CL},
+        {0x007B, 0x007B, LineBreaker::OP}, {0x007C, 0x007C, LineBreaker::BA},
+        {0x007D, 0x007D, LineBreaker::CL}, {0x00A0, 0x00A0, LineBreaker::GL},
+        {0x00A1, 0x00A1, LineBreaker::OP}, {0x00AB, 0x00AB, LineBreaker::OP},
+        {0x00AD, 0x00AD, LineBreaker::BA}, {0x00BB, 0x00BB, LineBreaker::CL},
+        {0x00BF, 0x00BF, LineBreaker::OP}, {0x0300, 0x036F, LineBreaker::CM},
+        {0x060C, 0x060C, LineBreaker::CL}, {0x0610, 0x061A, LineBreaker::CM},
+        {0x061B, 0x061B, LineBreaker::CL}, {0x061F, 0x061F, LineBreaker::CL},
+        {0x064B, 0x065F, LineBreaker::CM}, {0x0660, 0x0669, LineBreaker::NU},
+        {0x0670, 0x0670, LineBreaker::CM}, {0x06D4, 0x06D4, LineBreaker::CL},
+        {0x06D6, 0x06DC, LineBreaker::CM}, {0x06DF, 0x06E4, LineBreaker::CM},
+        {0x06E7, 0x06E8, LineBreaker::CM}, {0x06EA, 0x06ED, LineBreaker::CM},
+        {0x06F0, 0x06F9, LineBreaker::NU}, {0x2007, 0x2007, LineBreaker::GL},
+        {0x2010, 0x2010, LineBreaker::BA}, {0x2011, 0x2011, LineBreaker::GL},
+        {0x2013, 0x2013, LineBreaker::BA}, {0x2018, 0x2018, LineBreaker::OP},
+        {0x2019, 0x2019, LineBreaker::CL}, {0x201C, 0x201C, LineBreaker::OP},
+        {0x201D, 0x201D, LineBreaker::CL}, {0x2026, 0x2026, LineBreaker::CL},
+        {0x2028, 0x2029, LineBreaker::BK}, {0x202F, 0x202F, LineBreaker::GL},
+        {0x2060, 0x2060, LineBreaker::GL}, {0x2E80, 0x2FFF, LineBreaker::ID},
+        {0x3000, 0x3000, LineBreaker::BA}, {0x3001, 0x3002, LineBreaker::CL},
+        {0x3003, 0x3007, LineBreaker::ID}, {0x3008, 0x3008, LineBreaker::OP},
+        {0x3009, 0x3009, LineBreaker::CL}, {0x300A, 0x300A, LineBreaker::OP},
+        {0x300B, 0x300B, LineBreaker::CL}, {0x300C, 0x300C, LineBreaker::OP},
+        {0x300D, 0x300D, LineBreaker::CL}, {0x300E, 0x300E, LineBreaker::OP},
+        {0x300F, 0x300F, LineBreaker::CL}, {0x3010, 0x3010, LineBreaker::OP},
+        {0x3011, 0x3011, LineBreaker::CL}, {0x3012, 0x9FFF, LineBreaker::ID},
+        {0xAC00, 0xD7AF, LineBreaker::ID}, {0xF900, 0xFAFF, LineBreaker::ID},
+        {0xFE70, 0xFE7F, LineBreaker::CM}, {0xFEFF, 0xFEFF, LineBreaker::GL},
+        {0xFF01, 0xFF01, LineBreaker::CL}, {0xFF02, 0xFF07, LineBreaker::ID},
+        {0xFF08, 0xFF08, LineBreaker::OP}, {0xFF09, 0xFF09, LineBreaker::CL},
+        {0xFF0A, 0xFF0B, LineBreaker::ID}, {0xFF0C, 0xFF0C, LineBreaker::CL},
+        {0xFF0D, 0xFF0D, LineBreaker::ID}, {0xFF0E, 0xFF0E, LineBreaker::CL},
+        {0xFF0F, 0xFF0F, LineBreaker::ID}, {0xFF10, 0xFF19, LineBreaker::NU},
+        {0xFF1A, 0xFF1B, LineBreaker::CL}, {0xFF1C, 0xFF1E, LineBreaker::ID},
+        {0xFF1F, 0xFF1F, LineBreaker::CL}, {0xFF20, 0xFFEF, LineBreaker::ID},
+        {0x1F300, 0x1FAFF, LineBreaker::ID},
+        {0x20000, 0x3FFFD, LineBreaker::ID}
+    };
+
+    constexpr bool isSorted(size_t i = 1u)
+    {
+        return i >= sizeof(classRanges) / sizeof(Range) ||
+            (classRanges[i - 1u].last < classRanges[i].first && isSorted(i + 1u));
+    }
+
+    static_assert(isSorted(), "Line break classes must be sorted for the binary search");
+}
+
+LineBreaker::Class LineBreaker::classOf(uint32_t codePoint)
+{
+    auto it = std::upper_bound(
+        std::begin(classRanges), std::end(classRanges), codePoint,
+        [](uint32_t cp, const Range& range) {
+            return cp < range.first;
+        }
+    );
+
+    if (it == std::begin(classRanges)) return AL;
+
+    --it;
+    return codePoint <= it->last ? it->lineClass : AL;
+}
+
+bool LineBreaker::breakBefore(uint32_t codePoint)
+{
+    Class curr = classOf(codePoint);
+
+    // Spaces and combining marks stick to what precedes them
+    if (curr == SP) {
+        mSpaces = mPrev != BK;
+        return false;
+    }
+    if (curr == CM) return false;
+
+    Class prev = mPrev;
+    bool spaces = mSpaces;
+    mPrev = curr;
+    mSpaces = false;
+
+    // Start of the line
+    if (prev == BK) return false;
+
+    // Never break before closing punctuation or after opening punctuation and glue
+    if (curr == CL || curr == GL || prev == OP || prev == GL) return false;
+
+    // Break after spaces
+    if (spaces) return true;
+
+    // Hyphens only break when they're not a sign
+    if (prev == HY) return curr != NU;
+    if (prev == BA) return true;
+
+    // Ideographs can be broken anywhere
+    return prev == ID || curr == ID;
+}
+
+void LineBreaker::reset()
+{
+    mPrev = BK;
+    mSpaces = false;
+}
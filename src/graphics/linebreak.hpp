@@ -0,0 +1,62 @@
+/*
+    This is free and unencumbered software released into the public domain.
+
+    Anyone is free to copy, modify, publish, use, compile, sell, or
+    distribute this software, either in source code form or as a compiled
+    binary, for any purpose, commercial or non-commercial, and by any
+    means.
+
+    In jurisdictions that recognize copyright laws, the author or authors
+    of this software dedicate any and all copyright interest in the
+    software to the public domain. We make this dedication for the benefit
+    of the public at large and to the detriment of our heirs and
+    successors. We intend this dedication to be an overt act of
+    relinquishment in perpetuity of all present and future rights to this
+    software under copyright law.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+    MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+    IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+    OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+    ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+    OTHER DEALINGS IN THE SOFTWARE.
+
+    For more information, please refer to <http://unlicense.org>
+*/
+
+#pragma once
+#include "../config.hpp"
+
+// Simplified UAX #14 line breaking: finds the places where a line can be wrapped
+class NX_HIDDEN LineBreaker
+{
+public:
+    enum Class : uint8_t
+    {
+        AL, // Alphabetic and everything else
+        BK, // Mandatory break
+        SP, // Space
+        GL, // Non-breaking glue
+        OP, // Opening punctuation
+        CL, // Closing punctuation, exclamation and infix separators
+        HY, // Hyphen
+        BA, // Break after
+        NU, // Numeric
+        ID, // Ideographic
+        CM  // Combining mark
+    };
+
+public:
+    static Class classOf(uint32_t codePoint);
+
+    // Feeds the next character of the line, returns true if the line can be broken before it
+    bool breakBefore(uint32_t codePoint);
+
+    // To be called at the start of every line
+    void reset();
+
+private:
+    Class mPrev {BK};
+    bool mSpaces {false};
+};
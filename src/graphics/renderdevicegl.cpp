@@ -1642,6 +1642,11 @@ uint32_t RenderDeviceGL::TextureGL::bufferSize() const
     return calcSize(mFormat, mWidth, mHeight);
 }
 
+uint32_t RenderDeviceGL::TextureGL::memorySize() const
+{
+    return mMemSize;
+}
+
 uint16_t RenderDeviceGL::TextureGL::width() const
 {
     return mWidth;
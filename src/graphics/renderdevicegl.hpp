@@ -256,6 +256,7 @@ private:
             uint16_t height, uint8_t slice, uint8_t level);
         bool data(void* buffer, uint8_t slice, uint8_t level) const;
         uint32_t bufferSize() const;
+        uint32_t memorySize() const;
 
         uint16_t width() const;
         uint16_t height() const;
@@ -1648,6 +1648,11 @@ uint32_t RenderDeviceGLES2::TextureGLES2::bufferSize() const
     return calcSize(mFormat, mWidth, mHeight);
 }
 
+uint32_t RenderDeviceGLES2::TextureGLES2::memorySize() const
+{
+    return mMemSize;
+}
+
 uint16_t RenderDeviceGLES2::TextureGLES2::width() const
 {
     return mWidth;
@@ -26,33 +26,17 @@
 */
 
 #include "rtltext.hpp"
+#include "arabic.hpp"
+#include "linebreak.hpp"
 #include "renderdevice.hpp"
 
 #include <algorithm>
 #include <cmath>
-#include <set>
 
-static bool isHarakat(uint32_t haraka)
+RtlText::RtlText()
 {
-    static std::set<uint32_t> harakat {
-        0x0600, 0x0601, 0x0602, 0x0603, 0x0606, 0x0607, 0x0608, 0x0609,
-        0x060A, 0x060B, 0x060D, 0x060E, 0x0610, 0x0611, 0x0612, 0x0613,
-        0x0614, 0x0615, 0x0616, 0x0617, 0x0618, 0x0619, 0x061A, 0x061B,
-        0x061E, 0x061F, 0x063B, 0x063C, 0x063D, 0x063E, 0x063F, 0x0640,
-        0x064B, 0x064C, 0x064D, 0x064E, 0x064F, 0x0650, 0x0651, 0x0652,
-        0x0653, 0x0654, 0x0655, 0x0656, 0x0657, 0x0658, 0x0659, 0x065A,
-        0x065B, 0x065C, 0x065D, 0x065E, 0x0660, 0x066A, 0x066B, 0x066C,
-        0x066F, 0x0670, 0x0672, 0x06D4, 0x06D5, 0x06D6, 0x06D7, 0x06D8,
-        0x06D9, 0x06DA, 0x06DB, 0x06DC, 0x06DF, 0x06E0, 0x06E1, 0x06E2,
-        0x06E3, 0x06E4, 0x06E5, 0x06E6, 0x06E7, 0x06E8, 0x06E9, 0x06EA,
-        0x06EB, 0x06EC, 0x06ED, 0x06EE, 0x06EF, 0x06D6, 0x06D7, 0x06D8,
-        0x06D9, 0x06DA, 0x06DB, 0x06DC, 0x06DD, 0x06DE, 0x06DF, 0x06F0,
-        0x06FD, 0xFE70, 0xFE71, 0xFE72, 0xFE73, 0xFE74, 0xFE75, 0xFE76,
-        0xFE77, 0xFE78, 0xFE79, 0xFE7A, 0xFE7B, 0xFE7C, 0xFE7D, 0xFE7E,
-        0xFE7F, 0xFC5E, 0xFC5F, 0xFC60, 0xFC61, 0xFC62, 0xFC63
-    };
-
-    return harakat.find(haraka) != harakat.end();
+    mRightToLeft = true;
+    mAlignment = Right;
 }
 
 void RtlText::characterPosition(size_t index, float& x, float& y) const
@@ -63,149 +47,115 @@ void RtlText::characterPosition(size_t index, float& x, float& y) const
     // Make sure that we have a valid font
     if (!mFont) return;
 
-    // Adjust the index if it's out of range
-    if (index > mString.size()) index = mString.size();
+    ensureGeometryUpdate();
 
-    // Precompute stuff
-    bool bold = (mStyle & Bold) != 0;
-    float hspace = static_cast<float>(mFont->glyph(U' ', mCharSize, bold).advance);
-    float vspace = static_cast<float>(mFont->lineSpacing(mCharSize));
-
-    // Compute the position
-    uint32_t prevChar {0u};
-    for (size_t i = 0; i < index; ++i) {
-        uint32_t currChar = mString[i];
-
-        if (isHarakat(currChar)) {
-            index++;
-            continue;
-        }
+    // Harakat are skipped, the position is right after the index-th character
+    size_t stringIndex = 0u;
+    if (index > 0u) {
+        stringIndex = index <= mClusters.size() ? mClusters[index - 1u] + 1u : mString.size();
+    }
 
-        // Apply the kerning offset
-        x -= static_cast<float>(mFont->kerning(currChar, prevChar, mCharSize));
-        prevChar = currChar;
+    Text::characterPosition(stringIndex, x, y);
+}
 
-        // Handle special characters
-        switch (currChar) {
-            case U' ':  x -= hspace;        continue;
-            case U'\t': x -= hspace * 4;    continue;
-            case U'\n': x = 0; y += vspace; continue;
-        }
+size_t RtlText::characterAt(float x, float y) const
+{
+    size_t stringIndex = Text::characterAt(x, y);
+    if (!mFont) return 0u;
 
-        // For regular characters, add the advance offset of the glyph
-        x -= static_cast<float>(mFont->glyph(currChar, mCharSize, bold).advance);
-    }
+    // Number of characters before that position, not counting harakat
+    auto it = std::lower_bound(mClusters.begin(), mClusters.end(), stringIndex);
+    return static_cast<size_t>(it - mClusters.begin());
 }
 
 void RtlText::ensureGeometryUpdate() const
 {
-    // mNextPointer = mVertices.cbegin();
-
     // If geometry is already up-to-date, do nothing
     if (!mNeedsUpdate) return;
 
     // Mark the geometry as updated
     mNeedsUpdate = false;
 
-    // Reset variables
-    mBoundsX = mBoundsY = mBoundsW = mBoundsH = 0;
-
     // No font or no string: nothing to draw
     if (!mFont || mString.empty()) {
-        mNextPointer = mVertices.cbegin();
+        mClusters.clear();
+        mFirstChanged = 0u;
+        beginGeometryUpdate();
+
+        Pen pen = mLayout[0].pen;
+        beginLine(0u, pen);
+        endCharacterGeometry(0.f, pen);
+        finishGeometryUpdate(pen);
         return;
     }
 
-    // Temporary buffer
-    using BufType = std::vector<float>;
-    std::map<uint32_t, BufType> buffers;
-
     // Compute values related to the text style
-    bool bold                = (mStyle & Bold) != 0;
-    bool underlined          = (mStyle & Underlined) != 0;
-    bool strikeThrough       = (mStyle & StrikeThrough) != 0;
-    float italic             = (mStyle & Italic) ? -0.104f : 0.f; // 6 degrees
-    float underlineOffset    = mFont->underlinePosition(mCharSize);
-    float underlineThickness = mFont->underlineThickness(mCharSize);
-
-    // Compute the location of the strike through dynamically
-    // We use the center point of the lowercase 'x' glyph as thee reference
-    // We reuse teh underline thickness as the thickness of the strike through as well
-    auto& xGlyph = mFont->glyph(U'x', mCharSize, bold);
-    float xBoundsY {xGlyph.top}, xBoundsH {xGlyph.height};
-
-    float strikeThroughOffset = xBoundsY + xBoundsH / 2.f;
+    bool bold    = (mStyle & Bold) != 0;
+    float italic = (mStyle & Italic) ? -0.104f : 0.f; // 6 degrees
 
     // Precompute the variables needed by the algorithm
     float hspace = static_cast<float>(mFont->glyph(U' ', mCharSize, bold).advance);
-    float vspace = static_cast<float>(mFont->lineSpacing(mCharSize));
-    float x      = 0.f;
-    float y      = static_cast<float>(mCharSize);
 
-    // Create create two triangles for each character
-    float minX = 0.f;
-    float minY = static_cast<float>(mCharSize);
-    float maxX = 0.f;
-    float maxY = 0.f;
-    uint32_t currChar = 0u, prevChar;
+    // Resume from the pen state of the first line that changed
+    size_t first = beginGeometryUpdate();
+    Pen pen = mLayout[first].pen;
+    uint32_t currChar = first > 0u ? static_cast<uint32_t>(mString[first - 1u]) : 0u, prevChar;
+    beginLine(first, pen);
 
-    float lastExtraSpace = 0.f;
+    mClusters.erase(std::lower_bound(mClusters.begin(), mClusters.end(), first), mClusters.end());
 
-    for (size_t i = 0u; i < mString.size(); ++i) {
+    // Line wrapping state
+    bool wrap = mMaxWidth > 0.f;
+    LineBreaker breaker;
+    size_t breakAt = first;
+    float breakWidth = 0.f;
+    float lineWidth = 0.f;
+
+    // Create a quad for each character
+    for (size_t i = first; i < mString.size(); ++i) {
         prevChar = currChar;
         currChar = static_cast<uint32_t>(mString[i]);
 
-        // Apply the kerning offset
-        x += static_cast<float>(mFont->kerning(currChar, prevChar, mCharSize));
-
-        // If we're using the underlined style and there's a new line, draw a line
-        if (underlined && (currChar == U'\n')) {
-            float top = std::floor(y + underlineOffset - (underlineThickness / 2) + 0.5f);
-            float bottom = top + std::floor(underlineThickness + 0.5f);
-
-            float vertices[24] {
-                0.f,                top,    1.f, 1.f,
-                lastExtraSpace - x, top,    1.f, 1.f,
-                lastExtraSpace - x, bottom, 1.f, 1.f,
-                0.f,                top,    1.f, 1.f,
-                lastExtraSpace - x, bottom, 1.f, 1.f,
-                0.f,                bottom, 1.f, 1.f
-            };
-            buffers[0].insert(buffers[0].end(), std::begin(vertices), std::end(vertices));
+        auto& layout = mLayout[i];
+        layout = {pen, currentLine(), 0u, NoQuad, NoQuad};
+
+        bool haraka = Arabic::isHarakat(currChar);
+        if (!haraka) mClusters.push_back(i);
+
+        // Remember the last place where the line can be wrapped
+        if (wrap && breaker.breakBefore(currChar)) {
+            breakAt = i;
+            breakWidth = lineWidth;
         }
 
-        // If we're using strike through style and there's a new line, draw a line accross
-        // all characters
-        if (strikeThrough && (currChar == U'\n')) {
-            float top = std::floor(y + strikeThroughOffset - (underlineThickness / 2) + 0.5f);
-            float bottom = top + std::floor(underlineThickness + 0.5f);
-
-            float vertices[24] {
-                0.f, top,           1.f, 1.f,
-                lastExtraSpace - x, top,    1.f, 1.f,
-                lastExtraSpace - x, bottom, 1.f, 1.f,
-                0.f,                top,    1.f, 1.f,
-                lastExtraSpace - x, bottom, 1.f, 1.f,
-                0.f,                bottom, 1.f, 1.f
-            };
-            buffers[0].insert(buffers[0].end(), std::begin(vertices), std::end(vertices));
+        // Apply the kerning offset
+        pen.x += static_cast<float>(mFont->kerning(currChar, prevChar, mCharSize));
+
+        // If there's a new line, draw the underline and strike through lines up to here
+        if (currChar == U'\n') {
+            layout.lineQuad = decorateLine(pen, pen.extra - pen.x, 0.f);
         }
 
         // Handle special characters
         if (currChar == U' ' || currChar == U'\t' || currChar == U'\n') {
             // Update the current bounds (min coodinates)
-            minX = std::min(minX, -x);
-            minY = std::min(minY, y);
+            pen.minX = std::min(pen.minX, -pen.x);
+            pen.minY = std::min(pen.minY, pen.y);
 
             switch (currChar) {
-                case U' ':  x += hspace;        break;
-                case U'\t': x += hspace * 4;    break;
-                case U'\n': y += vspace; x = 0; break;
+                case U' ':  pen.x += hspace;     break;
+                case U'\t': pen.x += hspace * 4; break;
+                case U'\n':
+                    newLine(i + 1u, lineWidth, pen);
+                    breaker.reset();
+                    breakAt = i + 1u;
+                    lineWidth = 0.f;
+                    break;
             }
 
             // Update the current bounds (max coordinates)
-            maxX = std::max(maxX, -x);
-            maxY = std::max(maxY, y);
+            pen.maxX = std::max(pen.maxX, -pen.x);
+            pen.maxY = std::max(pen.maxY, pen.y);
 
             // next glyph, no need to create a quad for whitespace
             continue;
@@ -214,19 +164,39 @@ void RtlText::ensureGeometryUpdate() const
         // Extract the current glyph's descripts
         const auto& glyph = mFont->glyph(currChar, mCharSize, bold);
 
+        // Wrap the line if the glyph doesn't fit, words that don't fit on their own are split
+        if (wrap && !haraka && pen.x + glyph.advance > mMaxWidth && i > mLines.back().first) {
+            if (breakAt <= mLines.back().first) {
+                breakAt = i;
+                breakWidth = lineWidth;
+            }
+
+            wrapLine(breakAt, i, breakWidth, pen);
+            breaker.reset();
+            lineWidth = 0.f;
+            mClusters.erase(
+                std::lower_bound(mClusters.begin(), mClusters.end(), breakAt), mClusters.end()
+            );
+
+            // Carry on from the start of the new line, without kerning
+            i = breakAt - 1u;
+            currChar = 0u;
+            continue;
+        }
+
         float left   = glyph.left - 0.25f;
         float top    = glyph.top - 0.25f;
         float right  = glyph.left + glyph.width + 0.25f;
         float bottom = glyph.top + glyph.height + 0.25f;
 
-        x += glyph.advance;
+        pen.x += glyph.advance;
 
-        float x1 = -x + left;
-        float x2 = -x + right;
-        float y1 = y + top;
-        float y2 = y + bottom;
+        float x1 = -pen.x + left;
+        float x2 = -pen.x + right;
+        float y1 = pen.y + top;
+        float y2 = pen.y + bottom;
 
-        lastExtraSpace = glyph.advance - right;
+        pen.extra = glyph.advance - right;
 
         if (glyph.texWidth != 0 && glyph.texHeight != 0) {
             float u1 = glyph.texLeft - 0.25f;
@@ -234,8 +204,8 @@ void RtlText::ensureGeometryUpdate() const
             float u2 = glyph.texLeft + glyph.texWidth + 0.25f;
             float v2 = glyph.texTop + glyph.texHeight + 0.25f;
 
-            if (prevChar && isHarakat(currChar)) {
-                x -= glyph.advance;
+            if (prevChar && haraka) {
+                pen.x -= glyph.advance;
 
                 const auto& prevGlyph = mFont->glyph(prevChar, mCharSize, bold);
                 auto xOffset = (prevGlyph.advance + glyph.width) / 2.f;
@@ -243,89 +213,42 @@ void RtlText::ensureGeometryUpdate() const
                 x2 += xOffset;
 
                 if (glyph.top >= 0) {
-                    auto offset = y + prevGlyph.height + prevGlyph.top + mCharSize / 20;
+                    auto offset = pen.y + prevGlyph.height + prevGlyph.top + mCharSize / 20;
                     y1 = offset;
                     y2 = offset + glyph.height;
                 }
                 else {
-                    auto offset = y + prevGlyph.top - glyph.height - mCharSize / 20;
+                    auto offset = pen.y + prevGlyph.top - glyph.height - mCharSize / 20;
                     y1 = offset;
                     y2 = offset + glyph.height;
                 }
             }
 
             // Add a quad for the current character
-            float vertices[24] {
+            float vertices[16] {
                 x2 - italic * top,    y1, u2, v1,
                 x1 - italic * top,    y1, u1, v1,
                 x1 - italic * bottom, y2, u1, v2,
-                x2 - italic * top,    y1, u2, v1,
-                x1 - italic * bottom, y2, u1, v2,
                 x2 - italic * bottom, y2, u2, v2
             };
 
-            // Append vertices to the corresponding buffer
-            auto& buffer = buffers[glyph.page];
-            buffer.insert(buffer.end(), std::begin(vertices), std::end(vertices));
+            layout.page = glyph.page;
+            layout.quad = appendQuad(glyph.page, vertices);
         }
 
         // Update the current bounds
-        minX = std::min(minX, x1 - italic * bottom);
-        maxX = std::max(maxX, x2 - italic * top);
-        minY = std::min(minY, y1);
-        maxY = std::max(maxY, y2);
-    }
+        pen.minX = std::min(pen.minX, x1 - italic * bottom);
+        pen.maxX = std::max(pen.maxX, x2 - italic * top);
+        pen.minY = std::min(pen.minY, y1);
+        pen.maxY = std::max(pen.maxY, y2);
 
-    // If we're using the underlined style, add the last line
-    if (underlined) {
-        float top = std::floor(y + underlineOffset - (underlineThickness / 2) + 0.5f);
-        float bottom = top + std::floor(underlineThickness + 0.5f);
-
-        float vertices[24] {
-            0.f,                top,    1.f, 1.f,
-            lastExtraSpace - x, top,    1.f, 1.f,
-            lastExtraSpace - x, bottom, 1.f, 1.f,
-            0.f,                top,    1.f, 1.f,
-            lastExtraSpace - x, bottom, 1.f, 1.f,
-            0.f,                bottom, 1.f, 1.f
-        };
-        buffers[0].insert(buffers[0].end(), std::begin(vertices), std::end(vertices));
+        lineWidth = pen.x;
     }
 
-    // If we're using the strike through style, add the last line across all characters
-    if (strikeThrough) {
-        float top = std::floor(y + strikeThroughOffset - (underlineThickness / 2) + 0.5f);
-        float bottom = top + std::floor(underlineThickness + 0.5f);
-
-        float vertices[24] {
-            0.f,                top,    1.f, 1.f,
-            lastExtraSpace - x, top,    1.f, 1.f,
-            lastExtraSpace - x, bottom, 1.f, 1.f,
-            0.f,                top,    1.f, 1.f,
-            lastExtraSpace - x, bottom, 1.f, 1.f,
-            0.f,                bottom, 1.f, 1.f
-        };
-        buffers[0].insert(buffers[0].end(), std::begin(vertices), std::end(vertices));
-    }
-
-    mBoundsX = minX;
-    mBoundsY = minY;
-    mBoundsW = maxX - minX;
-    mBoundsH = maxY - minY;
-
-    mVertices.clear();
-    for (auto& it : buffers) {
-        if (it.second.empty()) continue;
+    endCharacterGeometry(lineWidth, pen);
 
-        auto buf = RenderDevice::instance().newVertexBuffer();
-        buf->load(
-            it.second.data(),
-            static_cast<uint32_t>(it.second.size() * sizeof(float)),
-            4 * sizeof(float)
-        );
-
-        mVertices[it.first] = std::shared_ptr<VertexBuffer>(buf);
-    }
+    // Decorate the last line
+    decorateLine(pen, pen.extra - pen.x, 0.f);
 
-    mNextPointer = mVertices.cbegin();
+    finishGeometryUpdate(pen);
 }
@@ -28,12 +28,19 @@
 #pragma once
 #include "text.hpp"
 
+#include <vector>
+
 class RtlText : public Text
 {
 public:
+    RtlText();
     virtual ~RtlText() = default;
     void characterPosition(size_t index, float& x, float& y) const;
+    size_t characterAt(float x, float y) const;
 
 protected:
     virtual void ensureGeometryUpdate() const;
+
+    // Characters that aren't harakat, character indices skip the others
+    mutable std::vector<size_t> mClusters;
 };
@@ -26,11 +26,22 @@
 */
 
 #include "text.hpp"
+#include "linebreak.hpp"
 #include "renderdevice.hpp"
 #include "../system/unicode.hpp"
 
 #include <algorithm>
 #include <cmath>
+#include <iterator>
+#include <limits>
+
+constexpr uint32_t Text::MaxQuadsPerDraw;
+constexpr uint32_t Text::NoQuad;
+
+Text::Text()
+{
+    mNextPointer = mPages.cbegin();
+}
 
 void Text::setString(const std::string& str)
 {
@@ -39,8 +50,12 @@ void Text::setString(const std::string& str)
 
 void Text::setString(const std::u32string& str)
 {
-    mString = str;
-    mNeedsUpdate = true;
+    // Only the characters after the common prefix need to be laid out again
+    size_t common = std::min(mString.size(), str.size());
+    auto diff = std::mismatch(str.begin(), str.begin() + common, mString.begin());
+
+    invalidateGeometry(static_cast<size_t>(diff.first - str.begin()));
+    mString.assign(str);
 }
 
 void Text::setFont(const Font& font)
@@ -48,7 +63,7 @@ void Text::setFont(const Font& font)
     if (mFont == &font) return;
 
     mFont = &font;
-    mNeedsUpdate = true;
+    invalidateGeometry();
 }
 
 void Text::setCharacterSize(uint32_t charSize)
@@ -56,7 +71,7 @@ void Text::setCharacterSize(uint32_t charSize)
     if (mCharSize == charSize) return;
 
     mCharSize = charSize;
-    mNeedsUpdate = true;
+    invalidateGeometry();
 }
 
 void Text::setStyle(uint8_t style)
@@ -64,7 +79,25 @@ void Text::setStyle(uint8_t style)
     if (mStyle == style) return;
 
     mStyle = style;
-    mNeedsUpdate = true;
+    invalidateGeometry();
+}
+
+void Text::setMaxWidth(float maxWidth)
+{
+    maxWidth = std::max(maxWidth, 0.f);
+    if (mMaxWidth == maxWidth) return;
+
+    mMaxWidth = maxWidth;
+    invalidateGeometry();
+}
+
+void Text::setAlignment(Alignment alignment)
+{
+    if (mAlignment == alignment) return;
+
+    // Only the line offsets change
+    mAlignment = alignment;
+    invalidateGeometry(mString.size());
 }
 
 const std::u32string& Text::string() const
@@ -87,6 +120,16 @@ uint8_t Text::style() const
     return mStyle;
 }
 
+float Text::maxWidth() const
+{
+    return mMaxWidth;
+}
+
+Text::Alignment Text::alignment() const
+{
+    return mAlignment;
+}
+
 void Text::characterPosition(size_t index, float& x, float& y) const
 {
     // Initialize the positions to 0
@@ -95,33 +138,50 @@ void Text::characterPosition(size_t index, float& x, float& y) const
     // Make sure that we have a valid font
     if (!mFont) return;
 
+    ensureGeometryUpdate();
+
     // Adjust the index if it's out of range
     if (index > mString.size()) index = mString.size();
 
-    // Precompute stuff
-    bool bold = (mStyle & Bold) != 0;
-    float hspace = static_cast<float>(mFont->glyph(U' ', mCharSize, bold).advance);
-    float vspace = static_cast<float>(mFont->lineSpacing(mCharSize));
+    const auto& layout = mLayout[index];
+    x = (mRightToLeft ? -layout.pen.x : layout.pen.x) + mLines[layout.line].offset;
+    y = layout.pen.y - static_cast<float>(mCharSize);
+}
 
-    // Compute the position
-    uint32_t prevChar {0u};
-    for (size_t i = 0; i < index; ++i) {
-        uint32_t currChar = mString[i];
+size_t Text::characterAt(float x, float y) const
+{
+    if (!mFont) return 0u;
 
-        // Apply the kerning offset
-        x += static_cast<float>(mFont->kerning(prevChar, currChar, mCharSize));
-        prevChar = currChar;
+    ensureGeometryUpdate();
 
-        // Handle special characters
-        switch (currChar) {
-            case U' ':  x += hspace;        continue;
-            case U'\t': x += hspace * 4;    continue;
-            case U'\n': x = 0; y += vspace; continue;
+    // Find the line, they're sorted from top to bottom
+    auto lineIt = std::upper_bound(mLines.begin(), mLines.end(), y,
+        [](float y, const LineLayout& line) {
+            return y < line.top;
         }
+    );
+    size_t line = lineIt == mLines.begin() ? 0u : static_cast<size_t>(lineIt - mLines.begin()) - 1u;
 
-        // For regular characters, add the advance offset of the glyph
-        x += static_cast<float>(mFont->glyph(currChar, mCharSize, bold).advance);
-    }
+    // Carets of the line, the one before the next line's first character isn't part of it
+    size_t first = mLines[line].first;
+    size_t last = line + 1u < mLines.size() ? mLines[line + 1u].first - 1u : mString.size();
+
+    // Pen positions grow along the line
+    float target = x - mLines[line].offset;
+    if (mRightToLeft) target = -target;
+
+    auto begin = mLayout.begin() + static_cast<std::ptrdiff_t>(first);
+    auto end = mLayout.begin() + static_cast<std::ptrdiff_t>(last + 1u);
+    auto it = std::lower_bound(begin, end, target, [](const CharLayout& layout, float target) {
+        return layout.pen.x < target;
+    });
+
+    if (it == begin) return first;
+    if (it == end) return last;
+
+    // Pick the closest of the two carets around the target
+    size_t index = static_cast<size_t>(it - mLayout.begin());
+    return target - mLayout[index - 1u].pen.x < mLayout[index].pen.x - target ? index - 1u : index;
 }
 
 void Text::bounds(float& x, float& y, float& w, float& h) const
@@ -133,126 +193,438 @@ void Text::bounds(float& x, float& y, float& w, float& h) const
     h = mBoundsH;
 }
 
-VertexBuffer* Text::nextBuffer(uint32_t* index) const
+size_t Text::lineCount() const
+{
+    ensureGeometryUpdate();
+    return mLines.size();
+}
+
+Text::LineMetrics Text::lineMetrics(size_t line) const
 {
     ensureGeometryUpdate();
 
-    if (mNextPointer == mVertices.cend()) {
-        mNextPointer = mVertices.cbegin();
+    LineMetrics metrics {0u, 0u, 0.f, 0.f, 0.f, 0.f, 0.f};
+    if (line >= mLines.size()) return metrics;
+
+    const auto& layout = mLines[line];
+    size_t next = line + 1u < mLines.size() ? mLines[line + 1u].first : mString.size();
+
+    metrics.first    = layout.first;
+    metrics.count    = next - layout.first;
+    metrics.x        = layout.offset + (mRightToLeft ? -layout.width : 0.f);
+    metrics.y        = layout.top;
+    metrics.width    = layout.width;
+    metrics.height   = mFont ? mFont->lineSpacing(mCharSize) : 0.f;
+    metrics.baseline = layout.top + static_cast<float>(mCharSize);
+    return metrics;
+}
+
+VertexBuffer* Text::nextBuffer(uint32_t* index, uint32_t* quadCount) const
+{
+    ensureGeometryUpdate();
+
+    // Skip pages that aren't used anymore
+    while (mNextPointer != mPages.cend() && mNextPointer->second.quadCount == 0u) {
+        ++mNextPointer;
+    }
+
+    if (mNextPointer == mPages.cend()) {
+        mNextPointer = mPages.cbegin();
         return nullptr;
     }
 
     *index = mNextPointer->first;
-    return (mNextPointer++)->second.get();
+    *quadCount = mNextPointer->second.quadCount;
+    return (mNextPointer++)->second.buffer.get();
 }
 
-void Text::ensureGeometryUpdate() const
+IndexBuffer* Text::quadIndexBuffer()
+{
+    // Shared by all texts, kept alive until exit so it's never released after the context
+    static IndexBuffer* buffer {nullptr};
+
+    if (!buffer) {
+        // Two triangles per quad: top-right, top-left, bottom-left and bottom-right corners
+        std::vector<uint16_t> indices(MaxQuadsPerDraw * 6u);
+        for (uint32_t i = 0u; i < MaxQuadsPerDraw; ++i) {
+            auto first = static_cast<uint16_t>(i * 4u);
+            uint16_t quad[6] {
+                first, static_cast<uint16_t>(first + 1u), static_cast<uint16_t>(first + 2u),
+                first, static_cast<uint16_t>(first + 2u), static_cast<uint16_t>(first + 3u)
+            };
+            std::copy(std::begin(quad), std::end(quad), indices.begin() + i * 6u);
+        }
+
+        buffer = RenderDevice::instance().newIndexBuffer();
+        buffer->load(
+            indices.data(),
+            static_cast<uint32_t>(indices.size() * sizeof(uint16_t)),
+            IndexBuffer::_16
+        );
+    }
+
+    return buffer;
+}
+
+void Text::invalidateGeometry(size_t firstChar)
+{
+    mFirstChanged = std::min(mFirstChanged, firstChar);
+    mNeedsUpdate = true;
+}
+
+size_t Text::beginGeometryUpdate() const
+{
+    // Start from the first changed character, as long as we have its pen state
+    size_t first = std::min(mFirstChanged, mString.size());
+    first = std::min(first, mLayoutCount > 0u ? mLayoutCount - 1u : 0u);
+
+    // Lay out whole lines again, starting from the previous one when wrapping
+    // since the first word of the changed line might fit there now
+    size_t line = 0u;
+    if (first > 0u) {
+        line = mLayout[first].line;
+        if (mMaxWidth > 0.f && line > 0u) --line;
+        first = mLines[line].first;
+    }
+
+    if (first == 0u) {
+        line = 0u;
+        for (auto& it : mPages) {
+            it.second.quadCount = 0u;
+            it.second.vertices.clear();
+            it.second.dirtyFrom = 0u;
+        }
+    }
+    else {
+        // Drop the trailing lines and the quads of every character from the first changed one
+        for (auto& it : mPages) {
+            it.second.quadCount = it.second.bodyQuads;
+        }
+        truncateGeometry(first, mLayoutCount);
+    }
+
+    mLines.resize(line);
+
+    // Initial pen state
+    if (first == 0u) {
+        float top = static_cast<float>(mCharSize);
+        mLayout.resize(1u);
+        mLayout[0] = {{0.f, top, 0.f, top, 0.f, 0.f, 0.f}, 0u, 0u, NoQuad, NoQuad};
+    }
+
+    mLayout.resize(mString.size() + 1u);
+    mLayoutCount = mString.size() + 1u;
+
+    return first;
+}
+
+void Text::truncateGeometry(size_t first, size_t last) const
+{
+    for (size_t i = first; i < last; ++i) {
+        const auto& layout = mLayout[i];
+        if (layout.lineQuad != NoQuad) {
+            auto& page = mPages[0];
+            page.quadCount = std::min(page.quadCount, layout.lineQuad);
+        }
+        if (layout.quad != NoQuad) {
+            auto& page = mPages[layout.page];
+            page.quadCount = std::min(page.quadCount, layout.quad);
+        }
+    }
+
+    for (auto& it : mPages) {
+        it.second.vertices.resize(it.second.quadCount * 16u);
+        it.second.dirtyFrom = std::min(it.second.dirtyFrom, it.second.quadCount);
+    }
+}
+
+uint32_t Text::appendQuad(uint32_t page, const float* vertices) const
+{
+    auto& geometry = mPages[page];
+    geometry.vertices.insert(geometry.vertices.end(), vertices, vertices + 16u);
+    return geometry.quadCount++;
+}
+
+uint32_t Text::decorateLine(const Pen& pen, float left, float right) const
+{
+    bool bold          = (mStyle & Bold) != 0;
+    bool underlined    = (mStyle & Underlined) != 0;
+    bool strikeThrough = (mStyle & StrikeThrough) != 0;
+    if (!underlined && !strikeThrough) return NoQuad;
+
+    float thickness = mFont->underlineThickness(mCharSize);
+
+    auto addLine = [&](float offset) {
+        float top = std::floor(pen.y + offset - (thickness / 2) + 0.5f);
+        float bottom = top + std::floor(thickness + 0.5f);
+
+        float vertices[16] {
+            right, top,    1.f, 1.f,
+            left,  top,    1.f, 1.f,
+            left,  bottom, 1.f, 1.f,
+            right, bottom, 1.f, 1.f
+        };
+        return appendQuad(0u, vertices);
+    };
+
+    uint32_t first = NoQuad;
+
+    // If we're using the underlined style, add a line under the text
+    if (underlined) {
+        first = addLine(mFont->underlinePosition(mCharSize));
+    }
+
+    // If we're using the strike through style, add a line across all characters
+    // We use the center point of the lowercase 'x' glyph as the reference
+    if (strikeThrough) {
+        auto& xGlyph = mFont->glyph(U'x', mCharSize, bold);
+        auto quad = addLine(xGlyph.top + xGlyph.height / 2.f);
+        if (first == NoQuad) first = quad;
+    }
+
+    return first;
+}
+
+void Text::beginLine(size_t first, const Pen& pen) const
+{
+    mLines.push_back({first, pen.y - static_cast<float>(mCharSize), 0.f, 0.f, 0.f, 0.f});
+}
+
+void Text::newLine(size_t next, float width, Pen& pen) const
+{
+    auto& line = mLines.back();
+    line.width = width;
+    line.minX  = pen.minX;
+    line.maxX  = pen.maxX;
+
+    pen.y += mFont->lineSpacing(mCharSize);
+    pen.x = pen.minX = pen.maxX = 0.f;
+    beginLine(next, pen);
+}
+
+void Text::wrapLine(size_t breakAt, size_t end, float width, Pen& pen) const
+{
+    // Throw away what was laid out past the break
+    truncateGeometry(breakAt, end);
+    pen = mLayout[breakAt].pen;
+
+    // Decorate the line up to its last visible character
+    float left  = mRightToLeft ? pen.extra - width : 0.f;
+    float right = mRightToLeft ? 0.f : width;
+    mLayout[breakAt - 1u].lineQuad = decorateLine(pen, left, right);
+
+    newLine(breakAt, width, pen);
+}
+
+void Text::endCharacterGeometry(float width, const Pen& pen) const
 {
-    // mNextPointer = mVertices.cbegin();
+    // Pen state at the end of the string
+    mLayout[mString.size()] = {pen, currentLine(), 0u, NoQuad, NoQuad};
+
+    auto& line = mLines.back();
+    line.width = width;
+    line.minX  = pen.minX;
+    line.maxX  = pen.maxX;
+
+    for (auto& it : mPages) {
+        it.second.bodyQuads = it.second.quadCount;
+    }
+}
+
+void Text::finishGeometryUpdate(const Pen& pen) const
+{
+    constexpr uint32_t quadSize = 16u * sizeof(float);
+
+    // Align lines inside the max width, or the widest line if there's none
+    float boxWidth = mMaxWidth;
+    if (boxWidth <= 0.f) {
+        for (const auto& line : mLines) boxWidth = std::max(boxWidth, line.width);
+    }
+    float boxLeft = mRightToLeft ? -boxWidth : 0.f;
+
+    for (size_t i = 0u; i < mLines.size(); ++i) {
+        auto& line = mLines[i];
+        float left = mRightToLeft ? -line.width : 0.f;
+
+        float offset = boxLeft - left;
+        if (mAlignment == Center) {
+            offset += (boxWidth - line.width) / 2.f;
+        }
+        else if (mAlignment == Right) {
+            offset += boxWidth - line.width;
+        }
+        offset = std::floor(offset + 0.5f);
+
+        if (offset != line.offset) {
+            shiftLine(i, offset - line.offset);
+            line.offset = offset;
+        }
+    }
+
+    // Update the bounds
+    if (mFont && !mString.empty()) {
+        float minX = std::numeric_limits<float>::max();
+        float maxX = std::numeric_limits<float>::lowest();
+        for (const auto& line : mLines) {
+            minX = std::min(minX, line.offset + line.minX);
+            maxX = std::max(maxX, line.offset + line.maxX);
+        }
+
+        mBoundsX = minX;
+        mBoundsY = pen.minY;
+        mBoundsW = maxX - minX;
+        mBoundsH = pen.maxY - pen.minY;
+    }
+    else {
+        mBoundsX = mBoundsY = mBoundsW = mBoundsH = 0.f;
+    }
+
+    for (auto& it : mPages) {
+        auto& page = it.second;
+        if (page.quadCount == 0u) continue;
+
+        if (page.quadCount > page.capacity) {
+            // Grow the GPU buffer
+            uint32_t capacity = std::max(page.capacity, 16u);
+            while (capacity < page.quadCount) capacity *= 2u;
+
+            if (!page.buffer) page.buffer.reset(RenderDevice::instance().newVertexBuffer());
+            page.buffer->load(nullptr, capacity * quadSize, 4u * sizeof(float));
+            page.capacity = capacity;
+            page.dirtyFrom = 0u;
+        }
+
+        if (page.dirtyFrom < page.quadCount) {
+            // Only upload what changed
+            page.buffer->update(
+                page.vertices.data() + page.dirtyFrom * 16u,
+                (page.quadCount - page.dirtyFrom) * quadSize,
+                page.dirtyFrom * quadSize
+            );
+        }
+
+        page.dirtyFrom = page.quadCount;
+    }
 
+    mFirstChanged = std::numeric_limits<size_t>::max();
+    mNextPointer = mPages.cbegin();
+}
+
+void Text::shiftLine(size_t line, float delta) const
+{
+    auto shiftQuads = [&](uint32_t page, uint32_t quad, uint32_t count) {
+        auto& geometry = mPages[page];
+        for (uint32_t i = quad * 4u; i < (quad + count) * 4u; ++i) {
+            geometry.vertices[i * 4u] += delta;
+        }
+        geometry.dirtyFrom = std::min(geometry.dirtyFrom, quad);
+    };
+
+    uint32_t decorations = ((mStyle & Underlined) ? 1u : 0u) + ((mStyle & StrikeThrough) ? 1u : 0u);
+    bool lastLine = line + 1u == mLines.size();
+    size_t first = mLines[line].first;
+    size_t last = lastLine ? mString.size() : mLines[line + 1u].first;
+
+    for (size_t i = first; i < last; ++i) {
+        const auto& layout = mLayout[i];
+        if (layout.quad != NoQuad) shiftQuads(layout.page, layout.quad, 1u);
+        if (layout.lineQuad != NoQuad) shiftQuads(0u, layout.lineQuad, decorations);
+    }
+
+    // The trailing decorations belong to the last line
+    auto page = mPages.find(0u);
+    if (lastLine && page != mPages.end() && page->second.quadCount > page->second.bodyQuads) {
+        shiftQuads(0u, page->second.bodyQuads, page->second.quadCount - page->second.bodyQuads);
+    }
+}
+
+uint32_t Text::currentLine() const
+{
+    return static_cast<uint32_t>(mLines.size() - 1u);
+}
+
+void Text::ensureGeometryUpdate() const
+{
     // If geometry is already up-to-date, do nothing
     if (!mNeedsUpdate) return;
 
     // Mark the geometry as updated
     mNeedsUpdate = false;
 
-    // Reset variables
-    mBoundsX = mBoundsY = mBoundsW = mBoundsH = 0;
-
     // No font or no string: nothing to draw
     if (!mFont || mString.empty()) {
-        mNextPointer = mVertices.cbegin();
+        mFirstChanged = 0u;
+        beginGeometryUpdate();
+
+        Pen pen = mLayout[0].pen;
+        beginLine(0u, pen);
+        endCharacterGeometry(0.f, pen);
+        finishGeometryUpdate(pen);
         return;
     }
 
-    // Temporary buffer
-    using BufType = std::vector<float>;
-    std::map<uint32_t, BufType> buffers;
-
     // Compute values related to the text style
-    bool bold                = (mStyle & Bold) != 0;
-    bool underlined          = (mStyle & Underlined) != 0;
-    bool strikeThrough       = (mStyle & StrikeThrough) != 0;
-    float italic             = (mStyle & Italic) ? 0.208f : 0.f; // 12 degrees
-    float underlineOffset    = mFont->underlinePosition(mCharSize);
-    float underlineThickness = mFont->underlineThickness(mCharSize);
-
-    // Compute the location of the strike through dynamically
-    // We use the center point of the lowercase 'x' glyph as thee reference
-    // We reuse teh underline thickness as the thickness of the strike through as well
-    auto& xGlyph = mFont->glyph(U'x', mCharSize, bold);
-    float xBoundsY {xGlyph.top}, xBoundsH {xGlyph.height};
-
-    float strikeThroughOffset = xBoundsY + xBoundsH / 2.f;
+    bool bold    = (mStyle & Bold) != 0;
+    float italic = (mStyle & Italic) ? 0.208f : 0.f; // 12 degrees
 
     // Precompute the variables needed by the algorithm
     float hspace = static_cast<float>(mFont->glyph(U' ', mCharSize, bold).advance);
-    float vspace = static_cast<float>(mFont->lineSpacing(mCharSize));
-    float x      = 0.f;
-    float y      = static_cast<float>(mCharSize);
-
-    // Create create two triangles for each character
-    float minX = 0.f;
-    float minY = static_cast<float>(mCharSize);
-    float maxX = 0.f;
-    float maxY = 0.f;
-    uint32_t currChar = 0u, prevChar;
-
-    for (size_t i = 0u; i < mString.size(); ++i) {
+
+    // Resume from the pen state of the first line that changed
+    size_t first = beginGeometryUpdate();
+    Pen pen = mLayout[first].pen;
+    uint32_t currChar = first > 0u ? static_cast<uint32_t>(mString[first - 1u]) : 0u, prevChar;
+    beginLine(first, pen);
+
+    // Line wrapping state
+    bool wrap = mMaxWidth > 0.f;
+    LineBreaker breaker;
+    size_t breakAt = first;
+    float breakWidth = 0.f;
+    float lineWidth = 0.f;
+
+    // Create a quad for each character
+    for (size_t i = first; i < mString.size(); ++i) {
         prevChar = currChar;
         currChar = static_cast<uint32_t>(mString[i]);
 
-        // Apply the kerning offset
-        x += static_cast<float>(mFont->kerning(prevChar, currChar, mCharSize));
-
-        // If we're using the underlined style and there's a new line, draw a line
-        if (underlined && (currChar == U'\n')) {
-            float top = std::floor(y + underlineOffset - (underlineThickness / 2) + 0.5f);
-            float bottom = top + std::floor(underlineThickness + 0.5f);
-
-            float vertices[24] {
-                x,   top,    1.f, 1.f,
-                0.f, top,    1.f, 1.f,
-                0.f, bottom, 1.f, 1.f,
-                x,   top,    1.f, 1.f,
-                0.f, bottom, 1.f, 1.f,
-                x,   bottom, 1.f, 1.f
-            };
-            buffers[0].insert(buffers[0].end(), std::begin(vertices), std::end(vertices));
+        auto& layout = mLayout[i];
+        layout = {pen, currentLine(), 0u, NoQuad, NoQuad};
+
+        // Remember the last place where the line can be wrapped
+        if (wrap && breaker.breakBefore(currChar)) {
+            breakAt = i;
+            breakWidth = lineWidth;
         }
 
-        // If we're using strike through style and there's a new line, draw a line accross
-        // all characters
-        if (strikeThrough && (currChar == U'\n')) {
-            float top = std::floor(y + strikeThroughOffset - (underlineThickness / 2) + 0.5f);
-            float bottom = top + std::floor(underlineThickness + 0.5f);
-
-            float vertices[24] {
-                x,   top,    1.f, 1.f,
-                0.f, top,    1.f, 1.f,
-                0.f, bottom, 1.f, 1.f,
-                x,   top,    1.f, 1.f,
-                0.f, bottom, 1.f, 1.f,
-                x,   bottom, 1.f, 1.f
-            };
-            buffers[0].insert(buffers[0].end(), std::begin(vertices), std::end(vertices));
+        // Apply the kerning offset
+        pen.x += static_cast<float>(mFont->kerning(prevChar, currChar, mCharSize));
+
+        // If there's a new line, draw the underline and strike through lines up to here
+        if (currChar == U'\n') {
+            layout.lineQuad = decorateLine(pen, 0.f, pen.x);
         }
 
         // Handle special characters
         if (currChar == U' ' || currChar == U'\t' || currChar == U'\n') {
             // Update the current bounds (min coodinates)
-            minX = std::min(minX, x);
-            minY = std::min(minY, y);
+            pen.minX = std::min(pen.minX, pen.x);
+            pen.minY = std::min(pen.minY, pen.y);
 
             switch (currChar) {
-                case U' ':  x += hspace;        break;
-                case U'\t': x += hspace * 4;    break;
-                case U'\n': y += vspace; x = 0; break;
+                case U' ':  pen.x += hspace;     break;
+                case U'\t': pen.x += hspace * 4; break;
+                case U'\n':
+                    newLine(i + 1u, lineWidth, pen);
+                    breaker.reset();
+                    breakAt = i + 1u;
+                    lineWidth = 0.f;
+                    break;
             }
 
             // Update the current bounds (max coordinates)
-            maxX = std::max(maxX, x);
-            maxY = std::max(maxY, y);
+            pen.maxX = std::max(pen.maxX, pen.x);
+            pen.maxY = std::max(pen.maxY, pen.y);
 
             // next glyph, no need to create a quad for whitespace
             continue;
@@ -261,15 +633,32 @@ void Text::ensureGeometryUpdate() const
         // Extract the current glyph's descripts
         const auto& glyph = mFont->glyph(currChar, mCharSize, bold);
 
+        // Wrap the line if the glyph doesn't fit, words that don't fit on their own are split
+        if (wrap && pen.x + glyph.advance > mMaxWidth && i > mLines.back().first) {
+            if (breakAt <= mLines.back().first) {
+                breakAt = i;
+                breakWidth = lineWidth;
+            }
+
+            wrapLine(breakAt, i, breakWidth, pen);
+            breaker.reset();
+            lineWidth = 0.f;
+
+            // Carry on from the start of the new line, without kerning
+            i = breakAt - 1u;
+            currChar = 0u;
+            continue;
+        }
+
         float left   = glyph.left - 0.25f;
         float top    = glyph.top - 0.25f;
         float right  = glyph.left + glyph.width + 0.25f;
         float bottom = glyph.top + glyph.height + 0.25f;
 
-        float x1 = x + left;
-        float x2 = x + right;
-        float y1 = y + top;
-        float y2 = y + bottom;
+        float x1 = pen.x + left;
+        float x2 = pen.x + right;
+        float y1 = pen.y + top;
+        float y2 = pen.y + bottom;
 
         if (glyph.texWidth != 0 && glyph.texHeight != 0) {
             float u1 = glyph.texLeft - 0.25f;
@@ -278,80 +667,32 @@ void Text::ensureGeometryUpdate() const
             float v2 = glyph.texTop + glyph.texHeight + 0.25f;
 
             // Add a quad for the current character
-            float vertices[24] {
+            float vertices[16] {
                 x2 - italic * top,    y1, u2, v1,
                 x1 - italic * top,    y1, u1, v1,
                 x1 - italic * bottom, y2, u1, v2,
-                x2 - italic * top,    y1, u2, v1,
-                x1 - italic * bottom, y2, u1, v2,
                 x2 - italic * bottom, y2, u2, v2
             };
 
-            // Append vertices to the corresponding buffer
-            auto& buffer = buffers[glyph.page];
-            buffer.insert(buffer.end(), std::begin(vertices), std::end(vertices));
+            layout.page = glyph.page;
+            layout.quad = appendQuad(glyph.page, vertices);
         }
 
         // Update the current bounds
-        minX = std::min(minX, x1 - italic * bottom);
-        maxX = std::max(maxX, x2 - italic * top);
-        minY = std::min(minY, y1);
-        maxY = std::max(maxY, y2);
+        pen.minX = std::min(pen.minX, x1 - italic * bottom);
+        pen.maxX = std::max(pen.maxX, x2 - italic * top);
+        pen.minY = std::min(pen.minY, y1);
+        pen.maxY = std::max(pen.maxY, y2);
 
         // Advance to the next character
-        x += glyph.advance;
+        pen.x += glyph.advance;
+        lineWidth = pen.x;
     }
 
-    // If we're using the underlined style, add the last line
-    if (underlined) {
-        float top = std::floor(y + underlineOffset - (underlineThickness / 2) + 0.5f);
-        float bottom = top + std::floor(underlineThickness + 0.5f);
-
-        float vertices[24] {
-            x,   top,    1.f, 1.f,
-            0.f, top,    1.f, 1.f,
-            0.f, bottom, 1.f, 1.f,
-            x,   top,    1.f, 1.f,
-            0.f, bottom, 1.f, 1.f,
-            x,   bottom, 1.f, 1.f
-        };
-        buffers[0].insert(buffers[0].end(), std::begin(vertices), std::end(vertices));
-    }
-
-    // If we're using the strike through style, add the last line across all characters
-    if (strikeThrough) {
-        float top = std::floor(y + strikeThroughOffset - (underlineThickness / 2) + 0.5f);
-        float bottom = top + std::floor(underlineThickness + 0.5f);
-
-        float vertices[24] {
-            x,   top,    1.f, 1.f,
-            0.f, top,    1.f, 1.f,
-            0.f, bottom, 1.f, 1.f,
-            x,   top,    1.f, 1.f,
-            0.f, bottom, 1.f, 1.f,
-            x,   bottom, 1.f, 1.f
-        };
-        buffers[0].insert(buffers[0].end(), std::begin(vertices), std::end(vertices));
-    }
+    endCharacterGeometry(lineWidth, pen);
 
-    mBoundsX = minX;
-    mBoundsY = minY;
-    mBoundsW = maxX - minX;
-    mBoundsH = maxY - minY;
-
-    mVertices.clear();
-    for (auto& it : buffers) {
-        if (it.second.empty()) continue;
-
-        auto buf = RenderDevice::instance().newVertexBuffer();
-        buf->load(
-            it.second.data(),
-            static_cast<uint32_t>(it.second.size() * sizeof(float)),
-            4 * sizeof(float)
-        );
-
-        mVertices[it.first] = std::shared_ptr<VertexBuffer>(buf);
-    }
+    // Decorate the last line
+    decorateLine(pen, 0.f, pen.x);
 
-    mNextPointer = mVertices.cbegin();
+    finishGeometryUpdate(pen);
 }
@@ -29,6 +29,7 @@
 #include "../config.hpp"
 
 #include "font.hpp"
+#include "indexbuffer.hpp"
 #include "vertexbuffer.hpp"
 
 #include <memory>
@@ -48,8 +49,29 @@ public:
         StrikeThrough = 1 << 3
     };
 
+    enum Alignment : uint8_t
+    {
+        Left,
+        Center,
+        Right
+    };
+
+    // Metrics of a laid out line
+    struct LineMetrics
+    {
+        size_t first;  // First character of the line
+        size_t count;  // Number of characters, including the trailing break
+        float x, y;    // Top left corner
+        float width;   // Width, without trailing spaces
+        float height;
+        float baseline;
+    };
+
+    // Quads that can be drawn at once with the shared 16-bit index buffer
+    static constexpr uint32_t MaxQuadsPerDraw = 16384u;
+
 public:
-    Text() = default;
+    Text();
     virtual ~Text() = default;
 
     void setString(const std::string& str);
@@ -57,29 +79,99 @@ public:
     void setFont(const Font& font);
     void setCharacterSize(uint32_t charSize);
     void setStyle(uint8_t style);
+    void setMaxWidth(float maxWidth);
+    void setAlignment(Alignment alignment);
 
     const std::u32string& string() const;
     const std::string& utf8String() const;
     const Font* font() const;
     uint32_t characterSize() const;
     uint8_t style() const;
+    float maxWidth() const;
+    Alignment alignment() const;
 
     virtual void characterPosition(size_t index, float& x, float& y) const;
+    virtual size_t characterAt(float x, float y) const;
     virtual void bounds(float& x, float& y, float& w, float& h) const;
 
-    VertexBuffer* nextBuffer(uint32_t* index) const;
+    size_t lineCount() const;
+    LineMetrics lineMetrics(size_t line) const;
+
+    VertexBuffer* nextBuffer(uint32_t* index, uint32_t* quadCount) const;
+
+    static IndexBuffer* quadIndexBuffer();
 
 protected:
+    // Pen state before a given character, horizontal bounds are relative to the line
+    struct Pen
+    {
+        float x, y;
+        float minX, minY, maxX, maxY;
+        float extra; // Direction specific state
+    };
+
+    // Where a character was laid out, and where its quads ended up
+    struct CharLayout
+    {
+        Pen pen;
+        uint32_t line;
+        uint32_t page;     // Page of the glyph quad
+        uint32_t quad;     // Index of the glyph quad in its page, NoQuad if none
+        uint32_t lineQuad; // First decoration quad of the line ending here in page 0, NoQuad if none
+    };
+
+    struct LineLayout
+    {
+        size_t first;
+        float top;
+        float width;
+        float minX, maxX;
+        float offset; // Alignment offset applied to the line's quads
+    };
+
+    // Geometry of a single font page, the GPU buffer grows by doubling and is never shrunk
+    struct PageGeometry
+    {
+        std::vector<float> vertices;
+        std::unique_ptr<VertexBuffer> buffer;
+        uint32_t quadCount {0u};
+        uint32_t bodyQuads {0u}; // Quads that belong to characters, the rest are trailing lines
+        uint32_t dirtyFrom {0u};
+        uint32_t capacity {0u};
+    };
+
+    static constexpr uint32_t NoQuad = 0xFFFFFFFFu;
+
     virtual void ensureGeometryUpdate() const;
 
+    void invalidateGeometry(size_t firstChar = 0u);
+    size_t beginGeometryUpdate() const;
+    void truncateGeometry(size_t first, size_t last) const;
+    uint32_t appendQuad(uint32_t page, const float* vertices) const;
+    uint32_t decorateLine(const Pen& pen, float left, float right) const;
+    void beginLine(size_t first, const Pen& pen) const;
+    void newLine(size_t next, float width, Pen& pen) const;
+    void wrapLine(size_t breakAt, size_t end, float width, Pen& pen) const;
+    void endCharacterGeometry(float width, const Pen& pen) const;
+    void finishGeometryUpdate(const Pen& pen) const;
+    void shiftLine(size_t line, float delta) const;
+    uint32_t currentLine() const;
+
     std::u32string mString;
     const Font*    mFont {nullptr};
     uint32_t       mCharSize {30u};
     uint8_t        mStyle {Regular};
-
-    using VertexMap = std::map<uint32_t, std::shared_ptr<VertexBuffer>>; 
-    mutable VertexMap::const_iterator mNextPointer;
-    mutable VertexMap mVertices;
+    float          mMaxWidth {0.f};
+    Alignment      mAlignment {Left};
+    bool           mRightToLeft {false};
+
+    using PageMap = std::map<uint32_t, PageGeometry>;
+    mutable PageMap::const_iterator mNextPointer;
+    mutable PageMap mPages;
+    mutable std::vector<CharLayout> mLayout;
+    mutable std::vector<LineLayout> mLines;
+    mutable size_t mLayoutCount {0u};
+    mutable size_t mFirstChanged {0u};
     mutable float mBoundsX {0.f}, mBoundsY {0.f}, mBoundsW {0.f}, mBoundsH {0.f};
     mutable bool mNeedsUpdate {false};
 };
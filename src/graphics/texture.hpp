@@ -109,6 +109,7 @@ public:
         uint16_t height, uint8_t slice, uint8_t level) = 0;
     virtual bool data(void* buffer, uint8_t slice, uint8_t level) const = 0;
     virtual uint32_t bufferSize() const = 0;
+    virtual uint32_t memorySize() const = 0;
 
     virtual void size(uint16_t& width, uint16_t& height) const;
     virtual uint16_t width() const = 0;
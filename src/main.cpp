@@ -30,6 +30,7 @@
 #include "system/filesystem.hpp"
 #include "system/thread.hpp"
 #include "system/luavm.hpp"
+#include "system/scheduler.hpp"
 #include "system/log.hpp"
 
 #include <physfs/physfs.h>
@@ -131,9 +132,13 @@ int main(int argc, char* argv[])
 
     // Run the lua code
     LuaVM lua;
-    if (!lua.initialize(argc, argv) || !lua.runCode("boot.lua", "return require 'main'")) {
-        return fatalError(lua.getErrorMessage());
-    }
+    bool succeeded = lua.initialize(argc, argv) && lua.runCode("boot.lua", "return require 'main'");
+
+    // Pooled states and pending jobs can't outlive the filesystem
+    Scheduler::shutdown();
+    LuaVM::clearPool();
+
+    if (!succeeded) return fatalError(lua.getErrorMessage());
 
     return 0;
 }
@@ -0,0 +1,159 @@
+/*
+    This is free and unencumbered software released into the public domain.
+
+    Anyone is free to copy, modify, publish, use, compile, sell, or
+    distribute this software, either in source code form or as a compiled
+    binary, for any purpose, commercial or non-commercial, and by any
+    means.
+
+    In jurisdictions that recognize copyright laws, the author or authors
+    of this software dedicate any and all copyright interest in the
+    software to the public domain. We make this dedication for the benefit
+    of the public at large and to the detriment of our heirs and
+    successors. We intend this dedication to be an overt act of
+    relinquishment in perpetuity of all present and future rights to this
+    software under copyright law.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+    MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+    IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+    OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+    ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+    OTHER DEALINGS IN THE SOFTWARE.
+
+    For more information, please refer to <http://unlicense.org>
+*/
+
+#include "arena.hpp"
+#include "thread.hpp"
+#include "log.hpp"
+
+#include <mutex>
+#include <vector>
+
+// Locals
+namespace
+{
+    constexpr size_t FrameCapacity = 256u * 1024u;
+    constexpr size_t ScratchCapacity = 64u * 1024u;
+    constexpr size_t ScratchSlots = 8u;
+    constexpr size_t BlockSize = 2u * FrameCapacity + ScratchSlots * ScratchCapacity;
+
+    // Both frame buffers first, then one scratch ring per thread that asked for one
+    alignas(std::max_align_t) uint8_t block[BlockSize];
+
+    uint32_t frameIndex {0u};
+    size_t frameOffset {0u};
+    bool frameOverflowed {false};
+
+    std::mutex slotMutex;
+    std::vector<size_t> freeSlots;
+    size_t nextSlot {0u};
+
+    // Gives the slot back when its thread ends, threads come and go with Lua's Thread objects
+    struct ScratchRing
+    {
+        size_t start {BlockSize};
+        size_t offset {0u};
+
+        ~ScratchRing()
+        {
+            if (start == BlockSize) return;
+
+            std::lock_guard<std::mutex> lock(slotMutex);
+            freeSlots.push_back((start - 2u * FrameCapacity) / ScratchCapacity);
+        }
+
+        bool acquire()
+        {
+            std::lock_guard<std::mutex> lock(slotMutex);
+
+            size_t slot;
+            if (!freeSlots.empty()) {
+                slot = freeSlots.back();
+                freeSlots.pop_back();
+            }
+            else if (nextSlot < ScratchSlots) {
+                slot = nextSlot++;
+            }
+            else {
+                return false;
+            }
+
+            start = 2u * FrameCapacity + slot * ScratchCapacity;
+            offset = start;
+            return true;
+        }
+    };
+
+    thread_local ScratchRing scratchRing;
+
+    bool isValidAlignment(size_t alignment)
+    {
+        return alignment != 0u && alignment <= ScratchCapacity;
+    }
+
+    // Alignments needn't be powers of two, Lua aligns to the size of the elements it indexes
+    size_t alignUp(size_t offset, size_t alignment)
+    {
+        return (offset + alignment - 1u) / alignment * alignment;
+    }
+}
+
+namespace Arena
+{
+    uint8_t* base()
+    {
+        return block;
+    }
+
+    uint32_t frame(size_t size, size_t alignment)
+    {
+        if (!isValidAlignment(alignment)) return Invalid;
+
+        size_t bufferStart = frameIndex * FrameCapacity;
+        size_t start = alignUp(bufferStart + frameOffset, alignment);
+        size_t end = bufferStart + FrameCapacity;
+        if (start > end || size > end - start) {
+            if (!frameOverflowed) {
+                Log::warning("Frame arena is full, falling back to regular allocations");
+                frameOverflowed = true;
+            }
+            return Invalid;
+        }
+
+        frameOffset = start + size - bufferStart;
+        return static_cast<uint32_t>(start);
+    }
+
+    void nextFrame()
+    {
+        frameIndex ^= 1u;
+        frameOffset = 0u;
+    }
+
+    uint32_t scratch(size_t size, size_t alignment)
+    {
+        // Bigger requests would wrap around too soon for the smaller ones to stay valid
+        if (!isValidAlignment(alignment) || size > ScratchCapacity / 4u) return Invalid;
+
+        auto& ring = scratchRing;
+        if (ring.start == BlockSize && !ring.acquire()) return Invalid;
+
+        size_t end = ring.start + ScratchCapacity;
+        size_t start = alignUp(ring.offset, alignment);
+        if (start > end || size > end - start) {
+            start = alignUp(ring.start, alignment);
+            if (size > end - start) return Invalid;
+        }
+
+        ring.offset = start + size;
+        return static_cast<uint32_t>(start);
+    }
+
+    uint32_t allocate(size_t size, size_t alignment)
+    {
+        return Thread::isMain() ? frame(size, alignment) : scratch(size, alignment);
+    }
+}
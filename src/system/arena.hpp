@@ -0,0 +1,57 @@
+/*
+    This is free and unencumbered software released into the public domain.
+
+    Anyone is free to copy, modify, publish, use, compile, sell, or
+    distribute this software, either in source code form or as a compiled
+    binary, for any purpose, commercial or non-commercial, and by any
+    means.
+
+    In jurisdictions that recognize copyright laws, the author or authors
+    of this software dedicate any and all copyright interest in the
+    software to the public domain. We make this dedication for the benefit
+    of the public at large and to the detriment of our heirs and
+    successors. We intend this dedication to be an overt act of
+    relinquishment in perpetuity of all present and future rights to this
+    software under copyright law.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+    MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+    IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+    OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+    ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+    OTHER DEALINGS IN THE SOFTWARE.
+
+    For more information, please refer to <http://unlicense.org>
+*/
+
+#pragma once
+#include "../config.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+// Linear allocators for short lived memory, nothing given out is ever freed individually
+// Every arena lives in one block and hands out offsets into it, so that Lua can index
+// from a single base pointer instead of getting a new pointer for each allocation
+// Offsets are multiples of the alignment, counted from the start of the block
+namespace Arena
+{
+    // Returned when a request doesn't fit, callers fall back to regular allocations
+    constexpr uint32_t Invalid = ~0u;
+
+    NX_HIDDEN uint8_t* base();
+
+    // Main thread only, the memory stays valid until the end of the next frame
+    NX_HIDDEN uint32_t frame(size_t size, size_t alignment);
+
+    // Called once per frame, reuses the memory given out the frame before the one that ended
+    NX_HIDDEN void nextFrame();
+
+    // Ring buffer of the calling thread, only fit for temporaries used right away
+    // The memory stays valid until the ring wraps around
+    NX_HIDDEN uint32_t scratch(size_t size, size_t alignment);
+
+    // Frame memory on the main thread, scratch memory on any other
+    NX_HIDDEN uint32_t allocate(size_t size, size_t alignment);
+}
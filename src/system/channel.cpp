@@ -0,0 +1,97 @@
+/*
+    This is free and unencumbered software released into the public domain.
+
+    Anyone is free to copy, modify, publish, use, compile, sell, or
+    distribute this software, either in source code form or as a compiled
+    binary, for any purpose, commercial or non-commercial, and by any
+    means.
+
+    In jurisdictions that recognize copyright laws, the author or authors
+    of this software dedicate any and all copyright interest in the
+    software to the public domain. We make this dedication for the benefit
+    of the public at large and to the detriment of our heirs and
+    successors. We intend this dedication to be an overt act of
+    relinquishment in perpetuity of all present and future rights to this
+    software under copyright law.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+    MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+    IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+    OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+    ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+    OTHER DEALINGS IN THE SOFTWARE.
+
+    For more information, please refer to <http://unlicense.org>
+*/
+
+#include "channel.hpp"
+
+#include <thread>
+
+Channel::Channel(size_t capacity) :
+    mCapacity(capacity > 0u ? capacity : 1u),
+    mFreeCells(static_cast<int>(mCapacity))
+{
+    size_t cellCount = 1u;
+    while (cellCount < mCapacity) cellCount <<= 1u;
+
+    mCells.reset(new Cell[cellCount]);
+    mMask = cellCount - 1u;
+
+    for (size_t i = 0u; i < cellCount; ++i) {
+        mCells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+}
+
+bool Channel::send(const void* data, size_t size, double timeout)
+{
+    if (!mFreeCells.acquire(timeout)) return false;
+
+    // Owning a free cell guarantees the one at this position gets released soon
+    auto position = mSendPosition.fetch_add(1u, std::memory_order_relaxed);
+    auto& cell = mCells[position & mMask];
+    while (cell.sequence.load(std::memory_order_acquire) != position) {
+        std::this_thread::yield();
+    }
+
+    auto* bytes = static_cast<const uint8_t*>(data);
+    cell.message.assign(bytes, bytes + size);
+    cell.sequence.store(position + 1u, std::memory_order_release);
+
+    mMessages.release();
+    return true;
+}
+
+const uint8_t* Channel::receive(size_t& size, double timeout)
+{
+    thread_local Message message;
+
+    if (!mMessages.acquire(timeout)) return nullptr;
+
+    // Another sender may still be writing to this cell if it claimed it first
+    auto position = mReceivePosition.fetch_add(1u, std::memory_order_relaxed);
+    auto& cell = mCells[position & mMask];
+    while (cell.sequence.load(std::memory_order_acquire) != position + 1u) {
+        std::this_thread::yield();
+    }
+
+    // Swapping keeps the cell's allocation around for the next messages
+    message.swap(cell.message);
+    cell.sequence.store(position + mMask + 1u, std::memory_order_release);
+
+    mFreeCells.release();
+
+    size = message.size();
+    return message.data();
+}
+
+size_t Channel::size() const
+{
+    return static_cast<size_t>(mMessages.count());
+}
+
+size_t Channel::capacity() const
+{
+    return mCapacity;
+}
@@ -0,0 +1,72 @@
+/*
+    This is free and unencumbered software released into the public domain.
+
+    Anyone is free to copy, modify, publish, use, compile, sell, or
+    distribute this software, either in source code form or as a compiled
+    binary, for any purpose, commercial or non-commercial, and by any
+    means.
+
+    In jurisdictions that recognize copyright laws, the author or authors
+    of this software dedicate any and all copyright interest in the
+    software to the public domain. We make this dedication for the benefit
+    of the public at large and to the detriment of our heirs and
+    successors. We intend this dedication to be an overt act of
+    relinquishment in perpetuity of all present and future rights to this
+    software under copyright law.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+    MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+    IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+    OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+    ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+    OTHER DEALINGS IN THE SOFTWARE.
+
+    For more information, please refer to <http://unlicense.org>
+*/
+
+#pragma once
+#include "../config.hpp"
+#include "semaphore.hpp"
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+// Bounded multi-producer multi-consumer message queue over a lock-free ring
+// Messages are copied in and out as raw bytes
+class NX_HIDDEN Channel
+{
+public:
+    explicit Channel(size_t capacity);
+
+    // A negative timeout waits forever, returns false if it expired
+    bool send(const void* data, size_t size, double timeout = -1.0);
+
+    // Returns nullptr if the timeout expired, the data is valid until the thread's next receive
+    const uint8_t* receive(size_t& size, double timeout = -1.0);
+
+    size_t size() const;
+    size_t capacity() const;
+
+private:
+    using Message = std::vector<uint8_t>;
+
+    struct Cell
+    {
+        std::atomic<size_t> sequence;
+        Message message;
+    };
+
+    std::unique_ptr<Cell[]> mCells;
+    size_t mMask;
+    size_t mCapacity;
+
+    // Kept on separate cache lines, so producers and consumers don't contend with one another
+    std::atomic<size_t> mSendPosition {0u};
+    char mPadding[64];
+    std::atomic<size_t> mReceivePosition {0u};
+
+    Semaphore mFreeCells;
+    Semaphore mMessages;
+};
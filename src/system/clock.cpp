@@ -0,0 +1,124 @@
+/*
+    This is free and unencumbered software released into the public domain.
+
+    Anyone is free to copy, modify, publish, use, compile, sell, or
+    distribute this software, either in source code form or as a compiled
+    binary, for any purpose, commercial or non-commercial, and by any
+    means.
+
+    In jurisdictions that recognize copyright laws, the author or authors
+    of this software dedicate any and all copyright interest in the
+    software to the public domain. We make this dedication for the benefit
+    of the public at large and to the detriment of our heirs and
+    successors. We intend this dedication to be an overt act of
+    relinquishment in perpetuity of all present and future rights to this
+    software under copyright law.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+    MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+    IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+    OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+    ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+    OTHER DEALINGS IN THE SOFTWARE.
+
+    For more information, please refer to <http://unlicense.org>
+*/
+
+#include "clock.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <thread>
+#if defined(NX_SYSTEM_WINDOWS) || defined(NX_SYSTEM_WINCE)
+    #include <windows.h>
+    #include <mmsystem.h>
+#endif
+
+// Locals
+namespace
+{
+    using SteadyClock = std::chrono::steady_clock;
+    const SteadyClock::time_point startTime = SteadyClock::now();
+
+    // Keeps a running estimate of how much the scheduler overshoots our sleep requests,
+    // so we know when to stop sleeping and start spinning
+    struct SleepEstimator
+    {
+        double mean {0.001};
+        double variance {0.0};
+
+        double estimate() const
+        {
+            return mean + std::sqrt(variance);
+        }
+
+        void add(double overshoot)
+        {
+            // Exponentially weighted mean and variance
+            constexpr double alpha = 0.1;
+            double delta = overshoot - mean;
+            mean += alpha * delta;
+            variance = (1.0 - alpha) * (variance + alpha * delta * delta);
+        }
+    };
+
+    thread_local SleepEstimator estimator;
+}
+
+namespace Clock
+{
+    double now()
+    {
+        auto t = SteadyClock::now() - startTime;
+        return std::chrono::duration<double>(t).count();
+    }
+
+    void sleep(double seconds)
+    {
+        // Not all system tolerate negative sleep times
+        if (seconds <= 0.0) return;
+
+        sleepUntil(now() + seconds);
+    }
+
+    void sleepUntil(double target)
+    {
+        double remaining = target - now();
+        if (remaining <= 0.0) return;
+
+        #if defined(NX_SYSTEM_WINDOWS) || defined(NX_SYSTEM_WINCE)
+            // Taken from SFML ._.
+
+            // Get the supported timer resolutions on this system
+            TIMECAPS tc;
+            timeGetDevCaps(&tc, sizeof(TIMECAPS));
+
+            // Set the timer resolution to the minimum for the Sleep call
+            timeBeginPeriod(tc.wPeriodMin);
+        #endif
+
+        // Sleep as long as the expected overshoot still fits in the remaining time
+        while (true) {
+            double request = remaining - estimator.estimate();
+            if (request < 0.001) break;
+
+            double start = now();
+            std::this_thread::sleep_for(std::chrono::duration<double>(request));
+            double end = now();
+
+            estimator.add(end - start - request);
+            remaining = target - end;
+        }
+
+        #if defined(NX_SYSTEM_WINDOWS) || defined(NX_SYSTEM_WINCE)
+            // Reset the timer resolution back to the system default
+            timeEndPeriod(tc.wPeriodMin);
+        #endif
+
+        // Spin through what's left
+        while (now() < target) {
+            std::this_thread::yield();
+        }
+    }
+}
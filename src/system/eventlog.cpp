@@ -0,0 +1,336 @@
+/*
+    This is free and unencumbered software released into the public domain.
+
+    Anyone is free to copy, modify, publish, use, compile, sell, or
+    distribute this software, either in source code form or as a compiled
+    binary, for any purpose, commercial or non-commercial, and by any
+    means.
+
+    In jurisdictions that recognize copyright laws, the author or authors
+    of this software dedicate any and all copyright interest in the
+    software to the public domain. We make this dedication for the benefit
+    of the public at large and to the detriment of our heirs and
+    successors. We intend this dedication to be an overt act of
+    relinquishment in perpetuity of all present and future rights to this
+    software under copyright law.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+    MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+    IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+    OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+    ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+    OTHER DEALINGS IN THE SOFTWARE.
+
+    For more information, please refer to <http://unlicense.org>
+*/
+
+#include "eventlog.hpp"
+#include "filesystem.hpp"
+#include "log.hpp"
+
+#include <physfs/physfs.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+// Locals
+namespace
+{
+    // Records are a tag byte followed by their payload:
+    // - FrameTag: the frame time as a double
+    // - Anything else is an event type, then a byte telling which values follow as doubles
+    //   and whether a text comes after them, as a 32-bit length and its bytes
+    struct Header
+    {
+        char magic[4];
+        uint32_t version;
+    };
+
+    const char Magic[4] = {'N', 'X', 'E', 'L'};
+    constexpr uint32_t Version = 1u;
+    constexpr uint8_t FrameTag = 0u;
+    constexpr uint8_t TextBit = 1u << 4u;
+    constexpr size_t FlushSize = 64u * 1024u;
+
+    const char* WriteDir = "replays";
+    const char* ReadDir = "userdata/replays";
+
+    EventLog::Mode currentMode {EventLog::Off};
+    std::string logName;
+
+    // Recording
+    PHYSFS_File* output {nullptr};
+    std::string buffer;
+
+    // Replaying
+    std::vector<EventLog::Event> events;
+    std::vector<char> textArena;
+    std::vector<size_t> frameEnds;
+    std::vector<double> frameTimes;
+    std::vector<float> timings;
+    size_t cursor {0u};
+    size_t currentFrame {0u};
+    double fixedStep {0.0};
+
+    template<typename T>
+    void put(const T& value)
+    {
+        buffer.append(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    template<typename T>
+    bool get(const std::string& data, size_t& offset, T& value)
+    {
+        if (offset + sizeof(T) > data.size()) return false;
+
+        std::memcpy(&value, &data[offset], sizeof(T));
+        offset += sizeof(T);
+        return true;
+    }
+
+    void flush()
+    {
+        if (output && !buffer.empty()) {
+            PHYSFS_writeBytes(output, buffer.data(), buffer.size());
+        }
+        buffer.clear();
+    }
+
+    bool readFile(const std::string& filename, std::string& contents)
+    {
+        auto* file = PHYSFS_openRead(filename.data());
+        if (!file) return false;
+
+        auto length = PHYSFS_fileLength(file);
+        bool ok = length >= 0;
+        if (ok) {
+            contents.resize(static_cast<size_t>(length));
+            ok = PHYSFS_readBytes(file, &contents[0], contents.size()) == length;
+        }
+
+        PHYSFS_close(file);
+        return ok;
+    }
+
+    bool parse(const std::string& data)
+    {
+        Header header;
+        size_t offset = 0u;
+        if (!get(data, offset, header) || std::memcmp(header.magic, Magic, sizeof(Magic)) != 0 ||
+            header.version != Version) {
+            return false;
+        }
+
+        // Texts are pointed to once the arena is done growing
+        std::vector<std::pair<size_t, size_t>> textOffsets;
+
+        uint8_t tag;
+        while (get(data, offset, tag)) {
+            if (tag == FrameTag) {
+                double frameTime;
+                if (!get(data, offset, frameTime)) return false;
+
+                frameEnds.push_back(events.size());
+                frameTimes.push_back(frameTime);
+                continue;
+            }
+
+            EventLog::Event event {tag, {0.0, 0.0, 0.0, 0.0}, nullptr};
+            uint8_t mask;
+            if (!get(data, offset, mask)) return false;
+
+            for (uint32_t i = 0u; i < 4u; ++i) {
+                if ((mask & (1u << i)) && !get(data, offset, event.values[i])) return false;
+            }
+
+            if (mask & TextBit) {
+                uint32_t length;
+                if (!get(data, offset, length) || offset + length > data.size()) return false;
+
+                textOffsets.emplace_back(events.size(), textArena.size());
+                textArena.insert(textArena.end(), &data[offset], &data[offset] + length);
+                textArena.push_back('\0');
+                offset += length;
+            }
+
+            events.push_back(event);
+        }
+
+        // Events after the last frame still get played
+        if (frameEnds.empty() || frameEnds.back() != events.size()) {
+            frameEnds.push_back(events.size());
+            frameTimes.push_back(0.0);
+        }
+
+        for (auto& it : textOffsets) {
+            events[it.first].text = textArena.data() + it.second;
+        }
+
+        return true;
+    }
+
+    void writeTimings()
+    {
+        if (timings.empty()) return;
+
+        PHYSFS_mkdir(WriteDir);
+        auto* file = PHYSFS_openWrite((std::string(WriteDir) + "/" + logName + ".csv").data());
+        if (file) {
+            std::string csv = "frame,ms\n";
+            char line[32];
+            for (size_t i = 0u; i < timings.size(); ++i) {
+                std::snprintf(line, sizeof(line), "%u,%.4f\n", static_cast<uint32_t>(i),
+                    timings[i] * 1000.0);
+                csv += line;
+            }
+
+            PHYSFS_writeBytes(file, csv.data(), csv.size());
+            PHYSFS_close(file);
+        }
+
+        std::vector<float> sorted = timings;
+        double total = 0.0;
+        for (auto timing : sorted) {
+            total += timing;
+        }
+
+        auto nth = sorted.begin() + (sorted.size() - 1u) * 99u / 100u;
+        std::nth_element(sorted.begin(), nth, sorted.end());
+        double p99 = *nth;
+        double max = *std::max_element(nth, sorted.end());
+
+        Log::info("Replay of %s: %u frames, %.3fms mean, %.3fms p99, %.3fms max",
+            logName.data(), static_cast<uint32_t>(timings.size()), total / timings.size() * 1000.0,
+            p99 * 1000.0, max * 1000.0);
+    }
+}
+
+namespace EventLog
+{
+    bool startRecording(const std::string& name)
+    {
+        stop();
+
+        PHYSFS_mkdir(WriteDir);
+        output = PHYSFS_openWrite((std::string(WriteDir) + "/" + name + ".nxr").data());
+        if (!output) {
+            Log::error("Cannot record events to %s: %s", name.data(),
+                Filesystem::getErrorMessage().data());
+            return false;
+        }
+
+        Header header;
+        std::memcpy(header.magic, Magic, sizeof(Magic));
+        header.version = Version;
+        put(header);
+
+        logName = name;
+        currentMode = Recording;
+        return true;
+    }
+
+    bool startReplay(const std::string& name, double step)
+    {
+        stop();
+
+        std::string data;
+        if (!readFile(std::string(ReadDir) + "/" + name + ".nxr", data) || !parse(data)) {
+            Log::error("Cannot replay events from %s", name.data());
+            events.clear();
+            textArena.clear();
+            frameEnds.clear();
+            frameTimes.clear();
+            return false;
+        }
+
+        logName = name;
+        fixedStep = std::max(step, 0.0);
+        cursor = currentFrame = 0u;
+        timings.clear();
+        timings.reserve(frameEnds.size());
+        currentMode = Replaying;
+        return true;
+    }
+
+    void stop()
+    {
+        if (currentMode == Recording) {
+            flush();
+            PHYSFS_close(output);
+            output = nullptr;
+        }
+        else if (currentMode == Replaying) {
+            writeTimings();
+            events.clear();
+            textArena.clear();
+            frameEnds.clear();
+            frameTimes.clear();
+            timings.clear();
+        }
+
+        currentMode = Off;
+    }
+
+    Mode mode()
+    {
+        return currentMode;
+    }
+
+    void record(const Event& event)
+    {
+        if (currentMode != Recording) return;
+
+        uint8_t mask = event.text ? TextBit : 0u;
+        for (uint32_t i = 0u; i < 4u; ++i) {
+            if (event.values[i] != 0.0) mask |= 1u << i;
+        }
+
+        put(static_cast<uint8_t>(event.type));
+        put(mask);
+        for (uint32_t i = 0u; i < 4u; ++i) {
+            if (mask & (1u << i)) put(event.values[i]);
+        }
+
+        if (event.text) {
+            auto length = static_cast<uint32_t>(std::strlen(event.text));
+            put(length);
+            buffer.append(event.text, length);
+        }
+    }
+
+    bool next(Event& event)
+    {
+        if (currentMode != Replaying || finished() || cursor >= frameEnds[currentFrame]) {
+            return false;
+        }
+
+        event = events[cursor++];
+        return true;
+    }
+
+    bool finished()
+    {
+        return currentMode == Replaying && currentFrame >= frameEnds.size();
+    }
+
+    double frame(double frameTime)
+    {
+        if (currentMode == Recording) {
+            put(FrameTag);
+            put(frameTime);
+            if (buffer.size() >= FlushSize) flush();
+        }
+        else if (currentMode == Replaying && !finished()) {
+            // What the frame actually took, while the game is fed the recorded time
+            timings.push_back(static_cast<float>(frameTime));
+
+            cursor = frameEnds[currentFrame];
+            frameTime = fixedStep > 0.0 ? fixedStep : frameTimes[currentFrame];
+            ++currentFrame;
+        }
+
+        return frameTime;
+    }
+}
@@ -0,0 +1,72 @@
+/*
+    This is free and unencumbered software released into the public domain.
+
+    Anyone is free to copy, modify, publish, use, compile, sell, or
+    distribute this software, either in source code form or as a compiled
+    binary, for any purpose, commercial or non-commercial, and by any
+    means.
+
+    In jurisdictions that recognize copyright laws, the author or authors
+    of this software dedicate any and all copyright interest in the
+    software to the public domain. We make this dedication for the benefit
+    of the public at large and to the detriment of our heirs and
+    successors. We intend this dedication to be an overt act of
+    relinquishment in perpetuity of all present and future rights to this
+    software under copyright law.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+    MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+    IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+    OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+    ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+    OTHER DEALINGS IN THE SOFTWARE.
+
+    For more information, please refer to <http://unlicense.org>
+*/
+
+#pragma once
+#include "../config.hpp"
+
+#include <string>
+
+// Records the translated event stream and frame times, and plays them back without SDL
+// Logs go to replays/<name>.nxr in the write directory, read back from /userdata
+// Not thread-safe, meant to be driven from the main thread
+namespace EventLog
+{
+    enum Mode
+    {
+        Off,
+        Recording,
+        Replaying
+    };
+
+    struct Event
+    {
+        uint32_t type;
+        double values[4];
+        const char* text;
+    };
+
+    bool startRecording(const std::string& name);
+
+    // A positive step replaces the recorded frame times with a fixed one
+    bool startReplay(const std::string& name, double step);
+
+    // Flushes the recording, or writes the replay's frame timings to replays/<name>.csv
+    void stop();
+
+    Mode mode();
+
+    void record(const Event& event);
+
+    // Next event of the current replayed frame, false once the frame has no more of them
+    bool next(Event& event);
+
+    // Whether the replay went through the whole log
+    bool finished();
+
+    // Closes a frame at display, returns the frame time the game should use
+    double frame(double frameTime);
+}
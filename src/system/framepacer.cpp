@@ -0,0 +1,169 @@
+/*
+    This is free and unencumbered software released into the public domain.
+
+    Anyone is free to copy, modify, publish, use, compile, sell, or
+    distribute this software, either in source code form or as a compiled
+    binary, for any purpose, commercial or non-commercial, and by any
+    means.
+
+    In jurisdictions that recognize copyright laws, the author or authors
+    of this software dedicate any and all copyright interest in the
+    software to the public domain. We make this dedication for the benefit
+    of the public at large and to the detriment of our heirs and
+    successors. We intend this dedication to be an overt act of
+    relinquishment in perpetuity of all present and future rights to this
+    software under copyright law.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+    MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+    IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+    OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+    ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+    OTHER DEALINGS IN THE SOFTWARE.
+
+    For more information, please refer to <http://unlicense.org>
+*/
+
+#include "framepacer.hpp"
+#include "clock.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+constexpr size_t FramePacer::StatsWindow;
+
+FramePacer& FramePacer::instance()
+{
+    static FramePacer pacer;
+    return pacer;
+}
+
+void FramePacer::restart()
+{
+    mLastTime = mDeadline = Clock::now();
+    mFrameTime = 0.0;
+}
+
+void FramePacer::frame()
+{
+    double currTime = Clock::now();
+
+    if (mFramerateLimit > 0.0) {
+        // Wait out the left time of the frame, aiming at the next slot of the frame grid
+        // so that oversleeping in one frame is made up for in the next one
+        double deadline = mDeadline + mFramerateLimit;
+        Clock::sleepUntil(deadline);
+        currTime = Clock::now();
+
+        // Resynchronize if we fell more than a whole frame behind
+        mDeadline = (currTime - deadline < mFramerateLimit) ? deadline : currTime;
+    }
+    else {
+        mDeadline = currTime;
+    }
+
+    mFrameTime = currTime - mLastTime;
+    mLastTime = currTime;
+
+    // Calculating FPS every whole second
+    mFpsElapsed += mFrameTime;
+    ++mFpsFrames;
+    if (mFpsElapsed > 1.0) {
+        mCurrentFPS = mFpsFrames / mFpsElapsed;
+        mFpsElapsed = std::fmod(mFpsElapsed, 1.0);
+        mFpsFrames = 0u;
+    }
+
+    // Record the frame time for statistics
+    mSamples[mNextSample] = static_cast<float>(mFrameTime);
+    mNextSample = (mNextSample + 1u) % StatsWindow;
+    mSampleCount = std::min(mSampleCount + 1u, StatsWindow);
+    if (mRecording) mRecording->push_back(static_cast<float>(mFrameTime));
+}
+
+void FramePacer::resetFrameTime()
+{
+    mFrameTime = 0.0;
+}
+
+void FramePacer::setFrameTime(double frameTime)
+{
+    mFrameTime = frameTime;
+}
+
+void FramePacer::setFramerateLimit(double frameTime)
+{
+    mFramerateLimit = std::max(frameTime, 0.0);
+}
+
+double FramePacer::framerateLimit() const
+{
+    return mFramerateLimit;
+}
+
+double FramePacer::frameTime() const
+{
+    return mFrameTime;
+}
+
+double FramePacer::currentFPS() const
+{
+    return mCurrentFPS;
+}
+
+void FramePacer::setFixedTimestep(double step, uint32_t maxSteps)
+{
+    mFixedStep = std::max(step, 0.0);
+    mMaxFixedSteps = maxSteps;
+    mAccumulator = 0.0;
+}
+
+uint32_t FramePacer::fixedSteps()
+{
+    if (mFixedStep <= 0.0) return 0u;
+
+    mAccumulator += mFrameTime;
+    auto steps = static_cast<uint32_t>(mAccumulator / mFixedStep);
+    mAccumulator -= steps * mFixedStep;
+
+    // Drop the steps we can't catch up with instead of spiraling down
+    if (mMaxFixedSteps > 0u && steps > mMaxFixedSteps) {
+        steps = mMaxFixedSteps;
+    }
+
+    return steps;
+}
+
+double FramePacer::fixedAlpha() const
+{
+    if (mFixedStep <= 0.0) return 0.0;
+
+    return mAccumulator / mFixedStep;
+}
+
+void FramePacer::stats(double& mean, double& p99, double& max) const
+{
+    mean = p99 = max = 0.0;
+    if (mSampleCount == 0u) return;
+
+    std::array<float, StatsWindow> sorted;
+    std::copy(mSamples.begin(), mSamples.begin() + mSampleCount, sorted.begin());
+
+    double total = 0.0;
+    for (size_t i = 0u; i < mSampleCount; ++i) {
+        total += sorted[i];
+    }
+    mean = total / mSampleCount;
+
+    auto end = sorted.begin() + mSampleCount;
+    auto nth = sorted.begin() + (mSampleCount - 1u) * 99u / 100u;
+    std::nth_element(sorted.begin(), nth, end);
+    p99 = *nth;
+    max = *std::max_element(nth, end);
+}
+
+void FramePacer::record(std::vector<float>* samples)
+{
+    mRecording = samples;
+}
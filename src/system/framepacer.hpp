@@ -0,0 +1,85 @@
+/*
+    This is free and unencumbered software released into the public domain.
+
+    Anyone is free to copy, modify, publish, use, compile, sell, or
+    distribute this software, either in source code form or as a compiled
+    binary, for any purpose, commercial or non-commercial, and by any
+    means.
+
+    In jurisdictions that recognize copyright laws, the author or authors
+    of this software dedicate any and all copyright interest in the
+    software to the public domain. We make this dedication for the benefit
+    of the public at large and to the detriment of our heirs and
+    successors. We intend this dedication to be an overt act of
+    relinquishment in perpetuity of all present and future rights to this
+    software under copyright law.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+    MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+    IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+    OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+    ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+    OTHER DEALINGS IN THE SOFTWARE.
+
+    For more information, please refer to <http://unlicense.org>
+*/
+
+#pragma once
+#include "../config.hpp"
+
+#include <array>
+#include <vector>
+
+// Paces the main loop to a target frame time and keeps frame time statistics
+class NX_HIDDEN FramePacer
+{
+public:
+    static constexpr size_t StatsWindow = 256u;
+
+public:
+    static FramePacer& instance();
+
+    void restart();
+    void frame();
+    void resetFrameTime();
+
+    // Replaces the measured frame time handed to the game, statistics keep the measured one
+    void setFrameTime(double frameTime);
+
+    void setFramerateLimit(double frameTime);
+    double framerateLimit() const;
+
+    double frameTime() const;
+    double currentFPS() const;
+
+    void setFixedTimestep(double step, uint32_t maxSteps);
+    uint32_t fixedSteps();
+    double fixedAlpha() const;
+
+    void stats(double& mean, double& p99, double& max) const;
+
+    // Also appends every measured frame time to samples until called again with nullptr
+    void record(std::vector<float>* samples);
+
+private:
+    FramePacer() = default;
+
+    double mLastTime {0.0};
+    double mDeadline {0.0};
+    double mFrameTime {0.0};
+    double mFramerateLimit {0.0};
+
+    double mFpsElapsed {0.0};
+    uint32_t mFpsFrames {0u};
+    double mCurrentFPS {0.0};
+
+    double mFixedStep {0.0};
+    uint32_t mMaxFixedSteps {0u};
+    double mAccumulator {0.0};
+
+    std::array<float, StatsWindow> mSamples;
+    size_t mSampleCount {0u};
+    size_t mNextSample {0u};
+    std::vector<float>* mRecording {nullptr};
+};
@@ -0,0 +1,314 @@
+/*
+    This is free and unencumbered software released into the public domain.
+
+    Anyone is free to copy, modify, publish, use, compile, sell, or
+    distribute this software, either in source code form or as a compiled
+    binary, for any purpose, commercial or non-commercial, and by any
+    means.
+
+    In jurisdictions that recognize copyright laws, the author or authors
+    of this software dedicate any and all copyright interest in the
+    software to the public domain. We make this dedication for the benefit
+    of the public at large and to the detriment of our heirs and
+    successors. We intend this dedication to be an overt act of
+    relinquishment in perpetuity of all present and future rights to this
+    software under copyright law.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+    MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+    IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+    OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+    ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+    OTHER DEALINGS IN THE SOFTWARE.
+
+    For more information, please refer to <http://unlicense.org>
+*/
+
+#include "input.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+// Locals
+namespace
+{
+    struct Binding
+    {
+        uint32_t action;
+        Input::BindingType type;
+        uint32_t index;
+        uint32_t mask;
+        float direction;
+        float threshold;
+    };
+
+    struct GamepadState
+    {
+        int32_t id;
+        uint32_t buttons;
+        uint32_t latched;
+        float axes[Input::MaxGamepadAxes];
+    };
+
+    // Raw state as the events left it, latched bits remember presses until the frame closes
+    uint32_t keys[Input::MaxKeys / 32u];
+    uint32_t latchedKeys[Input::MaxKeys / 32u];
+    uint32_t mouseButtons {0u};
+    uint32_t latchedMouseButtons {0u};
+    float mouseX {0.f}, mouseY {0.f};
+    float mouseDX {0.f}, mouseDY {0.f};
+    float wheelX {0.f}, wheelY {0.f};
+    std::vector<GamepadState> gamepads;
+
+    std::vector<Binding> bindings;
+    float stickDeadzone {0.2f};
+    float triggerDeadzone {0.1f};
+
+    Input::State snapshot;
+
+    GamepadState* gamepad(int32_t id)
+    {
+        for (auto& pad : gamepads) {
+            if (pad.id == id) return &pad;
+        }
+
+        if (gamepads.size() >= Input::MaxGamepads) return nullptr;
+
+        gamepads.push_back(GamepadState {id, 0u, 0u, {0.f, 0.f, 0.f, 0.f, 0.f, 0.f}});
+        return &gamepads.back();
+    }
+
+    float rescale(float value, float deadzone)
+    {
+        return std::max(0.f, (value - deadzone) / (1.f - deadzone));
+    }
+
+    void applyStickDeadzone(const float* in, float* out)
+    {
+        float length = std::sqrt(in[0] * in[0] + in[1] * in[1]);
+        if (length <= stickDeadzone) {
+            out[0] = out[1] = 0.f;
+            return;
+        }
+
+        // Scale along the stick's direction so diagonals keep their angle
+        float scale = std::min(rescale(length, stickDeadzone), 1.f) / length;
+        out[0] = in[0] * scale;
+        out[1] = in[1] * scale;
+    }
+
+    float evaluate(const Binding& binding)
+    {
+        switch (binding.type) {
+            case Input::KeyBinding:
+                return (snapshot.keys[binding.index] & binding.mask) ? 1.f : 0.f;
+            case Input::MouseButtonBinding:
+                return (snapshot.mouseButtons & binding.mask) ? 1.f : 0.f;
+            case Input::GamepadButtonBinding:
+                for (uint32_t i = 0u; i < snapshot.gamepadCount; ++i) {
+                    if (snapshot.gamepads[i].buttons & binding.mask) return 1.f;
+                }
+                return 0.f;
+            case Input::GamepadAxisBinding: {
+                float value = 0.f;
+                for (uint32_t i = 0u; i < snapshot.gamepadCount; ++i) {
+                    value = std::max(value, snapshot.gamepads[i].axes[binding.index] * binding.direction);
+                }
+                return value;
+            }
+            default:
+                return 0.f;
+        }
+    }
+}
+
+namespace Input
+{
+    void keyEvent(uint32_t scancode, bool down)
+    {
+        if (scancode >= MaxKeys) return;
+
+        uint32_t mask = 1u << (scancode % 32u);
+        if (down) {
+            keys[scancode / 32u] |= mask;
+            latchedKeys[scancode / 32u] |= mask;
+        }
+        else {
+            keys[scancode / 32u] &= ~mask;
+        }
+    }
+
+    void mouseMotion(float x, float y, float dx, float dy)
+    {
+        mouseX = x;
+        mouseY = y;
+        mouseDX += dx;
+        mouseDY += dy;
+    }
+
+    void mouseButton(uint32_t button, bool down)
+    {
+        if (button == 0u || button > 32u) return;
+
+        uint32_t mask = 1u << (button - 1u);
+        if (down) {
+            mouseButtons |= mask;
+            latchedMouseButtons |= mask;
+        }
+        else {
+            mouseButtons &= ~mask;
+        }
+    }
+
+    void wheel(float x, float y)
+    {
+        wheelX += x;
+        wheelY += y;
+    }
+
+    void gamepadAxis(int32_t id, uint32_t axis, float value)
+    {
+        auto* pad = gamepad(id);
+        if (!pad || axis == 0u || axis > MaxGamepadAxes) return;
+
+        pad->axes[axis - 1u] = std::max(-1.f, value / 32767.f);
+    }
+
+    void gamepadButton(int32_t id, uint32_t button, bool down)
+    {
+        auto* pad = gamepad(id);
+        if (!pad || button == 0u || button > 32u) return;
+
+        uint32_t mask = 1u << (button - 1u);
+        if (down) {
+            pad->buttons |= mask;
+            pad->latched |= mask;
+        }
+        else {
+            pad->buttons &= ~mask;
+        }
+    }
+
+    void gamepadRemoved(int32_t id)
+    {
+        gamepads.erase(std::remove_if(gamepads.begin(), gamepads.end(),
+            [id](const GamepadState& pad) {
+                return pad.id == id;
+            }), gamepads.end());
+    }
+
+    void focusLost()
+    {
+        // Releases won't reach us while the window is in the background
+        std::memset(keys, 0, sizeof(keys));
+        mouseButtons = 0u;
+    }
+
+    void bind(uint32_t action, BindingType type, uint32_t code, float direction, float threshold)
+    {
+        if (action >= MaxActions) return;
+
+        // Resolve codes to word and mask now so the evaluation is just a lookup
+        Binding binding {action, type, 0u, 0u, direction, threshold};
+        switch (type) {
+            case KeyBinding:
+                if (code >= MaxKeys) return;
+                binding.index = code / 32u;
+                binding.mask = 1u << (code % 32u);
+                break;
+            case MouseButtonBinding:
+            case GamepadButtonBinding:
+                if (code == 0u || code > 32u) return;
+                binding.mask = 1u << (code - 1u);
+                break;
+            case GamepadAxisBinding:
+                if (code == 0u || code > MaxGamepadAxes) return;
+                binding.index = code - 1u;
+                break;
+            default:
+                return;
+        }
+
+        bindings.push_back(binding);
+    }
+
+    void clearBindings()
+    {
+        bindings.clear();
+    }
+
+    void clearBindings(BindingType type)
+    {
+        bindings.erase(std::remove_if(bindings.begin(), bindings.end(),
+            [type](const Binding& binding) { return binding.type == type; }), bindings.end());
+    }
+
+    void setDeadzones(float stick, float trigger)
+    {
+        stickDeadzone = std::min(std::max(stick, 0.f), 0.99f);
+        triggerDeadzone = std::min(std::max(trigger, 0.f), 0.99f);
+    }
+
+    const State& update()
+    {
+        for (uint32_t i = 0u; i < MaxKeys / 32u; ++i) {
+            snapshot.keys[i] = keys[i] | latchedKeys[i];
+            latchedKeys[i] = 0u;
+        }
+
+        snapshot.mouseX = mouseX;
+        snapshot.mouseY = mouseY;
+        snapshot.mouseDX = mouseDX;
+        snapshot.mouseDY = mouseDY;
+        snapshot.wheelX = wheelX;
+        snapshot.wheelY = wheelY;
+        snapshot.mouseButtons = mouseButtons | latchedMouseButtons;
+        mouseDX = mouseDY = wheelX = wheelY = 0.f;
+        latchedMouseButtons = 0u;
+
+        snapshot.gamepadCount = static_cast<uint32_t>(gamepads.size());
+        for (uint32_t i = 0u; i < snapshot.gamepadCount; ++i) {
+            auto& pad = gamepads[i];
+            auto& out = snapshot.gamepads[i];
+
+            out.id = pad.id;
+            out.buttons = pad.buttons | pad.latched;
+            pad.latched = 0u;
+
+            applyStickDeadzone(&pad.axes[0], &out.axes[0]);
+            applyStickDeadzone(&pad.axes[2], &out.axes[2]);
+            out.axes[4] = rescale(pad.axes[4], triggerDeadzone);
+            out.axes[5] = rescale(pad.axes[5], triggerDeadzone);
+        }
+
+        // Actions in one pass over the bindings, each keeps its strongest input
+        uint32_t previous = snapshot.actionsDown;
+        uint32_t down = 0u;
+        std::fill(std::begin(snapshot.actionValues), std::end(snapshot.actionValues), 0.f);
+
+        for (const auto& binding : bindings) {
+            float value = evaluate(binding);
+            if (value <= 0.f) continue;
+
+            auto& actionValue = snapshot.actionValues[binding.action];
+            actionValue = std::max(actionValue, value);
+            if (binding.type != GamepadAxisBinding || value >= binding.threshold) {
+                down |= 1u << binding.action;
+            }
+        }
+
+        snapshot.actionsDown = down;
+        snapshot.actionsPressed = down & ~previous;
+        snapshot.actionsReleased = previous & ~down;
+
+        return snapshot;
+    }
+
+    const State& state()
+    {
+        return snapshot;
+    }
+}
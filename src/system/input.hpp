@@ -0,0 +1,95 @@
+/*
+    This is free and unencumbered software released into the public domain.
+
+    Anyone is free to copy, modify, publish, use, compile, sell, or
+    distribute this software, either in source code form or as a compiled
+    binary, for any purpose, commercial or non-commercial, and by any
+    means.
+
+    In jurisdictions that recognize copyright laws, the author or authors
+    of this software dedicate any and all copyright interest in the
+    software to the public domain. We make this dedication for the benefit
+    of the public at large and to the detriment of our heirs and
+    successors. We intend this dedication to be an overt act of
+    relinquishment in perpetuity of all present and future rights to this
+    software under copyright law.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+    MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+    IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+    OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+    ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+    OTHER DEALINGS IN THE SOFTWARE.
+
+    For more information, please refer to <http://unlicense.org>
+*/
+
+#pragma once
+#include "../config.hpp"
+
+// Input state snapshot and action map, built from the window's event stream
+// Lua reads one State per frame instead of querying every button and axis on its own
+// Not thread-safe, meant to be driven from the main thread
+namespace Input
+{
+    constexpr uint32_t MaxKeys = 512u;
+    constexpr uint32_t MaxGamepads = 4u;
+    constexpr uint32_t MaxGamepadAxes = 6u;
+    constexpr uint32_t MaxActions = 32u;
+
+    enum BindingType : uint32_t
+    {
+        KeyBinding = 0u,
+        MouseButtonBinding,
+        GamepadButtonBinding,
+        GamepadAxisBinding
+    };
+
+    struct Gamepad
+    {
+        int32_t id;
+        uint32_t buttons;
+        float axes[MaxGamepadAxes];
+    };
+
+    struct State
+    {
+        uint32_t keys[MaxKeys / 32u];
+        float mouseX, mouseY;
+        float mouseDX, mouseDY;
+        float wheelX, wheelY;
+        uint32_t mouseButtons;
+
+        uint32_t gamepadCount;
+        Gamepad gamepads[MaxGamepads];
+
+        uint32_t actionsDown;
+        uint32_t actionsPressed;
+        uint32_t actionsReleased;
+        float actionValues[MaxActions];
+    };
+
+    // Fed by the event layer, ids and codes are 1-based like the exported events
+    void keyEvent(uint32_t scancode, bool down);
+    void mouseMotion(float x, float y, float dx, float dy);
+    void mouseButton(uint32_t button, bool down);
+    void wheel(float x, float y);
+    void gamepadAxis(int32_t id, uint32_t axis, float value);
+    void gamepadButton(int32_t id, uint32_t button, bool down);
+    void gamepadRemoved(int32_t id);
+    void focusLost();
+
+    // Axis bindings trigger past the threshold in the given direction, others ignore both
+    void bind(uint32_t action, BindingType type, uint32_t code, float direction, float threshold);
+    void clearBindings();
+    void clearBindings(BindingType type);
+
+    // Radial deadzone for the sticks and a plain one for the triggers, both in [0, 1)
+    void setDeadzones(float stick, float trigger);
+
+    // Closes the frame: applies deadzones, evaluates the action map and resets deltas
+    // Presses that were released before the frame closed still count as down for it
+    const State& update();
+    const State& state();
+}
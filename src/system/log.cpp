@@ -29,10 +29,16 @@
 
 #include <SDL2/SDL.h>
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <csignal>
 #include <cstdarg>
 #include <cstdio>
+#include <cstdlib>
 #include <memory>
 #include <mutex>
+#include <thread>
 
 // Locals
 namespace
@@ -46,91 +52,374 @@ namespace
     };
     using FilePtr = std::unique_ptr<FILE, FileDeleter>;
 
-    std::mutex logFileMutex;
-    FilePtr logFile {nullptr};
+    // Bounded multi-producer single-consumer queue of formatted messages
+    // Producers format directly into their claimed slot, the writer thread is the only consumer
+    class LogQueue
+    {
+    public:
+        static constexpr size_t Capacity = 1024u; // Must be a power of two
+        static constexpr size_t TextSize = 512u;
+
+    public:
+        LogQueue()
+        {
+            for (size_t i = 0u; i < Capacity; ++i) {
+                mSlots[i].sequence.store(i, std::memory_order_relaxed);
+            }
+        }
+
+        ~LogQueue()
+        {
+            stop();
+        }
+
+        bool setFile(const std::string& filename)
+        {
+            FilePtr file(fopen(filename.data(), "w"));
+            if (!file) return false;
+
+            {
+                std::lock_guard<std::mutex> lock(mFileMutex);
+                mFile = std::move(file);
+            }
+
+            if (!mThread.joinable()) {
+                mRunning = true;
+                mThread = std::thread(&LogQueue::run, this);
+                installCrashHandlers();
+            }
+
+            mEnabled.store(true, std::memory_order_release);
+            return true;
+        }
+
+        // If mustDeliver is set, waits a bounded amount of time for room instead of dropping
+        void push(const char* prefix, const char* format, va_list args, bool mustDeliver)
+        {
+            if (!mEnabled.load(std::memory_order_acquire)) return;
+
+            // Claim a slot
+            auto deadline = std::chrono::steady_clock::time_point::max();
+            size_t pos = mEnqueuePos.load(std::memory_order_relaxed);
+            Slot* slot;
+            while (true) {
+                slot = &mSlots[pos & (Capacity - 1u)];
+                size_t seq = slot->sequence.load(std::memory_order_acquire);
+                auto diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+
+                if (diff == 0) {
+                    if (mEnqueuePos.compare_exchange_weak(pos, pos + 1u,
+                        std::memory_order_relaxed)) break;
+                }
+                else if (diff < 0) {
+                    // Queue is full
+                    if (mustDeliver) {
+                        auto now = std::chrono::steady_clock::now();
+                        if (deadline == std::chrono::steady_clock::time_point::max()) {
+                            deadline = now + std::chrono::milliseconds(200);
+                        }
+
+                        if (now < deadline) {
+                            mWakeCondition.notify_one();
+                            std::this_thread::yield();
+                            pos = mEnqueuePos.load(std::memory_order_relaxed);
+                            continue;
+                        }
+                    }
+
+                    mDropped.fetch_add(1u, std::memory_order_relaxed);
+                    return;
+                }
+                else {
+                    pos = mEnqueuePos.load(std::memory_order_relaxed);
+                }
+            }
+
+            // Format the message into the slot, spill over to the heap if it's too long
+            va_list argsCopy;
+            va_copy(argsCopy, args);
+
+            slot->prefix = prefix;
+            slot->overflow = nullptr;
+            int length = vsnprintf(slot->text, TextSize, format, args);
+            if (length >= static_cast<int>(TextSize)) {
+                slot->overflow = static_cast<char*>(malloc(length + 1));
+                if (slot->overflow) vsnprintf(slot->overflow, length + 1, format, argsCopy);
+            }
+            else if (length < 0) {
+                slot->text[0] = '\0';
+            }
+
+            va_end(argsCopy);
+
+            slot->sequence.store(pos + 1u, std::memory_order_release);
+
+            // Wake the writer early if the queue is filling up
+            if (pos - mDequeuePos.load(std::memory_order_relaxed) >= Capacity / 2u) {
+                mWakeCondition.notify_one();
+            }
+        }
+
+        bool flush(double maxWait)
+        {
+            if (!mThread.joinable()) return true;
+
+            size_t target = mEnqueuePos.load(std::memory_order_acquire);
+            auto deadline = std::chrono::steady_clock::now() +
+                std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                    std::chrono::duration<double>(maxWait)
+                );
+
+            std::unique_lock<std::mutex> lock(mWaitMutex);
+            mFlushRequested = true;
+            mWakeCondition.notify_one();
+
+            return mFlushedCondition.wait_until(lock, deadline, [&] {
+                return mWrittenPos.load(std::memory_order_acquire) >= target;
+            });
+        }
+
+        uint64_t dropped() const
+        {
+            return mDropped.load(std::memory_order_relaxed);
+        }
+
+        void stop()
+        {
+            if (!mThread.joinable()) return;
+
+            {
+                std::lock_guard<std::mutex> lock(mWaitMutex);
+                mRunning = false;
+            }
+            mWakeCondition.notify_one();
+            mThread.join();
+        }
+
+        // Used from signal handlers: only spins on atomics, for a bounded amount of time
+        void waitForWriter()
+        {
+            size_t target = mEnqueuePos.load(std::memory_order_acquire);
+            auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(250);
 
-    void logToFile(const char* prefix, const char* format, va_list args)
+            while (mWrittenPos.load(std::memory_order_acquire) < target &&
+                std::chrono::steady_clock::now() < deadline) {
+                std::this_thread::yield();
+            }
+        }
+
+    private:
+        struct Slot
+        {
+            std::atomic<size_t> sequence;
+            const char* prefix;
+            char* overflow;
+            char text[TextSize];
+        };
+
+        void run()
+        {
+            std::unique_lock<std::mutex> lock(mWaitMutex);
+            while (mRunning) {
+                // Write in batches, either periodically or when someone needs it now
+                mWakeCondition.wait_for(lock, std::chrono::milliseconds(50), [this] {
+                    return mFlushRequested || !mRunning;
+                });
+                mFlushRequested = false;
+
+                lock.unlock();
+                drain();
+                lock.lock();
+
+                mFlushedCondition.notify_all();
+            }
+
+            lock.unlock();
+            drain();
+            mFlushedCondition.notify_all();
+        }
+
+        void drain()
+        {
+            std::lock_guard<std::mutex> lock(mFileMutex);
+            auto* file = mFile.get();
+
+            size_t pos = mDequeuePos.load(std::memory_order_relaxed);
+            while (true) {
+                auto& slot = mSlots[pos & (Capacity - 1u)];
+                if (slot.sequence.load(std::memory_order_acquire) != pos + 1u) break;
+
+                if (file) {
+                    fputs(slot.prefix, file);
+                    fputs(": ", file);
+                    fputs(slot.overflow ? slot.overflow : slot.text, file);
+                    fputs("\r\n", file);
+                }
+
+                free(slot.overflow);
+                slot.overflow = nullptr;
+
+                slot.sequence.store(pos + Capacity, std::memory_order_release);
+                mDequeuePos.store(++pos, std::memory_order_relaxed);
+            }
+
+            // Report lost messages
+            uint64_t dropped = mDropped.load(std::memory_order_relaxed);
+            if (file && dropped != mReportedDropped) {
+                fprintf(file, "WARN: Log queue full, %llu messages dropped\r\n",
+                    static_cast<unsigned long long>(dropped - mReportedDropped));
+                mReportedDropped = dropped;
+            }
+
+            if (file) fflush(file);
+            mWrittenPos.store(pos, std::memory_order_release);
+        }
+
+        static void crashHandler(int sig);
+
+        void installCrashHandlers()
+        {
+            std::signal(SIGSEGV, crashHandler);
+            std::signal(SIGABRT, crashHandler);
+            std::signal(SIGFPE,  crashHandler);
+            std::signal(SIGILL,  crashHandler);
+        }
+
+        Slot mSlots[Capacity];
+        std::atomic<size_t> mEnqueuePos {0u};
+        std::atomic<size_t> mDequeuePos {0u};
+        std::atomic<size_t> mWrittenPos {0u};
+        std::atomic<uint64_t> mDropped {0u};
+        std::atomic<bool> mEnabled {false};
+        uint64_t mReportedDropped {0u};
+
+        std::mutex mFileMutex;
+        FilePtr mFile {nullptr};
+
+        std::thread mThread;
+        std::mutex mWaitMutex;
+        std::condition_variable mWakeCondition;
+        std::condition_variable mFlushedCondition;
+        bool mRunning {false};
+        bool mFlushRequested {false};
+    };
+
+    constexpr size_t LogQueue::Capacity;
+    constexpr size_t LogQueue::TextSize;
+
+    LogQueue& logQueue()
+    {
+        static LogQueue queue;
+        return queue;
+    }
+
+    void LogQueue::crashHandler(int sig)
     {
-        std::lock_guard<std::mutex> lock(logFileMutex);
-        if (!logFile) return;
+        // Give the writer thread a chance to get everything to disk, then die as we would have
+        logQueue().waitForWriter();
 
-        auto* file = logFile.get();
+        std::signal(sig, SIG_DFL);
+        std::raise(sig);
+    }
 
-        fprintf (file, "%s: ", prefix); // Write prefix
-        vfprintf(file, format, args);   // Write message
-        fprintf (file, "\r\n");         // New line
-        fflush  (file);                 // Flush
+    void logToFile(const char* prefix, const char* format, va_list args, bool mustDeliver = false)
+    {
+        logQueue().push(prefix, format, args, mustDeliver);
     }
 }
 
 bool Log::setLogFile(const std::string& filename)
 {
-    logFile = FilePtr(fopen(filename.data(), "w"));
-    return logFile != nullptr;
+    return logQueue().setFile(filename);
+}
+
+bool Log::flush(double maxWait)
+{
+    return logQueue().flush(maxWait);
+}
+
+uint64_t Log::droppedMessages()
+{
+    return logQueue().dropped();
 }
 
 void Log::verbose(const char* format, ...)
 {
-    va_list args;
+    va_list args, fileArgs;
     va_start(args, format);
+    va_copy(fileArgs, args);
 
     SDL_LogMessageV(SDL_LOG_CATEGORY_APPLICATION, SDL_LOG_PRIORITY_VERBOSE, format, args);
-    logToFile("VERBOSE", format, args);
+    logToFile("VERBOSE", format, fileArgs);
 
+    va_end(fileArgs);
     va_end(args);
 }
 
 void Log::debug(const char* format, ...)
 {
-    va_list args;
+    va_list args, fileArgs;
     va_start(args, format);
+    va_copy(fileArgs, args);
 
     SDL_LogMessageV(SDL_LOG_CATEGORY_APPLICATION, SDL_LOG_PRIORITY_DEBUG, format, args);
-    logToFile("DEBUG", format, args);
+    logToFile("DEBUG", format, fileArgs);
 
+    va_end(fileArgs);
     va_end(args);
 }
 
 void Log::info(const char* format, ...)
 {
-    va_list args;
+    va_list args, fileArgs;
     va_start(args, format);
+    va_copy(fileArgs, args);
 
     SDL_LogMessageV(SDL_LOG_CATEGORY_APPLICATION, SDL_LOG_PRIORITY_INFO, format, args);
-    logToFile("INFO", format, args);
+    logToFile("INFO", format, fileArgs);
 
+    va_end(fileArgs);
     va_end(args);
 }
 
 void Log::warning(const char* format, ...)
 {
-    va_list args;
+    va_list args, fileArgs;
     va_start(args, format);
+    va_copy(fileArgs, args);
 
     SDL_LogMessageV(SDL_LOG_CATEGORY_APPLICATION, SDL_LOG_PRIORITY_WARN, format, args);
-    logToFile("WARN", format, args);
+    logToFile("WARN", format, fileArgs);
 
+    va_end(fileArgs);
     va_end(args);
 }
 
 void Log::error(const char* format, ...)
 {
-    va_list args;
+    va_list args, fileArgs;
     va_start(args, format);
+    va_copy(fileArgs, args);
 
     SDL_LogMessageV(SDL_LOG_CATEGORY_APPLICATION, SDL_LOG_PRIORITY_ERROR, format, args);
-    logToFile("ERROR", format, args);
+    logToFile("ERROR", format, fileArgs);
 
+    va_end(fileArgs);
     va_end(args);
 }
 
 void Log::fatal(const char* format, ...)
 {
-    va_list args;
+    va_list args, fileArgs;
     va_start(args, format);
+    va_copy(fileArgs, args);
 
     SDL_LogMessageV(SDL_LOG_CATEGORY_APPLICATION, SDL_LOG_PRIORITY_CRITICAL, format, args);
-    logToFile("FATAL", format, args);
+    logToFile("FATAL", format, fileArgs, true);
 
+    va_end(fileArgs);
     va_end(args);
+
+    // Make sure the message reaches the disk before we go down
+    flush();
 }
@@ -31,11 +31,18 @@
 #include <string>
 
 // A set of functions to handle logging information
+// Messages are queued and written to the log file in batches by a background thread
 class NX_HIDDEN Log
 {
 public:
     static bool setLogFile(const std::string& filename);
 
+    // Blocks until queued messages are written to disk, or until maxWait seconds have passed
+    static bool flush(double maxWait = 0.2);
+
+    // Number of messages that were lost because the queue was full
+    static uint64_t droppedMessages();
+
     static void verbose(const char* format, ...);
     static void verbose(const std::string& message)
     {
@@ -0,0 +1,240 @@
+/*
+    This is free and unencumbered software released into the public domain.
+
+    Anyone is free to copy, modify, publish, use, compile, sell, or
+    distribute this software, either in source code form or as a compiled
+    binary, for any purpose, commercial or non-commercial, and by any
+    means.
+
+    In jurisdictions that recognize copyright laws, the author or authors
+    of this software dedicate any and all copyright interest in the
+    software to the public domain. We make this dedication for the benefit
+    of the public at large and to the detriment of our heirs and
+    successors. We intend this dedication to be an overt act of
+    relinquishment in perpetuity of all present and future rights to this
+    software under copyright law.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+    MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+    IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+    OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+    ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+    OTHER DEALINGS IN THE SOFTWARE.
+
+    For more information, please refer to <http://unlicense.org>
+*/
+
+#include "luacache.hpp"
+
+#include <physfs/physfs.h>
+#include <luajit/luajit.h>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+// Locals
+namespace
+{
+    using Bytecode = std::shared_ptr<const std::string>;
+
+    struct Entry
+    {
+        uint64_t hash;
+        Bytecode bytecode;
+    };
+
+    struct Header
+    {
+        char magic[4];
+        uint32_t version;
+        uint64_t hash;
+    };
+
+    const char Magic[4] = {'N', 'X', 'L', 'C'};
+    const char* WriteDir = "cache/lua";
+    const char* ReadDir = "userdata/cache/lua";
+
+    #if defined(NDEBUG)
+        constexpr bool StripDebugInfo = true;
+    #else
+        constexpr bool StripDebugInfo = false;
+    #endif
+
+    std::mutex mutex;
+    std::unordered_map<std::string, Entry> entries;
+    std::map<std::string, std::string> modules;
+    LuaCache::Stats counters {};
+    std::once_flag writeDirFlag;
+
+    // Bytecode from 32 and 64-bit builds, or stripped and unstripped, must never be mixed up
+    uint64_t hashData(const char* data, size_t size)
+    {
+        uint64_t hash = 14695981039346656037ull;
+        hash ^= (sizeof(void*) << 1u) | (StripDebugInfo ? 1u : 0u);
+        hash *= 1099511628211ull;
+
+        for (size_t i = 0u; i < size; ++i) {
+            hash ^= static_cast<uint8_t>(data[i]);
+            hash *= 1099511628211ull;
+        }
+
+        return hash;
+    }
+
+    std::string cacheName(const std::string& filename)
+    {
+        char name[21];
+        std::snprintf(name, sizeof(name), "/%016" PRIx64, hashData(filename.data(), filename.size()));
+        return std::string(name) + ".luac";
+    }
+
+    bool readFile(const std::string& filename, std::string& contents)
+    {
+        auto* file = PHYSFS_openRead(filename.data());
+        if (!file) return false;
+
+        auto length = PHYSFS_fileLength(file);
+        bool ok = length >= 0;
+        if (ok) {
+            contents.resize(static_cast<size_t>(length));
+            ok = PHYSFS_readBytes(file, &contents[0], contents.size()) == length;
+        }
+
+        PHYSFS_close(file);
+        return ok;
+    }
+
+    Bytecode readBytecode(const std::string& filename, uint64_t hash)
+    {
+        std::string contents;
+        if (!readFile(ReadDir + cacheName(filename), contents)) return nullptr;
+        if (contents.size() < sizeof(Header)) return nullptr;
+
+        Header header;
+        std::memcpy(&header, contents.data(), sizeof(Header));
+        if (std::memcmp(header.magic, Magic, sizeof(Magic)) != 0 ||
+            header.version != LUAJIT_VERSION_NUM || header.hash != hash) {
+            return nullptr;
+        }
+
+        contents.erase(0u, sizeof(Header));
+        return std::make_shared<const std::string>(std::move(contents));
+    }
+
+    void writeBytecode(const std::string& filename, uint64_t hash, const std::string& bytecode)
+    {
+        std::call_once(writeDirFlag, [] { PHYSFS_mkdir(WriteDir); });
+
+        auto* file = PHYSFS_openWrite((WriteDir + cacheName(filename)).data());
+        if (!file) return;
+
+        Header header;
+        std::memcpy(header.magic, Magic, sizeof(Magic));
+        header.version = LUAJIT_VERSION_NUM;
+        header.hash = hash;
+
+        PHYSFS_writeBytes(file, &header, sizeof(Header));
+        PHYSFS_writeBytes(file, bytecode.data(), bytecode.size());
+        PHYSFS_close(file);
+    }
+}
+
+namespace LuaCache
+{
+    const char* fetch(const std::string& filename, size_t& size, const char*& bytecode,
+        size_t& bytecodeSize, uint64_t& hash)
+    {
+        // Keeps the returned buffers alive until the caller is done with them
+        thread_local std::string source;
+        thread_local Bytecode current;
+
+        if (!readFile(filename, source)) return nullptr;
+
+        size = source.size();
+        hash = hashData(source.data(), source.size());
+        current = nullptr;
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+
+            auto it = entries.find(filename);
+            if (it != entries.end() && it->second.hash == hash) {
+                current = it->second.bytecode;
+                ++counters.memoryHits;
+            }
+        }
+
+        // Look for bytecode from a previous run
+        if (!current) {
+            current = readBytecode(filename, hash);
+            if (current) {
+                std::lock_guard<std::mutex> lock(mutex);
+                entries[filename] = {hash, current};
+                ++counters.diskHits;
+            }
+        }
+
+        bytecode = current ? current->data() : nullptr;
+        bytecodeSize = current ? current->size() : 0u;
+
+        return source.data();
+    }
+
+    void store(const std::string& filename, uint64_t hash, const char* bytecode, size_t size)
+    {
+        auto data = std::make_shared<const std::string>(bytecode, size);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            entries[filename] = {hash, data};
+            ++counters.compiles;
+        }
+
+        writeBytecode(filename, hash, *data);
+    }
+
+    const char* resolve(const std::string& moduleName)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        // Map nodes never move, and modules are never removed from the index
+        auto it = modules.find(moduleName);
+        return it != modules.end() ? it->second.data() : nullptr;
+    }
+
+    void index(const std::string& moduleName, const std::string& filename)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        modules.emplace(moduleName, filename);
+    }
+
+    bool stripsDebugInfo()
+    {
+        return StripDebugInfo;
+    }
+
+    void addVM(double creationTime)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        ++counters.vmCount;
+        counters.vmCreationTime += creationTime;
+    }
+
+    void addVMAcquire(double acquireTime)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        ++counters.vmAcquires;
+        counters.vmAcquireTime += acquireTime;
+    }
+
+    Stats stats()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return counters;
+    }
+}
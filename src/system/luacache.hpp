@@ -0,0 +1,67 @@
+/*
+    This is free and unencumbered software released into the public domain.
+
+    Anyone is free to copy, modify, publish, use, compile, sell, or
+    distribute this software, either in source code form or as a compiled
+    binary, for any purpose, commercial or non-commercial, and by any
+    means.
+
+    In jurisdictions that recognize copyright laws, the author or authors
+    of this software dedicate any and all copyright interest in the
+    software to the public domain. We make this dedication for the benefit
+    of the public at large and to the detriment of our heirs and
+    successors. We intend this dedication to be an overt act of
+    relinquishment in perpetuity of all present and future rights to this
+    software under copyright law.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+    MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+    IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+    OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+    ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+    OTHER DEALINGS IN THE SOFTWARE.
+
+    For more information, please refer to <http://unlicense.org>
+*/
+
+#pragma once
+#include "../config.hpp"
+
+#include <string>
+
+// Process-wide cache of compiled Lua chunks and resolved module paths, shared by all Lua VMs
+// Bytecode is kept in memory and under userdata, keyed by path and source content hash
+namespace LuaCache
+{
+    struct Stats
+    {
+        uint32_t memoryHits;
+        uint32_t diskHits;
+        uint32_t compiles;
+        uint32_t vmCount;
+        uint32_t vmAcquires;
+        double vmCreationTime;
+        double vmAcquireTime;
+    };
+
+    // Reads a script, along with its bytecode if an up to date one is cached
+    // The returned pointers are valid until the next fetch on the same thread
+    NX_HIDDEN const char* fetch(const std::string& filename, size_t& size, const char*& bytecode,
+        size_t& bytecodeSize, uint64_t& hash);
+
+    // Keeps the bytecode compiled from a fetched script, and writes it to disk
+    NX_HIDDEN void store(const std::string& filename, uint64_t hash, const char* bytecode,
+        size_t size);
+
+    // Module name to filename index, resolve() returns nullptr for unknown modules
+    NX_HIDDEN const char* resolve(const std::string& moduleName);
+    NX_HIDDEN void index(const std::string& moduleName, const std::string& filename);
+
+    // Debug information is only stripped from release builds' bytecode
+    NX_HIDDEN bool stripsDebugInfo();
+
+    NX_HIDDEN void addVM(double creationTime);
+    NX_HIDDEN void addVMAcquire(double acquireTime);
+    NX_HIDDEN Stats stats();
+}
@@ -26,8 +26,74 @@
 */
 
 #include "luavm.hpp"
+#include "luacache.hpp"
+#include "clock.hpp"
+#include "log.hpp"
 
 #include <luajit/lua.hpp>
+#include <algorithm>
+#include <mutex>
+#include <thread>
+
+// Locals
+namespace
+{
+    int appendChunk(lua_State*, const void* data, size_t size, void* userdata)
+    {
+        static_cast<std::string*>(userdata)->append(static_cast<const char*>(data), size);
+        return 0;
+    }
+
+    struct Pool
+    {
+        ~Pool()
+        {
+            LuaVM::clearPool();
+        }
+
+        std::mutex mutex;
+        std::vector<lua_State*> states;
+        std::vector<std::string> modules;
+        size_t capacity = 4u;
+        std::thread worker;
+        bool stopping = false;
+    };
+
+    Pool pool;
+
+    lua_State* createState(const std::vector<std::string>& modules)
+    {
+        lua_State* state = luaL_newstate();
+        if (!state) return nullptr;
+
+        std::string err;
+        if (!LuaVM::loadNxLibs(state, &err)) {
+            Log::warning("Unable to load NxLibs into new Lua VM: " + err);
+            lua_close(state);
+            return nullptr;
+        }
+
+        for (const auto& module : modules) {
+            lua_settop(state, 0);
+            lua_getglobal(state, "require");
+            lua_pushstring(state, module.data());
+            if (lua_pcall(state, 1, 0, 0) != 0) {
+                Log::warning("Unable to preload module " + module + ": " + lua_tostring(state, -1));
+            }
+        }
+
+        // Whatever gets defined from now on is wiped when the state is released
+        lua_settop(state, 0);
+        lua_getglobal(state, "NX_SnapshotGlobals");
+        lua_pcall(state, 0, 0, 0);
+
+        // Reserve the first slot for the debug function
+        lua_settop(state, 0);
+        lua_getglobal(state, "NX_Debug");
+
+        return state;
+    }
+}
 
 LuaVM::~LuaVM()
 {
@@ -102,6 +168,8 @@ bool LuaVM::loadNxLibs(lua_State* state, std::string* err)
         return false;
     }
 
+    auto startTime = Clock::now();
+
     // Lua libraries to load
     static const luaL_Reg lj_lib_load[] = {
         { "",              luaopen_base },
@@ -144,13 +212,29 @@ bool LuaVM::loadNxLibs(lua_State* state, std::string* err)
     }
     lua_pop(state, 1);
 
-    // Load custom nxLibs
+    // Load custom nxLibs, only the first VM has to parse them
     static std::string code(
         #include "../lua/nxlib.luainl"
     );
+    static std::string bytecode;
+    static std::once_flag compiled;
+
+    std::call_once(compiled, [] {
+        lua_State* compiler = luaL_newstate();
+        if (!compiler) return;
+
+        if (luaL_loadbuffer(compiler, code.data(), code.size(), "nxlib.lua") == 0) {
+            lua_dump(compiler, appendChunk, &bytecode);
+        }
+        lua_close(compiler);
+    });
 
     // Load up the code into the Lua state
-    if (luaL_loadbuffer(state, code.data(), code.size(), "nxlib.lua") != 0) return false;
+    const std::string& chunk = bytecode.empty() ? code : bytecode;
+    if (luaL_loadbuffer(state, chunk.data(), chunk.size(), "nxlib.lua") != 0) {
+        if (err) *err = lua_tolstring(state, -1, nullptr);
+        return false;
+    }
 
     // Try to run the code
     if (lua_pcall(state, 0, 1, 0) != 0) {
@@ -158,5 +242,104 @@ bool LuaVM::loadNxLibs(lua_State* state, std::string* err)
         return false;
     }
 
+    LuaCache::addVM(Clock::now() - startTime);
     return true;
 }
+
+lua_State* LuaVM::acquireState()
+{
+    auto startTime = Clock::now();
+    lua_State* state = nullptr;
+    std::vector<std::string> modules;
+
+    {
+        std::lock_guard<std::mutex> lock(pool.mutex);
+        if (!pool.states.empty()) {
+            state = pool.states.back();
+            pool.states.pop_back();
+        }
+        else {
+            modules = pool.modules;
+        }
+    }
+
+    if (!state) state = createState(modules);
+
+    LuaCache::addVMAcquire(Clock::now() - startTime);
+    return state;
+}
+
+void LuaVM::releaseState(lua_State* state)
+{
+    if (!state) return;
+
+    lua_settop(state, 0);
+    lua_getglobal(state, "NX_ResetGlobals");
+    if (lua_pcall(state, 0, 0, 0) != 0) {
+        lua_close(state);
+        return;
+    }
+
+    // A full collection would stall the releasing thread, the next user's steps catch up
+    lua_gc(state, LUA_GCSTEP, 0);
+    lua_settop(state, 0);
+    lua_getglobal(state, "NX_Debug");
+
+    {
+        std::lock_guard<std::mutex> lock(pool.mutex);
+        if (!pool.stopping && pool.states.size() < pool.capacity) {
+            pool.states.push_back(state);
+            return;
+        }
+    }
+
+    lua_close(state);
+}
+
+void LuaVM::prewarm(size_t count, const std::vector<std::string>& modules)
+{
+    // Only one worker fills the pool at a time
+    if (pool.worker.joinable()) pool.worker.join();
+
+    std::vector<lua_State*> stale;
+    {
+        std::lock_guard<std::mutex> lock(pool.mutex);
+        if (pool.stopping) return;
+
+        // States that were created with another set of modules are replaced
+        if (pool.modules != modules) stale.swap(pool.states);
+        pool.modules = modules;
+        pool.capacity = std::max(pool.capacity, count);
+    }
+
+    for (auto* state : stale) lua_close(state);
+
+    pool.worker = std::thread([count, modules] {
+        while (true) {
+            {
+                std::lock_guard<std::mutex> lock(pool.mutex);
+                if (pool.stopping || pool.states.size() >= count) return;
+            }
+
+            lua_State* state = createState(modules);
+            if (!state) return;
+
+            std::lock_guard<std::mutex> lock(pool.mutex);
+            pool.states.push_back(state);
+        }
+    });
+}
+
+void LuaVM::clearPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(pool.mutex);
+        pool.stopping = true;
+    }
+
+    if (pool.worker.joinable()) pool.worker.join();
+
+    std::lock_guard<std::mutex> lock(pool.mutex);
+    for (auto* state : pool.states) lua_close(state);
+    pool.states.clear();
+}
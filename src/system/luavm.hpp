@@ -29,6 +29,7 @@
 #include "../config.hpp"
 
 #include <string>
+#include <vector>
 
 struct lua_State;
 
@@ -46,6 +47,15 @@ public:
 
     static bool loadNxLibs(lua_State* state, std::string* err = nullptr);
 
+    // Pool of ready to use states, with nxLibs and the preloaded modules loaded
+    // Released states are reset to their initial globals and handed out again
+    static lua_State* acquireState();
+    static void releaseState(lua_State* state);
+
+    // Fills the pool in the background, up to count states requiring the given modules
+    static void prewarm(size_t count, const std::vector<std::string>& modules);
+    static void clearPool();
+
 private:
     lua_State* mState {nullptr};
     std::string mErrorMessage;
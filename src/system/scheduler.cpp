@@ -0,0 +1,276 @@
+/*
+    This is free and unencumbered software released into the public domain.
+
+    Anyone is free to copy, modify, publish, use, compile, sell, or
+    distribute this software, either in source code form or as a compiled
+    binary, for any purpose, commercial or non-commercial, and by any
+    means.
+
+    In jurisdictions that recognize copyright laws, the author or authors
+    of this software dedicate any and all copyright interest in the
+    software to the public domain. We make this dedication for the benefit
+    of the public at large and to the detriment of our heirs and
+    successors. We intend this dedication to be an overt act of
+    relinquishment in perpetuity of all present and future rights to this
+    software under copyright law.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+    MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+    IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+    OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+    ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+    OTHER DEALINGS IN THE SOFTWARE.
+
+    For more information, please refer to <http://unlicense.org>
+*/
+
+#include "scheduler.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+// Locals
+namespace
+{
+    struct Future
+    {
+        Scheduler::Status status;
+        Scheduler::Result result;
+    };
+
+    std::mutex mutex;
+    std::condition_variable finishedCondition;
+    std::condition_variable jobCondition;
+
+    std::unordered_map<uint32_t, Future> futures;
+    std::vector<uint32_t> completed;
+    uint32_t nextId = 1u;
+
+    std::deque<std::pair<uint32_t, Scheduler::Job>> jobs;
+    std::vector<std::thread> workers;
+    bool stopping = false;
+
+    void discard(Scheduler::Result& result)
+    {
+        if (result.object && result.deleter) result.deleter(result.object);
+        result.object = nullptr;
+    }
+
+    void finish(uint32_t id, Scheduler::Status status, Scheduler::Result&& result)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+
+            auto it = futures.find(id);
+            if (it != futures.end() && it->second.status == Scheduler::Pending) {
+                it->second.status = status;
+                it->second.result = std::move(result);
+                completed.push_back(id);
+                finishedCondition.notify_all();
+                return;
+            }
+        }
+
+        // Nobody is interested in the result anymore
+        discard(result);
+    }
+
+    void workerLoop()
+    {
+        while (true) {
+            std::pair<uint32_t, Scheduler::Job> job;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                jobCondition.wait(lock, [] { return stopping || !jobs.empty(); });
+                if (stopping) return;
+
+                job = std::move(jobs.front());
+                jobs.pop_front();
+            }
+
+            Scheduler::Result result;
+            bool succeeded = job.second(result);
+            finish(job.first, succeeded ? Scheduler::Done : Scheduler::Failed, std::move(result));
+        }
+    }
+}
+
+namespace Scheduler
+{
+    uint32_t create()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        // Zero is never used, so it can stand for no future at all
+        uint32_t id = nextId++;
+        if (nextId == 0u) nextId = 1u;
+
+        futures[id].status = Pending;
+        return id;
+    }
+
+    uint32_t submit(Job job)
+    {
+        uint32_t id = create();
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (stopping) {
+            futures[id].status = Failed;
+            futures[id].result.error = "Scheduler is shut down";
+            completed.push_back(id);
+            return id;
+        }
+
+        // Workers are only started once there's something for them to do
+        if (workers.empty()) {
+            unsigned count = std::max(std::thread::hardware_concurrency(), 2u) - 1u;
+            for (unsigned i = 0u; i < std::min(count, 4u); ++i) {
+                workers.emplace_back(workerLoop);
+            }
+        }
+
+        jobs.emplace_back(id, std::move(job));
+        jobCondition.notify_one();
+
+        return id;
+    }
+
+    void complete(uint32_t id, const void* data, size_t size)
+    {
+        Result result;
+        if (data && size > 0u) {
+            auto* bytes = static_cast<const uint8_t*>(data);
+            result.data.assign(bytes, bytes + size);
+        }
+
+        finish(id, Done, std::move(result));
+    }
+
+    void fail(uint32_t id, const std::string& error)
+    {
+        Result result;
+        result.error = error;
+
+        finish(id, Failed, std::move(result));
+    }
+
+    size_t poll(uint32_t* ids, size_t maxCount)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        auto count = std::min(maxCount, completed.size());
+        std::copy(completed.begin(), completed.begin() + count, ids);
+        completed.erase(completed.begin(), completed.begin() + count);
+
+        return count;
+    }
+
+    Status wait(uint32_t id, double timeout)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+
+        auto isFinished = [id] {
+            auto it = futures.find(id);
+            return it == futures.end() || it->second.status != Pending;
+        };
+
+        if (timeout < 0.0) {
+            finishedCondition.wait(lock, isFinished);
+        }
+        else {
+            finishedCondition.wait_for(lock, std::chrono::duration<double>(timeout), isFinished);
+        }
+
+        auto it = futures.find(id);
+        return it != futures.end() ? it->second.status : Invalid;
+    }
+
+    Status status(uint32_t id)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        auto it = futures.find(id);
+        return it != futures.end() ? it->second.status : Invalid;
+    }
+
+    const std::vector<uint8_t>* data(uint32_t id)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        // Finished futures are never modified again, the data stays put until released
+        auto it = futures.find(id);
+        if (it == futures.end() || it->second.status == Pending) return nullptr;
+
+        return &it->second.result.data;
+    }
+
+    const char* error(uint32_t id)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        auto it = futures.find(id);
+        if (it == futures.end() || it->second.status != Failed) return nullptr;
+
+        return it->second.result.error.data();
+    }
+
+    void* takeObject(uint32_t id)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        auto it = futures.find(id);
+        if (it == futures.end() || it->second.status != Done) return nullptr;
+
+        auto* object = it->second.result.object;
+        it->second.result.object = nullptr;
+        return object;
+    }
+
+    void release(uint32_t id)
+    {
+        Result result;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+
+            // Jobs still running for this future throw their result away when they're done
+            auto it = futures.find(id);
+            if (it == futures.end()) return;
+
+            result = std::move(it->second.result);
+            futures.erase(it);
+        }
+
+        discard(result);
+    }
+
+    void shutdown()
+    {
+        // Queued jobs never run, their futures fail instead so that nobody waits on them forever
+        std::deque<std::pair<uint32_t, Job>> dropped;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+            dropped.swap(jobs);
+
+            for (auto& job : dropped) {
+                auto it = futures.find(job.first);
+                if (it == futures.end() || it->second.status != Pending) continue;
+
+                it->second.status = Failed;
+                it->second.result.error = "Scheduler is shut down";
+                completed.push_back(job.first);
+            }
+        }
+
+        finishedCondition.notify_all();
+        jobCondition.notify_all();
+        for (auto& worker : workers) worker.join();
+        workers.clear();
+    }
+}
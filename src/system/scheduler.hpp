@@ -0,0 +1,84 @@
+/*
+    This is free and unencumbered software released into the public domain.
+
+    Anyone is free to copy, modify, publish, use, compile, sell, or
+    distribute this software, either in source code form or as a compiled
+    binary, for any purpose, commercial or non-commercial, and by any
+    means.
+
+    In jurisdictions that recognize copyright laws, the author or authors
+    of this software dedicate any and all copyright interest in the
+    software to the public domain. We make this dedication for the benefit
+    of the public at large and to the detriment of our heirs and
+    successors. We intend this dedication to be an overt act of
+    relinquishment in perpetuity of all present and future rights to this
+    software under copyright law.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+    MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+    IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+    OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+    ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+    OTHER DEALINGS IN THE SOFTWARE.
+
+    For more information, please refer to <http://unlicense.org>
+*/
+
+#pragma once
+#include "../config.hpp"
+
+#include <functional>
+#include <string>
+#include <vector>
+
+// Process-wide futures, completed by native jobs or by any thread,
+// and collected by the main thread in batches to resume whatever awaits them
+namespace Scheduler
+{
+    enum Status : uint32_t {
+        Pending,
+        Done,
+        Failed,
+        Invalid
+    };
+
+    struct Result
+    {
+        std::vector<uint8_t> data;
+        void* object = nullptr;
+        std::function<void(void*)> deleter;
+        std::string error;
+    };
+
+    // Jobs fill the result and return whether they succeeded
+    using Job = std::function<bool(Result&)>;
+
+    // A future that is completed with complete() or fail()
+    NX_HIDDEN uint32_t create();
+
+    // A future that is completed once the job ran on the worker pool
+    NX_HIDDEN uint32_t submit(Job job);
+
+    NX_HIDDEN void complete(uint32_t id, const void* data, size_t size);
+    NX_HIDDEN void fail(uint32_t id, const std::string& error);
+
+    // Ids of the futures completed since the last call
+    NX_HIDDEN size_t poll(uint32_t* ids, size_t maxCount);
+
+    // A negative timeout waits forever, returns the status either way
+    NX_HIDDEN Status wait(uint32_t id, double timeout);
+    NX_HIDDEN Status status(uint32_t id);
+
+    // Only valid for finished futures, until they're released
+    NX_HIDDEN const std::vector<uint8_t>* data(uint32_t id);
+    NX_HIDDEN const char* error(uint32_t id);
+
+    // The caller becomes the owner of the object
+    NX_HIDDEN void* takeObject(uint32_t id);
+
+    NX_HIDDEN void release(uint32_t id);
+
+    // Waits for running jobs and stops the worker pool, the futures of queued ones fail
+    NX_HIDDEN void shutdown();
+}
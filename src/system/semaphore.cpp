@@ -0,0 +1,89 @@
+/*
+    This is free and unencumbered software released into the public domain.
+
+    Anyone is free to copy, modify, publish, use, compile, sell, or
+    distribute this software, either in source code form or as a compiled
+    binary, for any purpose, commercial or non-commercial, and by any
+    means.
+
+    In jurisdictions that recognize copyright laws, the author or authors
+    of this software dedicate any and all copyright interest in the
+    software to the public domain. We make this dedication for the benefit
+    of the public at large and to the detriment of our heirs and
+    successors. We intend this dedication to be an overt act of
+    relinquishment in perpetuity of all present and future rights to this
+    software under copyright law.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+    MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+    IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+    OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+    ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+    OTHER DEALINGS IN THE SOFTWARE.
+
+    For more information, please refer to <http://unlicense.org>
+*/
+
+#include "semaphore.hpp"
+
+#include <chrono>
+
+Semaphore::Semaphore(int count) :
+    mCount(count)
+{
+    // Nothing else to do
+}
+
+void Semaphore::release(int count)
+{
+    mCount.fetch_add(count);
+
+    // Waiters check the count under the lock, so they can't miss this notification
+    if (mWaiters.load() > 0) {
+        std::lock_guard<std::mutex> lock(mMutex);
+        if (count == 1) {
+            mCondition.notify_one();
+        }
+        else {
+            mCondition.notify_all();
+        }
+    }
+}
+
+bool Semaphore::tryAcquire()
+{
+    int count = mCount.load();
+    while (count > 0) {
+        if (mCount.compare_exchange_weak(count, count - 1)) return true;
+    }
+
+    return false;
+}
+
+bool Semaphore::acquire(double timeout)
+{
+    if (tryAcquire()) return true;
+    if (timeout == 0.0) return false;
+
+    std::unique_lock<std::mutex> lock(mMutex);
+    mWaiters.fetch_add(1);
+
+    bool acquired;
+    if (timeout < 0.0) {
+        mCondition.wait(lock, [this] { return tryAcquire(); });
+        acquired = true;
+    }
+    else {
+        auto duration = std::chrono::duration<double>(timeout);
+        acquired = mCondition.wait_for(lock, duration, [this] { return tryAcquire(); });
+    }
+
+    mWaiters.fetch_sub(1);
+    return acquired;
+}
+
+int Semaphore::count() const
+{
+    return mCount.load();
+}
@@ -0,0 +1,265 @@
+/*
+    This is free and unencumbered software released into the public domain.
+
+    Anyone is free to copy, modify, publish, use, compile, sell, or
+    distribute this software, either in source code form or as a compiled
+    binary, for any purpose, commercial or non-commercial, and by any
+    means.
+
+    In jurisdictions that recognize copyright laws, the author or authors
+    of this software dedicate any and all copyright interest in the
+    software to the public domain. We make this dedication for the benefit
+    of the public at large and to the detriment of our heirs and
+    successors. We intend this dedication to be an overt act of
+    relinquishment in perpetuity of all present and future rights to this
+    software under copyright law.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+    MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+    IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+    OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+    ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+    OTHER DEALINGS IN THE SOFTWARE.
+
+    For more information, please refer to <http://unlicense.org>
+*/
+
+#include "snapshot.hpp"
+#include "log.hpp"
+
+#include <physfs/physfs.h>
+#include <stb_image/stb_image.h>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+// Part of stb_image_write, compiled along with image.cpp
+unsigned char* stbi_zlib_compress(unsigned char* data, int dataLength, int* outLength, int quality);
+
+// Locals
+namespace
+{
+    const char Magic[4] = {'N', 'X', 'S', 'S'};
+    constexpr uint8_t Version = 1u;
+    constexpr int CompressionQuality = 8;
+}
+
+Snapshot::~Snapshot()
+{
+    // Pending snapshots are still written
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mStopping = true;
+    }
+
+    mCondition.notify_all();
+    if (mWorker.joinable()) mWorker.join();
+}
+
+uint8_t* Snapshot::reserve(size_t size)
+{
+    if (mBuffer.size() < size) mBuffer.resize(size);
+
+    return mBuffer.data();
+}
+
+bool Snapshot::save(const std::string& filename, size_t size, bool delta)
+{
+    if (size > mBuffer.size() || (delta && !mBase)) return false;
+
+    Job job;
+    job.filename = filename;
+    job.data.swap(mBuffer);
+    job.data.resize(size);
+    job.delta = delta;
+
+    // The base is filled by the worker, before any delta is computed against it
+    if (!delta) mBase = std::make_shared<Base>();
+    job.base = mBase;
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    mJobs.push_back(std::move(job));
+    ++mPending;
+
+    if (!mWorker.joinable()) {
+        mWorker = std::thread(&Snapshot::run, this);
+    }
+
+    mCondition.notify_all();
+    return true;
+}
+
+bool Snapshot::isBusy() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mPending > 0u;
+}
+
+bool Snapshot::wait()
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+    mCondition.wait(lock, [this] {
+        return mPending == 0u;
+    });
+
+    return mSucceeded;
+}
+
+const uint8_t* Snapshot::load(const std::string& filename, size_t& size)
+{
+    // The base snapshot is only complete once it's been written
+    wait();
+
+    PHYSFS_File* file = PHYSFS_openRead(filename.data());
+    if (!file) {
+        Log::error("Unable to open snapshot " + filename + ": " + PHYSFS_getLastError());
+        return nullptr;
+    }
+
+    Buffer contents(static_cast<size_t>(std::max<PHYSFS_sint64>(PHYSFS_fileLength(file), 0)));
+    auto read = PHYSFS_readBytes(file, contents.data(), contents.size());
+    PHYSFS_close(file);
+
+    Header header;
+    if (read != static_cast<PHYSFS_sint64>(contents.size()) || contents.size() < sizeof(header)) {
+        Log::error("Unable to read snapshot " + filename);
+        return nullptr;
+    }
+
+    std::memcpy(&header, contents.data(), sizeof(header));
+    if (std::memcmp(header.magic, Magic, sizeof(Magic)) != 0 || header.version != Version) {
+        Log::error("Invalid snapshot " + filename);
+        return nullptr;
+    }
+
+    if (header.delta && (!mBase || header.baseHash != mBase->hash)) {
+        Log::warning("Snapshot " + filename + " is out of date with its full snapshot");
+        return nullptr;
+    }
+
+    int length = 0;
+    char* data = stbi_zlib_decode_malloc_guesssize(
+        reinterpret_cast<const char*>(contents.data() + sizeof(header)),
+        static_cast<int>(contents.size() - sizeof(header)), static_cast<int>(header.size), &length
+    );
+    if (!data || static_cast<uint32_t>(length) != header.size) {
+        Log::error("Unable to decompress snapshot " + filename);
+        std::free(data);
+        return nullptr;
+    }
+
+    mLoaded.assign(data, data + length);
+    std::free(data);
+
+    if (header.delta) {
+        // Undo the delta encoding
+        size_t common = std::min(mLoaded.size(), mBase->data.size());
+        for (size_t i = 0u; i < common; ++i) {
+            mLoaded[i] ^= mBase->data[i];
+        }
+    }
+    else {
+        mBase = std::make_shared<Base>();
+        mBase->data = mLoaded;
+        mBase->hash = hash(mLoaded);
+    }
+
+    size = mLoaded.size();
+    return mLoaded.data();
+}
+
+bool Snapshot::hasBase() const
+{
+    return mBase != nullptr;
+}
+
+void Snapshot::run()
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+
+    while (true) {
+        mCondition.wait(lock, [this] {
+            return !mJobs.empty() || mStopping;
+        });
+        if (mJobs.empty()) break;
+
+        Job job = std::move(mJobs.front());
+        mJobs.pop_front();
+
+        lock.unlock();
+        bool succeeded = write(job);
+        lock.lock();
+
+        mSucceeded = succeeded;
+        --mPending;
+        mCondition.notify_all();
+    }
+}
+
+bool Snapshot::write(Job& job)
+{
+    Buffer& data = job.data;
+    const Base& base = *job.base;
+
+    if (!job.delta) {
+        job.base->data = data;
+        job.base->hash = hash(data);
+    }
+    else {
+        // Unchanged bytes become zeroes, which compress down to almost nothing
+        size_t common = std::min(data.size(), base.data.size());
+        for (size_t i = 0u; i < common; ++i) {
+            data[i] ^= base.data[i];
+        }
+    }
+
+    int length = 0;
+    unsigned char* compressed = stbi_zlib_compress(
+        data.data(), static_cast<int>(data.size()), &length, CompressionQuality
+    );
+    if (!compressed) {
+        Log::error("Unable to compress snapshot " + job.filename);
+        return false;
+    }
+
+    Header header;
+    std::memcpy(header.magic, Magic, sizeof(Magic));
+    header.version  = Version;
+    header.delta    = job.delta ? 1u : 0u;
+    header.reserved = 0u;
+    header.size     = static_cast<uint32_t>(data.size());
+    header.baseHash = base.hash;
+
+    // Make sure the destination directory exists
+    auto separator = job.filename.find_last_of('/');
+    if (separator != std::string::npos) {
+        PHYSFS_mkdir(job.filename.substr(0u, separator).data());
+    }
+
+    bool succeeded = false;
+    PHYSFS_File* file = PHYSFS_openWrite(job.filename.data());
+    if (file) {
+        succeeded = PHYSFS_writeBytes(file, &header, sizeof(header)) == sizeof(header)
+            && PHYSFS_writeBytes(file, compressed, length) == static_cast<PHYSFS_sint64>(length);
+        PHYSFS_close(file);
+    }
+
+    if (!succeeded) {
+        Log::error("Unable to write snapshot " + job.filename + ": " + PHYSFS_getLastError());
+    }
+
+    std::free(compressed);
+    return succeeded;
+}
+
+uint32_t Snapshot::hash(const Buffer& data)
+{
+    // FNV-1a
+    uint32_t value = 2166136261u;
+    for (auto byte : data) {
+        value = (value ^ byte) * 16777619u;
+    }
+
+    return value;
+}
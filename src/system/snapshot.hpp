@@ -0,0 +1,102 @@
+/*
+    This is free and unencumbered software released into the public domain.
+
+    Anyone is free to copy, modify, publish, use, compile, sell, or
+    distribute this software, either in source code form or as a compiled
+    binary, for any purpose, commercial or non-commercial, and by any
+    means.
+
+    In jurisdictions that recognize copyright laws, the author or authors
+    of this software dedicate any and all copyright interest in the
+    software to the public domain. We make this dedication for the benefit
+    of the public at large and to the detriment of our heirs and
+    successors. We intend this dedication to be an overt act of
+    relinquishment in perpetuity of all present and future rights to this
+    software under copyright law.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+    MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+    IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+    OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+    ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+    OTHER DEALINGS IN THE SOFTWARE.
+
+    For more information, please refer to <http://unlicense.org>
+*/
+
+#pragma once
+#include "../config.hpp"
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Compressed binary snapshots, written in order by a background thread
+// Delta snapshots only store what changed since the last full snapshot
+class NX_HIDDEN Snapshot
+{
+public:
+    Snapshot() = default;
+    ~Snapshot();
+
+    // Makes room for size bytes of data, returns the buffer to fill
+    uint8_t* reserve(size_t size);
+
+    // Queues the first size bytes of the buffer to be compressed and written
+    bool save(const std::string& filename, size_t size, bool delta);
+    bool isBusy() const;
+    bool wait();
+
+    // Delta snapshots need the full snapshot they are based on to be loaded first
+    const uint8_t* load(const std::string& filename, size_t& size);
+
+    bool hasBase() const;
+
+private:
+    using Buffer = std::vector<uint8_t>;
+
+    struct Header
+    {
+        char magic[4];
+        uint8_t version;
+        uint8_t delta;
+        uint16_t reserved;
+        uint32_t size;
+        uint32_t baseHash;
+    };
+
+    struct Base
+    {
+        Buffer data;
+        uint32_t hash;
+    };
+
+    struct Job
+    {
+        std::string filename;
+        Buffer data;
+        std::shared_ptr<Base> base;
+        bool delta;
+    };
+
+    void run();
+    static bool write(Job& job);
+    static uint32_t hash(const Buffer& data);
+
+    Buffer mBuffer;
+    Buffer mLoaded;
+    std::shared_ptr<Base> mBase;
+
+    std::thread mWorker;
+    mutable std::mutex mMutex;
+    std::condition_variable mCondition;
+    std::deque<Job> mJobs;
+    size_t mPending {0u};
+    bool mStopping {false};
+    bool mSucceeded {true};
+};
@@ -0,0 +1,429 @@
+/*
+    This is free and unencumbered software released into the public domain.
+
+    Anyone is free to copy, modify, publish, use, compile, sell, or
+    distribute this software, either in source code form or as a compiled
+    binary, for any purpose, commercial or non-commercial, and by any
+    means.
+
+    In jurisdictions that recognize copyright laws, the author or authors
+    of this software dedicate any and all copyright interest in the
+    software to the public domain. We make this dedication for the benefit
+    of the public at large and to the detriment of our heirs and
+    successors. We intend this dedication to be an overt act of
+    relinquishment in perpetuity of all present and future rights to this
+    software under copyright law.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+    MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+    IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+    OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+    ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+    OTHER DEALINGS IN THE SOFTWARE.
+
+    For more information, please refer to <http://unlicense.org>
+*/
+
+#include "stream.hpp"
+#include "filesystem.hpp"
+
+#include <physfs/physfs.h>
+#include <algorithm>
+#include <cstring>
+
+// Locals
+namespace
+{
+    constexpr size_t MinBufferSize = 64u;
+
+    bool isHostBigEndian()
+    {
+        const uint16_t value = 1u;
+        uint8_t firstByte;
+        std::memcpy(&firstByte, &value, 1u);
+        return firstByte == 0u;
+    }
+
+    const bool HostBigEndian = isHostBigEndian();
+
+    void swapElements(uint8_t* data, size_t count, size_t elementSize)
+    {
+        for (size_t i = 0u; i < count; ++i, data += elementSize) {
+            std::reverse(data, data + elementSize);
+        }
+    }
+
+    template<typename T>
+    bool fitsIn(size_t value)
+    {
+        return static_cast<uint64_t>(value) <= static_cast<uint64_t>(static_cast<T>(-1));
+    }
+}
+
+Stream::~Stream()
+{
+    close();
+}
+
+bool Stream::open(const std::string& filename, Mode mode, size_t bufferSize)
+{
+    close();
+
+    mHandle = (mode == Read) ? PHYSFS_openRead(filename.data())
+                             : PHYSFS_openWrite(filename.data());
+    if (!mHandle) return fail();
+
+    mMode = mode;
+    mBuffer.resize(std::max(bufferSize, MinBufferSize));
+    mPosition = 0u;
+    mEnd = 0u;
+    mError.clear();
+
+    return true;
+}
+
+void Stream::close()
+{
+    if (!mHandle) return;
+
+    if (mMode == Write) commit();
+
+    PHYSFS_close(mHandle);
+    mHandle = nullptr;
+}
+
+bool Stream::isOpen() const
+{
+    return mHandle != nullptr;
+}
+
+void Stream::setBigEndian(bool bigEndian)
+{
+    mBigEndian = bigEndian;
+}
+
+bool Stream::isBigEndian() const
+{
+    return mBigEndian;
+}
+
+bool Stream::size(size_t& size)
+{
+    if (!mHandle) return fail("Stream is not open");
+    if (mMode == Write && !commit()) return false;
+
+    auto length = PHYSFS_fileLength(mHandle);
+    if (length < 0) return fail();
+
+    size = static_cast<size_t>(length);
+    return true;
+}
+
+bool Stream::tell(size_t& position)
+{
+    if (!mHandle) return fail("Stream is not open");
+
+    auto filePosition = PHYSFS_tell(mHandle);
+    if (filePosition < 0) return fail();
+
+    // The file cursor is past the buffered data when reading, behind it when writing
+    if (mMode == Read) {
+        position = static_cast<size_t>(filePosition) - (mEnd - mPosition);
+    }
+    else {
+        position = static_cast<size_t>(filePosition) + mPosition;
+    }
+
+    return true;
+}
+
+bool Stream::seek(size_t position)
+{
+    if (!mHandle) return fail("Stream is not open");
+
+    if (mMode == Read) {
+        // Seeking within the buffered block doesn't need to touch the file
+        auto filePosition = PHYSFS_tell(mHandle);
+        if (filePosition < 0) return fail();
+
+        auto blockStart = static_cast<size_t>(filePosition) - mEnd;
+        if (position >= blockStart && position <= blockStart + mEnd) {
+            mPosition = position - blockStart;
+            return true;
+        }
+
+        mPosition = 0u;
+        mEnd = 0u;
+    }
+    else if (!commit()) {
+        return false;
+    }
+
+    return PHYSFS_seek(mHandle, position) != 0 || fail();
+}
+
+bool Stream::flush()
+{
+    if (!mHandle) return fail("Stream is not open");
+    if (mMode == Read) return true;
+
+    return commit() && (PHYSFS_flush(mHandle) != 0 || fail());
+}
+
+bool Stream::read(void* data, size_t size, size_t& readBytes)
+{
+    readBytes = 0u;
+    if (!mHandle || mMode != Read) return fail("Stream is not open for reading");
+
+    auto* dst = static_cast<uint8_t*>(data);
+
+    while (readBytes < size) {
+        if (mPosition == mEnd) {
+            // Large reads skip the buffer altogether
+            if (size - readBytes >= mBuffer.size()) {
+                auto status = PHYSFS_readBytes(mHandle, dst + readBytes, size - readBytes);
+                if (status < 0) return fail();
+
+                readBytes += static_cast<size_t>(status);
+                break;
+            }
+
+            if (!fill()) return false;
+            if (mPosition == mEnd) break;
+        }
+
+        auto count = std::min(size - readBytes, mEnd - mPosition);
+        std::memcpy(dst + readBytes, mBuffer.data() + mPosition, count);
+        mPosition += count;
+        readBytes += count;
+    }
+
+    return true;
+}
+
+bool Stream::write(const void* data, size_t size)
+{
+    if (!mHandle || mMode != Write) return fail("Stream is not open for writing");
+
+    if (size > mBuffer.size() - mPosition && !commit()) return false;
+
+    // Large writes skip the buffer altogether
+    if (size >= mBuffer.size()) {
+        auto status = PHYSFS_writeBytes(mHandle, data, size);
+        return status == static_cast<PHYSFS_sint64>(size) || fail();
+    }
+
+    std::memcpy(mBuffer.data() + mPosition, data, size);
+    mPosition += size;
+
+    return true;
+}
+
+bool Stream::readArray(void* data, size_t count, size_t elementSize)
+{
+    auto size = count * elementSize;
+    size_t readBytes;
+    if (!read(data, size, readBytes)) return false;
+    if (readBytes != size) return fail("Unexpected end of file");
+
+    if (elementSize > 1u && needsSwap()) {
+        swapElements(static_cast<uint8_t*>(data), count, elementSize);
+    }
+
+    return true;
+}
+
+bool Stream::writeArray(const void* data, size_t count, size_t elementSize)
+{
+    if (elementSize <= 1u || !needsSwap()) return write(data, count * elementSize);
+
+    if (!mHandle || mMode != Write) return fail("Stream is not open for writing");
+    if (elementSize > mBuffer.size()) return fail("Element size is too large");
+
+    // Swap the elements in place inside the buffer, as many as fit at a time
+    auto* src = static_cast<const uint8_t*>(data);
+    while (count > 0u) {
+        auto batch = std::min(count, (mBuffer.size() - mPosition) / elementSize);
+        if (batch == 0u) {
+            if (!commit()) return false;
+            continue;
+        }
+
+        auto* dst = mBuffer.data() + mPosition;
+        std::memcpy(dst, src, batch * elementSize);
+        swapElements(dst, batch, elementSize);
+
+        mPosition += batch * elementSize;
+        src += batch * elementSize;
+        count -= batch;
+    }
+
+    return true;
+}
+
+const char* Stream::readCString(size_t& length)
+{
+    if (!mHandle || mMode != Read) {
+        fail("Stream is not open for reading");
+        return nullptr;
+    }
+
+    mString.clear();
+
+    while (true) {
+        auto* begin = mBuffer.data() + mPosition;
+        auto* end = static_cast<uint8_t*>(std::memchr(begin, '\0', mEnd - mPosition));
+
+        if (end) {
+            mString.append(reinterpret_cast<const char*>(begin), end - begin);
+            mPosition += (end - begin) + 1u;
+            break;
+        }
+
+        mString.append(reinterpret_cast<const char*>(begin), mEnd - mPosition);
+        mPosition = mEnd;
+
+        if (!fill()) return nullptr;
+        if (mPosition == mEnd) {
+            fail("Unexpected end of file");
+            return nullptr;
+        }
+    }
+
+    length = mString.size();
+    return mString.data();
+}
+
+const char* Stream::readLengthPrefixed(size_t prefixSize, size_t& length)
+{
+    uint64_t prefix = 0u;
+
+    switch (prefixSize) {
+        case 1u: {
+            uint8_t value;
+            if (!readArray(&value, 1u, 1u)) return nullptr;
+            prefix = value;
+            break;
+        }
+        case 2u: {
+            uint16_t value;
+            if (!readArray(&value, 1u, 2u)) return nullptr;
+            prefix = value;
+            break;
+        }
+        case 4u: {
+            uint32_t value;
+            if (!readArray(&value, 1u, 4u)) return nullptr;
+            prefix = value;
+            break;
+        }
+        case 8u: {
+            if (!readArray(&prefix, 1u, 8u)) return nullptr;
+            break;
+        }
+        default:
+            fail("Invalid length prefix size");
+            return nullptr;
+    }
+
+    // Don't trust the prefix with an allocation larger than the file
+    size_t fileSize, position;
+    if (!size(fileSize) || !tell(position)) return nullptr;
+    if (prefix > fileSize - position) {
+        fail("Unexpected end of file");
+        return nullptr;
+    }
+
+    mString.resize(static_cast<size_t>(prefix));
+    size_t readBytes;
+    if (!read(&mString[0], mString.size(), readBytes)) return nullptr;
+    if (readBytes != mString.size()) {
+        fail("Unexpected end of file");
+        return nullptr;
+    }
+
+    length = mString.size();
+    return mString.data();
+}
+
+bool Stream::writeLengthPrefixed(const char* str, size_t length, size_t prefixSize)
+{
+    bool written = false;
+
+    switch (prefixSize) {
+        case 1u: {
+            if (!fitsIn<uint8_t>(length)) return fail("String is too long");
+            auto value = static_cast<uint8_t>(length);
+            written = writeArray(&value, 1u, 1u);
+            break;
+        }
+        case 2u: {
+            if (!fitsIn<uint16_t>(length)) return fail("String is too long");
+            auto value = static_cast<uint16_t>(length);
+            written = writeArray(&value, 1u, 2u);
+            break;
+        }
+        case 4u: {
+            if (!fitsIn<uint32_t>(length)) return fail("String is too long");
+            auto value = static_cast<uint32_t>(length);
+            written = writeArray(&value, 1u, 4u);
+            break;
+        }
+        case 8u: {
+            auto value = static_cast<uint64_t>(length);
+            written = writeArray(&value, 1u, 8u);
+            break;
+        }
+        default:
+            return fail("Invalid length prefix size");
+    }
+
+    return written && write(str, length);
+}
+
+const std::string& Stream::getError() const
+{
+    return mError;
+}
+
+bool Stream::fill()
+{
+    // Keep whatever wasn't consumed yet at the front of the buffer
+    auto remaining = mEnd - mPosition;
+    if (remaining > 0u && mPosition > 0u) {
+        std::memmove(mBuffer.data(), mBuffer.data() + mPosition, remaining);
+    }
+
+    mPosition = 0u;
+    mEnd = remaining;
+
+    auto status = PHYSFS_readBytes(mHandle, mBuffer.data() + mEnd, mBuffer.size() - mEnd);
+    if (status < 0) return fail();
+
+    // Nothing new past the end of the file, which isn't an error
+    mEnd += static_cast<size_t>(status);
+    return true;
+}
+
+bool Stream::commit()
+{
+    if (mPosition == 0u) return true;
+
+    auto status = PHYSFS_writeBytes(mHandle, mBuffer.data(), mPosition);
+    if (status != static_cast<PHYSFS_sint64>(mPosition)) return fail();
+
+    mPosition = 0u;
+    return true;
+}
+
+bool Stream::needsSwap() const
+{
+    return mBigEndian != HostBigEndian;
+}
+
+bool Stream::fail(const char* message)
+{
+    mError = message ? message : Filesystem::getErrorMessage();
+    return false;
+}
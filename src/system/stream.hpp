@@ -0,0 +1,99 @@
+/*
+    This is free and unencumbered software released into the public domain.
+
+    Anyone is free to copy, modify, publish, use, compile, sell, or
+    distribute this software, either in source code form or as a compiled
+    binary, for any purpose, commercial or non-commercial, and by any
+    means.
+
+    In jurisdictions that recognize copyright laws, the author or authors
+    of this software dedicate any and all copyright interest in the
+    software to the public domain. We make this dedication for the benefit
+    of the public at large and to the detriment of our heirs and
+    successors. We intend this dedication to be an overt act of
+    relinquishment in perpetuity of all present and future rights to this
+    software under copyright law.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+    MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+    IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+    OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+    ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+    OTHER DEALINGS IN THE SOFTWARE.
+
+    For more information, please refer to <http://unlicense.org>
+*/
+
+#pragma once
+#include "../config.hpp"
+
+#include <string>
+#include <vector>
+
+struct PHYSFS_File;
+
+// Buffered binary file stream, reads or writes whole blocks at a time
+// Multi-byte values are swapped when the stream's endianness isn't the host's
+class NX_HIDDEN Stream
+{
+public:
+    enum Mode
+    {
+        Read,
+        Write
+    };
+
+    static constexpr size_t DefaultBufferSize = 64u * 1024u;
+
+    Stream() = default;
+    ~Stream();
+
+    bool open(const std::string& filename, Mode mode, size_t bufferSize = DefaultBufferSize);
+    void close();
+    bool isOpen() const;
+
+    void setBigEndian(bool bigEndian);
+    bool isBigEndian() const;
+
+    bool size(size_t& size);
+    bool tell(size_t& position);
+    bool seek(size_t position);
+    bool flush();
+
+    // Raw bytes, for strings and whole structs
+    // Fails on read errors only, fewer bytes than asked for are read at the end of the file
+    bool read(void* data, size_t size, size_t& readBytes);
+    bool write(const void* data, size_t size);
+
+    // Arrays of count scalars of elementSize bytes each
+    bool readArray(void* data, size_t count, size_t elementSize);
+    bool writeArray(const void* data, size_t count, size_t elementSize);
+
+    // Null-terminated string, valid until the next string read
+    const char* readCString(size_t& length);
+
+    // String preceded by its length as an unsigned integer of prefixSize bytes
+    const char* readLengthPrefixed(size_t prefixSize, size_t& length);
+    bool writeLengthPrefixed(const char* str, size_t length, size_t prefixSize);
+
+    const std::string& getError() const;
+
+private:
+    bool fill();
+    bool commit();
+    bool needsSwap() const;
+    bool fail(const char* message = nullptr);
+
+    PHYSFS_File* mHandle = nullptr;
+    Mode mMode = Read;
+    bool mBigEndian = false;
+
+    // Read: data lives between mPosition and mEnd; Write: pending data ends at mPosition
+    std::vector<uint8_t> mBuffer;
+    size_t mPosition = 0u;
+    size_t mEnd = 0u;
+
+    std::string mString;
+    std::string mError;
+};
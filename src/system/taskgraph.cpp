@@ -0,0 +1,220 @@
+/*
+    This is free and unencumbered software released into the public domain.
+
+    Anyone is free to copy, modify, publish, use, compile, sell, or
+    distribute this software, either in source code form or as a compiled
+    binary, for any purpose, commercial or non-commercial, and by any
+    means.
+
+    In jurisdictions that recognize copyright laws, the author or authors
+    of this software dedicate any and all copyright interest in the
+    software to the public domain. We make this dedication for the benefit
+    of the public at large and to the detriment of our heirs and
+    successors. We intend this dedication to be an overt act of
+    relinquishment in perpetuity of all present and future rights to this
+    software under copyright law.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+    MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+    IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+    OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+    ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+    OTHER DEALINGS IN THE SOFTWARE.
+
+    For more information, please refer to <http://unlicense.org>
+*/
+
+#include "taskgraph.hpp"
+
+#include <algorithm>
+#include <chrono>
+
+uint32_t TaskGraph::add()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    uint32_t node;
+    if (mFreeNodes.empty()) {
+        node = static_cast<uint32_t>(mNodes.size());
+        mNodes.emplace_back();
+    }
+    else {
+        node = mFreeNodes.back();
+        mFreeNodes.pop_back();
+    }
+
+    // New nodes are runnable right away
+    Node& entry = mNodes[node];
+    entry.dependents.clear();
+    entry.dependencies.clear();
+    entry.pending = 0u;
+    entry.status  = Pending;
+    entry.waiting = false;
+    entry.queued  = false;
+
+    return node;
+}
+
+void TaskGraph::remove(uint32_t node)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (!isValid(node)) return;
+
+    // The id gets reused, dependencies must not count down a future node when they finish
+    Node& entry = mNodes[node];
+    for (auto dependency : entry.dependencies) {
+        if (!isValid(dependency) || mNodes[dependency].status != Pending) continue;
+
+        auto& dependents = mNodes[dependency].dependents;
+        dependents.erase(std::remove(dependents.begin(), dependents.end(), node),
+            dependents.end());
+    }
+
+    if (entry.queued) {
+        mQueue.erase(std::remove(mQueue.begin(), mQueue.end(), node), mQueue.end());
+    }
+
+    entry.status = Invalid;
+    entry.dependents.clear();
+    entry.dependencies.clear();
+    mFreeNodes.push_back(node);
+}
+
+void TaskGraph::depend(uint32_t node, uint32_t dependency)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (!isValid(node) || !isValid(dependency) || mNodes[node].status != Pending) return;
+
+    Node& entry = mNodes[dependency];
+    if (entry.status == Failed) {
+        failRecursive(node);
+    }
+    else if (entry.status == Pending) {
+        entry.dependents.push_back(node);
+        mNodes[node].dependencies.push_back(dependency);
+        ++mNodes[node].pending;
+    }
+}
+
+bool TaskGraph::await(uint32_t node)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (!isValid(node)) return false;
+
+    Node& entry = mNodes[node];
+    entry.waiting = entry.pending > 0u;
+    return entry.waiting;
+}
+
+void TaskGraph::signal(uint32_t node)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (!isValid(node)) return;
+
+    Node& entry = mNodes[node];
+    if (entry.pending == 0u) {
+        enqueue(node);
+    }
+    else {
+        entry.waiting = true;
+    }
+}
+
+void TaskGraph::complete(uint32_t node)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (!isValid(node) || mNodes[node].status != Pending) return;
+
+    Node& entry = mNodes[node];
+    entry.status = Done;
+
+    for (auto dependent : entry.dependents) {
+        Node& other = mNodes[dependent];
+        if (other.status != Pending) continue;
+
+        if (--other.pending == 0u && other.waiting) {
+            enqueue(dependent);
+        }
+    }
+    entry.dependents.clear();
+}
+
+void TaskGraph::fail(uint32_t node)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (!isValid(node) || mNodes[node].status != Pending) return;
+
+    // The node itself is being handled by the caller, only notify its dependents
+    Node& entry = mNodes[node];
+    entry.status = Failed;
+
+    std::vector<uint32_t> dependents;
+    dependents.swap(entry.dependents);
+    for (auto dependent : dependents) {
+        failRecursive(dependent);
+    }
+}
+
+TaskGraph::Status TaskGraph::status(uint32_t node) const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return isValid(node) ? mNodes[node].status : Invalid;
+}
+
+size_t TaskGraph::poll(uint32_t* nodes, size_t max)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    size_t count = 0u;
+    while (count < max && !mQueue.empty()) {
+        uint32_t node = mQueue.front();
+        mQueue.pop_front();
+
+        if (!isValid(node)) continue;
+        mNodes[node].queued = false;
+        nodes[count++] = node;
+    }
+
+    return count;
+}
+
+bool TaskGraph::wait(uint32_t timeout)
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+
+    return mCondition.wait_for(lock, std::chrono::milliseconds(timeout), [this] {
+        return !mQueue.empty();
+    });
+}
+
+bool TaskGraph::isValid(uint32_t node) const
+{
+    return node < mNodes.size() && mNodes[node].status != Invalid;
+}
+
+void TaskGraph::enqueue(uint32_t node)
+{
+    Node& entry = mNodes[node];
+    entry.waiting = false;
+    if (entry.queued) return;
+
+    entry.queued = true;
+    mQueue.push_back(node);
+    mCondition.notify_all();
+}
+
+void TaskGraph::failRecursive(uint32_t node)
+{
+    Node& entry = mNodes[node];
+    if (entry.status != Pending) return;
+
+    entry.status = Failed;
+    enqueue(node);
+
+    std::vector<uint32_t> dependents;
+    dependents.swap(entry.dependents);
+    for (auto dependent : dependents) {
+        failRecursive(dependent);
+    }
+}
@@ -0,0 +1,90 @@
+/*
+    This is free and unencumbered software released into the public domain.
+
+    Anyone is free to copy, modify, publish, use, compile, sell, or
+    distribute this software, either in source code form or as a compiled
+    binary, for any purpose, commercial or non-commercial, and by any
+    means.
+
+    In jurisdictions that recognize copyright laws, the author or authors
+    of this software dedicate any and all copyright interest in the
+    software to the public domain. We make this dedication for the benefit
+    of the public at large and to the detriment of our heirs and
+    successors. We intend this dedication to be an overt act of
+    relinquishment in perpetuity of all present and future rights to this
+    software under copyright law.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+    MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+    IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+    OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+    ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+    OTHER DEALINGS IN THE SOFTWARE.
+
+    For more information, please refer to <http://unlicense.org>
+*/
+
+#pragma once
+#include "../config.hpp"
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+// Dependency graph of loading tasks
+// Nodes are queued as soon as they become runnable, whichever thread caused it
+class NX_HIDDEN TaskGraph
+{
+public:
+    enum Status : uint32_t {
+        Pending,
+        Done,
+        Failed,
+        Invalid
+    };
+
+public:
+    uint32_t add();
+    void remove(uint32_t node);
+
+    // Makes node wait for dependency, fails it if dependency already failed
+    void depend(uint32_t node, uint32_t dependency);
+
+    // Returns true if the node has unfinished dependencies,
+    // it will then be queued once they're done
+    bool await(uint32_t node);
+
+    // Queues the node once its dependencies are done
+    void signal(uint32_t node);
+
+    void complete(uint32_t node);
+    void fail(uint32_t node);
+
+    Status status(uint32_t node) const;
+
+    size_t poll(uint32_t* nodes, size_t max);
+    bool wait(uint32_t timeout);
+
+private:
+    struct Node
+    {
+        std::vector<uint32_t> dependents;
+        std::vector<uint32_t> dependencies;
+        uint32_t pending;
+        Status status;
+        bool waiting;
+        bool queued;
+    };
+
+    bool isValid(uint32_t node) const;
+    void enqueue(uint32_t node);
+    void failRecursive(uint32_t node);
+
+    mutable std::mutex mMutex;
+    std::condition_variable mCondition;
+    std::vector<Node> mNodes;
+    std::vector<uint32_t> mFreeNodes;
+    std::deque<uint32_t> mQueue;
+};
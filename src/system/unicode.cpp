@@ -27,123 +27,320 @@
 
 #include "unicode.hpp"
 
-#include <iterator>
+#include <cstdint>
+#include <cstring>
 
-template <typename In>
-static In decodeUtf8(In begin, In end, uint32_t& output, uint32_t rep)
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #include <emmintrin.h>
+    #define NX_UNICODE_SSE2
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+    #include <arm_neon.h>
+    #define NX_UNICODE_NEON
+#endif
+
+//----------------------------------------------------------
+// Locals
+//----------------------------------------------------------
+namespace
 {
-    static const int trailing[256] {
-        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-        1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
-        1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
-        2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
-        3, 3, 3, 3, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5
-    };
-
-    static const uint32_t offsets[6] {
-        0x00000000, 0x00003080, 0x000E2080, 0x03C82080, 0xFA082080, 0x82082080
-    };
-
-    // decode the character
-    int trailingBytes = trailing[static_cast<uint8_t>(*begin)];
-
-    if (begin + trailingBytes < end) {
-        output = 0;
-        switch(trailingBytes) {
-            case 5: output += static_cast<uint8_t>(*begin++); output <<= 6;
-            case 4: output += static_cast<uint8_t>(*begin++); output <<= 6;
-            case 3: output += static_cast<uint8_t>(*begin++); output <<= 6;
-            case 2: output += static_cast<uint8_t>(*begin++); output <<= 6;
-            case 1: output += static_cast<uint8_t>(*begin++); output <<= 6;
-            case 0: output += static_cast<uint8_t>(*begin++);
-        }
-        output -= offsets[trailingBytes];
+    // Decodes a single code point, ill-formed sequences are replaced one maximal subpart
+    // at a time, as recommended by the Unicode standard
+    inline const uint8_t* decodeUtf8(const uint8_t* it, const uint8_t* end, char32_t& output,
+        char32_t replacement)
+    {
+        uint8_t lead = *it++;
+        if (lead < 0x80u) {
+            output = lead;
+            return it;
+        }
+
+        // Continuation bytes, overlong 2-byte leads and leads past U+10FFFF
+        if (lead < 0xC2u || lead > 0xF4u) {
+            output = replacement;
+            return it;
+        }
+
+        uint32_t codePoint;
+        int trailing;
+        uint8_t lower = 0x80u, upper = 0xBFu;
+
+        if (lead < 0xE0u) {
+            codePoint = lead & 0x1Fu;
+            trailing = 1;
+        }
+        else if (lead < 0xF0u) {
+            codePoint = lead & 0x0Fu;
+            trailing = 2;
+            if (lead == 0xE0u) lower = 0xA0u; // Overlong
+            if (lead == 0xEDu) upper = 0x9Fu; // Surrogates
+        }
+        else {
+            codePoint = lead & 0x07u;
+            trailing = 3;
+            if (lead == 0xF0u) lower = 0x90u; // Overlong
+            if (lead == 0xF4u) upper = 0x8Fu; // Past U+10FFFF
+        }
+
+        for (; trailing > 0; --trailing) {
+            if (it == end || *it < lower || *it > upper) {
+                output = replacement;
+                return it;
+            }
+
+            codePoint = (codePoint << 6u) | (*it++ & 0x3Fu);
+            lower = 0x80u;
+            upper = 0xBFu;
+        }
+
+        output = static_cast<char32_t>(codePoint);
+        return it;
     }
-    else {
-        // Incomplete character
-        begin = end;
-        output = rep;
+
+    inline size_t encodedLength(char32_t codePoint)
+    {
+        if (codePoint < 0x80u) return 1u;
+        if (codePoint < 0x800u) return 2u;
+        if (codePoint < 0x10000u) return 3u; // Surrogates become the 3 byte replacement
+        if (codePoint <= 0x10FFFFu) return 4u;
+        return 3u; // Replacement character
     }
 
-    return begin;
-}
+    inline char* encodeUtf8(char32_t codePoint, char* output)
+    {
+        // Surrogates and code points out of range can't be encoded
+        if ((codePoint >= 0xD800u && codePoint <= 0xDFFFu) || codePoint > 0x10FFFFu) {
+            codePoint = Unicode::Replacement;
+        }
 
-template <typename Out>
-static Out encodeUtf8(uint32_t input, Out output)
-{
-    // Some useful precomputed data
-    static const uint8_t firstBytes[7] { 0x00, 0x00, 0xC0, 0xE0, 0xF0, 0xF8, 0xFC };
-
-    if (input <= 0x0010FFFF && (input < 0xD800 || input > 0xDBFF)) {
-        // Valid character
-
-        // Get the number of bytes to write
-        std::size_t bytesToWrite = 1;
-        if      (input <  0x80)       bytesToWrite = 1;
-        else if (input <  0x800)      bytesToWrite = 2;
-        else if (input <  0x10000)    bytesToWrite = 3;
-        else if (input <= 0x0010FFFF) bytesToWrite = 4;
-
-        // Extract the bytes to write
-        uint8_t bytes[4];
-        switch (bytesToWrite)
-        {
-            case 4: bytes[3] = static_cast<uint8_t>((input | 0x80) & 0xBF); input >>= 6;
-            case 3: bytes[2] = static_cast<uint8_t>((input | 0x80) & 0xBF); input >>= 6;
-            case 2: bytes[1] = static_cast<uint8_t>((input | 0x80) & 0xBF); input >>= 6;
-            case 1: bytes[0] = static_cast<uint8_t> (input | firstBytes[bytesToWrite]);
-        }
-
-        // Add them to the output
-        output = std::copy(bytes, bytes + bytesToWrite, output);
+        if (codePoint < 0x80u) {
+            *output++ = static_cast<char>(codePoint);
+        }
+        else if (codePoint < 0x800u) {
+            *output++ = static_cast<char>(0xC0u | (codePoint >> 6u));
+            *output++ = static_cast<char>(0x80u | (codePoint & 0x3Fu));
+        }
+        else if (codePoint < 0x10000u) {
+            *output++ = static_cast<char>(0xE0u | (codePoint >> 12u));
+            *output++ = static_cast<char>(0x80u | ((codePoint >> 6u) & 0x3Fu));
+            *output++ = static_cast<char>(0x80u | (codePoint & 0x3Fu));
+        }
+        else {
+            *output++ = static_cast<char>(0xF0u | (codePoint >> 18u));
+            *output++ = static_cast<char>(0x80u | ((codePoint >> 12u) & 0x3Fu));
+            *output++ = static_cast<char>(0x80u | ((codePoint >> 6u) & 0x3Fu));
+            *output++ = static_cast<char>(0x80u | (codePoint & 0x3Fu));
+        }
+
+        return output;
+    }
+
+    // Length of the run of ASCII characters at the start of the input, in 16 byte blocks
+    inline size_t asciiBlocks(const uint8_t* it, const uint8_t* end)
+    {
+        const uint8_t* begin = it;
+
+        #if defined(NX_UNICODE_SSE2)
+            while (end - it >= 16) {
+                __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(it));
+                if (_mm_movemask_epi8(block) != 0) break;
+                it += 16;
+            }
+        #else
+            while (end - it >= 16) {
+                uint64_t block[2];
+                std::memcpy(block, it, 16u);
+                if (((block[0] | block[1]) & 0x8080808080808080ull) != 0u) break;
+                it += 16;
+            }
+        #endif
+
+        return static_cast<size_t>(it - begin);
+    }
+
+    // Widens a block of 16 ASCII characters
+    inline void widenAscii(const uint8_t* input, char32_t* output)
+    {
+        #if defined(NX_UNICODE_SSE2)
+            __m128i zero  = _mm_setzero_si128();
+            __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input));
+            __m128i low   = _mm_unpacklo_epi8(block, zero);
+            __m128i high  = _mm_unpackhi_epi8(block, zero);
+
+            auto out = reinterpret_cast<__m128i*>(output);
+            _mm_storeu_si128(out + 0, _mm_unpacklo_epi16(low, zero));
+            _mm_storeu_si128(out + 1, _mm_unpackhi_epi16(low, zero));
+            _mm_storeu_si128(out + 2, _mm_unpacklo_epi16(high, zero));
+            _mm_storeu_si128(out + 3, _mm_unpackhi_epi16(high, zero));
+        #elif defined(NX_UNICODE_NEON)
+            uint8x16_t block = vld1q_u8(input);
+            uint16x8_t low   = vmovl_u8(vget_low_u8(block));
+            uint16x8_t high  = vmovl_u8(vget_high_u8(block));
+
+            auto out = reinterpret_cast<uint32_t*>(output);
+            vst1q_u32(out + 0,  vmovl_u16(vget_low_u16(low)));
+            vst1q_u32(out + 4,  vmovl_u16(vget_high_u16(low)));
+            vst1q_u32(out + 8,  vmovl_u16(vget_low_u16(high)));
+            vst1q_u32(out + 12, vmovl_u16(vget_high_u16(high)));
+        #else
+            for (int i = 0; i < 16; ++i) output[i] = input[i];
+        #endif
     }
 
-    return output;
+    // Length of the run of ASCII code points at the start of the input, in blocks of 8
+    inline size_t asciiCodePoints(const char32_t* it, const char32_t* end)
+    {
+        const char32_t* begin = it;
+
+        #if defined(NX_UNICODE_SSE2)
+            __m128i mask = _mm_set1_epi32(~0x7F);
+            while (end - it >= 8) {
+                auto in = reinterpret_cast<const __m128i*>(it);
+                __m128i bits = _mm_or_si128(_mm_loadu_si128(in), _mm_loadu_si128(in + 1));
+                if (_mm_movemask_epi8(_mm_cmpeq_epi32(_mm_and_si128(bits, mask), _mm_setzero_si128())) != 0xFFFF) break;
+                it += 8;
+            }
+        #else
+            while (end - it >= 8) {
+                uint32_t bits = 0u;
+                for (int i = 0; i < 8; ++i) bits |= static_cast<uint32_t>(it[i]);
+                if (bits >= 0x80u) break;
+                it += 8;
+            }
+        #endif
+
+        return static_cast<size_t>(it - begin);
+    }
+
+    // Narrows a block of 8 ASCII code points
+    inline void narrowAscii(const char32_t* input, char* output)
+    {
+        #if defined(NX_UNICODE_SSE2)
+            auto in = reinterpret_cast<const __m128i*>(input);
+            __m128i words = _mm_packs_epi32(_mm_loadu_si128(in), _mm_loadu_si128(in + 1));
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(output), _mm_packus_epi16(words, words));
+        #elif defined(NX_UNICODE_NEON)
+            auto in = reinterpret_cast<const uint32_t*>(input);
+            uint16x8_t words = vcombine_u16(vmovn_u32(vld1q_u32(in)), vmovn_u32(vld1q_u32(in + 4)));
+            vst1_u8(reinterpret_cast<uint8_t*>(output), vmovn_u16(words));
+        #else
+            for (int i = 0; i < 8; ++i) output[i] = static_cast<char>(input[i]);
+        #endif
+    }
 }
 
 namespace Unicode
 {
-    std::u32string utf8To32(const std::string& str)
+    bool isValidUtf8(const char* begin, const char* end)
     {
-        std::u32string output;
-        output.reserve(str.length());
+        auto it = reinterpret_cast<const uint8_t*>(begin);
+        auto last = reinterpret_cast<const uint8_t*>(end);
 
-        auto begin = str.begin();
-        auto end = str.end();
+        while (it < last) {
+            it += asciiBlocks(it, last);
+            if (it == last) break;
 
-        while (begin < end) {
-            uint32_t codepoint;
-            begin = decodeUtf8(begin, end, codepoint, U'?');
-            output += codepoint;
+            // Use a value that can't be decoded as the marker
+            char32_t codePoint;
+            it = decodeUtf8(it, last, codePoint, 0xFFFFFFFFu);
+            if (codePoint == 0xFFFFFFFFu) return false;
+        }
+
+        return true;
+    }
+
+    size_t utf32Length(const char* begin, const char* end)
+    {
+        auto it = reinterpret_cast<const uint8_t*>(begin);
+        auto last = reinterpret_cast<const uint8_t*>(end);
+        size_t length = 0u;
+
+        while (it < last) {
+            size_t ascii = asciiBlocks(it, last);
+            it += ascii;
+            length += ascii;
+            if (it == last) break;
+
+            char32_t codePoint;
+            it = decodeUtf8(it, last, codePoint, Replacement);
+            ++length;
+        }
+
+        return length;
+    }
+
+    char32_t* utf8To32(const char* begin, const char* end, char32_t* output,
+        char32_t replacement)
+    {
+        auto it = reinterpret_cast<const uint8_t*>(begin);
+        auto last = reinterpret_cast<const uint8_t*>(end);
+
+        while (it < last) {
+            // Widen runs of ASCII characters 16 at a time
+            size_t ascii = asciiBlocks(it, last);
+            for (size_t i = 0u; i < ascii; i += 16u) {
+                widenAscii(it + i, output + i);
+            }
+            it += ascii;
+            output += ascii;
+            if (it == last) break;
+
+            it = decodeUtf8(it, last, *output++, replacement);
         }
 
         return output;
     }
 
-    std::string utf32To8(const std::u32string& str)
+    size_t utf8Length(const char32_t* begin, const char32_t* end)
     {
-        std::string output;
-        output.reserve(str.length());
+        size_t length = 0u;
 
-        auto begin = str.begin();
-        auto end   = str.end();
-        auto out   = std::back_inserter(output);
+        while (begin < end) {
+            size_t ascii = asciiCodePoints(begin, end);
+            begin += ascii;
+            length += ascii;
+            if (begin == end) break;
+
+            length += encodedLength(*begin++);
+        }
+
+        return length;
+    }
 
+    char* utf32To8(const char32_t* begin, const char32_t* end, char* output)
+    {
         while (begin < end) {
-            out = encodeUtf8(*begin++, out);
+            // Narrow runs of ASCII code points 8 at a time
+            size_t ascii = asciiCodePoints(begin, end);
+            for (size_t i = 0u; i < ascii; i += 8u) {
+                narrowAscii(begin + i, output + i);
+            }
+            begin += ascii;
+            output += ascii;
+            if (begin == end) break;
+
+            output = encodeUtf8(*begin++, output);
         }
 
         return output;
     }
+
+    std::u32string utf8To32(const std::string& str)
+    {
+        const char* begin = str.data();
+        const char* end = begin + str.size();
+
+        std::u32string output(utf32Length(begin, end), U'\0');
+        utf8To32(begin, end, &output[0]);
+        return output;
+    }
+
+    std::string utf32To8(const std::u32string& str)
+    {
+        const char32_t* begin = str.data();
+        const char32_t* end = begin + str.size();
+
+        std::string output(utf8Length(begin, end), '\0');
+        utf32To8(begin, end, &output[0]);
+        return output;
+    }
 }
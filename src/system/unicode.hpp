@@ -27,10 +27,32 @@
 
 #pragma once
 
+#include <cstddef>
 #include <string>
 
+// UTF-8 and UTF-32 transcoding, invalid input is replaced with U+FFFD
 namespace Unicode
 {
+    constexpr char32_t Replacement = 0xFFFD;
+
+    // True if the input is well-formed UTF-8
+    bool isValidUtf8(const char* begin, const char* end);
+
+    // Number of code points utf8To32() will write for the given input
+    size_t utf32Length(const char* begin, const char* end);
+
+    // Decodes into output, which must have room for utf32Length() code points
+    // Returns the end of the written range
+    char32_t* utf8To32(const char* begin, const char* end, char32_t* output,
+        char32_t replacement = Replacement);
+
+    // Number of bytes utf32To8() will write for the given input
+    size_t utf8Length(const char32_t* begin, const char32_t* end);
+
+    // Encodes into output, which must have room for utf8Length() bytes
+    // Returns the end of the written range
+    char* utf32To8(const char32_t* begin, const char32_t* end, char* output);
+
     std::u32string utf8To32(const std::string& str);
     std::string utf32To8(const std::u32string& str);
 }
@@ -0,0 +1,99 @@
+/*
+    This is free and unencumbered software released into the public domain.
+
+    Anyone is free to copy, modify, publish, use, compile, sell, or
+    distribute this software, either in source code form or as a compiled
+    binary, for any purpose, commercial or non-commercial, and by any
+    means.
+
+    In jurisdictions that recognize copyright laws, the author or authors
+    of this software dedicate any and all copyright interest in the
+    software to the public domain. We make this dedication for the benefit
+    of the public at large and to the detriment of our heirs and
+    successors. We intend this dedication to be an overt act of
+    relinquishment in perpetuity of all present and future rights to this
+    software under copyright law.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+    MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+    IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+    OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+    ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+    OTHER DEALINGS IN THE SOFTWARE.
+
+    For more information, please refer to <http://unlicense.org>
+*/
+
+// Task graph regression checks, exits with a non zero status on the first failure
+
+#include "system/taskgraph.hpp"
+
+#include <cstdio>
+
+//----------------------------------------------------------
+// Locals
+//----------------------------------------------------------
+namespace
+{
+    int failures = 0;
+
+    void check(bool condition, const char* what)
+    {
+        if (condition) return;
+
+        std::fprintf(stderr, "FAILED: %s\n", what);
+        ++failures;
+    }
+
+    // A removed node's id is reused, finishing its old dependency must not touch the new node
+    void removeWhileDependencyPending()
+    {
+        TaskGraph graph;
+
+        uint32_t dependency = graph.add();
+        uint32_t node = graph.add();
+        graph.depend(node, dependency);
+        check(graph.await(node), "node waits for its dependency");
+
+        graph.remove(node);
+        uint32_t reused = graph.add();
+        check(reused == node, "removed id is reused");
+
+        uint32_t other = graph.add();
+        graph.depend(reused, other);
+        check(graph.await(reused), "new node waits for its own dependency");
+
+        graph.complete(dependency);
+        uint32_t polled[4];
+        check(graph.poll(polled, 4u) == 0u, "stale dependency doesn't queue the new node");
+
+        graph.complete(other);
+        check(graph.poll(polled, 4u) == 1u && polled[0] == reused,
+            "new node runs once its dependency is done");
+    }
+
+    // A queued node that gets removed isn't handed out under its new owner
+    void removeWhileQueued()
+    {
+        TaskGraph graph;
+
+        uint32_t node = graph.add();
+        graph.signal(node);
+        graph.remove(node);
+        graph.add();
+
+        uint32_t polled[4];
+        check(graph.poll(polled, 4u) == 0u, "removed node is dropped from the queue");
+    }
+}
+
+//----------------------------------------------------------
+int main()
+{
+    removeWhileDependencyPending();
+    removeWhileQueued();
+
+    if (failures == 0) std::printf("taskgraph: all checks passed\n");
+    return failures == 0 ? 0 : 1;
+}